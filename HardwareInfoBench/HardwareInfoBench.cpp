@@ -0,0 +1,802 @@
+﻿// HardwareInfo 效能測試：以合成或重播來源驅動與 HardwareInfo 相同的原生路徑
+// (繫結、輪詢、訂閱、衍生指標、拓撲彙總、自適應取樣、JSON 串流輸出、frame 發布、快照複製、歷史、變化串流、警示規則、時間序列錄製、共享記憶體、OpenMetrics、集中收集)，
+// 不需要感測器硬體、系統管理員權限或 .NET，可在 Linux CI 執行。
+// 每個項目輸出 ns/op、allocs/op 與 B/op (取代全域 operator new 計數)。
+//
+// Windows：建置 HardwareInfoBench.vcxproj
+// Linux (在方案目錄執行)：
+//   g++ -std=c++17 -O2 -I HardwareInfoDll -o hwibench HardwareInfoBench/HardwareInfoBench.cpp HardwareInfoDll/AdaptiveSampling.cpp HardwareInfoDll/AlertRules.cpp HardwareInfoDll/CpuTopology.cpp HardwareInfoDll/DeltaStream.cpp HardwareInfoDll/DerivedMetrics.cpp HardwareInfoDll/Diagnostics.cpp HardwareInfoDll/FleetCollector.cpp HardwareInfoDll/SensorSource.cpp HardwareInfoDll/SeriesRecorder.cpp HardwareInfoDll/SensorModel.cpp HardwareInfoDll/InfoSerializer.cpp HardwareInfoDll/MetricsExporter.cpp HardwareInfoDll/SensorHistory.cpp HardwareInfoDll/SharedSnapshot.cpp HardwareInfoDll/Subscriptions.cpp HardwareInfoDll/TopologyAggregates.cpp -lpthread -lrt
+//
+// 用法：hwibench [--threads N] [--sockets N] [--cores-per-l3 N] [--ecores N] [--gpus N] [--disks N] [--nics N] [--boards N] [--batteries N] [--iterations N] [--agents N] [--replay 軌跡檔] [--record 軌跡檔]
+
+#include "AdaptiveSampling.h"
+#include "AlertRules.h"
+#include "DeltaStream.h"
+#include "DerivedMetrics.h"
+#include "Diagnostics.h"
+#include "FleetCollector.h"
+#include "FramePublisher.h"
+#include "InfoSerializer.h"
+#include "MetricsExporter.h"
+#include "SensorHistory.h"
+#include "SensorModel.h"
+#include "SensorSource.h"
+#include "SeriesRecorder.h"
+#include "SharedSnapshot.h"
+#include "Subscriptions.h"
+#include "TopologyAggregates.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace HardwareInfoDll;
+
+// 全域配置計數 (所有執行緒)
+static std::atomic<long long> allocationCount{ 0 };
+static std::atomic<long long> allocationBytes{ 0 };
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(static_cast<long long>(size), std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    operator delete(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    operator delete(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    operator delete(memory);
+}
+
+namespace {
+    struct Options {
+        SyntheticTopology topology;
+        long iterations = 20000;
+        int agents = 64;  // 集中收集模擬的主機數
+        std::string replay;  // 重播的軌跡檔 (空字串表示使用合成來源)
+        std::string record;  // 錄製合成來源的軌跡後結束
+    };
+
+    // 執行 body iterations 次，輸出每次的平均時間與配置
+    template <typename TBody>
+    void Run(const char* name, long iterations, TBody&& body) {
+        long warmup = iterations / 10 < 100 ? iterations / 10 : 100;
+        for (long i = 0; i < warmup; i++) body();
+
+        long long countBefore = allocationCount.load();
+        long long bytesBefore = allocationBytes.load();
+        auto start = std::chrono::steady_clock::now();
+        for (long i = 0; i < iterations; i++) body();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        long long allocations = allocationCount.load() - countBefore;
+        long long bytes = allocationBytes.load() - bytesBefore;
+
+        double nanoseconds = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+        std::printf("%-32s %12.1f ns/op %10.2f allocs/op %12.1f B/op\n",
+            name, nanoseconds, static_cast<double>(allocations) / iterations, static_cast<double>(bytes) / iterations);
+    }
+
+    long long NowMicroseconds() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string option = argv[i];
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "缺少 %s 的參數\n", option.c_str());
+                return false;
+            }
+
+            const char* value = argv[++i];
+            if (option == "--threads") options.topology.threads = std::atoi(value);
+            else if (option == "--sockets") options.topology.sockets = std::atoi(value);
+            else if (option == "--cores-per-l3") options.topology.coresPerDomain = std::atoi(value);
+            else if (option == "--ecores") options.topology.efficiencyCores = std::atoi(value);
+            else if (option == "--gpus") options.topology.gpus = std::atoi(value);
+            else if (option == "--disks") options.topology.disks = std::atoi(value);
+            else if (option == "--nics") options.topology.nics = std::atoi(value);
+            else if (option == "--boards") options.topology.boards = std::atoi(value);
+            else if (option == "--batteries") options.topology.batteries = std::atoi(value);
+            else if (option == "--iterations") options.iterations = std::atol(value);
+            else if (option == "--agents") options.agents = std::atoi(value);
+            else if (option == "--replay") options.replay = value;
+            else if (option == "--record") options.record = value;
+            else {
+                std::fprintf(stderr, "未知的選項 %s\n", option.c_str());
+                return false;
+            }
+        }
+        if (options.iterations < 1) options.iterations = 1;
+        if (options.agents < 1) options.agents = 1;
+        return true;
+    }
+
+    // 與 HardwareInfo::WriteFrame 相同的步驟 (不含 JSON 快取世代)
+    void WriteFrame(FramePublisher<HardwareFrame>& frames, const SensorModel& model, unsigned int catalogVersion, unsigned long long& sequence) {
+        int index;
+        HardwareFrame* frame = frames.BeginWrite(index);
+        if (!frame) return;
+
+        model.LockValues();
+        if (frame->catalogVersion != catalogVersion) model.BuildFrameLayout(*frame, catalogVersion);
+        model.FillFrame(*frame);
+        model.UnlockValues();
+
+        auto header = reinterpret_cast<HwiSnapshotHeader*>(frame->snapshot.data());
+        header->sequence = ++sequence;
+        header->timestamp = NowMicroseconds();
+        frames.Publish(index);
+    }
+
+    // 以 loopback 連線 GET /metrics，回傳收到的位元組數 (含標頭)，失敗時回傳 0
+    size_t ScrapeMetrics(int port, std::vector<char>& buffer) {
+#ifdef _WIN32
+        SOCKET client = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (client == INVALID_SOCKET) return 0;
+#else
+        int client = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (client < 0) return 0;
+#endif
+        sockaddr_in endpoint = {};
+        endpoint.sin_family = AF_INET;
+        endpoint.sin_port = htons(static_cast<unsigned short>(port));
+        inet_pton(AF_INET, "127.0.0.1", &endpoint.sin_addr);
+
+        size_t total = 0;
+        const char request[] = "GET /metrics HTTP/1.1\r\nHost: 127.0.0.1\r\nAccept: application/openmetrics-text; version=1.0.0\r\n\r\n";
+        if (connect(client, reinterpret_cast<sockaddr*>(&endpoint), sizeof(endpoint)) == 0 &&
+            send(client, request, static_cast<int>(sizeof(request) - 1), 0) == static_cast<int>(sizeof(request) - 1)) {
+            for (;;) {
+                if (total == buffer.size()) buffer.resize(buffer.size() * 2 + 4096);
+                int received = recv(client, buffer.data() + total, static_cast<int>(buffer.size() - total), 0);
+                if (received <= 0) break;
+                total += static_cast<size_t>(received);
+            }
+        }
+#ifdef _WIN32
+        closesocket(client);
+#else
+        close(client);
+#endif
+        return total;
+    }
+
+    // 與 HardwareSampling.cpp 的預設取樣週期相同 (毫秒)
+    double DefaultInterval(int hardwareType) {
+        switch (hardwareType) {
+            case CpuHardware: return 250;
+            case GpuNvidiaHardware:
+            case GpuAmdHardware:
+            case GpuIntelHardware: return 500;
+            case StorageHardware: return 5000;
+            default: return 1000;
+        }
+    }
+
+    void PollAll(SensorSource& source, SensorModel& model) {
+        for (size_t i = 0; i < model.bindings.size(); ++i) model.Poll(source, i);
+    }
+
+    // 集中收集模擬的主機：分組為 rack-0 到 rack-7，數值為目前的取樣加上各自的偏移
+    struct FleetAgent {
+        std::unique_ptr<FleetSender> sender;
+        std::string group;
+        std::vector<float> values;
+    };
+
+    std::vector<FleetAgent> CreateAgents(int count, const SensorModel& model) {
+        std::vector<FleetAgent> agents(count);
+        for (int i = 0; i < count; i++) {
+            agents[i].sender.reset(new FleetSender());
+            agents[i].group = "rack-" + std::to_string(i % 8);
+            agents[i].values = model.values;
+            for (float& value : agents[i].values) value += i * 0.25f;
+        }
+        return agents;
+    }
+
+    bool OpenAgents(std::vector<FleetAgent>& agents, const std::string& endpoint) {
+        for (size_t i = 0; i < agents.size(); i++) {
+            if (!agents[i].sender->Open(endpoint, "agent-" + std::to_string(i), agents[i].group, 0, 3600000000LL)) return false;
+        }
+        return true;
+    }
+
+    void SendRound(std::vector<FleetAgent>& agents, const SensorModel& model, unsigned int catalogVersion, uint64_t sequence, long long timestamp) {
+        for (FleetAgent& agent : agents) agent.sender->Send(model.slots, catalogVersion, sequence, timestamp, agent.values.data(), agent.values.size());
+    }
+
+    long long SentDatagrams(const std::vector<FleetAgent>& agents) {
+        long long total = 0;
+        for (const FleetAgent& agent : agents) total += agent.sender->Stats().datagrams;
+        return total;
+    }
+
+    // 等待收集端收到 expected 個封包 (超過 50 毫秒沒有進展時視為遺失)，回傳收到的封包數
+    long long WaitCollector(FleetCollector& collector, long long expected) {
+        long long received = collector.Stats().datagrams;
+        auto progress = std::chrono::steady_clock::now();
+        while (received < expected && std::chrono::steady_clock::now() - progress < std::chrono::milliseconds(50)) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            long long current = collector.Stats().datagrams;
+            if (current != received) progress = std::chrono::steady_clock::now();
+            received = current;
+        }
+        return received;
+    }
+
+    // 以各主機的數值重新計算預設規則的各分組最高溫度與總封裝功率，與收集端的結果比較
+    bool CheckAggregates(FleetCollector& collector, const std::vector<FleetAgent>& agents, const SensorModel& model) {
+        std::vector<FleetAggregateValue> aggregates;
+        collector.Aggregates(aggregates);
+
+        bool checked = false;
+        for (const FleetAggregateValue& aggregate : aggregates) {
+            bool temperature = aggregate.rule == "MaxTemperature";
+            if (!temperature && !(aggregate.rule == "PackagePower" && aggregate.group.empty())) continue;
+
+            double expected = temperature ? -INFINITY : 0.0;
+            for (const FleetAgent& agent : agents) {
+                if (temperature && agent.group != aggregate.group) continue;
+                for (size_t s = 0; s < model.slots.size(); s++) {
+                    const SensorSlot& slot = model.slots[s];
+                    if (slot.hardwareType != CpuHardware) continue;
+                    float value = agent.values[s];
+                    if (temperature && slot.sensorType == TemperatureSensor && slot.name == "Core Max") expected = std::max<double>(expected, value);
+                    if (!temperature && slot.sensorType == PowerSensor && slot.name == "CPU Package") expected += value;
+                }
+            }
+            if (!(std::fabs(aggregate.value - expected) <= 1e-3 * std::max(1.0, std::fabs(expected)))) return false;
+            checked = true;
+        }
+        return checked;
+    }
+
+    // 把每台主機的一次取樣 (目錄與數值) 送到 loopback 的 UDP socket 後讀回，作為直接餵入 Ingest 的封包
+    bool CaptureRound(std::vector<FleetAgent>& agents, const SensorModel& model, unsigned int catalogVersion, std::vector<std::vector<unsigned char>>& packets) {
+#ifdef _WIN32
+        SOCKET capture = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (capture == INVALID_SOCKET) return false;
+#else
+        int capture = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (capture < 0) return false;
+#endif
+
+        sockaddr_in endpoint = {};
+        endpoint.sin_family = AF_INET;
+        inet_pton(AF_INET, "127.0.0.1", &endpoint.sin_addr);
+        socklen_t length = sizeof(endpoint);
+        bool bound = bind(capture, reinterpret_cast<sockaddr*>(&endpoint), sizeof(endpoint)) == 0 &&
+            getsockname(capture, reinterpret_cast<sockaddr*>(&endpoint), &length) == 0;
+
+        // 逐台送出後讀回 (一次送出所有主機的目錄會超過接收緩衝區)
+        long long expected = 0;
+        bool complete = bound && OpenAgents(agents, "udp://127.0.0.1:" + std::to_string(ntohs(endpoint.sin_port)));
+        std::vector<unsigned char> buffer(HWI_FLEET_MAX_DATAGRAM);
+        long long timestamp = NowMicroseconds();
+        for (size_t i = 0; complete && i < agents.size(); i++) {
+            FleetAgent& agent = agents[i];
+            agent.sender->Send(model.slots, catalogVersion, 1, timestamp, agent.values.data(), agent.values.size());
+            expected += agent.sender->Stats().datagrams;
+            agent.sender->Close();
+
+            while (static_cast<long long>(packets.size()) < expected) {
+                fd_set readable;
+                FD_ZERO(&readable);
+                FD_SET(capture, &readable);
+                timeval timeout = { 0, 200000 };
+                if (select(static_cast<int>(capture + 1), &readable, nullptr, nullptr, &timeout) <= 0) break;
+
+                int received = recv(capture, reinterpret_cast<char*>(buffer.data()), static_cast<int>(buffer.size()), 0);
+                if (received <= 0) break;
+                packets.emplace_back(buffer.begin(), buffer.begin() + received);
+            }
+            complete = static_cast<long long>(packets.size()) == expected;
+        }
+#ifdef _WIN32
+        closesocket(capture);
+#else
+        close(capture);
+#endif
+        return complete;
+    }
+
+    // 經由端點送出 rounds 輪取樣 (每 16 輪等待收集端跟上)，輸出遺失的封包與彙總是否正確
+    void RunFleet(const char* name, const std::string& endpoint, long rounds, std::vector<FleetAgent>& agents, const SensorModel& model, unsigned int catalogVersion) {
+        FleetCollector collector;
+        if (!collector.Start(endpoint)) {
+            std::printf("%-32s skipped (cannot bind %s)\n", name, endpoint.c_str());
+            return;
+        }
+
+        std::string target = collector.Port() ? "udp://127.0.0.1:" + std::to_string(collector.Port()) : endpoint;
+        if (!OpenAgents(agents, target)) {
+            std::printf("%-32s skipped (cannot open senders)\n", name);
+            return;
+        }
+
+        // 第一輪逐台送出目錄 (一次送出所有主機的目錄會超過接收緩衝區)
+        uint64_t sequence = 1;
+        long long timestamp = NowMicroseconds();
+        for (FleetAgent& agent : agents) {
+            agent.sender->Send(model.slots, catalogVersion, sequence, timestamp, agent.values.data(), agent.values.size());
+            WaitCollector(collector, SentDatagrams(agents));
+        }
+
+        Run(name, rounds, [&] {
+            SendRound(agents, model, catalogVersion, ++sequence, timestamp += 100000);
+            if (sequence % 16 == 0) WaitCollector(collector, SentDatagrams(agents));
+        });
+
+        long long sent = SentDatagrams(agents);
+        long long received = WaitCollector(collector, sent);
+        FleetCollectorStats stats = collector.Stats();
+        long long errors = 0;
+        for (const FleetAgent& agent : agents) {
+            errors += agent.sender->Stats().errors;
+            agent.sender->Close();
+        }
+
+        bool match = CheckAggregates(collector, agents, model);
+        std::printf("  %zu/%zu hosts, %lld datagrams (%lld lost, %lld send errors), %.1f per batch, %.0f ns ingest per datagram, aggregates %s\n",
+            stats.activeHosts, agents.size(), received, sent - received, errors,
+            stats.batches ? static_cast<double>(stats.datagrams) / stats.batches : 0.0,
+            stats.datagrams ? static_cast<double>(stats.ingestNanoseconds) / stats.datagrams : 0.0, match ? "match" : "MISMATCH");
+        collector.Stop();
+    }
+
+    // 以合成來源錄製 iterations 筆取樣
+    int Record(const Options& options) {
+        SyntheticSource source(options.topology);
+        SensorModel model;
+        std::vector<SourceHardware> hardware;
+        source.Enumerate(hardware);
+        model.Rebind(hardware);
+
+        TraceWriter writer;
+        if (!writer.Open(options.record)) {
+            std::fprintf(stderr, "無法建立 %s\n", options.record.c_str());
+            return 1;
+        }
+
+        writer.WriteTopology(model.boundHardware);
+        long long timestamp = NowMicroseconds();
+        for (long i = 0; i < options.iterations; i++) {
+            PollAll(source, model);
+            writer.WriteFrame(timestamp + i * 100000LL, model.sourceValues.data(), model.sourceValues.size());  // 每 100 毫秒一筆
+        }
+        std::printf("Recorded %ld frames (%zu sensors) to %s\n", options.iterations, model.sourceValues.size(), options.record.c_str());
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) return 2;
+    if (!options.record.empty()) return Record(options);
+
+    // 重播時逐筆前進，不依實際時間
+    std::unique_ptr<SensorSource> source;
+    ReplaySource* replay = nullptr;
+    if (!options.replay.empty()) {
+        replay = new ReplaySource(false);
+        source.reset(replay);
+        if (!replay->Load(options.replay)) {
+            std::fprintf(stderr, "無法讀取軌跡檔 %s\n", options.replay.c_str());
+            return 1;
+        }
+    }
+    else {
+        source.reset(new SyntheticSource(options.topology));
+    }
+
+    SensorModel model;
+    std::vector<SourceHardware> hardware;
+    long bindIterations = options.iterations / 100 > 10 ? options.iterations / 100 : 10;
+    Run("Bind (enumerate + rebind)", bindIterations, [&] {
+        source->Enumerate(hardware);
+        model.Rebind(hardware);
+    });
+    std::printf("  %zu hardware, %zu sensors, %zu slots\n", model.bindings.size(), model.boundSlots.size(), model.slots.size());
+
+    long iterations = options.iterations;
+    Run("Poll all hardware", iterations, [&] {
+        if (replay) replay->Advance();
+        PollAll(*source, model);
+    });
+
+    // 啟用自我量測時的輪詢 (與上一項的差距即為量測成本)
+    PollDiagnostics diagnostics;
+    diagnostics.Resize(model.bindings.size());
+    diagnostics.Enable(true);
+    Run("Poll all hardware (diagnostics)", iterations, [&] {
+        if (replay) replay->Advance();
+        for (size_t i = 0; i < model.bindings.size(); ++i) diagnostics.Poll(model, *source, i);
+    });
+
+    // 只訂閱 CPU 總負載時的輪詢 (沒有訂閱需要的硬體不更新)
+    {
+        SubscriptionSet subscriptions;
+        subscriptions.Add(CpuHardware, "CPU Total");
+        size_t wanted = subscriptions.Apply(model);
+        Run("Poll subscribed (CPU Total)", iterations, [&] {
+            if (replay) replay->Advance();
+            for (size_t i = 0; i < model.bindings.size(); ++i) {
+                if (model.bindings[i].subscribed) model.Poll(*source, i);
+            }
+        });
+        std::printf("  %zu of %zu hardware updated\n", wanted, model.bindings.size());
+        SubscriptionSet().Apply(model);  // 恢復更新所有硬體
+    }
+
+    // 衍生指標 (預設規則)：每次輪詢後增量計算，槽位接在來源感測器之後，之後的項目都包含衍生指標
+    DerivedMetrics derived;
+    size_t derivedCount = derived.Rebind(model);
+    Run("Poll all + derived metrics", iterations, [&] {
+        if (replay) replay->Advance();
+        int64_t now = DiagnosticsClock();
+        for (size_t i = 0; i < model.bindings.size(); ++i) {
+            model.Poll(*source, i);
+            derived.Update(model, i, now);
+        }
+    });
+    std::printf("  %zu derived metrics, %zu slots\n", derivedCount, model.slots.size());
+
+    // 拓撲彙總：CPU 更新後依封裝、L3 網域與效能/效率核心計算最小、最大、平均與 P95，之後的項目都包含
+    TopologyAggregates aggregates;
+    CpuTopology cpuTopology;
+    source->DescribeCpuTopology(cpuTopology);
+    size_t aggregateCount = aggregates.Rebind(model, cpuTopology);
+    PollAll(*source, model);
+    Run("Topology aggregates (reduce)", iterations, [&] {
+        for (size_t i = 0; i < model.bindings.size(); ++i) aggregates.Update(model, i);
+    });
+    std::printf("  %zu groups, %zu aggregates, %zu slots\n", aggregates.GroupCount(), aggregateCount, model.slots.size());
+
+    // 自適應取樣：與 StartSampling 相同依 HardwareType 分組，以虛擬時鐘每次取樣最早到期的群組。
+    // 儲存與網路的數值保持不變 (多數時間的實際情形)；Update() 耗時以固定值模擬 (儲存 20 ms、其他 0.5 ms)，
+    // 在 0.5% 的 CPU 預算下輸出各群組最後的實際週期
+    {
+        std::vector<int> groupTypes;
+        std::vector<std::vector<size_t>> groupBindings;
+        for (size_t i = 0; i < model.bindings.size(); ++i) {
+            size_t group = 0;
+            while (group < groupTypes.size() && groupTypes[group] != model.bindings[i].hardwareType) group++;
+            if (group == groupTypes.size()) {
+                groupTypes.push_back(model.bindings[i].hardwareType);
+                groupBindings.emplace_back();
+            }
+            groupBindings[group].push_back(i);
+        }
+
+        AdaptiveSampler sampler;
+        AdaptiveSamplingOptions adaptiveOptions;
+        adaptiveOptions.enabled = true;
+        adaptiveOptions.cpuBudget = 0.005;
+        sampler.Configure(adaptiveOptions);
+        sampler.Reset(groupTypes.size(), 0.0);
+
+        std::vector<float> frozen(model.sourceValues);
+        std::vector<double> nextDue(groupTypes.size(), 0.0);
+        std::vector<long long> groupSamples(groupTypes.size(), 0);
+        double now = 0.0;
+        Run("Adaptive sample (poll + observe)", iterations, [&] {
+            size_t group = 0;
+            for (size_t g = 1; g < nextDue.size(); ++g) {
+                if (nextDue[g] < nextDue[group]) group = g;
+            }
+            now = nextDue[group];
+
+            int type = groupTypes[group];
+            bool stable = type == StorageHardware || type == NetworkHardware;
+            for (size_t binding : groupBindings[group]) {
+                model.Poll(*source, binding);
+                const HardwareBinding& entry = model.bindings[binding];
+                if (stable) std::memcpy(model.sourceValues.data() + entry.firstSensor, frozen.data() + entry.firstSensor, entry.sensorCount * sizeof(float));
+            }
+            double cost = (type == StorageHardware ? 20.0 : 0.5) * groupBindings[group].size();
+            nextDue[group] = now + sampler.Observe(group, now, DefaultInterval(type), cost, model, groupBindings[group]);
+            groupSamples[group]++;
+        });
+        std::printf("  %.0f s simulated, stretch %.2f, estimated CPU %.3f%% (average %.3f%%, budget %.3f%%)\n",
+            now / 1000.0, sampler.Stretch(), sampler.EstimatedCpu() * 100.0, sampler.AverageCpu(now) * 100.0, adaptiveOptions.cpuBudget * 100.0);
+        for (size_t g = 0; g < groupTypes.size(); ++g) {
+            AdaptiveGroupStats stats = sampler.Stats(g);
+            std::printf("  %-12s %6.0f -> %8.0f ms (volatility %.3f/s, %lld samples)\n",
+                HardwareTypeName(groupTypes[g]), stats.baseIntervalMs, stats.effectiveIntervalMs, stats.volatility, groupSamples[g]);
+        }
+    }
+
+    FramePublisher<HardwareFrame> frames;
+    unsigned long long sequence = 0;
+    unsigned int catalogVersion = 1;
+    Run("Frame publish", iterations, [&] {
+        WriteFrame(frames, model, catalogVersion, sequence);
+    });
+
+    std::string text;
+    size_t jsonBytes = 0;
+    Run("Serialize streaming (5 categories)", iterations, [&] {
+        FrameLease<HardwareFrame> lease(frames);
+        text.clear();
+        for (int category = 0; category < InfoCategoryCount; category++) {
+            SerializeInfo(static_cast<InfoCategory>(category), *lease.Get(), text);
+        }
+        jsonBytes = text.size();
+    });
+    std::printf("  %zu bytes of JSON\n", jsonBytes);
+
+    // GetAllInfo 的路徑：一次輸出所有類別，直接寫入 UTF-16 (受控端由緩衝區直接建立 System::String)
+    std::u16string utf16;
+    Run("Serialize all (UTF-16, one pass)", iterations, [&] {
+        FrameLease<HardwareFrame> lease(frames);
+        utf16.clear();
+        SerializeAllInfo(*lease.Get(), utf16);
+    });
+    std::printf("  %zu UTF-16 units\n", utf16.size());
+
+    std::vector<unsigned char> buffer;
+    {
+        FrameLease<HardwareFrame> lease(frames);
+        buffer.resize(lease.Get()->snapshot.size());
+    }
+    Run("Snapshot copy", iterations, [&] {
+        FrameLease<HardwareFrame> lease(frames);
+        std::memcpy(buffer.data(), lease.Get()->snapshot.data(), lease.Get()->snapshot.size());
+    });
+
+    SensorHistory history(SensorHistory::DefaultLevels(), SensorHistory::DefaultMaxSensors);
+    long long historyTime = NowMicroseconds();
+    Run("History record", iterations, [&] {
+        historyTime += 100000;  // 每 100 毫秒一筆，讓各解析度的區間正常推進
+        history.Record(historyTime, model.values.data(), model.values.size());
+    });
+
+    // 變化串流：溫度 0.5 度、其他感測器 1% 的門檻，輸出每次取樣實際送出的感測器數
+    DeltaStream deltas;
+    Deadband relativeBand;
+    relativeBand.relative = 0.01f;
+    Deadband temperatureBand;
+    temperatureBand.absolute = 0.5f;
+    deltas.SetDeadband("*", relativeBand);
+    deltas.SetDeadband("*/temperature/*", temperatureBand);
+    deltas.Start(DeltaStream::DefaultCapacity);
+    long long deltaTime = NowMicroseconds();
+    deltas.Record(model.slots, model.values.data(), model.values.size(), deltaTime, catalogVersion);  // 第一個批次包含所有感測器
+    long long emittedBefore = deltas.Emitted();
+    Run("Delta record (poll + compare)", iterations, [&] {
+        if (replay) replay->Advance();
+        PollAll(*source, model);
+        deltaTime += 100000;
+        deltas.Record(model.slots, model.values.data(), model.values.size(), deltaTime, catalogVersion);
+    });
+    std::printf("  %.1f of %zu sensors emitted per sample, %llu batches\n",
+        static_cast<double>(deltas.Emitted() - emittedBefore) / iterations, model.slots.size(), static_cast<unsigned long long>(deltas.Sequence()));
+
+    // 警示規則：每個感測器套用大於、小於、每秒上升、每秒下降四條規則 (含遲滯與持續時間)，
+    // 量測每次發布的評估 (不含輪詢)，輸出實例數與每次取樣的事件數
+    {
+        AlertEngine alerts;
+        const int conditions[] = { AlertAbove, AlertBelow, AlertRising, AlertFalling };
+        const float thresholds[] = { 90.0f, 5.0f, 2.0f, 2.0f };
+        for (int c = 0; c < 4; ++c) {
+            AlertRule rule;
+            rule.condition = conditions[c];
+            rule.threshold = thresholds[c];
+            rule.hysteresis = 1.0f;
+            rule.duration = c < 2 ? 10.0f : 0.0f;
+            alerts.Add(rule);
+        }
+
+        std::vector<AlertEvent> events;
+        long long alertTime = NowMicroseconds();
+        alerts.Evaluate(model.slots, catalogVersion, alertTime, model.values.data(), model.values.size(), events);  // 第一次評估時編譯
+        events.clear();
+        size_t eventCount = 0;
+        Run("Alert evaluate (4 rules/sensor)", iterations, [&] {
+            if (replay) replay->Advance();
+            PollAll(*source, model);
+            alertTime += 100000;
+            eventCount += alerts.Evaluate(model.slots, catalogVersion, alertTime, model.values.data(), model.values.size(), events);
+            events.clear();
+        });
+        std::printf("  %zu instances, %.3f us per evaluation, %.2f events per sample\n",
+            alerts.InstanceCount(), alerts.EvaluationNanoseconds() / 1000.0 / alerts.Evaluations(), static_cast<double>(eventCount) / iterations);
+    }
+
+    // 時間序列錄製：發布端只在記憶體中編碼，區塊滿時交給寫入執行緒；之後映射區段檔讀回一個感測器
+    {
+        std::error_code error;
+        std::filesystem::path seriesDirectory = std::filesystem::temp_directory_path(error) / ("hwibench-series-" + std::to_string(NowMicroseconds()));
+        std::filesystem::create_directories(seriesDirectory, error);
+
+        SeriesRecorderOptions seriesOptions;
+        seriesOptions.directory = seriesDirectory.string();
+        seriesOptions.interval = 0;
+        SeriesRecorder recorder;
+        if (!error && recorder.Start(seriesOptions)) {
+            long long seriesTime = NowMicroseconds();
+            Run("Series record (poll + encode)", iterations, [&] {
+                if (replay) replay->Advance();
+                PollAll(*source, model);
+                seriesTime += 100000;  // 每 100 毫秒一筆
+                recorder.Record(model.slots, catalogVersion, seriesTime, model.values.data(), model.values.size());
+            });
+            recorder.Stop();
+            SeriesRecorderStats stats = recorder.Stats();
+            std::printf("  %lld values in %lld blocks, %.2f bytes per value (%lld dropped blocks)\n",
+                stats.values, stats.blocks, stats.values ? static_cast<double>(stats.bytes) / stats.values : 0.0, stats.droppedBlocks);
+
+            std::vector<std::string> segments;
+            for (const auto& entry : std::filesystem::directory_iterator(seriesDirectory, error)) segments.push_back(entry.path().string());
+            std::vector<int64_t> timestamps;
+            std::vector<float> values;
+            size_t column = model.slots.size() / 2;
+            Run("Series scan (1 sensor)", 10, [&] {
+                timestamps.clear();
+                values.clear();
+                for (const std::string& segment : segments) {
+                    SeriesReader reader;
+                    if (reader.Open(segment)) reader.Scan(column, 0, INT64_MAX, timestamps, values);
+                }
+            });
+            bool match = !values.empty() && values.back() == model.values[column];
+            std::printf("  %zu samples of %s read back (%s)\n", values.size(), model.slots[column].identifier.c_str(), match ? "last value matches" : "MISMATCH");
+        }
+        else {
+            std::printf("%-32s skipped (cannot create %s)\n", "Series record", seriesDirectory.string().c_str());
+        }
+        std::filesystem::remove_all(seriesDirectory, error);
+    }
+
+    SharedSnapshotWriter sharedWriter;
+    std::string sharedName = "HardwareInfoBench-" + std::to_string(NowMicroseconds());
+    if (sharedWriter.Create(sharedName, static_cast<uint32_t>(model.slots.size()))) {
+        Run("Shared publish", iterations, [&] {
+            FrameLease<HardwareFrame> lease(frames);
+            sharedWriter.Publish(lease.Get()->snapshot.data(), lease.Get()->snapshot.size());
+        });
+
+        SharedSnapshotReader sharedReader;
+        if (sharedReader.Open(sharedName)) {
+            Run("Shared read", iterations, [&] {
+                sharedReader.Read(buffer.data(), static_cast<uint32_t>(buffer.size()));
+            });
+        }
+    }
+    else {
+        std::printf("%-32s skipped (shared memory unavailable)\n", "Shared publish");
+    }
+
+    // OpenMetrics：範本只在目錄改變時產生，scrape 只填入數值
+    MetricsExporter exporter(frames);
+    {
+        int index;
+        HardwareFrame* frame = frames.BeginWrite(index);
+        if (frame) {
+            model.BuildFrameLayout(*frame, catalogVersion);
+            model.FillFrame(*frame);
+            auto header = reinterpret_cast<HwiSnapshotHeader*>(frame->snapshot.data());
+            header->sequence = ++sequence;
+            header->timestamp = NowMicroseconds();
+            exporter.Prepare(*frame, model);
+            frames.Publish(index);
+        }
+    }
+
+    std::vector<char> metricsBuffer;
+    size_t metricsBytes = 0;
+    Run("Metrics render", iterations, [&] {
+        FrameLease<HardwareFrame> lease(frames);
+        const MetricsTemplate& metrics = *lease.Get()->metrics;
+        if (metricsBuffer.size() < metrics.MaxSize()) metricsBuffer.resize(metrics.MaxSize());
+        metricsBytes = RenderMetrics(metrics, *lease.Get(), metricsBuffer.data(), metricsBuffer.size());
+    });
+    std::printf("  %zu bytes of OpenMetrics\n", metricsBytes);
+
+#ifdef _WIN32
+    WSADATA winsock;
+    WSAStartup(MAKEWORD(2, 2), &winsock);
+#endif
+    if (exporter.Start("127.0.0.1", 0)) {
+        std::vector<char> scrapeBuffer(metricsBytes + 4096);
+        size_t scrapeBytes = 0;
+        Run("Metrics scrape (loopback HTTP)", iterations / 10 > 100 ? iterations / 10 : 100, [&] {
+            scrapeBytes = ScrapeMetrics(exporter.Port(), scrapeBuffer);
+        });
+        std::printf("  %zu bytes per response, %lld scrapes served\n", scrapeBytes, exporter.Scrapes());
+        exporter.Stop();
+    }
+    else {
+        std::printf("%-32s skipped (cannot listen on loopback)\n", "Metrics scrape");
+    }
+
+    // 集中收集：先把所有主機的封包直接餵入 Ingest (只量測去除重複與彙總)，再經由 loopback 量測含系統呼叫的路徑
+    {
+        std::vector<FleetAgent> agents = CreateAgents(options.agents, model);
+        std::vector<std::vector<unsigned char>> packets;
+        if (CaptureRound(agents, model, catalogVersion, packets)) {
+            FleetCollector collector;
+            std::vector<FleetDatagram> batch;
+            for (const auto& packet : packets) batch.push_back({ packet.data(), packet.size() });
+            collector.Ingest(batch.data(), batch.size(), DiagnosticsClock());  // 目錄與第一個取樣
+
+            batch.clear();
+            for (auto& packet : packets) {
+                if (reinterpret_cast<const HwiFleetHeader*>(packet.data())->kind == HWI_FLEET_VALUES) batch.push_back({ packet.data(), packet.size() });
+            }
+
+            uint64_t fleetSequence = 1;
+            Run("Fleet ingest (no sockets)", iterations / 10 > 100 ? iterations / 10 : 100, [&] {
+                ++fleetSequence;
+                for (const FleetDatagram& datagram : batch) {
+                    HwiFleetHeader* header = static_cast<HwiFleetHeader*>(const_cast<void*>(datagram.data));
+                    header->sequence = fleetSequence;
+                }
+                for (size_t first = 0; first < batch.size(); first += 64) {
+                    collector.Ingest(batch.data() + first, std::min<size_t>(64, batch.size() - first), DiagnosticsClock());
+                }
+            });
+            FleetCollectorStats stats = collector.Stats();
+            std::printf("  %d agents, %zu value datagrams per round, %.0f ns per datagram, %zu aggregates (%s)\n",
+                options.agents, batch.size(), static_cast<double>(stats.ingestNanoseconds) / stats.datagrams, stats.aggregates,
+                CheckAggregates(collector, agents, model) ? "match" : "MISMATCH");
+        }
+        else {
+            std::printf("%-32s skipped (cannot capture loopback datagrams)\n", "Fleet ingest");
+        }
+
+        long rounds = iterations / 10 > 100 ? iterations / 10 : 100;
+        RunFleet("Fleet send + ingest (UDP)", "udp://127.0.0.1:0", rounds, agents, model, catalogVersion);
+#ifndef _WIN32
+        std::error_code error;
+        std::string unixPath = (std::filesystem::temp_directory_path(error) / ("hwibench-fleet-" + std::to_string(NowMicroseconds()))).string();
+        RunFleet("Fleet send + ingest (Unix)", "unix:" + unixPath, rounds, agents, model, catalogVersion);
+#endif
+    }
+
+    Run("Full sample (poll + publish)", iterations, [&] {
+        if (replay) replay->Advance();
+        PollAll(*source, model);
+        WriteFrame(frames, model, catalogVersion, sequence);
+    });
+    return 0;
+}
@@ -0,0 +1,163 @@
+﻿#include "AdaptiveSampling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace HardwareInfoDll {
+    static const double CostSmoothing = 0.2;  // 耗時移動平均的權重
+    static const double VolatilitySmoothing = 0.3;  // 變化率下降時的權重
+
+    struct AdaptiveSampler::Impl {
+        struct Group {
+            AdaptiveGroupStats stats;
+            double lastTime = 0.0;  // 上一次取樣的時間 (毫秒)
+            std::vector<float> previous;  // 上一次取樣的來源數值 (依 bindings 順序串接)
+        };
+
+        mutable std::mutex lock;  // 各群組的執行緒與統計讀取共用 (每次取樣只取得一次)
+        AdaptiveSamplingOptions options;
+        std::vector<Group> groups;
+        double startTime = 0.0;
+        double totalCostMs = 0.0;  // Reset 之後所有群組的耗時總和
+        double stretch = 1.0;  // 目前的預算延長倍數
+
+        // 依各群組的耗時與週期重新計算 stretch
+        void UpdateStretch() {
+            stretch = 1.0;
+            if (options.cpuBudget <= 0.0) return;
+
+            double demand = 0.0;  // 不延長時的 CPU 使用量
+            for (const Group& group : groups) {
+                if (group.stats.observations > 0 && group.stats.adaptiveIntervalMs > 0.0) demand += group.stats.costMs / group.stats.adaptiveIntervalMs;
+            }
+            stretch = std::min(options.maxStretch, std::max(1.0, demand / options.cpuBudget));
+        }
+    };
+
+    AdaptiveSampler::AdaptiveSampler() : impl(new Impl()) {}
+
+    AdaptiveSampler::~AdaptiveSampler() {
+        delete impl;
+    }
+
+    void AdaptiveSampler::Configure(const AdaptiveSamplingOptions& newOptions) {
+        std::lock_guard<std::mutex> guard(impl->lock);
+        AdaptiveSamplingOptions& options = impl->options;
+        options = newOptions;
+        if (options.minFactor <= 0.0) options.minFactor = 1.0;
+        if (options.maxFactor < options.minFactor) options.maxFactor = options.minFactor;
+        if (options.backoff < 1.0) options.backoff = 1.0;
+        if (options.maxStretch < 1.0) options.maxStretch = 1.0;
+        impl->UpdateStretch();
+    }
+
+    AdaptiveSamplingOptions AdaptiveSampler::Options() const {
+        std::lock_guard<std::mutex> guard(impl->lock);
+        return impl->options;
+    }
+
+    void AdaptiveSampler::Reset(size_t count, double now) {
+        std::lock_guard<std::mutex> guard(impl->lock);
+        impl->groups.clear();
+        impl->groups.resize(count);
+        impl->startTime = now;
+        impl->totalCostMs = 0.0;
+        impl->stretch = 1.0;
+    }
+
+    double AdaptiveSampler::Observe(size_t index, double now, double baseIntervalMs, double cost, const SensorModel& model, const std::vector<size_t>& bindings) {
+        std::lock_guard<std::mutex> guard(impl->lock);
+        if (index >= impl->groups.size()) return baseIntervalMs;
+
+        const AdaptiveSamplingOptions& options = impl->options;
+        Impl::Group& group = impl->groups[index];
+        AdaptiveGroupStats& stats = group.stats;
+        bool first = stats.observations++ == 0;
+        stats.baseIntervalMs = baseIntervalMs;
+        stats.costMs = first ? cost : stats.costMs + CostSmoothing * (cost - stats.costMs);
+        impl->totalCostMs += cost;
+
+        // 平均相對變化：|新 - 舊| / max(|舊|, |新|, 1)，兩邊有 NaN 的感測器不計
+        size_t total = 0;
+        for (size_t binding : bindings) total += model.bindings[binding].sensorCount;
+        bool comparable = !first && group.previous.size() == total;  // 繫結改變後重新開始
+        if (!comparable) group.previous.resize(total);
+
+        double change = 0.0;
+        size_t counted = 0;
+        float* previous = group.previous.data();
+        for (size_t binding : bindings) {
+            const HardwareBinding& entry = model.bindings[binding];
+            const float* current = model.sourceValues.data() + entry.firstSensor;
+            for (size_t i = 0; i < entry.sensorCount; ++i, ++previous) {
+                float value = current[i];
+                if (comparable && value == value && *previous == *previous) {
+                    double scale = std::max(1.0, std::max(std::fabs(static_cast<double>(value)), std::fabs(static_cast<double>(*previous))));
+                    change += std::fabs(static_cast<double>(value) - *previous) / scale;
+                    counted++;
+                }
+                *previous = value;
+            }
+        }
+
+        double elapsed = now - group.lastTime;
+        group.lastTime = now;
+        if (comparable && counted > 0 && elapsed > 0.0) {
+            double rate = change / counted / (elapsed / 1000.0);
+            double smoothed = stats.volatility + VolatilitySmoothing * (rate - stats.volatility);
+            stats.volatility = std::max(rate, smoothed);  // 變化突然增加時立即加快
+        }
+
+        double minimum = std::max(1.0, baseIntervalMs * options.minFactor);
+        double maximum = std::max(minimum, baseIntervalMs * options.maxFactor);
+        double& interval = stats.adaptiveIntervalMs;
+        if (!options.enabled || interval <= 0.0) {
+            interval = baseIntervalMs;
+        }
+        else if (comparable) {
+            // 讓每次取樣平均看到 targetChange 的變化：變化率高時立即縮短，穩定時每次最多延長 backoff 倍
+            double desired = stats.volatility > 0.0 ? options.targetChange / stats.volatility * 1000.0 : maximum;
+            if (desired < interval) interval = desired;
+            else interval = std::min(desired, interval * options.backoff);
+        }
+        interval = std::min(maximum, std::max(options.enabled ? minimum : 1.0, interval));
+
+        impl->UpdateStretch();
+        stats.effectiveIntervalMs = interval * impl->stretch;
+        return stats.effectiveIntervalMs;
+    }
+
+    size_t AdaptiveSampler::GroupCount() const {
+        std::lock_guard<std::mutex> guard(impl->lock);
+        return impl->groups.size();
+    }
+
+    AdaptiveGroupStats AdaptiveSampler::Stats(size_t index) const {
+        std::lock_guard<std::mutex> guard(impl->lock);
+        if (index >= impl->groups.size()) return AdaptiveGroupStats();
+
+        AdaptiveGroupStats stats = impl->groups[index].stats;
+        stats.effectiveIntervalMs = stats.adaptiveIntervalMs * impl->stretch;  // 其他群組改變預算延長後尚未取樣時也一致
+        return stats;
+    }
+
+    double AdaptiveSampler::Stretch() const {
+        std::lock_guard<std::mutex> guard(impl->lock);
+        return impl->stretch;
+    }
+
+    double AdaptiveSampler::EstimatedCpu() const {
+        std::lock_guard<std::mutex> guard(impl->lock);
+        double usage = 0.0;
+        for (const Impl::Group& group : impl->groups) {
+            if (group.stats.observations > 0 && group.stats.adaptiveIntervalMs > 0.0) usage += group.stats.costMs / (group.stats.adaptiveIntervalMs * impl->stretch);
+        }
+        return usage;
+    }
+
+    double AdaptiveSampler::AverageCpu(double now) const {
+        std::lock_guard<std::mutex> guard(impl->lock);
+        return now > impl->startTime ? impl->totalCostMs / (now - impl->startTime) : 0.0;
+    }
+}
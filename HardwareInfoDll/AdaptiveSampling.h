@@ -0,0 +1,61 @@
+﻿#pragma once
+
+// 自適應取樣：追蹤每個取樣群組最近的變化率，數值變化快時縮短週期，穩定時以倍數逐步延長；
+// 並估計取樣本身使用的 CPU (每次取樣的耗時 / 週期)，超過預算時同比例延長所有群組的週期。
+// 耗時以經過時間計算 (平行更新的裝置各自計時後相加)，Update() 等待 I/O 時會高估，預算偏保守。
+// 純原生程式碼，由 HardwareInfo 與效能測試共用。
+
+#include "SensorModel.h"
+
+#include <stddef.h>
+#include <vector>
+
+namespace HardwareInfoDll {
+    struct AdaptiveSamplingOptions {
+        bool enabled = false;  // false 時只統計耗時與變化率，週期維持設定值
+        double cpuBudget = 0.0;  // 取樣允許使用的 CPU (單一核心的比例，0.005 表示 0.5%)，0 表示不限制
+        double targetChange = 0.02;  // 每次取樣期望看到的平均相對變化，變化率越高週期越短
+        double minFactor = 0.25;  // 最短週期 = 設定週期 x minFactor
+        double maxFactor = 16.0;  // 最長週期 = 設定週期 x maxFactor (不含預算延長)
+        double backoff = 2.0;  // 穩定時每次取樣最多延長的倍數
+        double maxStretch = 64.0;  // 預算延長的上限倍數 (避免單一昂貴群組讓所有群組停止)
+    };
+
+    struct AdaptiveGroupStats {
+        double baseIntervalMs = 0.0;  // 設定的週期
+        double adaptiveIntervalMs = 0.0;  // 依變化率決定的週期
+        double effectiveIntervalMs = 0.0;  // 加上預算延長後實際使用的週期
+        double volatility = 0.0;  // 平均相對變化率 (每秒)，上升立即反應、下降平滑
+        double costMs = 0.0;  // 每次取樣耗時的移動平均
+        long long observations = 0;
+    };
+
+    class AdaptiveSampler {
+        struct Impl;
+        Impl* impl;
+
+        public:
+        AdaptiveSampler();
+        ~AdaptiveSampler();
+
+        AdaptiveSampler(const AdaptiveSampler&) = delete;
+        AdaptiveSampler& operator=(const AdaptiveSampler&) = delete;
+
+        void Configure(const AdaptiveSamplingOptions& newOptions);  // 執行中的群組在下一次取樣套用
+        AdaptiveSamplingOptions Options() const;
+
+        // 重新建立 count 個群組 (清除變化率與耗時)，now 為毫秒
+        void Reset(size_t count, double now);
+
+        // 每次取樣後由群組的執行緒呼叫 (持有繫結的讀取鎖)：bindings 為本次更新的繫結，cost 為本次耗時，
+        // 時間皆為毫秒。回傳下一次取樣前應等待的週期
+        double Observe(size_t group, double now, double baseIntervalMs, double cost, const SensorModel& model, const std::vector<size_t>& bindings);
+
+        size_t GroupCount() const;
+        AdaptiveGroupStats Stats(size_t group) const;
+
+        double Stretch() const;  // 預算延長倍數 (1 表示沒有延長)
+        double EstimatedCpu() const;  // 以目前週期估計的 CPU 使用量 (單一核心的比例)
+        double AverageCpu(double now) const;  // Reset 之後實際的平均 CPU 使用量
+    };
+}
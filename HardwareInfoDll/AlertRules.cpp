@@ -0,0 +1,341 @@
+﻿#include "AlertRules.h"
+#include "Diagnostics.h"
+#include "Subscriptions.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define HWI_ALERT_SSE2 1
+#endif
+
+namespace HardwareInfoDll {
+    static const size_t BlockSize = 8;  // 每個區塊的實例數 (狀態位元組的位元數)
+
+    struct AlertEngine::Impl {
+        mutable std::mutex mutex;  // 規則、實例與狀態 (發布端每次 Evaluate 取得一次)
+        std::vector<AlertRule> rules;
+        std::atomic<size_t> ruleCount{ 0 };  // 沒有規則時 Evaluate 不取得 mutex
+        int nextId = 1;
+        bool rulesChanged = false;
+        unsigned int compiledCatalog = 0;
+
+        // 編譯後的實例 (前 levelCount 個為數值條件，之後為變化率條件)，長度補齊到 BlockSize 的倍數
+        size_t instanceCount = 0;
+        size_t levelCount = 0;
+        std::vector<uint32_t> slot;
+        std::vector<int> ruleId;
+        std::vector<float> sign;  // 低於/下降為 -1，輸入乘上 sign 後一律以「大於」比較
+        std::vector<float> trigger;  // 輸入 x sign 大於此值時條件成立
+        std::vector<float> release;  // 觸發後輸入 x sign 小於此值時解除 (trigger - hysteresis)
+        std::vector<int64_t> duration;  // 微秒
+        std::vector<int64_t> since;  // 條件開始成立或觸發的時間
+        std::vector<float> input;  // 本次的輸入 x sign
+        std::vector<unsigned char> firingBits;  // 每個區塊的觸發中位元
+        std::vector<unsigned char> pendingBits;  // 每個區塊的等待持續時間位元
+        std::vector<std::string> identifiers;
+
+        // 變化率 (每個使用變化率條件的槽位一份，同一槽位的上升與下降規則共用)
+        std::vector<uint32_t> rateSlot;  // 槽位
+        std::vector<uint32_t> rateIndex;  // 變化率條件的實例 (依 i - levelCount) 對應的 rateSlot 位置
+        std::vector<float> previous;  // 上一次改變後的數值
+        std::vector<int64_t> changedAt;  // 上一次改變的時間
+        std::vector<int64_t> changeInterval;  // 最近兩次改變的間隔 (感測器更新週期的估計)
+        std::vector<float> rate;  // 最近的變化率 (數值沒有改變時沿用)
+
+        int64_t lastTimestamp = 0;  // 上一次 Evaluate 的取樣時間
+        long long evaluations = 0;
+        long long evaluationNanoseconds = 0;
+
+        void Compile(const std::vector<SensorSlot>& slots);
+    };
+
+    static bool RuleMatches(const AlertRule& rule, const SensorSlot& slot) {
+        if (!(rule.hardwareMask & HardwareTypeBit(slot.hardwareType))) return false;
+        if (rule.sensorType >= 0 && rule.sensorType != slot.sensorType) return false;
+
+        const char* pattern = rule.pattern.empty() ? "*" : rule.pattern.c_str();
+        return WildcardMatch(pattern, pattern[0] == '/' ? slot.identifier.c_str() : slot.name.c_str());
+    }
+
+    static std::string StateKey(int ruleId, const std::string& identifier) {
+        return std::to_string(ruleId) + '\n' + identifier;
+    }
+
+    void AlertEngine::Impl::Compile(const std::vector<SensorSlot>& slots) {
+        // 保留同一規則與 Identifier 的狀態 (重新繫結不會讓觸發中的警示重新觸發)
+        struct State {
+            bool firing;
+            bool pending;
+            int64_t since;
+        };
+        std::unordered_map<std::string, State> states;
+        for (size_t i = 0; i < instanceCount; ++i) {
+            unsigned char bit = static_cast<unsigned char>(1u << (i % BlockSize));
+            bool firing = (firingBits[i / BlockSize] & bit) != 0;
+            bool pending = (pendingBits[i / BlockSize] & bit) != 0;
+            if (firing || pending) states[StateKey(ruleId[i], identifiers[i])] = { firing, pending, since[i] };
+        }
+
+        struct Entry {
+            size_t rule;
+            uint32_t slot;
+        };
+        std::vector<Entry> entries;
+        for (int pass = 0; pass < 2; ++pass) {  // 數值條件在前
+            for (size_t r = 0; r < rules.size(); ++r) {
+                bool isRate = rules[r].condition == AlertRising || rules[r].condition == AlertFalling;
+                if (isRate != (pass == 1)) continue;
+                for (size_t s = 0; s < slots.size(); ++s) {
+                    if (RuleMatches(rules[r], slots[s])) entries.push_back({ r, static_cast<uint32_t>(s) });
+                }
+            }
+            if (pass == 0) levelCount = entries.size();
+        }
+
+        instanceCount = entries.size();
+        size_t padded = (instanceCount + BlockSize - 1) / BlockSize * BlockSize;
+        slot.assign(padded, 0);
+        ruleId.assign(padded, 0);
+        sign.assign(padded, 1.0f);
+        trigger.assign(padded, std::numeric_limits<float>::infinity());  // 補齊的實例永遠不成立
+        release.assign(padded, -std::numeric_limits<float>::infinity());
+        duration.assign(padded, 0);
+        since.assign(padded, 0);
+        input.assign(padded, 0.0f);
+        firingBits.assign(padded / BlockSize, 0);
+        pendingBits.assign(padded / BlockSize, 0);
+        identifiers.assign(instanceCount, std::string());
+
+        for (size_t i = 0; i < instanceCount; ++i) {
+            const AlertRule& rule = rules[entries[i].rule];
+            bool negative = rule.condition == AlertBelow || rule.condition == AlertFalling;
+            slot[i] = entries[i].slot;
+            ruleId[i] = rule.id;
+            sign[i] = negative ? -1.0f : 1.0f;
+            trigger[i] = rule.condition == AlertBelow ? -rule.threshold : rule.threshold;  // 下降的 threshold 為幅度
+            release[i] = trigger[i] - std::max(0.0f, rule.hysteresis);
+            duration[i] = static_cast<int64_t>(std::max(0.0f, rule.duration) * 1e6);
+            identifiers[i] = slots[entries[i].slot].identifier;
+
+            auto found = states.find(StateKey(rule.id, identifiers[i]));
+            if (found != states.end()) {
+                unsigned char bit = static_cast<unsigned char>(1u << (i % BlockSize));
+                if (found->second.firing) firingBits[i / BlockSize] |= bit;
+                if (found->second.pending) pendingBits[i / BlockSize] |= bit;
+                since[i] = found->second.since;
+            }
+        }
+
+        std::vector<uint32_t> slotRate(slots.size(), UINT32_MAX);
+        rateSlot.clear();
+        rateIndex.resize(instanceCount - levelCount);
+        for (size_t i = levelCount; i < instanceCount; ++i) {
+            uint32_t& index = slotRate[slot[i]];
+            if (index == UINT32_MAX) {
+                index = static_cast<uint32_t>(rateSlot.size());
+                rateSlot.push_back(slot[i]);
+            }
+            rateIndex[i - levelCount] = index;
+        }
+
+        size_t rateCount = rateSlot.size();
+        previous.assign(rateCount, std::numeric_limits<float>::quiet_NaN());
+        changedAt.assign(rateCount, 0);
+        changeInterval.assign(rateCount, 0);
+        rate.assign(rateCount, std::numeric_limits<float>::quiet_NaN());
+    }
+
+    AlertEngine::AlertEngine() : impl(new Impl()) {}
+
+    AlertEngine::~AlertEngine() {
+        delete impl;
+    }
+
+    int AlertEngine::Add(const AlertRule& rule) {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        AlertRule added = rule;
+        added.id = impl->nextId++;
+        impl->rules.push_back(added);
+        impl->rulesChanged = true;
+        impl->ruleCount.store(impl->rules.size());
+        return added.id;
+    }
+
+    bool AlertEngine::Remove(int id) {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        auto found = std::find_if(impl->rules.begin(), impl->rules.end(), [id](const AlertRule& rule) { return rule.id == id; });
+        if (found == impl->rules.end()) return false;
+
+        impl->rules.erase(found);
+        impl->rulesChanged = true;
+        impl->ruleCount.store(impl->rules.size());
+        return true;
+    }
+
+    void AlertEngine::Clear() {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->rules.clear();
+        impl->rulesChanged = true;
+        impl->ruleCount.store(0);
+    }
+
+    size_t AlertEngine::RuleCount() const {
+        return impl->ruleCount.load();
+    }
+
+    size_t AlertEngine::InstanceCount() const {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        return impl->instanceCount;
+    }
+
+    size_t AlertEngine::Evaluate(const std::vector<SensorSlot>& slots, unsigned int catalogVersion, int64_t timestamp, const float* values, size_t count, std::vector<AlertEvent>& events) {
+        if (impl->ruleCount.load() == 0 && impl->instanceCount == 0) return 0;
+
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        Impl& state = *impl;
+        int64_t start = DiagnosticsClock();
+        if (state.rulesChanged || state.compiledCatalog != catalogVersion) {
+            state.Compile(slots);
+            state.rulesChanged = false;
+            state.compiledCatalog = catalogVersion;
+        }
+
+        // 收集輸入：數值條件直接取槽位，變化率條件只在數值改變時更新 (其他硬體的發布不會讓變化率歸零)，
+        // 超過最近改變間隔的兩倍 (至少 1 秒) 沒有改變時視為 0；穩定後第一次改變以更新週期的估計 (沒有時為本次發布間隔) 計算
+        int64_t frameGap = state.lastTimestamp && timestamp > state.lastTimestamp ? timestamp - state.lastTimestamp : 1000000;
+        state.lastTimestamp = timestamp;
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        float* input = state.input.data();
+        const uint32_t* slot = state.slot.data();
+        const float* sign = state.sign.data();
+        for (size_t i = 0; i < state.levelCount; ++i) {
+            input[i] = slot[i] < count ? values[slot[i]] * sign[i] : nan;
+        }
+        for (size_t k = 0; k < state.rateSlot.size(); ++k) {
+            float value = state.rateSlot[k] < count ? values[state.rateSlot[k]] : nan;
+            int64_t elapsed = timestamp - state.changedAt[k];
+            bool steady = elapsed > std::max<int64_t>(2 * state.changeInterval[k], 1000000);
+            if (value != state.previous[k]) {
+                if (value == value && state.previous[k] == state.previous[k] && elapsed > 0) {
+                    int64_t interval = elapsed;
+                    if (steady) interval = state.changeInterval[k] ? state.changeInterval[k] : frameGap;
+                    else state.changeInterval[k] = elapsed;
+                    state.rate[k] = (value - state.previous[k]) * (1e6f / static_cast<float>(interval));
+                }
+                else {
+                    state.rate[k] = nan;  // 第一次或有無數值改變
+                }
+                state.previous[k] = value;
+                state.changedAt[k] = timestamp;
+            }
+            else if (steady) {
+                state.rate[k] = value == value ? 0.0f : nan;
+            }
+        }
+        const uint32_t* rateIndex = state.rateIndex.data();
+        const float* rate = state.rate.data();
+        for (size_t i = state.levelCount; i < state.instanceCount; ++i) {
+            input[i] = rate[rateIndex[i - state.levelCount]] * sign[i];
+        }
+
+        size_t added = 0;
+        size_t blocks = state.firingBits.size();
+        const float* trigger = state.trigger.data();
+        const float* release = state.release.data();
+        for (size_t b = 0; b < blocks; ++b) {
+            size_t first = b * BlockSize;
+            unsigned int above;
+            unsigned int below;
+#ifdef HWI_ALERT_SSE2
+            __m128 low = _mm_loadu_ps(input + first);
+            __m128 high = _mm_loadu_ps(input + first + 4);
+            above = static_cast<unsigned int>(_mm_movemask_ps(_mm_cmpgt_ps(low, _mm_loadu_ps(trigger + first))) |
+                (_mm_movemask_ps(_mm_cmpgt_ps(high, _mm_loadu_ps(trigger + first + 4))) << 4));
+            below = static_cast<unsigned int>(_mm_movemask_ps(_mm_cmplt_ps(low, _mm_loadu_ps(release + first))) |
+                (_mm_movemask_ps(_mm_cmplt_ps(high, _mm_loadu_ps(release + first + 4))) << 4));
+#else
+            above = 0;
+            below = 0;
+            for (size_t j = 0; j < BlockSize; ++j) {
+                if (input[first + j] > trigger[first + j]) above |= 1u << j;
+                if (input[first + j] < release[first + j]) below |= 1u << j;
+            }
+#endif
+            unsigned int firing = state.firingBits[b];
+            unsigned int pending = state.pendingBits[b];
+
+            // 狀態可能改變的實例：閒置且成立、觸發中且回到解除門檻、等待持續時間
+            unsigned int candidates = (above & ~firing & ~pending) | (below & firing) | pending;
+            while (candidates) {
+                unsigned int j = 0;
+                while (!(candidates & (1u << j))) ++j;
+                unsigned int bit = 1u << j;
+                candidates &= ~bit;
+                size_t i = first + j;
+
+                bool fire = false;
+                bool clear = false;
+                if (firing & bit) {
+                    clear = true;
+                    firing &= ~bit;
+                }
+                else if (!(above & bit)) {
+                    pending &= ~bit;  // 持續時間內條件不再成立
+                }
+                else if (pending & bit) {
+                    if (timestamp - state.since[i] >= state.duration[i]) {
+                        pending &= ~bit;
+                        fire = true;
+                    }
+                }
+                else if (state.duration[i] <= 0) {
+                    fire = true;
+                }
+                else {
+                    pending |= bit;
+                    state.since[i] = timestamp;
+                }
+
+                if (fire) {
+                    firing |= bit;
+                    state.since[i] = timestamp;
+                }
+                if (fire || clear) {
+                    events.push_back({ state.ruleId[i], state.slot[i], fire, input[i] * sign[i], timestamp, state.identifiers[i] });
+                    added++;
+                }
+            }
+            state.firingBits[b] = static_cast<unsigned char>(firing);
+            state.pendingBits[b] = static_cast<unsigned char>(pending);
+        }
+
+        state.evaluations++;
+        state.evaluationNanoseconds += DiagnosticsClock() - start;
+        return added;
+    }
+
+    void AlertEngine::Firing(std::vector<AlertEvent>& result) const {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        const Impl& state = *impl;
+        for (size_t i = 0; i < state.instanceCount; ++i) {
+            if (!(state.firingBits[i / BlockSize] & (1u << (i % BlockSize)))) continue;
+            result.push_back({ state.ruleId[i], state.slot[i], true, state.input[i] * state.sign[i], state.since[i], state.identifiers[i] });
+        }
+    }
+
+    long long AlertEngine::Evaluations() const {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        return impl->evaluations;
+    }
+
+    long long AlertEngine::EvaluationNanoseconds() const {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        return impl->evaluationNanoseconds;
+    }
+}
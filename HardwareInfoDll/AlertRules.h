@@ -0,0 +1,71 @@
+﻿#pragma once
+
+// 警示規則：規則在目錄或規則改變時編譯為 (規則, 槽位) 的實例，以連續陣列保存門檻與狀態；
+// 每次發布 frame 時收集輸入後以 SIMD 一次比較 8 個實例的觸發與解除條件，
+// 只有狀態可能改變的實例 (剛超過門檻、等待持續時間、觸發中回到解除門檻) 才逐一處理。
+// 支援遲滯 (解除門檻) 與持續時間，觸發與解除以事件回報。
+// 純原生程式碼，由 HardwareInfo 與效能測試共用。
+
+#include "HardwareModel.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace HardwareInfoDll {
+    enum AlertCondition {
+        AlertAbove,  // 數值大於 threshold
+        AlertBelow,  // 數值小於 threshold
+        AlertRising,  // 每秒上升超過 threshold
+        AlertFalling  // 每秒下降超過 threshold
+    };
+
+    struct AlertRule {
+        int id = 0;  // AlertEngine::Add 指定
+        uint32_t hardwareMask = 0xFFFFFFFF;  // SourceHardwareType 的位元遮罩
+        int sensorType = -1;  // SourceSensorType (-1 表示所有類型)
+        std::string pattern = "*";  // 感測器名稱 ('*'、'?')，以 '/' 開頭時比對 Identifier
+        int condition = AlertAbove;
+        float threshold = 0.0f;
+        float hysteresis = 0.0f;  // 觸發後需回到 threshold 另一側超過此值才解除
+        float duration = 0.0f;  // 條件需持續的秒數 (0 表示立即觸發)
+    };
+
+    struct AlertEvent {
+        int ruleId;
+        uint32_t slot;
+        bool firing;  // true 為觸發、false 為解除
+        float value;  // 當時的數值 (變化率條件為每秒變化)
+        int64_t timestamp;  // 取樣時間 (Unix epoch 微秒)
+        std::string identifier;  // 感測器 Identifier
+    };
+
+    class AlertEngine {
+        struct Impl;
+        Impl* impl;
+
+        public:
+        AlertEngine();
+        ~AlertEngine();
+
+        AlertEngine(const AlertEngine&) = delete;
+        AlertEngine& operator=(const AlertEngine&) = delete;
+
+        int Add(const AlertRule& rule);  // 回傳規則編號，下一次 Evaluate 時重新編譯
+        bool Remove(int id);  // 移除規則 (觸發中的實例不送出解除事件)
+        void Clear();
+
+        size_t RuleCount() const;
+        size_t InstanceCount() const;  // 編譯後的 (規則, 槽位) 數
+
+        // 發布端呼叫 (同時只有一個執行緒)：目錄版本或規則改變時重新編譯 (保留同一規則與 Identifier 的狀態)，
+        // values 依槽位排列，觸發與解除附加到 events，回傳附加的事件數。沒有規則時不取得鎖
+        size_t Evaluate(const std::vector<SensorSlot>& slots, unsigned int catalogVersion, int64_t timestamp, const float* values, size_t count, std::vector<AlertEvent>& events);
+
+        void Firing(std::vector<AlertEvent>& result) const;  // 目前觸發中的實例 (timestamp 為觸發時間)
+
+        long long Evaluations() const;  // Evaluate 次數 (有規則時)
+        long long EvaluationNanoseconds() const;  // Evaluate 的累計耗時
+    };
+}
@@ -0,0 +1,195 @@
+﻿#include "CpuTopology.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cstdio>
+#include <cstdlib>
+#endif
+
+namespace HardwareInfoDll {
+    // 一個邏輯處理器 (各鍵值只用來分組，不要求連續)
+    struct LogicalProcessor {
+        long long package = 0;
+        long long core = 0;  // 在系統中唯一
+        long long domain = -1;  // L3 網域 (-1 表示沒有 L3 資訊)
+        int efficiencyClass = 0;  // 數值較大的效能較高
+    };
+
+    // 依邏輯處理器的順序建立各封裝的核心 (核心依第一次出現的順序排列，與 LibreHardwareMonitor 相同)
+    static bool BuildTopology(const std::vector<LogicalProcessor>& processors, CpuTopology& topology) {
+        topology.packages.clear();
+        if (processors.empty()) return false;
+
+        struct PackageState {
+            std::unordered_map<long long, size_t> cores;
+            std::unordered_map<long long, int> domains;
+            std::vector<int> classes;  // 每個核心的效率等級
+        };
+        std::map<long long, PackageState> packages;  // 依封裝編號排序
+        std::map<long long, CpuPackageLayout> layouts;
+
+        for (const LogicalProcessor& processor : processors) {
+            PackageState& state = packages[processor.package];
+            CpuPackageLayout& layout = layouts[processor.package];
+
+            auto core = state.cores.find(processor.core);
+            if (core != state.cores.end()) {
+                layout.cores[core->second].threads++;
+                continue;
+            }
+
+            auto domain = state.domains.emplace(processor.domain, static_cast<int>(state.domains.size())).first;
+            CpuCoreLayout entry;
+            entry.domain = domain->second;
+            state.cores.emplace(processor.core, layout.cores.size());
+            state.classes.push_back(processor.efficiencyClass);
+            layout.cores.push_back(entry);
+        }
+
+        for (auto& entry : layouts) {
+            PackageState& state = packages[entry.first];
+            CpuPackageLayout& layout = entry.second;
+            layout.domains = std::max(1, static_cast<int>(state.domains.size()));
+
+            auto range = std::minmax_element(state.classes.begin(), state.classes.end());
+            layout.hybrid = *range.first != *range.second;
+            for (size_t c = 0; c < layout.cores.size(); ++c) layout.cores[c].efficient = layout.hybrid && state.classes[c] < *range.second;
+            topology.packages.push_back(std::move(layout));
+        }
+        return true;
+    }
+
+#ifdef _WIN32
+    // 對 GROUP_AFFINITY 中的每個邏輯處理器 (以群組與位元編號組成的鍵值) 呼叫 action
+    template <typename Action>
+    static void ForEachProcessor(const GROUP_AFFINITY& affinity, Action action) {
+        for (int bit = 0; bit < static_cast<int>(sizeof(KAFFINITY) * 8); ++bit) {
+            if (affinity.Mask & (static_cast<KAFFINITY>(1) << bit)) action(static_cast<long long>(affinity.Group) * 64 + bit);
+        }
+    }
+
+    bool DetectCpuTopology(CpuTopology& topology) {
+        topology.packages.clear();
+
+        DWORD length = 0;
+        GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+        if (GetLastError() != ERROR_INSUFFICIENT_BUFFER || length == 0) return false;
+
+        std::vector<char> buffer(length);
+        auto first = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data());
+        if (!GetLogicalProcessorInformationEx(RelationAll, first, &length)) return false;
+
+        // 每個邏輯處理器所屬的封裝、核心與 L3 (記錄的編號)
+        std::map<long long, LogicalProcessor> processors;  // 依群組與編號排序 (與 LibreHardwareMonitor 列舉的順序相同)
+        long long packageIndex = 0, coreIndex = 0, cacheIndex = 0;
+        for (DWORD offset = 0; offset < length;) {
+            auto info = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+            switch (info->Relationship) {
+                case RelationProcessorPackage:
+                    for (WORD g = 0; g < info->Processor.GroupCount; ++g) {
+                        ForEachProcessor(info->Processor.GroupMask[g], [&](long long p) { processors[p].package = packageIndex; });
+                    }
+                    packageIndex++;
+                    break;
+                case RelationProcessorCore:
+                    for (WORD g = 0; g < info->Processor.GroupCount; ++g) {
+                        ForEachProcessor(info->Processor.GroupMask[g], [&](long long p) {
+                            processors[p].core = coreIndex;
+                            processors[p].efficiencyClass = info->Processor.EfficiencyClass;
+                        });
+                    }
+                    coreIndex++;
+                    break;
+                case RelationCache:
+                    if (info->Cache.Level == 3) {
+                        ForEachProcessor(info->Cache.GroupMask, [&](long long p) { processors[p].domain = cacheIndex; });
+                        cacheIndex++;
+                    }
+                    break;
+                default:
+                    break;
+            }
+            offset += info->Size;
+        }
+
+        std::vector<LogicalProcessor> ordered;
+        ordered.reserve(processors.size());
+        for (auto& processor : processors) ordered.push_back(processor.second);
+        return BuildTopology(ordered, topology);
+    }
+#elif defined(__linux__)
+    // 讀取 sysfs 中的整數 (不存在時回傳 fallback)
+    static long long ReadNumber(const std::string& path, long long fallback) {
+        std::FILE* file = std::fopen(path.c_str(), "r");
+        if (!file) return fallback;
+        long long value;
+        if (std::fscanf(file, "%lld", &value) != 1) value = fallback;
+        std::fclose(file);
+        return value;
+    }
+
+    // 讀取 "0-7,16-23" 格式的處理器清單
+    static std::vector<int> ReadCpuList(const std::string& path) {
+        std::vector<int> result;
+        std::FILE* file = std::fopen(path.c_str(), "r");
+        if (!file) return result;
+
+        char text[4096];
+        if (std::fgets(text, sizeof(text), file)) {
+            for (char* p = text; *p && *p != '\n';) {
+                char* end;
+                long from = std::strtol(p, &end, 10);
+                if (end == p) break;
+                long to = from;
+                if (*end == '-') to = std::strtol(end + 1, &end, 10);
+                for (long cpu = from; cpu <= to; ++cpu) result.push_back(static_cast<int>(cpu));
+                p = *end == ',' ? end + 1 : end;
+            }
+        }
+        std::fclose(file);
+        return result;
+    }
+
+    bool DetectCpuTopology(CpuTopology& topology) {
+        topology.packages.clear();
+
+        // 混合架構的效率核心 (Intel 的 cpu_atom PMU)
+        std::vector<int> atoms = ReadCpuList("/sys/devices/cpu_atom/cpus");
+        std::vector<int> online = ReadCpuList("/sys/devices/system/cpu/online");
+
+        std::vector<LogicalProcessor> processors;
+        for (int cpu : online) {
+            std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+            LogicalProcessor processor;
+            processor.package = ReadNumber(base + "/topology/physical_package_id", -1);
+            if (processor.package < 0) continue;  // 沒有拓撲資訊
+
+            // core_id 只在同一個封裝 (與 die) 內唯一
+            long long die = ReadNumber(base + "/topology/die_id", 0);
+            processor.core = ((processor.package << 16 | (die & 0xFFFF)) << 24) | (ReadNumber(base + "/topology/core_id", cpu) & 0xFFFFFF);
+
+            // L3 的 id 在系統中唯一；舊核心沒有 id 時使用共用清單的第一個處理器
+            processor.domain = ReadNumber(base + "/cache/index3/id", -1);
+            if (processor.domain < 0) {
+                std::vector<int> shared = ReadCpuList(base + "/cache/index3/shared_cpu_list");
+                processor.domain = shared.empty() ? -1 : shared.front();
+            }
+            processor.efficiencyClass = std::find(atoms.begin(), atoms.end(), cpu) != atoms.end() ? 0 : 1;
+            processors.push_back(processor);
+        }
+        return BuildTopology(processors, topology);
+    }
+#else
+    bool DetectCpuTopology(CpuTopology& topology) {
+        topology.packages.clear();
+        return false;
+    }
+#endif
+}
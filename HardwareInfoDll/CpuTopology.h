@@ -0,0 +1,29 @@
+﻿#pragma once
+
+// CPU 拓撲：每個封裝 (插槽) 的核心依 LibreHardwareMonitor 的核心順序 (核心 #1 在前) 排列，
+// 記錄所屬的 L3 網域 (AMD 的 CCD/CCX；Intel 通常整個封裝共用一個 L3) 與是否為效率核心 (E-core)。
+// Windows 使用 GetLogicalProcessorInformationEx，Linux 讀取 sysfs，其他平台回傳 false。
+// 純原生程式碼，由 HardwareInfo、合成來源與效能測試共用。
+
+#include <vector>
+
+namespace HardwareInfoDll {
+    struct CpuCoreLayout {
+        int domain = 0;  // L3 網域在封裝內的編號 (從 0 開始)
+        int threads = 1;  // 邏輯處理器數量
+        bool efficient = false;  // 效率核心 (混合架構中效率等級較低的核心)
+    };
+
+    struct CpuPackageLayout {
+        std::vector<CpuCoreLayout> cores;
+        int domains = 1;  // L3 網域數量
+        bool hybrid = false;  // 同時有效能與效率核心
+    };
+
+    struct CpuTopology {
+        std::vector<CpuPackageLayout> packages;  // 依封裝編號排列 (與 LibreHardwareMonitor 的 CPU 順序相同)
+    };
+
+    // 偵測目前系統的拓撲，無法取得時回傳 false (topology 為空)
+    bool DetectCpuTopology(CpuTopology& topology);
+}
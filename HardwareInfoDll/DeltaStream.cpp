@@ -0,0 +1,183 @@
+﻿#include "DeltaStream.h"
+#include "Subscriptions.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+
+namespace HardwareInfoDll {
+    struct DeltaRule {
+        std::string pattern;
+        Deadband deadband;
+    };
+
+    struct DeltaStream::Impl {
+        mutable std::mutex mutex;
+        mutable std::condition_variable changed;  // 新批次或停止時通知讀者
+
+        // 讀者與寫入端共用 (mutex 保護)
+        std::vector<DeltaBatch> ring;  // 最近的批次 (sequence % capacity)
+        std::vector<float> emitted;  // 每個槽位最後送出的數值
+        uint64_t sequence = 0;
+        size_t retained = 0;  // ring 中有效的批次數
+        std::atomic<bool> active{ false };  // 停用時寫入端不取得 mutex
+        std::vector<DeltaRule> rules;
+        bool rulesChanged = true;
+        long long emittedCount = 0;
+        long long suppressedCount = 0;
+
+        // 只由寫入端存取
+        std::vector<Deadband> bands;  // 每個槽位解析後的門檻
+        unsigned int bandsCatalog = 0;  // bands 對應的目錄版本
+        DeltaBatch scratch;  // 填好後與 ring 中最舊的批次交換 (穩定狀態不配置)
+    };
+
+    // 數值改變且超過門檻；有無數值 (NaN) 的變化一律送出
+    static bool Exceeds(float value, float previous, const Deadband& band) {
+        bool valueMissing = std::isnan(value);
+        bool previousMissing = std::isnan(previous);
+        if (valueMissing || previousMissing) return valueMissing != previousMissing;
+
+        float threshold = std::max(band.absolute, band.relative * std::fabs(previous));
+        return std::fabs(value - previous) > threshold;
+    }
+
+    DeltaStream::DeltaStream() : impl(new Impl()) {}
+
+    DeltaStream::~DeltaStream() {
+        delete impl;
+    }
+
+    void DeltaStream::Start(size_t capacity) {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->ring.assign(std::max<size_t>(capacity, 1), DeltaBatch());
+        impl->retained = 0;
+        impl->emitted.clear();  // 下一個批次送出所有感測器
+        impl->active = true;
+    }
+
+    void DeltaStream::Stop() {
+        {
+            std::lock_guard<std::mutex> lock(impl->mutex);
+            impl->active = false;
+        }
+        impl->changed.notify_all();
+    }
+
+    bool DeltaStream::Active() const {
+        return impl->active.load(std::memory_order_acquire);
+    }
+
+    void DeltaStream::SetDeadband(const std::string& identifierPattern, const Deadband& deadband) {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->rules.push_back({ identifierPattern.empty() ? "*" : identifierPattern, deadband });
+        impl->rulesChanged = true;
+    }
+
+    void DeltaStream::ClearDeadbands() {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->rules.clear();
+        impl->rulesChanged = true;
+    }
+
+    size_t DeltaStream::Record(const std::vector<SensorSlot>& slots, const float* values, size_t count, int64_t timestamp, unsigned int catalogVersion) {
+        if (!impl->active.load(std::memory_order_acquire)) return 0;
+
+        std::unique_lock<std::mutex> lock(impl->mutex);
+        if (!impl->active || impl->ring.empty()) return 0;
+
+        // 門檻只在規則或目錄改變時依 Identifier 重新解析
+        count = std::min(count, slots.size());
+        if (impl->rulesChanged || impl->bandsCatalog != catalogVersion || impl->bands.size() != count) {
+            impl->bands.assign(count, Deadband());
+            for (size_t slot = 0; slot < count; ++slot) {
+                for (auto rule = impl->rules.rbegin(); rule != impl->rules.rend(); ++rule) {
+                    if (WildcardMatch(rule->pattern.c_str(), slots[slot].identifier.c_str())) {
+                        impl->bands[slot] = rule->deadband;
+                        break;
+                    }
+                }
+            }
+            impl->rulesChanged = false;
+            impl->bandsCatalog = catalogVersion;
+        }
+
+        // 新的槽位視為從未送出 (NaN 與 NaN 相同，沒有數值的新感測器不送出)
+        bool first = impl->emitted.empty();
+        if (impl->emitted.size() < count) impl->emitted.resize(count, std::numeric_limits<float>::quiet_NaN());
+
+        DeltaBatch& batch = impl->scratch;
+        batch.entries.clear();
+        for (size_t slot = 0; slot < count; ++slot) {
+            float value = values[slot];
+            float previous = impl->emitted[slot];
+            if (first ? !std::isnan(value) : Exceeds(value, previous, impl->bands[slot])) {
+                batch.entries.push_back({ static_cast<uint32_t>(slot), value });
+                impl->emitted[slot] = value;
+            }
+            else if (value != previous && !(std::isnan(value) && std::isnan(previous))) {
+                impl->suppressedCount++;
+            }
+        }
+        if (batch.entries.empty()) return 0;
+
+        batch.sequence = ++impl->sequence;
+        batch.timestamp = timestamp;
+        batch.catalogVersion = catalogVersion;
+        size_t emitted = batch.entries.size();
+        impl->emittedCount += static_cast<long long>(emitted);
+
+        std::swap(impl->ring[batch.sequence % impl->ring.size()], batch);
+        impl->retained = std::min(impl->retained + 1, impl->ring.size());
+        lock.unlock();
+
+        impl->changed.notify_all();
+        return emitted;
+    }
+
+    bool DeltaStream::Read(uint64_t afterSequence, std::vector<DeltaBatch>& result, int timeoutMs) const {
+        result.clear();
+
+        std::unique_lock<std::mutex> lock(impl->mutex);
+        if (timeoutMs > 0 && impl->sequence <= afterSequence) {
+            uint64_t waitAfter = afterSequence;
+            impl->changed.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this, waitAfter] {
+                return impl->sequence > waitAfter || !impl->active;
+            });
+        }
+
+        // afterSequence 之後的第一個批次必須還在 ring 中
+        uint64_t oldest = impl->sequence - impl->retained + 1;
+        if (afterSequence + 1 < oldest) return false;
+
+        for (uint64_t sequence = afterSequence + 1; sequence <= impl->sequence; ++sequence) {
+            result.push_back(impl->ring[sequence % impl->ring.size()]);
+        }
+        return true;
+    }
+
+    uint64_t DeltaStream::Baseline(std::vector<float>& values) const {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        values = impl->emitted;
+        return impl->sequence;
+    }
+
+    uint64_t DeltaStream::Sequence() const {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        return impl->sequence;
+    }
+
+    long long DeltaStream::Emitted() const {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        return impl->emittedCount;
+    }
+
+    long long DeltaStream::Suppressed() const {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        return impl->suppressedCount;
+    }
+}
@@ -0,0 +1,74 @@
+﻿#pragma once
+
+// 變化串流：每次發布 frame 時比較每個感測器與「上一次送出的數值」，
+// 只有超過門檻 (絕對值或相對比例) 的感測器加入新的批次。批次有連續的序號，
+// 讀者以最後處理的序號讀取後續批次；序號不連續或批次已被覆寫時以 Baseline 重新同步。
+// 純原生程式碼，由 HardwareInfo 與效能測試共用。
+
+#include "HardwareModel.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace HardwareInfoDll {
+    // 變化門檻：|新值 - 上次送出的值| 大於 max(absolute, relative x |上次送出的值|) 時送出
+    struct Deadband {
+        float absolute = 0.0f;
+        float relative = 0.0f;  // 比例 (0.01 表示 1%)
+    };
+
+    struct DeltaEntry {
+        uint32_t slot;
+        float value;  // NaN 表示感測器不再有數值
+    };
+
+    // 一次發布中超過門檻的感測器
+    struct DeltaBatch {
+        uint64_t sequence = 0;  // 連續遞增 (沒有變化的發布不產生批次)
+        int64_t timestamp = 0;  // 取樣時間 (Unix epoch 微秒)
+        unsigned int catalogVersion = 0;
+        std::vector<DeltaEntry> entries;
+    };
+
+    class DeltaStream {
+        struct Impl;
+        Impl* impl;
+
+        public:
+        static const size_t DefaultCapacity = 256;
+
+        DeltaStream();
+        ~DeltaStream();
+
+        DeltaStream(const DeltaStream&) = delete;
+        DeltaStream& operator=(const DeltaStream&) = delete;
+
+        // 開始記錄並保留最近 capacity 個批次 (清除舊批次，下一個批次包含所有感測器)
+        void Start(size_t capacity);
+        void Stop();  // 停止記錄並喚醒等待中的讀者
+        bool Active() const;
+
+        // 設定 Identifier 符合 identifierPattern ('*'、'?') 的感測器門檻，後設定的規則優先。
+        // 沒有符合任何規則的感測器在數值改變時就送出
+        void SetDeadband(const std::string& identifierPattern, const Deadband& deadband);
+        void ClearDeadbands();
+
+        // 寫入端在發布 frame 時呼叫 (同時只有一個執行緒)，values 依槽位排列，回傳送出的感測器數
+        size_t Record(const std::vector<SensorSlot>& slots, const float* values, size_t count, int64_t timestamp, unsigned int catalogVersion);
+
+        // 取得 afterSequence 之後的批次 (沒有新批次時最多等待 timeoutMs 毫秒)。
+        // afterSequence 之後有批次已被覆寫時回傳 false，讀者需要以 Baseline 重新同步
+        bool Read(uint64_t afterSequence, std::vector<DeltaBatch>& result, int timeoutMs) const;
+
+        // 每個槽位最後送出的數值 (套用到目前序號為止的所有批次後的狀態)，回傳目前序號
+        uint64_t Baseline(std::vector<float>& values) const;
+
+        uint64_t Sequence() const;  // 最後一個批次的序號 (尚未送出時為 0)
+
+        long long Emitted() const;  // 送出的感測器總數
+
+        long long Suppressed() const;  // 數值有改變但在門檻內而未送出的次數
+    };
+}
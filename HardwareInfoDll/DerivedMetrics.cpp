@@ -0,0 +1,239 @@
+﻿#include "DerivedMetrics.h"
+#include "Subscriptions.h"
+
+#include <cmath>
+#include <unordered_set>
+
+namespace HardwareInfoDll {
+    const char* DerivedKindName(int kind) {
+        switch (kind) {
+            case DerivedRate: return "Rate";
+            case DerivedEwma: return "EWMA";
+            case DerivedAverage: return "Average";
+            case DerivedThrottling: return "Throttling";
+            default: return "Derived";
+        }
+    }
+
+    static const uint32_t GpuHardwareMask = (1u << GpuNvidiaHardware) | (1u << GpuAmdHardware) | (1u << GpuIntelHardware);
+
+    static DerivedRule MakeRule(int kind, uint32_t hardwareMask, int sensorType, const char* pattern, float parameter) {
+        DerivedRule rule;
+        rule.kind = kind;
+        rule.hardwareMask = hardwareMask;
+        rule.sensorType = sensorType;
+        rule.pattern = pattern;
+        rule.parameter = parameter;
+        return rule;
+    }
+
+    std::vector<DerivedRule> DerivedMetrics::DefaultRules() {
+        std::vector<DerivedRule> result;
+
+        // 累計數據 (GB) 轉成每秒位元組數
+        DerivedRule dataRate = MakeRule(DerivedRate, HardwareTypeBit(NetworkHardware) | HardwareTypeBit(StorageHardware), DataSensor, "Data *", 1073741824.0f);
+        dataRate.outputType = ThroughputSensor;
+        result.push_back(dataRate);
+
+        result.push_back(MakeRule(DerivedEwma, HardwareTypeBit(CpuHardware), LoadSensor, "CPU Total", 10.0f));
+        result.push_back(MakeRule(DerivedAverage, HardwareTypeBit(CpuHardware), LoadSensor, "CPU Total", 60.0f));
+        result.push_back(MakeRule(DerivedEwma, GpuHardwareMask, LoadSensor, "GPU Core", 10.0f));
+        result.push_back(MakeRule(DerivedEwma, HardwareTypeBit(StorageHardware), LoadSensor, "* Activity", 10.0f));
+        result.push_back(MakeRule(DerivedAverage, HardwareTypeBit(StorageHardware), LoadSensor, "Total Activity", 30.0f));
+
+        // 每核心時脈對應同名的核心溫度，沒有每核心溫度時 (AMD) 使用 Tctl/Tdie
+        DerivedRule cpuThrottling = MakeRule(DerivedThrottling, HardwareTypeBit(CpuHardware), ClockSensor, "CPU Core #*", 90.0f);
+        cpuThrottling.companion = "Core (Tctl*";
+        cpuThrottling.outputType = FactorSensor;
+        result.push_back(cpuThrottling);
+
+        DerivedRule gpuThrottling = MakeRule(DerivedThrottling, GpuHardwareMask, ClockSensor, "GPU Core", 85.0f);
+        gpuThrottling.outputType = FactorSensor;
+        result.push_back(gpuThrottling);
+        return result;
+    }
+
+    DerivedMetrics::DerivedMetrics() : rules(DefaultRules()) {}
+
+    void DerivedMetrics::SetRules(const std::vector<DerivedRule>& newRules) {
+        rules = newRules;
+    }
+
+    void DerivedMetrics::AddRule(const DerivedRule& rule) {
+        rules.push_back(rule);
+    }
+
+    // 在 hardware 中尋找 sensorType 且名稱符合 pattern 的感測器 (找不到時回傳 sensors.size())
+    static size_t FindSensor(const SourceHardware& hardware, int sensorType, const char* pattern) {
+        for (size_t i = 0; i < hardware.sensors.size(); ++i) {
+            const SourceSensor& sensor = hardware.sensors[i];
+            if (sensor.sensorType == sensorType && WildcardMatch(pattern, sensor.name.c_str())) return i;
+        }
+        return hardware.sensors.size();
+    }
+
+    // 輸出所在的 Get*Info 結構 (GPU 另外加入感測器對照表)
+    static CoreSeries* SeriesFor(SensorModel& model, const SourceHardware& hardware, int category) {
+        switch (category) {
+            case CpuCategory: return &model.cpu.Derived;
+            case MemoryCategory: return &model.memory.derived;
+            case StorageCategory: return &model.storage[hardware.name].derived;
+            case NetworkCategory: return &model.network[Utf8ToWide(hardware.name)].derived;
+            case DeviceCategory: return &model.devices[hardware.name].derived;
+            default: return nullptr;
+        }
+    }
+
+    size_t DerivedMetrics::Rebind(SensorModel& model) {
+        metrics.clear();
+        samples.clear();
+        firstMetric.assign(1, 0);
+
+        // 先決定所有指標再取欄位位址：加入名稱時 CoreSeries 的陣列可能重新配置
+        struct Pending {
+            SensorSlot description;
+            CoreSeries* series;
+            size_t index;
+            GpuSensorInfo* gpuSensor;
+        };
+        std::vector<Pending> pending;
+        std::unordered_set<std::string> identifiers;  // 多條規則產生相同名稱時只保留第一個
+
+        for (size_t b = 0; b < model.bindings.size(); ++b) {
+            const HardwareBinding& binding = model.bindings[b];
+            const SourceHardware& hardware = model.boundHardware[b];
+
+            for (const DerivedRule& rule : rules) {
+                if (!(rule.hardwareMask & HardwareTypeBit(hardware.hardwareType))) continue;
+
+                for (size_t i = 0; i < hardware.sensors.size(); ++i) {
+                    const SourceSensor& sensor = hardware.sensors[i];
+                    if (rule.sensorType >= 0 && sensor.sensorType != rule.sensorType) continue;
+                    if (!WildcardMatch(rule.pattern.c_str(), sensor.name.c_str())) continue;
+
+                    Metric metric = {};
+                    metric.kind = rule.kind;
+                    metric.input = binding.firstSensor + i;
+                    metric.companion = metric.input;
+                    metric.parameter = rule.parameter;
+                    metric.drop = rule.drop;
+
+                    if (rule.kind == DerivedThrottling) {
+                        size_t temperature = FindSensor(hardware, TemperatureSensor, sensor.name.c_str());
+                        if (temperature == hardware.sensors.size() && !rule.companion.empty())
+                            temperature = FindSensor(hardware, TemperatureSensor, rule.companion.c_str());
+                        if (temperature == hardware.sensors.size()) continue;  // 沒有可對應的溫度
+                        metric.companion = binding.firstSensor + temperature;
+                    }
+                    else if (rule.kind == DerivedAverage) {
+                        size_t window = rule.parameter >= 1.0f ? static_cast<size_t>(rule.parameter) : 1;
+                        metric.window = samples.size();
+                        metric.parameter = static_cast<float>(window);
+                        samples.resize(samples.size() + window, 0.0f);
+                    }
+
+                    std::string label = rule.label.empty() ? DerivedKindName(rule.kind) : rule.label;
+                    Pending entry = {};
+                    entry.description.identifier = sensor.identifier + "/" + label;
+                    if (!identifiers.insert(entry.description.identifier).second) continue;
+
+                    entry.description.hardwareName = hardware.name;
+                    entry.description.name = sensor.name + " " + label;
+                    entry.description.hardwareType = hardware.hardwareType;
+                    entry.description.sensorType = rule.outputType >= 0 ? rule.outputType : sensor.sensorType;
+
+                    if (binding.category == GpuCategory) {
+                        GpuSensorInfo& gpuSensor = model.gpu[hardware.name][entry.description.name];  // unordered_map 的元素位址固定
+                        gpuSensor.Type = SensorTypeName(entry.description.sensorType);
+                        entry.gpuSensor = &gpuSensor;
+                    }
+                    else if ((entry.series = SeriesFor(model, hardware, binding.category))) {
+                        entry.index = entry.series->Values.size();
+                        entry.series->Names.push_back(entry.description.name);
+                        entry.series->Values.push_back(0.0f);
+                    }
+
+                    metrics.push_back(metric);
+                    pending.push_back(entry);
+                }
+            }
+            firstMetric.push_back(metrics.size());
+        }
+
+        for (size_t m = 0; m < metrics.size(); ++m) {
+            Pending& entry = pending[m];
+            float* field = entry.gpuSensor ? &entry.gpuSensor->Value : entry.series ? &entry.series->Values[entry.index] : nullptr;
+            metrics[m].field = field;
+            metrics[m].output = model.BindDerived(entry.description, field);
+        }
+        return metrics.size();
+    }
+
+    bool DerivedMetrics::Update(SensorModel& model, size_t bindingIndex, int64_t nanoseconds) {
+        if (!Active(bindingIndex)) return false;
+
+        const float* sourceValues = model.sourceValues.data();
+        float* values = model.values.data();
+        bool changed = false;
+
+        size_t end = firstMetric[bindingIndex + 1];
+        for (size_t m = firstMetric[bindingIndex]; m < end; ++m) {
+            Metric& metric = metrics[m];
+            float value = sourceValues[metric.input];
+            if (value != value) continue;  // 本次沒有數值 (NaN)
+
+            float result;
+            switch (metric.kind) {
+                case DerivedRate: {
+                    bool first = metric.time == 0;
+                    double seconds = (nanoseconds - metric.time) / 1e9;
+                    double delta = value - metric.state;
+                    if (!first && seconds <= 0.0) continue;
+
+                    metric.state = value;
+                    metric.time = nanoseconds;
+                    if (first) continue;  // 需要兩次更新才有速率
+                    result = delta < 0.0 ? 0.0f : static_cast<float>(delta / seconds * metric.parameter);
+                    break;
+                }
+                case DerivedEwma: {
+                    if (metric.time == 0 || metric.parameter <= 0.0f) {
+                        metric.state = value;
+                    }
+                    else {
+                        double seconds = (nanoseconds - metric.time) / 1e9;
+                        double alpha = seconds > 0.0 ? 1.0 - std::exp(-seconds / metric.parameter) : 0.0;
+                        metric.state += alpha * (value - metric.state);
+                    }
+                    metric.time = nanoseconds;
+                    result = static_cast<float>(metric.state);
+                    break;
+                }
+                case DerivedAverage: {
+                    float* window = samples.data() + metric.window;
+                    uint32_t size = static_cast<uint32_t>(metric.parameter);
+                    if (metric.count == size) metric.state -= window[metric.next];
+                    else metric.count++;
+                    window[metric.next] = value;
+                    metric.state += value;
+                    metric.next = metric.next + 1 == size ? 0 : metric.next + 1;
+                    result = static_cast<float>(metric.state / metric.count);
+                    break;
+                }
+                default: {
+                    float temperature = sourceValues[metric.companion];
+                    if (temperature != temperature) continue;
+
+                    if (value > metric.state) metric.state = value;  // 峰值時脈
+                    result = temperature >= metric.parameter && value < metric.state * (1.0 - metric.drop) ? 1.0f : 0.0f;
+                    break;
+                }
+            }
+
+            if (values[metric.output] != result) changed = true;
+            values[metric.output] = result;
+            if (metric.field) *metric.field = result;
+        }
+        return changed;
+    }
+}
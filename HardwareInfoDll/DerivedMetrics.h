@@ -0,0 +1,89 @@
+﻿#pragma once
+
+// 衍生指標：每次硬體更新後以增量計算變化率、EWMA、移動平均與高溫降頻偵測 (每個指標 O(1)，不配置記憶體)，
+// 結果繫結為額外的槽位 (Identifier 為來源 Identifier 加上 "/" 與名稱)，因此快照、目錄、共享記憶體、
+// OpenMetrics、歷史與變化串流都會包含，Get*Info 則輸出在各硬體的 "Derived" 中。
+// 純原生程式碼，由 HardwareInfo 與效能測試共用。
+
+#include "SensorModel.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace HardwareInfoDll {
+    enum DerivedKind {
+        DerivedRate,  // 累計值每秒的變化 x parameter (數值變小時視為計數器重設，輸出 0)
+        DerivedEwma,  // 指數加權移動平均，parameter 為時間常數 (秒)，取樣間隔不固定也正確
+        DerivedAverage,  // 最近 parameter 次更新的平均
+        DerivedThrottling,  // 高溫降頻：溫度達到 parameter (°C) 且時脈低於峰值 drop 比例時為 1，否則為 0
+        DerivedKindCount
+    };
+
+    const char* DerivedKindName(int kind);  // 預設的名稱後綴 ("Rate"、"EWMA"、"Average"、"Throttling")
+
+    // 一條規則套用到所有符合的感測器
+    struct DerivedRule {
+        int kind = DerivedEwma;
+        uint32_t hardwareMask = 0xFFFFFFFF;  // SourceHardwareType 位元遮罩
+        int sensorType = -1;  // 來源的 SourceSensorType (-1 表示所有類型)
+        std::string pattern = "*";  // 來源感測器名稱樣式 ('*'、'?'，不分大小寫)
+        float parameter = 0.0f;
+        float drop = 0.1f;  // DerivedThrottling：時脈低於峰值的比例
+        std::string companion;  // DerivedThrottling：沒有同名溫度感測器時使用的溫度感測器名稱樣式
+        int outputType = -1;  // 輸出的 SourceSensorType (-1 表示與來源相同)
+        std::string label;  // 名稱後綴 (空字串表示使用 DerivedKindName)
+    };
+
+    class DerivedMetrics {
+        struct Metric {
+            int kind;
+            size_t input;  // 來源在 sourceValues 的位置
+            size_t companion;  // DerivedThrottling 的溫度在 sourceValues 的位置
+            size_t output;  // 輸出槽位
+            float* field;  // 輸出的結構欄位 (nullptr 表示只保存在槽位)
+            float parameter;
+            float drop;
+            double state;  // Rate：上一次的數值；Ewma：平均；Average：視窗總和；Throttling：峰值時脈
+            int64_t time;  // 上一次更新 (奈秒，0 表示尚未更新)
+            size_t window;  // DerivedAverage：在 samples 中的起點
+            uint32_t count;  // DerivedAverage：視窗內的樣本數
+            uint32_t next;  // DerivedAverage：下一個寫入位置
+        };
+
+        std::vector<DerivedRule> rules;
+        std::vector<Metric> metrics;  // 依繫結排列
+        std::vector<size_t> firstMetric;  // 每個繫結的第一個指標 (多一個結尾)
+        std::vector<float> samples;  // 所有 DerivedAverage 的視窗
+
+        public:
+        DerivedMetrics();  // 使用 DefaultRules()
+
+        // 預設規則：網路與儲存累計數據的速率、CPU/GPU 負載與儲存活動的 EWMA 與平均、CPU/GPU 高溫降頻
+        static std::vector<DerivedRule> DefaultRules();
+
+        void SetRules(const std::vector<DerivedRule>& newRules);  // 下一次 Rebind 後生效
+        void AddRule(const DerivedRule& rule);
+
+        size_t RuleCount() const {
+            return rules.size();
+        }
+
+        // 在 SensorModel::Rebind 之後呼叫：依規則解析來源並繫結輸出槽位 (清除所有狀態)，回傳指標數
+        size_t Rebind(SensorModel& model);
+
+        // 繫結是否有衍生指標 (沒有時不必讀取時間)
+        bool Active(size_t bindingIndex) const {
+            return bindingIndex + 1 < firstMetric.size() && firstMetric[bindingIndex] != firstMetric[bindingIndex + 1];
+        }
+
+        // 在繫結 bindingIndex 的 Poll 之後呼叫 (nanoseconds 為單調時間)，回傳是否有數值改變。
+        // 每個指標只屬於一個繫結，不同繫結可同時呼叫
+        bool Update(SensorModel& model, size_t bindingIndex, int64_t nanoseconds);
+
+        size_t Count() const {
+            return metrics.size();
+        }
+    };
+}
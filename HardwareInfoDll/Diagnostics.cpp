@@ -0,0 +1,204 @@
+﻿#include "Diagnostics.h"
+
+#include <chrono>
+
+namespace HardwareInfoDll {
+    int64_t DiagnosticsClock() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    namespace {
+        // 最高位元的位置 (value 不為 0)
+        int HighestBit(uint64_t value) {
+            int bit = 0;
+            for (int shift = 32; shift > 0; shift >>= 1) {
+                if (value >> shift) {
+                    value >>= shift;
+                    bit += shift;
+                }
+            }
+            return bit;
+        }
+    }
+
+    // 0~3 各佔一個區間；之後每個 2 的次方 [2^k, 2^(k+1)) 依次高的兩個位元分成 4 個區間
+    int LatencyHistogram::BucketOf(uint64_t nanoseconds) {
+        if (nanoseconds < SubBuckets) return static_cast<int>(nanoseconds);
+
+        int bit = HighestBit(nanoseconds);
+        int sub = static_cast<int>(nanoseconds >> (bit - 2)) & (SubBuckets - 1);
+        int bucket = (bit - 1) * SubBuckets + sub;
+        return bucket < BucketCount ? bucket : BucketCount - 1;
+    }
+
+    uint64_t LatencyHistogram::BucketUpperBound(int bucket) {
+        if (bucket < SubBuckets) return static_cast<uint64_t>(bucket);
+
+        int bit = bucket / SubBuckets + 1;
+        uint64_t width = 1ULL << (bit - 2);
+        uint64_t lower = static_cast<uint64_t>(SubBuckets + bucket % SubBuckets) << (bit - 2);
+        return lower + width - 1;
+    }
+
+    LatencyHistogram::LatencyHistogram() {
+        for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+    }
+
+    void LatencyHistogram::Record(int64_t nanoseconds) {
+        uint64_t value = nanoseconds > 0 ? static_cast<uint64_t>(nanoseconds) : 0;
+        buckets[BucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(value, std::memory_order_relaxed);
+
+        int64_t current = max.load(std::memory_order_relaxed);
+        while (static_cast<int64_t>(value) > current && !max.compare_exchange_weak(current, static_cast<int64_t>(value), std::memory_order_relaxed)) {}
+    }
+
+    void LatencyHistogram::RecordExclusive(int64_t nanoseconds) {
+        uint64_t value = nanoseconds > 0 ? static_cast<uint64_t>(nanoseconds) : 0;
+        std::atomic<uint64_t>& bucket = buckets[BucketOf(value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        total.store(total.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        if (static_cast<int64_t>(value) > max.load(std::memory_order_relaxed)) max.store(static_cast<int64_t>(value), std::memory_order_relaxed);
+    }
+
+    void LatencyHistogram::MergeInto(LatencyHistogram& target) const {
+        for (int i = 0; i < BucketCount; i++) {
+            target.buckets[i].fetch_add(buckets[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        target.count.fetch_add(count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        target.total.fetch_add(total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        int64_t largest = max.load(std::memory_order_relaxed);
+        if (largest > target.max.load(std::memory_order_relaxed)) target.max.store(largest, std::memory_order_relaxed);
+    }
+
+    void LatencyHistogram::Reset() {
+        for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+        count.store(0, std::memory_order_relaxed);
+        total.store(0, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t LatencyHistogram::Count() const {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    double LatencyHistogram::Mean() const {
+        uint64_t samples = Count();
+        return samples ? static_cast<double>(total.load(std::memory_order_relaxed)) / samples : 0.0;
+    }
+
+    int64_t LatencyHistogram::Max() const {
+        return max.load(std::memory_order_relaxed);
+    }
+
+    int64_t LatencyHistogram::Percentile(double quantile) const {
+        // 各區間分別讀取，總數以區間加總為準 (與 Record 同時進行時仍然一致)
+        uint64_t counts[BucketCount];
+        uint64_t samples = 0;
+        for (int i = 0; i < BucketCount; i++) {
+            counts[i] = buckets[i].load(std::memory_order_relaxed);
+            samples += counts[i];
+        }
+        if (samples == 0) return 0;
+
+        if (quantile < 0.0) quantile = 0.0;
+        if (quantile > 1.0) quantile = 1.0;
+        uint64_t rank = static_cast<uint64_t>(quantile * (samples - 1)) + 1;
+
+        uint64_t seen = 0;
+        for (int i = 0; i < BucketCount; i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                int64_t bound = static_cast<int64_t>(BucketUpperBound(i));
+                int64_t largest = Max();
+                return largest > 0 && bound > largest ? largest : bound;  // 不超過實際最大值
+            }
+        }
+        return Max();
+    }
+
+    PollDiagnostics::PollDiagnostics() {
+        for (auto& hits : cacheHits) hits.store(0, std::memory_order_relaxed);
+    }
+
+    void PollDiagnostics::Resize(size_t bindings) {
+        updates.reset(new LatencyHistogram[bindings]);
+        applies.reset(new LatencyHistogram[bindings]);
+        lastUpdates.reset(new std::atomic<int64_t>[bindings]);
+        for (size_t i = 0; i < bindings; ++i) lastUpdates[i].store(0, std::memory_order_relaxed);
+        bindingCount = bindings;
+    }
+
+    bool PollDiagnostics::Poll(SensorModel& model, SensorSource& source, size_t bindingIndex) {
+        if (!Enabled() || bindingIndex >= bindingCount) return model.Poll(source, bindingIndex);
+
+        Fetch(model, source, bindingIndex);
+
+        model.LockValues();
+        bool changed = Apply(model, bindingIndex);
+        model.UnlockValues();
+        return changed;
+    }
+
+    // 每次輪詢讀取四次時鐘並更新兩個只有本執行緒寫入的直方圖，相對於 Update() 本身可以忽略
+    void PollDiagnostics::Fetch(SensorModel& model, SensorSource& source, size_t bindingIndex) {
+        if (!Enabled() || bindingIndex >= bindingCount) {
+            model.Fetch(source, bindingIndex);
+            return;
+        }
+
+        int64_t start = DiagnosticsClock();
+        model.Fetch(source, bindingIndex);
+        updates[bindingIndex].RecordExclusive(DiagnosticsClock() - start);
+    }
+
+    bool PollDiagnostics::Apply(SensorModel& model, size_t bindingIndex) {
+        if (!Enabled() || bindingIndex >= bindingCount) return model.Apply(bindingIndex);
+
+        int64_t start = DiagnosticsClock();
+        bool changed = model.Apply(bindingIndex);
+        int64_t applied = DiagnosticsClock();
+
+        applies[bindingIndex].RecordExclusive(applied - start);
+        lastUpdates[bindingIndex].store(applied, std::memory_order_relaxed);
+        return changed;
+    }
+
+    void PollDiagnostics::MergeHandler(const SensorModel& model, int category, LatencyHistogram& result) const {
+        size_t count = model.bindings.size() < bindingCount ? model.bindings.size() : bindingCount;
+        for (size_t i = 0; i < count; ++i) {
+            if (model.bindings[i].category == category) applies[i].MergeInto(result);
+        }
+    }
+
+    void PollDiagnostics::GpuScheduled() {
+        gpuScheduled.fetch_add(1, std::memory_order_relaxed);
+        if (gpuInFlight.fetch_add(1, std::memory_order_relaxed) > 0) gpuOverlapped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void PollDiagnostics::GpuSkipped() {
+        gpuSkipped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void PollDiagnostics::GpuFinished() {
+        gpuInFlight.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void PollDiagnostics::Reset() {
+        for (size_t i = 0; i < bindingCount; ++i) {
+            updates[i].Reset();
+            applies[i].Reset();
+        }
+        for (auto& kind : serializers) {
+            for (auto& histogram : kind) histogram.Reset();
+        }
+        for (auto& hits : cacheHits) hits.store(0, std::memory_order_relaxed);
+        publish.Reset();
+        readAge.Reset();
+        gpuScheduled.store(0, std::memory_order_relaxed);
+        gpuSkipped.store(0, std::memory_order_relaxed);
+        gpuOverlapped.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,161 @@
+﻿#pragma once
+
+// 自我量測：每個硬體 Update() 的耗時、硬體處理函數 (套用數值) 與序列化的耗時、
+// GPU 更新被略過或重疊的次數，以及資料的年齡。
+// 記錄只使用 relaxed atomic 遞增，不需要鎖或配置；停用時輪詢不讀取時鐘。
+// 純原生程式碼，由 HardwareInfo 與效能測試共用。
+
+#include "SensorModel.h"
+#include "SensorSource.h"
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace HardwareInfoDll {
+    int64_t DiagnosticsClock();  // 單調時鐘 (奈秒)
+
+    // 延遲直方圖：每個 2 的次方再分成 4 個區間 (誤差不超過 25%)，涵蓋 1 奈秒到約 36 分鐘
+    class LatencyHistogram {
+        public:
+        static const int SubBuckets = 4;
+        static const int BucketCount = 40 * SubBuckets;
+
+        private:
+        std::atomic<uint64_t> buckets[BucketCount];
+        std::atomic<uint64_t> count{ 0 };
+        std::atomic<uint64_t> total{ 0 };  // 奈秒總和
+        std::atomic<int64_t> max{ 0 };
+
+        static int BucketOf(uint64_t nanoseconds);
+        static uint64_t BucketUpperBound(int bucket);
+
+        public:
+        LatencyHistogram();
+
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+        void Record(int64_t nanoseconds);  // 負值視為 0，可由多個執行緒同時呼叫
+        void RecordExclusive(int64_t nanoseconds);  // 同一時間只有一個寫入端時使用 (不使用鎖定指令)
+        void Reset();  // 與 Record 同時呼叫時可能遺失少量樣本
+        void MergeInto(LatencyHistogram& target) const;  // 將樣本加入 target (target 不能同時被寫入)
+
+        uint64_t Count() const;
+        double Mean() const;  // 平均 (奈秒)，沒有樣本時為 0
+        int64_t Max() const;
+        int64_t Percentile(double quantile) const;  // 所在區間的上限 (奈秒)，quantile 為 0~1
+    };
+
+    // HardwareInfo 的量測資料 (每個 HardwareInfo 一份)
+    class PollDiagnostics {
+        std::atomic<bool> enabled{ false };
+
+        std::unique_ptr<LatencyHistogram[]> updates;  // 每個繫結的 Update() 耗時
+        std::unique_ptr<LatencyHistogram[]> applies;  // 每個繫結的處理函數 (套用數值) 耗時，讀取時依類別合併
+        std::unique_ptr<std::atomic<int64_t>[]> lastUpdates;  // 每個繫結最後一次更新的時間 (DiagnosticsClock，0 表示尚未更新)
+        size_t bindingCount = 0;
+
+        LatencyHistogram serializers[2][InfoCategoryCount];  // [JsonSerializerKind][類別] 序列化耗時 (只計入快取未命中)
+        std::atomic<uint64_t> cacheHits[InfoCategoryCount];
+        LatencyHistogram publish;  // 寫入並發布一個 frame 的耗時
+        LatencyHistogram readAge;  // Get*Info 讀取時 frame 的年齡
+
+        std::atomic<uint64_t> gpuScheduled{ 0 };  // SaveAllHardware 排入的 GPU 更新
+        std::atomic<uint64_t> gpuSkipped{ 0 };  // 因前一次更新尚未結束而略過 (WaitOne(0) 失敗)
+        std::atomic<uint64_t> gpuOverlapped{ 0 };  // 排入時前一次更新仍在佇列或執行中
+        std::atomic<int> gpuInFlight{ 0 };
+
+        public:
+        PollDiagnostics();
+
+        PollDiagnostics(const PollDiagnostics&) = delete;
+        PollDiagnostics& operator=(const PollDiagnostics&) = delete;
+
+        bool Enabled() const {
+            return enabled.load(std::memory_order_relaxed);
+        }
+
+        void Enable(bool value) {
+            enabled.store(value, std::memory_order_relaxed);
+        }
+
+        // 重新繫結後呼叫 (沒有輪詢進行中)，清除每個硬體的量測
+        void Resize(size_t bindings);
+
+        // 從來源更新一個硬體並套用數值，啟用時記錄 Update() 與處理函數的耗時 (取代 SensorModel::Poll)。
+        // 同一個硬體不會同時被輪詢，因此每個繫結的量測只有一個寫入端
+        bool Poll(SensorModel& model, SensorSource& source, size_t bindingIndex);
+
+        // Poll 的兩個步驟 (取代 SensorModel::Fetch 與 Apply)：Fetch 在鎖外執行，Apply 由呼叫端持有 LockValues
+        void Fetch(SensorModel& model, SensorSource& source, size_t bindingIndex);
+        bool Apply(SensorModel& model, size_t bindingIndex);
+
+        void RecordSerialize(int serializer, int category, int64_t nanoseconds) {
+            serializers[serializer][category].Record(nanoseconds);
+        }
+
+        void RecordCacheHit(int category) {
+            cacheHits[category].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void RecordPublish(int64_t nanoseconds) {
+            publish.Record(nanoseconds);
+        }
+
+        void RecordReadAge(int64_t nanoseconds) {
+            readAge.Record(nanoseconds);
+        }
+
+        // GPU 更新排入與結束 (不論是否啟用都計數)
+        void GpuScheduled();
+        void GpuSkipped();
+        void GpuFinished();
+
+        size_t BindingCount() const {
+            return bindingCount;
+        }
+
+        const LatencyHistogram& Update(size_t bindingIndex) const {
+            return updates[bindingIndex];
+        }
+
+        int64_t LastUpdate(size_t bindingIndex) const {
+            return lastUpdates[bindingIndex].load(std::memory_order_relaxed);
+        }
+
+        // 合併 category 所有硬體的處理函數耗時到 result (NoCategory 為沒有對應 Get*Info 的硬體)
+        void MergeHandler(const SensorModel& model, int category, LatencyHistogram& result) const;
+
+        const LatencyHistogram& Serializer(int serializer, int category) const {
+            return serializers[serializer][category];
+        }
+
+        uint64_t CacheHits(int category) const {
+            return cacheHits[category].load(std::memory_order_relaxed);
+        }
+
+        const LatencyHistogram& Publish() const {
+            return publish;
+        }
+
+        const LatencyHistogram& ReadAge() const {
+            return readAge;
+        }
+
+        uint64_t GpuScheduledCount() const {
+            return gpuScheduled.load(std::memory_order_relaxed);
+        }
+
+        uint64_t GpuSkippedCount() const {
+            return gpuSkipped.load(std::memory_order_relaxed);
+        }
+
+        uint64_t GpuOverlappedCount() const {
+            return gpuOverlapped.load(std::memory_order_relaxed);
+        }
+
+        void Reset();  // 清除所有耗時與計數 (不影響啟用狀態)
+    };
+}
@@ -0,0 +1,958 @@
+﻿#include "FleetCollector.h"
+#include "Diagnostics.h"
+#include "Subscriptions.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace HardwareInfoDll {
+    namespace {
+#ifdef _WIN32
+        typedef SOCKET Socket;
+        const Socket InvalidSocket = INVALID_SOCKET;
+
+        void CloseSocket(Socket socket) {
+            closesocket(socket);
+        }
+
+        bool SetNonBlocking(Socket socket) {
+            u_long enabled = 1;
+            return ioctlsocket(socket, FIONBIO, &enabled) == 0;
+        }
+#else
+        typedef int Socket;
+        const Socket InvalidSocket = -1;
+
+        void CloseSocket(Socket socket) {
+            close(socket);
+        }
+
+        bool SetNonBlocking(Socket socket) {
+            int flags = fcntl(socket, F_GETFL, 0);
+            return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+        }
+#endif
+
+        const size_t ValuesPerDatagram = (HWI_FLEET_MAX_DATAGRAM - sizeof(HwiFleetHeader)) / sizeof(float);
+        const size_t SensorsPerDatagram = (HWI_FLEET_MAX_DATAGRAM - sizeof(HwiFleetHeader) - sizeof(HwiFleetHost)) / sizeof(HwiFleetSensor);
+        const uint32_t MaxSensors = 65536;  // 目錄的上限 (避免錯誤的封包配置大量記憶體)
+        const size_t BatchSize = 64;  // 一次系統呼叫最多接收的封包數
+        const int ReceivePollMs = 200;  // 等待封包的間隔 (同時檢查是否要停止與逾時)
+        const int ReceiveBufferBytes = 4 << 20;  // 大量主機同時送出時的接收緩衝區
+        const int64_t DefaultHostTimeout = 10000000000LL;  // 10 秒
+        const int64_t ExpireInterval = 100000000LL;  // 接收時每 100 毫秒檢查一次逾時的主機
+        const int UnixSendTimeoutMs = 5;  // Unix datagram 佇列已滿時等待收集端的時間 (預設佇列只有 10 個封包)
+
+        // 端點：UDP (IPv4) 或 Unix datagram
+        struct Endpoint {
+            sockaddr_storage address = {};
+            socklen_t length = 0;
+            int family = AF_INET;
+            std::string path;  // Unix datagram 的路徑
+        };
+
+        bool ParseEndpoint(const std::string& text, Endpoint& endpoint) {
+            if (text.compare(0, 5, "unix:") == 0) {
+#ifdef _WIN32
+                return false;  // Winsock 的 AF_UNIX 只支援 stream
+#else
+                sockaddr_un* address = reinterpret_cast<sockaddr_un*>(&endpoint.address);
+                endpoint.path = text.substr(5);
+                if (endpoint.path.empty() || endpoint.path.size() >= sizeof(address->sun_path)) return false;
+
+                address->sun_family = AF_UNIX;
+                std::memcpy(address->sun_path, endpoint.path.c_str(), endpoint.path.size() + 1);
+                endpoint.family = AF_UNIX;
+                endpoint.length = static_cast<socklen_t>(sizeof(sockaddr_un));
+                return true;
+#endif
+            }
+
+            std::string hostPort = text.compare(0, 6, "udp://") == 0 ? text.substr(6) : text;
+            size_t colon = hostPort.rfind(':');
+            if (colon == std::string::npos || colon + 1 == hostPort.size()) return false;
+
+            char* end = nullptr;
+            long port = std::strtol(hostPort.c_str() + colon + 1, &end, 10);
+            if (*end != '\0' || port < 0 || port > 65535) return false;
+
+            sockaddr_in* address = reinterpret_cast<sockaddr_in*>(&endpoint.address);
+            address->sin_family = AF_INET;
+            address->sin_port = htons(static_cast<unsigned short>(port));
+            std::string host = hostPort.substr(0, colon);
+            if (inet_pton(AF_INET, host.empty() ? "0.0.0.0" : host.c_str(), &address->sin_addr) != 1) return false;
+
+            endpoint.family = AF_INET;
+            endpoint.length = static_cast<socklen_t>(sizeof(sockaddr_in));
+            return true;
+        }
+
+        uint64_t HostId(const std::string& hostName) {
+            uint64_t hash = 14695981039346656037ULL;  // FNV-1a
+            for (unsigned char c : hostName) {
+                hash ^= c;
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        // 固定長度欄位中以 '\0' 結尾的字串 (沒有結尾時取整個欄位)
+        template <size_t N>
+        std::string FieldString(const char (&field)[N]) {
+            const void* end = std::memchr(field, '\0', N);
+            return std::string(field, end ? static_cast<const char*>(end) - field : N);
+        }
+
+        template <size_t N>
+        void CopyField(char (&field)[N], const std::string& value) {
+            size_t length = std::min(value.size(), N - 1);
+            std::memcpy(field, value.data(), length);
+            std::memset(field + length, 0, N - length);
+        }
+    }
+
+    const char* FleetReduceName(int reduce) {
+        switch (reduce) {
+            case FleetMax: return "Max";
+            case FleetMin: return "Min";
+            case FleetSum: return "Sum";
+            case FleetAverage: return "Average";
+            default: return "Unknown";
+        }
+    }
+
+    // ---- 送出端 ----
+
+    struct FleetSender::Impl {
+        Socket socket = InvalidSocket;
+        Endpoint endpoint;
+        HwiFleetHost host = {};
+        uint64_t hostId = 0;
+        uint32_t instance = 0;
+        int64_t interval = 0;
+        int64_t catalogInterval = 0;
+        int64_t lastSample = 0;  // 最後送出取樣的時間 (0 表示尚未送出)
+        int64_t lastCatalog = 0;
+        unsigned int sentCatalog = 0;  // 已送出的目錄版本
+        bool catalogSent = false;
+        unsigned char buffer[HWI_FLEET_MAX_DATAGRAM];  // 沒有對齊保證：標頭與項目在區域變數中填好後以 memcpy 寫入
+
+        std::atomic<long long> samples{ 0 };
+        std::atomic<long long> datagrams{ 0 };
+        std::atomic<long long> bytes{ 0 };
+        std::atomic<long long> catalogs{ 0 };
+        std::atomic<long long> errors{ 0 };
+
+        bool Transmit(size_t size);
+        void WriteHeader(uint16_t kind, unsigned int catalogVersion, uint64_t sequence, int64_t timestamp, size_t count, size_t first, size_t chunk, size_t n);
+    };
+
+    bool FleetSender::Impl::Transmit(size_t size) {
+        int sent = sendto(socket, reinterpret_cast<const char*>(buffer), static_cast<int>(size), 0, reinterpret_cast<const sockaddr*>(&endpoint.address), endpoint.length);
+        if (sent != static_cast<int>(size)) {
+            errors.fetch_add(1, std::memory_order_relaxed);  // 緩衝區已滿或收集端不存在 (Unix datagram)，數值不重試
+            return false;
+        }
+
+        datagrams.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(static_cast<long long>(size), std::memory_order_relaxed);
+        return true;
+    }
+
+    void FleetSender::Impl::WriteHeader(uint16_t kind, unsigned int catalogVersion, uint64_t sequence, int64_t timestamp, size_t count, size_t first, size_t chunk, size_t n) {
+        HwiFleetHeader header = {};
+        header.magic = HWI_FLEET_MAGIC;
+        header.version = HWI_FLEET_VERSION;
+        header.kind = kind;
+        header.hostId = hostId;
+        header.instance = instance;
+        header.catalogVersion = catalogVersion;
+        header.sequence = sequence;
+        header.timestamp = timestamp;
+        header.sensorCount = static_cast<uint32_t>(count);
+        header.first = static_cast<uint32_t>(first);
+        header.chunk = static_cast<uint16_t>(chunk);
+        header.count = static_cast<uint16_t>(n);
+        std::memcpy(buffer, &header, sizeof(header));
+    }
+
+    FleetSender::FleetSender() : impl(new Impl()) {}
+
+    FleetSender::~FleetSender() {
+        Close();
+        delete impl;
+    }
+
+    bool FleetSender::Open(const std::string& endpoint, const std::string& hostName, const std::string& group, int64_t interval, int64_t catalogInterval) {
+        Close();
+
+        Endpoint target;
+        if (!ParseEndpoint(endpoint, target)) return false;
+
+#ifdef _WIN32
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0) return false;
+#endif
+        // UDP 以非阻塞方式送出 (取樣不等待網路)；同一台機器上的 Unix datagram 在佇列已滿時最多等待 UnixSendTimeoutMs
+        Socket socket = ::socket(target.family, SOCK_DGRAM, 0);
+        bool configured = socket != InvalidSocket;
+#ifndef _WIN32
+        if (configured && target.family == AF_UNIX) {
+            timeval timeout = { 0, UnixSendTimeoutMs * 1000 };
+            configured = setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) == 0;
+        }
+        else
+#endif
+        if (configured) configured = SetNonBlocking(socket);
+        if (!configured) {
+            if (socket != InvalidSocket) CloseSocket(socket);
+#ifdef _WIN32
+            WSACleanup();
+#endif
+            return false;
+        }
+
+        impl->socket = socket;
+        impl->endpoint = target;
+        CopyField(impl->host.hostName, hostName);
+        CopyField(impl->host.group, group);
+        impl->hostId = HostId(hostName);
+        impl->instance = std::random_device()();
+        impl->interval = std::max<int64_t>(0, interval);
+        impl->catalogInterval = catalogInterval > 0 ? catalogInterval : 10000000;
+        impl->lastSample = 0;
+        impl->catalogSent = false;
+        impl->samples.store(0);
+        impl->datagrams.store(0);
+        impl->bytes.store(0);
+        impl->catalogs.store(0);
+        impl->errors.store(0);
+        return true;
+    }
+
+    void FleetSender::Close() {
+        if (impl->socket == InvalidSocket) return;
+
+        CloseSocket(impl->socket);
+        impl->socket = InvalidSocket;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+
+    bool FleetSender::IsOpen() const {
+        return impl->socket != InvalidSocket;
+    }
+
+    size_t FleetSender::Send(const std::vector<SensorSlot>& slots, unsigned int catalogVersion, uint64_t sequence, int64_t timestamp, const float* values, size_t count) {
+        Impl& state = *impl;
+        if (state.socket == InvalidSocket) return 0;
+        if (state.lastSample != 0 && timestamp - state.lastSample < state.interval) return 0;
+
+        count = std::min<size_t>(std::min(count, slots.size()), MaxSensors);  // 數值與目錄的感測器數必須相同
+        long long before = state.datagrams.load(std::memory_order_relaxed) + state.errors.load(std::memory_order_relaxed);
+        state.lastSample = timestamp;
+
+        // 目錄在版本改變時與固定間隔重送 (UDP 可能遺失，收集端也可能晚於送出端啟動)，送出失敗時下一次取樣重送
+        if (!state.catalogSent || state.sentCatalog != catalogVersion || timestamp - state.lastCatalog >= state.catalogInterval) {
+            bool complete = true;
+            for (size_t first = 0, chunk = 0; first < count || first == 0; first += SensorsPerDatagram, ++chunk) {
+                size_t n = std::min(SensorsPerDatagram, count - first);
+                state.WriteHeader(HWI_FLEET_CATALOG, catalogVersion, sequence, timestamp, count, first, chunk, n);
+                std::memcpy(state.buffer + sizeof(HwiFleetHeader), &state.host, sizeof(HwiFleetHost));
+
+                unsigned char* entries = state.buffer + sizeof(HwiFleetHeader) + sizeof(HwiFleetHost);
+                for (size_t i = 0; i < n; ++i) {
+                    const SensorSlot& slot = slots[first + i];
+                    HwiFleetSensor entry = {};
+                    entry.hardwareType = static_cast<uint16_t>(slot.hardwareType);
+                    entry.sensorType = static_cast<uint16_t>(slot.sensorType);
+                    CopyField(entry.identifier, slot.identifier);
+                    CopyField(entry.name, slot.name);
+                    std::memcpy(entries + i * sizeof(HwiFleetSensor), &entry, sizeof(entry));
+                }
+                complete &= state.Transmit(sizeof(HwiFleetHeader) + sizeof(HwiFleetHost) + n * sizeof(HwiFleetSensor));
+                if (count == 0) break;
+            }
+            state.catalogSent = complete;
+            state.sentCatalog = catalogVersion;
+            state.lastCatalog = timestamp;
+            state.catalogs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        for (size_t first = 0, chunk = 0; first < count; first += ValuesPerDatagram, ++chunk) {
+            size_t n = std::min(ValuesPerDatagram, count - first);
+            state.WriteHeader(HWI_FLEET_VALUES, catalogVersion, sequence, timestamp, count, first, chunk, n);
+            std::memcpy(state.buffer + sizeof(HwiFleetHeader), values + first, n * sizeof(float));
+            state.Transmit(sizeof(HwiFleetHeader) + n * sizeof(float));
+        }
+
+        state.samples.fetch_add(1, std::memory_order_relaxed);
+        long long after = state.datagrams.load(std::memory_order_relaxed) + state.errors.load(std::memory_order_relaxed);
+        return static_cast<size_t>(after - before);
+    }
+
+    FleetSenderStats FleetSender::Stats() const {
+        FleetSenderStats stats;
+        stats.samples = impl->samples.load(std::memory_order_relaxed);
+        stats.datagrams = impl->datagrams.load(std::memory_order_relaxed);
+        stats.bytes = impl->bytes.load(std::memory_order_relaxed);
+        stats.catalogs = impl->catalogs.load(std::memory_order_relaxed);
+        stats.errors = impl->errors.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    // ---- 收集端 ----
+
+    struct FleetCollector::Impl {
+        // 一台主機對一個彙總的貢獻：termSlots[first, first + count) 中的槽位
+        struct Term {
+            uint32_t aggregate;
+            uint32_t first;
+            uint32_t count;
+        };
+
+        struct Host {
+            uint64_t hostId = 0;
+            uint32_t instance = 0;
+            std::string name;
+            std::string group;
+
+            // 目前的目錄與數值 (依槽位)
+            bool catalogReady = false;
+            uint32_t catalogVersion = 0;
+            std::vector<HwiFleetSensor> sensors;
+            std::vector<float> values;
+
+            // 組合中的目錄
+            uint32_t pendingVersion = 0;
+            bool pendingActive = false;
+            std::vector<HwiFleetSensor> pendingSensors;
+            std::vector<unsigned char> pendingReceived;
+            size_t pendingCount = 0;
+
+            // 去除重複：最新的取樣序號與已套用的封包編號
+            bool hasSequence = false;
+            uint64_t sequence = 0;
+            std::vector<uint64_t> chunks;  // 位元集合
+            int64_t timestamp = 0;
+
+            std::vector<Term> terms;
+            std::vector<uint32_t> termSlots;
+            int64_t lastSeen = 0;
+            bool active = false;
+            bool dirty = false;
+
+            long long samples = 0;
+            long long duplicates = 0;
+            long long stale = 0;
+        };
+
+        // 一個彙總：column 依主機排列 (NaN 表示沒有貢獻)，總和與主機數增量維護，
+        // 最大/最小值只在持有者變小 (變大) 時重新掃描整欄
+        struct Aggregate {
+            size_t rule;
+            std::string group;
+            std::vector<float> column;
+            double sum = 0.0;
+            uint32_t hosts = 0;
+            float extreme = std::numeric_limits<float>::quiet_NaN();
+            bool rescan = false;
+        };
+
+        struct Item {
+            HwiFleetHeader header;
+            const unsigned char* payload;
+            size_t payloadSize;
+        };
+
+        std::mutex mutex;  // 主機、彙總與規則 (接收執行緒每批取得一次)
+        std::vector<FleetRule> rules;
+        std::vector<Host> hosts;
+        std::unordered_map<uint64_t, size_t> hostIndex;
+        std::vector<Aggregate> aggregates;
+        std::unordered_map<std::string, size_t> aggregateIndex;  // 規則索引 + '\n' + 分組
+        std::vector<Item> items;  // Ingest 的排序暫存 (重複使用)
+        std::vector<size_t> dirtyHosts;
+        int64_t hostTimeout = DefaultHostTimeout;
+        int64_t lastExpire = 0;
+        FleetCollectorStats stats;
+
+        Socket socket = InvalidSocket;
+        std::string unixPath;
+        int port = 0;
+        std::thread thread;
+        std::atomic<bool> stopping{ false };
+
+        Impl() : rules(FleetCollector::DefaultRules()) {}
+
+        size_t FindHost(uint64_t hostId);
+        size_t FindAggregate(size_t rule, const std::string& group);
+        void SetContribution(size_t aggregate, size_t host, float value);
+        void MarkDirty(size_t host);  // 在這一批結束時重新計算
+        void ClearHost(size_t host);  // 移除主機的所有貢獻
+        void Compile(size_t host);  // 依目錄與規則建立主機的貢獻
+        void Recompute(size_t host);  // 依最新數值更新主機的貢獻
+        void Rebuild();  // 規則改變後重新編譯所有主機
+        void Expire(int64_t now);  // 移出逾時的主機 (掃描所有主機)
+        bool ApplyCatalog(size_t host, const Item& item);  // 回傳是否套用 (重複、過期或等待目錄時為 false)
+        bool ApplyValues(size_t host, const Item& item);
+        double Value(Aggregate& aggregate);
+        void Receive(FleetCollector& owner);
+    };
+
+    size_t FleetCollector::Impl::FindHost(uint64_t hostId) {
+        auto found = hostIndex.find(hostId);
+        if (found != hostIndex.end()) return found->second;
+
+        size_t index = hosts.size();
+        hosts.emplace_back();
+        hosts.back().hostId = hostId;
+        hostIndex.emplace(hostId, index);
+        for (Aggregate& aggregate : aggregates) aggregate.column.push_back(std::numeric_limits<float>::quiet_NaN());
+        return index;
+    }
+
+    size_t FleetCollector::Impl::FindAggregate(size_t rule, const std::string& group) {
+        std::string key = std::to_string(rule) + '\n' + group;
+        auto found = aggregateIndex.find(key);
+        if (found != aggregateIndex.end()) return found->second;
+
+        Aggregate aggregate;
+        aggregate.rule = rule;
+        aggregate.group = group;
+        aggregate.column.assign(hosts.size(), std::numeric_limits<float>::quiet_NaN());
+        aggregates.push_back(std::move(aggregate));
+        aggregateIndex.emplace(key, aggregates.size() - 1);
+        return aggregates.size() - 1;
+    }
+
+    void FleetCollector::Impl::SetContribution(size_t index, size_t host, float value) {
+        Aggregate& aggregate = aggregates[index];
+        float old = aggregate.column[host];
+        if (old == value || (old != old && value != value)) return;
+
+        aggregate.column[host] = value;
+        if (old == old) {
+            aggregate.sum -= old;
+            aggregate.hosts--;
+        }
+        if (value == value) {
+            aggregate.sum += value;
+            aggregate.hosts++;
+        }
+        if (aggregate.hosts == 0) aggregate.sum = 0.0;  // 避免累積的捨入誤差
+
+        int reduce = rules[aggregate.rule].reduce;
+        if (reduce != FleetMax && reduce != FleetMin) return;
+        if (aggregate.rescan) return;
+
+        float extreme = aggregate.extreme;
+        bool better = value == value && (extreme != extreme || (reduce == FleetMax ? value >= extreme : value <= extreme));
+        if (better) aggregate.extreme = value;
+        else if (old == extreme) aggregate.rescan = true;  // 持有者變差或離開
+    }
+
+    double FleetCollector::Impl::Value(Aggregate& aggregate) {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        int reduce = rules[aggregate.rule].reduce;
+        if (aggregate.hosts == 0) return nan;
+        if (reduce == FleetSum) return aggregate.sum;
+        if (reduce == FleetAverage) return aggregate.sum / aggregate.hosts;
+
+        if (aggregate.rescan) {
+            float extreme = std::numeric_limits<float>::quiet_NaN();
+            for (float value : aggregate.column) {
+                if (value != value) continue;
+                if (extreme != extreme || (reduce == FleetMax ? value > extreme : value < extreme)) extreme = value;
+            }
+            aggregate.extreme = extreme;
+            aggregate.rescan = false;
+        }
+        return aggregate.extreme;
+    }
+
+    void FleetCollector::Impl::MarkDirty(size_t index) {
+        if (hosts[index].dirty) return;
+
+        hosts[index].dirty = true;
+        dirtyHosts.push_back(index);
+    }
+
+    void FleetCollector::Impl::ClearHost(size_t index) {
+        Host& host = hosts[index];
+        for (const Term& term : host.terms) SetContribution(term.aggregate, index, std::numeric_limits<float>::quiet_NaN());
+    }
+
+    void FleetCollector::Impl::Compile(size_t index) {
+        ClearHost(index);
+        Host& host = hosts[index];
+        host.terms.clear();
+        host.termSlots.clear();
+        if (!host.catalogReady) return;
+
+        for (size_t r = 0; r < rules.size(); ++r) {
+            const FleetRule& rule = rules[r];
+            const char* pattern = rule.pattern.empty() ? "*" : rule.pattern.c_str();
+            bool byIdentifier = pattern[0] == '/';
+
+            Term term = { 0, static_cast<uint32_t>(host.termSlots.size()), 0 };
+            for (size_t s = 0; s < host.sensors.size(); ++s) {
+                const HwiFleetSensor& sensor = host.sensors[s];
+                if (!(rule.hardwareMask & HardwareTypeBit(sensor.hardwareType))) continue;
+                if (rule.sensorType >= 0 && rule.sensorType != sensor.sensorType) continue;
+                if (!WildcardMatch(pattern, FieldString(byIdentifier ? sensor.identifier : sensor.name).c_str())) continue;
+
+                host.termSlots.push_back(static_cast<uint32_t>(s));
+                term.count++;
+            }
+            if (term.count == 0) continue;
+
+            term.aggregate = static_cast<uint32_t>(FindAggregate(r, rule.byGroup ? host.group : std::string()));
+            host.terms.push_back(term);
+        }
+    }
+
+    void FleetCollector::Impl::Recompute(size_t index) {
+        Host& host = hosts[index];
+        host.dirty = false;
+        if (!host.active) return;
+
+        const float* values = host.values.data();
+        for (const Term& term : host.terms) {
+            int reduce = rules[aggregates[term.aggregate].rule].reduce;
+            const uint32_t* slot = host.termSlots.data() + term.first;
+
+            double result = 0.0;
+            uint32_t counted = 0;
+            for (uint32_t i = 0; i < term.count; ++i) {
+                float value = values[slot[i]];
+                if (value != value) continue;
+                if (counted == 0 || reduce == FleetSum || reduce == FleetAverage) {
+                    result = counted == 0 ? value : result + value;
+                }
+                else if (reduce == FleetMax ? value > result : value < result) {
+                    result = value;
+                }
+                counted++;
+            }
+            if (reduce == FleetAverage && counted > 0) result /= counted;
+            SetContribution(term.aggregate, index, counted > 0 ? static_cast<float>(result) : std::numeric_limits<float>::quiet_NaN());
+        }
+    }
+
+    void FleetCollector::Impl::Rebuild() {
+        aggregates.clear();
+        aggregateIndex.clear();
+        for (size_t h = 0; h < hosts.size(); ++h) {
+            hosts[h].terms.clear();  // 舊的彙總已移除，不需要清除貢獻
+            Compile(h);
+            Recompute(h);
+        }
+    }
+
+    void FleetCollector::Impl::Expire(int64_t now) {
+        lastExpire = now;
+        for (size_t h = 0; h < hosts.size(); ++h) {
+            Host& host = hosts[h];
+            if (!host.active || now - host.lastSeen <= hostTimeout) continue;
+
+            ClearHost(h);
+            host.active = false;
+            stats.expired++;
+        }
+    }
+
+    bool FleetCollector::Impl::ApplyCatalog(size_t index, const Item& item) {
+        Host& host = hosts[index];
+        const HwiFleetHeader& header = item.header;
+        if (host.catalogReady && header.catalogVersion == host.catalogVersion) return false;  // 定期重送的目錄
+
+        if (!host.pendingActive || host.pendingVersion != header.catalogVersion || host.pendingSensors.size() != header.sensorCount) {
+            host.pendingActive = true;
+            host.pendingVersion = header.catalogVersion;
+            host.pendingSensors.assign(header.sensorCount, HwiFleetSensor());
+            host.pendingReceived.assign(header.sensorCount, 0);
+            host.pendingCount = 0;
+        }
+
+        // 封包內容沒有對齊保證，只以位元組位移讀取
+        const unsigned char* entries = item.payload + sizeof(HwiFleetHost);
+        for (size_t i = 0; i < header.count; ++i) {
+            size_t slot = header.first + i;
+            std::memcpy(&host.pendingSensors[slot], entries + i * sizeof(HwiFleetSensor), sizeof(HwiFleetSensor));
+            if (!host.pendingReceived[slot]) {
+                host.pendingReceived[slot] = 1;
+                host.pendingCount++;
+            }
+        }
+        if (host.pendingCount < host.pendingSensors.size()) return true;
+
+        // 目錄完整：換成新的目錄，數值等待下一個取樣
+        HwiFleetHost description;
+        std::memcpy(&description, item.payload, sizeof(description));
+        ClearHost(index);
+        host.name = FieldString(description.hostName);
+        host.group = FieldString(description.group);
+        host.sensors.swap(host.pendingSensors);
+        host.values.assign(host.sensors.size(), std::numeric_limits<float>::quiet_NaN());
+        host.catalogVersion = header.catalogVersion;
+        host.catalogReady = true;
+        host.pendingActive = false;
+        host.hasSequence = false;
+        Compile(index);
+        MarkDirty(index);
+        return true;
+    }
+
+    bool FleetCollector::Impl::ApplyValues(size_t index, const Item& item) {
+        Host& host = hosts[index];
+        const HwiFleetHeader& header = item.header;
+        if (!host.catalogReady || header.catalogVersion != host.catalogVersion || header.sensorCount != host.values.size()) {
+            stats.waitingCatalog++;
+            return false;
+        }
+
+        if (host.hasSequence && header.sequence < host.sequence) {
+            host.stale++;
+            stats.stale++;
+            return false;
+        }
+        if (!host.hasSequence || header.sequence > host.sequence) {
+            host.hasSequence = true;
+            host.sequence = header.sequence;
+            host.timestamp = header.timestamp;
+            host.chunks.assign((header.sensorCount / ValuesPerDatagram + 64) / 64, 0);
+            host.samples++;
+        }
+
+        size_t word = header.chunk / 64;
+        uint64_t bit = 1ULL << (header.chunk % 64);
+        if (word >= host.chunks.size() || (host.chunks[word] & bit)) {
+            host.duplicates++;
+            stats.duplicates++;
+            return false;
+        }
+        host.chunks[word] |= bit;
+
+        std::memcpy(host.values.data() + header.first, item.payload, header.count * sizeof(float));
+        MarkDirty(index);
+        return true;
+    }
+
+    FleetCollector::FleetCollector() : impl(new Impl()) {}
+
+    FleetCollector::~FleetCollector() {
+        Stop();
+        delete impl;
+    }
+
+    std::vector<FleetRule> FleetCollector::DefaultRules() {
+        std::vector<FleetRule> result(4);
+        result[0].name = "MaxTemperature";
+        result[0].hardwareMask = HardwareTypeBit(CpuHardware);
+        result[0].sensorType = TemperatureSensor;
+        result[0].pattern = "Core Max";
+        result[0].reduce = FleetMax;
+        result[0].byGroup = true;
+
+        result[1].name = "PackagePower";
+        result[1].hardwareMask = HardwareTypeBit(CpuHardware);
+        result[1].sensorType = PowerSensor;
+        result[1].pattern = "CPU Package";
+        result[1].reduce = FleetSum;
+        result[1].byGroup = true;
+
+        result[2] = result[1];
+        result[2].byGroup = false;
+
+        result[3] = result[2];
+        result[3].name = "CoresPower";
+        result[3].pattern = "CPU Cores";
+        return result;
+    }
+
+    void FleetCollector::SetRules(const std::vector<FleetRule>& rules) {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->rules = rules;
+        impl->Rebuild();
+    }
+
+    void FleetCollector::AddRule(const FleetRule& rule) {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->rules.push_back(rule);
+        impl->Rebuild();
+    }
+
+    void FleetCollector::SetHostTimeout(int64_t nanoseconds) {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->hostTimeout = nanoseconds > 0 ? nanoseconds : DefaultHostTimeout;
+    }
+
+    size_t FleetCollector::Ingest(const FleetDatagram* datagrams, size_t count, int64_t now) {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        Impl& state = *impl;
+        int64_t start = DiagnosticsClock();
+        state.stats.datagrams += static_cast<long long>(count);
+        state.stats.batches++;
+
+        // 驗證後依 (主機, 取樣序號, 目錄在前, 編號) 排序：同一台主機的封包連續處理，亂序到達的舊取樣先套用
+        state.items.clear();
+        for (size_t i = 0; i < count; ++i) {
+            const unsigned char* data = static_cast<const unsigned char*>(datagrams[i].data);
+            size_t size = datagrams[i].size;
+
+            Impl::Item item;
+            if (size < sizeof(HwiFleetHeader)) {
+                state.stats.invalid++;
+                continue;
+            }
+            std::memcpy(&item.header, data, sizeof(HwiFleetHeader));
+            item.payload = data + sizeof(HwiFleetHeader);
+            item.payloadSize = size - sizeof(HwiFleetHeader);
+
+            const HwiFleetHeader& header = item.header;
+            size_t entrySize = header.kind == HWI_FLEET_VALUES ? sizeof(float) : sizeof(HwiFleetSensor);
+            size_t prefix = header.kind == HWI_FLEET_CATALOG ? sizeof(HwiFleetHost) : 0;
+            bool valid = header.magic == HWI_FLEET_MAGIC && header.version == HWI_FLEET_VERSION &&
+                (header.kind == HWI_FLEET_VALUES || header.kind == HWI_FLEET_CATALOG) &&
+                header.sensorCount <= MaxSensors && header.first <= header.sensorCount && header.count <= header.sensorCount - header.first &&
+                item.payloadSize >= prefix + header.count * entrySize;
+            if (!valid) {
+                state.stats.invalid++;
+                continue;
+            }
+            state.items.push_back(item);
+        }
+
+        std::sort(state.items.begin(), state.items.end(), [](const Impl::Item& a, const Impl::Item& b) {
+            if (a.header.hostId != b.header.hostId) return a.header.hostId < b.header.hostId;
+            if (a.header.sequence != b.header.sequence) return a.header.sequence < b.header.sequence;
+            if (a.header.kind != b.header.kind) return a.header.kind > b.header.kind;
+            return a.header.chunk < b.header.chunk;
+        });
+
+        size_t applied = 0;
+        size_t index = SIZE_MAX;
+        uint64_t current = 0;
+        for (const Impl::Item& item : state.items) {
+            if (index == SIZE_MAX || item.header.hostId != current) {
+                current = item.header.hostId;
+                index = state.FindHost(current);
+            }
+
+            Impl::Host& host = state.hosts[index];
+            if (host.instance != item.header.instance) {
+                // 送出端重新啟動：序號與目錄版本重新開始
+                state.ClearHost(index);
+                host.instance = item.header.instance;
+                host.catalogReady = false;
+                host.pendingActive = false;
+                host.hasSequence = false;
+                host.terms.clear();
+                host.termSlots.clear();
+            }
+            host.lastSeen = now;
+            if (!host.active) {
+                host.active = true;  // 新的或逾時後恢復的主機
+                state.MarkDirty(index);
+            }
+
+            bool used = item.header.kind == HWI_FLEET_CATALOG ? state.ApplyCatalog(index, item) : state.ApplyValues(index, item);
+            if (used) applied++;
+        }
+
+        // 每台主機在一批封包中只重新計算一次
+        for (size_t host : state.dirtyHosts) {
+            if (state.hosts[host].dirty) state.Recompute(host);
+        }
+        state.dirtyHosts.clear();
+        if (now - state.lastExpire >= ExpireInterval) state.Expire(now);
+
+        state.stats.ingestNanoseconds += DiagnosticsClock() - start;
+        return applied;
+    }
+
+    void FleetCollector::Impl::Receive(FleetCollector& owner) {
+        std::vector<unsigned char> buffers(BatchSize * HWI_FLEET_MAX_DATAGRAM);
+        FleetDatagram datagrams[BatchSize];
+#ifdef __linux__
+        mmsghdr messages[BatchSize];
+        iovec vectors[BatchSize];
+        for (size_t i = 0; i < BatchSize; ++i) {
+            vectors[i].iov_base = buffers.data() + i * HWI_FLEET_MAX_DATAGRAM;
+            vectors[i].iov_len = HWI_FLEET_MAX_DATAGRAM;
+        }
+#endif
+
+        while (!stopping.load()) {
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(socket, &readable);
+            timeval timeout = { 0, ReceivePollMs * 1000 };
+            if (select(static_cast<int>(socket + 1), &readable, nullptr, nullptr, &timeout) <= 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                Expire(DiagnosticsClock());  // 所有主機都停止送出時仍然移出逾時的主機
+                continue;
+            }
+
+            // 讀到沒有封包為止，每次系統呼叫最多 BatchSize 個
+            for (;;) {
+                size_t count = 0;
+#ifdef __linux__
+                std::memset(messages, 0, sizeof(messages));
+                for (size_t i = 0; i < BatchSize; ++i) {
+                    messages[i].msg_hdr.msg_iov = &vectors[i];
+                    messages[i].msg_hdr.msg_iovlen = 1;
+                }
+                int received = recvmmsg(socket, messages, BatchSize, MSG_DONTWAIT, nullptr);
+                if (received <= 0) break;
+                for (int i = 0; i < received; ++i) {
+                    bool truncated = (messages[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+                    datagrams[count++] = { vectors[i].iov_base, truncated ? 0 : messages[i].msg_len };
+                }
+#else
+                while (count < BatchSize) {
+                    char* buffer = reinterpret_cast<char*>(buffers.data() + count * HWI_FLEET_MAX_DATAGRAM);
+                    int received = recv(socket, buffer, HWI_FLEET_MAX_DATAGRAM, 0);
+                    if (received < 0) break;  // 沒有封包 (非阻塞) 或過長的封包 (Windows 為 WSAEMSGSIZE)
+                    datagrams[count++] = { buffer, static_cast<size_t>(received) };
+                }
+                if (count == 0) break;
+#endif
+                owner.Ingest(datagrams, count, DiagnosticsClock());
+                if (count < BatchSize) break;
+            }
+        }
+    }
+
+    bool FleetCollector::Start(const std::string& endpoint) {
+        Stop();
+
+        Endpoint local;
+        if (!ParseEndpoint(endpoint, local)) return false;
+
+#ifdef _WIN32
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0) return false;
+#else
+        if (local.family == AF_UNIX) unlink(local.path.c_str());  // 上一次沒有正常結束留下的檔案
+#endif
+        Socket socket = ::socket(local.family, SOCK_DGRAM, 0);
+        bool bound = socket != InvalidSocket && SetNonBlocking(socket);
+        if (bound) {
+            int size = ReceiveBufferBytes;
+            setsockopt(socket, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&size), sizeof(size));
+            bound = bind(socket, reinterpret_cast<const sockaddr*>(&local.address), local.length) == 0;
+        }
+        if (!bound) {
+            if (socket != InvalidSocket) CloseSocket(socket);
+#ifdef _WIN32
+            WSACleanup();
+#endif
+            return false;
+        }
+
+        impl->port = 0;
+        if (local.family == AF_INET) {
+            sockaddr_in address = {};
+            socklen_t length = sizeof(address);
+            getsockname(socket, reinterpret_cast<sockaddr*>(&address), &length);
+            impl->port = ntohs(address.sin_port);
+        }
+
+        impl->socket = socket;
+        impl->unixPath = local.path;
+        impl->stopping.store(false);
+        impl->thread = std::thread([this] { impl->Receive(*this); });
+        return true;
+    }
+
+    void FleetCollector::Stop() {
+        if (impl->socket == InvalidSocket) return;
+
+        impl->stopping.store(true);
+        impl->thread.join();
+        CloseSocket(impl->socket);
+        impl->socket = InvalidSocket;
+        impl->port = 0;
+#ifdef _WIN32
+        WSACleanup();
+#else
+        if (!impl->unixPath.empty()) unlink(impl->unixPath.c_str());
+#endif
+        impl->unixPath.clear();
+    }
+
+    int FleetCollector::Port() const {
+        return impl->port;
+    }
+
+    void FleetCollector::Aggregates(std::vector<FleetAggregateValue>& result) {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->Expire(DiagnosticsClock());
+
+        result.clear();
+        for (Impl::Aggregate& aggregate : impl->aggregates) {
+            const FleetRule& rule = impl->rules[aggregate.rule];
+            result.push_back({ rule.name, aggregate.group, rule.reduce, impl->Value(aggregate), aggregate.hosts });
+        }
+    }
+
+    void FleetCollector::Hosts(std::vector<FleetHostInfo>& result) {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        int64_t now = DiagnosticsClock();
+        impl->Expire(now);
+
+        result.clear();
+        for (const Impl::Host& host : impl->hosts) {
+            FleetHostInfo info;
+            info.name = host.name;
+            info.group = host.group;
+            info.hostId = host.hostId;
+            info.sequence = host.sequence;
+            info.timestamp = host.timestamp;
+            info.ageMilliseconds = (now - host.lastSeen) / 1000000;
+            info.sensorCount = static_cast<uint32_t>(host.sensors.size());
+            info.active = host.active;
+            info.samples = host.samples;
+            info.duplicates = host.duplicates;
+            info.stale = host.stale;
+            result.push_back(info);
+        }
+    }
+
+    FleetCollectorStats FleetCollector::Stats() {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        FleetCollectorStats stats = impl->stats;
+        stats.hosts = impl->hosts.size();
+        stats.activeHosts = 0;
+        for (const Impl::Host& host : impl->hosts) {
+            if (host.active) stats.activeHosts++;
+        }
+        stats.aggregates = impl->aggregates.size();
+        return stats;
+    }
+}
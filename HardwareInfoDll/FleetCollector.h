@@ -0,0 +1,145 @@
+﻿#pragma once
+
+// 集中收集：每台主機的送出端把每次取樣依槽位切成小封包 (HwiFleetHeader)，以 UDP 或 Unix datagram 送到收集端；
+// 收集端一次接收一批封包 (Linux 使用 recvmmsg)，依主機與取樣序號排序後去除重複與過期的封包，
+// 每台主機在一批封包中只重新計算一次，再以欄式陣列 (每個彙總一欄，依主機排列) 增量維護跨主機的彙總
+// (例如各機櫃的最高溫度、所有主機的總功率)。目錄 (感測器名稱與類型) 在改變時與固定間隔重送。
+// 端點為 "udp://位址:連接埠" (或 "位址:連接埠"，IPv4) 與 "unix:路徑" (Windows 不支援 Unix datagram)。
+// 純原生程式碼 (Windows 使用 Winsock，其他平台使用 BSD socket)，由 HardwareInfo、C 介面與效能測試共用。
+
+#include "SnapshotLayout.h"
+#include "HardwareModel.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace HardwareInfoDll {
+    enum FleetReduce {
+        FleetMax,
+        FleetMin,
+        FleetSum,
+        FleetAverage
+    };
+
+    const char* FleetReduceName(int reduce);  // "Max"、"Min"、"Sum"、"Average"
+
+    // 彙總規則：每台主機先以 reduce 彙總符合的感測器，再以相同的 reduce 彙總所有 (或同一分組的) 主機
+    struct FleetRule {
+        std::string name;  // 結果的名稱 (最多 HWI_FLEET_NAME_LENGTH - 1 個位元組)
+        uint32_t hardwareMask = 0xFFFFFFFF;  // SourceHardwareType 的位元遮罩
+        int sensorType = -1;  // SourceSensorType (-1 表示所有類型)
+        std::string pattern = "*";  // 感測器名稱 ('*'、'?')，以 '/' 開頭時比對 Identifier
+        int reduce = FleetMax;
+        bool byGroup = false;  // 依主機的分組 (例如機櫃) 各自彙總
+    };
+
+    struct FleetAggregateValue {
+        std::string rule;
+        std::string group;  // byGroup 為 false 時為空字串
+        int reduce;
+        double value;  // NaN 表示沒有主機有數值
+        uint32_t hosts;  // 有數值的主機數
+    };
+
+    struct FleetHostInfo {
+        std::string name;
+        std::string group;
+        uint64_t hostId;
+        uint64_t sequence;  // 最新套用的取樣序號
+        int64_t timestamp;  // 最新取樣的時間 (送出端的 Unix epoch 微秒)
+        int64_t ageMilliseconds;  // 距離最後一個封包的時間
+        uint32_t sensorCount;
+        bool active;  // 沒有逾時 (逾時的主機不計入彙總)
+        long long samples;
+        long long duplicates;
+        long long stale;  // 晚於較新取樣到達的封包
+    };
+
+    struct FleetCollectorStats {
+        long long datagrams = 0;  // 接收的封包數
+        long long batches = 0;  // Ingest 次數 (一次系統呼叫接收的封包為一批)
+        long long invalid = 0;  // 格式錯誤或不相容的封包
+        long long duplicates = 0;
+        long long stale = 0;
+        long long waitingCatalog = 0;  // 目錄尚未完整而略過的數值封包
+        long long expired = 0;  // 逾時而移出彙總的次數
+        long long ingestNanoseconds = 0;  // Ingest 的累計耗時
+        size_t hosts = 0;
+        size_t activeHosts = 0;
+        size_t aggregates = 0;
+    };
+
+    struct FleetSenderStats {  // Open 之後的累計
+        long long samples = 0;  // 送出的取樣數 (未達間隔而略過的不計)
+        long long datagrams = 0;
+        long long bytes = 0;
+        long long catalogs = 0;  // 送出目錄的次數
+        long long errors = 0;  // 送出失敗的封包 (例如緩衝區已滿)
+    };
+
+    // 一個收到的封包 (Ingest 的輸入)
+    struct FleetDatagram {
+        const void* data;
+        size_t size;
+    };
+
+    // 送出端 (只由發布 frame 的執行緒呼叫 Send)
+    class FleetSender {
+        struct Impl;
+        Impl* impl;
+
+        public:
+        FleetSender();
+        ~FleetSender();
+
+        FleetSender(const FleetSender&) = delete;
+        FleetSender& operator=(const FleetSender&) = delete;
+
+        // 開啟 datagram socket (不等待收集端)，interval 與 catalogInterval 為微秒；端點不正確時回傳 false
+        bool Open(const std::string& endpoint, const std::string& hostName, const std::string& group, int64_t interval, int64_t catalogInterval);
+        void Close();
+
+        bool IsOpen() const;
+
+        // 送出一次取樣 (距離上一次未達 interval 時略過)，目錄版本改變或超過 catalogInterval 時先送出目錄。
+        // UDP 以非阻塞方式送出 (Unix datagram 在佇列已滿時最多等待 5 毫秒)，回傳送出與失敗的封包數
+        size_t Send(const std::vector<SensorSlot>& slots, unsigned int catalogVersion, uint64_t sequence, int64_t timestamp, const float* values, size_t count);
+
+        FleetSenderStats Stats() const;
+    };
+
+    class FleetCollector {
+        struct Impl;
+        Impl* impl;
+
+        public:
+        FleetCollector();
+        ~FleetCollector();
+
+        FleetCollector(const FleetCollector&) = delete;
+        FleetCollector& operator=(const FleetCollector&) = delete;
+
+        // 各分組的最高 CPU 溫度 (Core Max)、各分組與所有主機的 CPU 封裝功率總和、所有主機的 CPU 核心功率總和
+        static std::vector<FleetRule> DefaultRules();
+
+        void SetRules(const std::vector<FleetRule>& rules);  // 替換規則 (所有主機依目前的目錄重新編譯)
+        void AddRule(const FleetRule& rule);
+
+        void SetHostTimeout(int64_t nanoseconds);  // 超過此時間沒有封包的主機移出彙總 (預設 10 秒)
+
+        // 在端點開始接收 (UDP 連接埠為 0 時由系統指定)，失敗時回傳 false
+        bool Start(const std::string& endpoint);
+        void Stop();  // 停止並等待接收執行緒結束
+
+        int Port() const;  // UDP 實際使用的連接埠 (Unix datagram 或尚未開始時為 0)
+
+        // 處理一批封包 (now 為 DiagnosticsClock)，回傳套用的封包數。接收執行緒使用，也可直接餵入 (效能測試)
+        size_t Ingest(const FleetDatagram* datagrams, size_t count, int64_t now);
+
+        void Aggregates(std::vector<FleetAggregateValue>& result);  // 目前的彙總 (先移出逾時的主機)
+        void Hosts(std::vector<FleetHostInfo>& result);
+        FleetCollectorStats Stats();
+    };
+}
@@ -0,0 +1,97 @@
+﻿#pragma once
+
+#include <atomic>
+
+namespace HardwareInfoDll {
+    // 多緩衝區發布：寫入端在沒有讀者的 frame 中填好資料後以原子操作發布，
+    // 讀者固定 (pin) 最新的 frame 直到釋放，雙方都不需要鎖。
+    // 寫入端只能有一個；所有 frame 都被讀者占用時，本次發布會被略過而不是等待。
+    template <typename TFrame, int FrameCount = 4>
+    class FramePublisher {
+        TFrame frames[FrameCount];
+        std::atomic<int> latest{ -1 };  // 最新發布的 frame (-1 表示尚未發布)
+        std::atomic<int> readers[FrameCount];  // 每個 frame 的讀者數量
+        std::atomic<long long> published{ 0 };  // 已發布次數
+        std::atomic<long long> dropped{ 0 };  // 因為沒有可用 frame 而略過的次數
+
+        public:
+        FramePublisher() {
+            for (auto& count : readers) count.store(0);
+        }
+
+        FramePublisher(const FramePublisher&) = delete;
+        FramePublisher& operator=(const FramePublisher&) = delete;
+
+        // 寫入端：取得一個不是最新且沒有讀者的 frame，沒有時回傳 nullptr
+        TFrame* BeginWrite(int& index) {
+            int current = latest.load();
+            for (int i = 0; i < FrameCount; ++i) {
+                if (i != current && readers[i].load() == 0) {
+                    index = i;
+                    return &frames[i];
+                }
+            }
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        // 寫入端：發布 BeginWrite 取得的 frame
+        void Publish(int index) {
+            latest.store(index);
+            published.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // 讀取端：固定最新的 frame，尚未發布時回傳 nullptr
+        const TFrame* Acquire(int& index) {
+            for (;;) {
+                int current = latest.load();
+                if (current < 0) return nullptr;
+
+                readers[current].fetch_add(1);
+
+                // 增加讀者數量後 frame 仍是最新的，寫入端就不會再選到它
+                if (latest.load() == current) {
+                    index = current;
+                    return &frames[current];
+                }
+                readers[current].fetch_sub(1);
+            }
+        }
+
+        void Release(int index) {
+            readers[index].fetch_sub(1);
+        }
+
+        long long Published() const {
+            return published.load(std::memory_order_relaxed);
+        }
+
+        long long Dropped() const {
+            return dropped.load(std::memory_order_relaxed);
+        }
+    };
+
+    // 在作用域內固定最新的 frame
+    template <typename TFrame, int FrameCount = 4>
+    class FrameLease {
+        FramePublisher<TFrame, FrameCount>& publisher;
+        int index = -1;
+        const TFrame* frame;
+
+        public:
+        explicit FrameLease(FramePublisher<TFrame, FrameCount>& source) : publisher(source) {
+            frame = publisher.Acquire(index);
+        }
+
+        ~FrameLease() {
+            if (frame) publisher.Release(index);
+        }
+
+        FrameLease(const FrameLease&) = delete;
+        FrameLease& operator=(const FrameLease&) = delete;
+
+        const TFrame* Get() const {
+            return frame;
+        }
+    };
+}
@@ -0,0 +1,158 @@
+﻿#include "pch.h"
+
+#include "HardwareInfoDll.h"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <msclr\marshal_cppstd.h>
+#include <string.h>
+
+using namespace System;
+using namespace System::Threading;
+using json = nlohmann::json;
+
+#define DUMP_JSON_INDENT -1  // -1 表示不使用縮排
+
+namespace HardwareInfoDll {
+    int HardwareInfo::AddAlertRule(HardwareType type, SensorType sensorType, System::String^ sensorPattern, SensorAlertCondition condition, float threshold, float hysteresis, float durationSeconds) {
+        return AddAlert(HardwareTypeBit(static_cast<int>(type)), static_cast<int>(sensorType), sensorPattern, static_cast<int>(condition), threshold, hysteresis, durationSeconds);
+    }
+
+    int HardwareInfo::AddAlertRule(SensorType sensorType, System::String^ sensorPattern, SensorAlertCondition condition, float threshold, float hysteresis, float durationSeconds) {
+        return AddAlert(0xFFFFFFFF, static_cast<int>(sensorType), sensorPattern, static_cast<int>(condition), threshold, hysteresis, durationSeconds);
+    }
+
+    int HardwareInfo::AddAlert(uint32_t hardwareMask, int sensorType, System::String^ sensorPattern, int condition, float threshold, float hysteresis, float durationSeconds) {
+        if (sensorType < -1 || sensorType >= SensorTypeCount) throw gcnew ArgumentOutOfRangeException("sensorType");
+        if (condition < AlertAbove || condition > AlertFalling) throw gcnew ArgumentOutOfRangeException("condition");
+        if (!std::isfinite(threshold)) throw gcnew ArgumentOutOfRangeException("threshold");
+        if (!(hysteresis >= 0.0f) || !std::isfinite(hysteresis)) throw gcnew ArgumentOutOfRangeException("hysteresis");
+        if (!(durationSeconds >= 0.0f) || !std::isfinite(durationSeconds)) throw gcnew ArgumentOutOfRangeException("durationSeconds");
+
+        AlertRule rule;
+        rule.hardwareMask = hardwareMask;
+        rule.sensorType = sensorType;
+        rule.pattern = String::IsNullOrEmpty(sensorPattern) ? "*" : ToUtf8String(sensorPattern);
+        rule.condition = condition;
+        rule.threshold = threshold;
+        rule.hysteresis = hysteresis;
+        rule.duration = durationSeconds;
+        return alerts->Add(rule);  // 下一次發布時編譯
+    }
+
+    bool HardwareInfo::RemoveAlertRule(int ruleId) {
+        return alerts->Remove(ruleId);
+    }
+
+    void HardwareInfo::ClearAlertRules() {
+        alerts->Clear();
+    }
+
+    void HardwareInfo::SetAlertCallback(HwiAlertCallback callback, void* context) {
+        Monitor::Enter(alertLock);
+        try {
+            alertCallback = callback;
+            alertContext = context;
+        }
+        finally {
+            Monitor::Exit(alertLock);
+        }
+    }
+
+    static SensorAlert ToSensorAlert(const AlertEvent& entry) {
+        SensorAlert alert;
+        alert.RuleId = entry.ruleId;
+        alert.Slot = static_cast<int>(entry.slot);
+        alert.Identifier = FromUtf8String(entry.identifier);
+        alert.Firing = entry.firing;
+        alert.Value = entry.value;
+        alert.Timestamp = entry.timestamp;
+        return alert;
+    }
+
+    void HardwareInfo::QueueAlerts() {
+        Monitor::Enter(alertLock);
+        try {
+            alertQueue->insert(alertQueue->end(), alertScratch->begin(), alertScratch->end());
+            Volatile::Write(alertsQueued, 1);
+        }
+        finally {
+            Monitor::Exit(alertLock);
+        }
+        alertScratch->clear();
+    }
+
+    // 與 PublishSnapshot 相同：已有執行緒在送出時留給它在結束後接續，處理函數依事件發生的順序呼叫。
+    // 持有繫結鎖時不送出 (處理函數可能呼叫 Subscribe 或 AddDerivedMetric 而需要寫入鎖)，
+    // 取得讀取鎖或寫入鎖的呼叫端在釋放鎖後再呼叫一次
+    void HardwareInfo::DispatchAlerts() {
+        if (bindingLock->IsReadLockHeld || bindingLock->IsWriteLockHeld) return;
+
+        while (Volatile::Read(alertsQueued) != 0 && Interlocked::CompareExchange(alertDispatching, 1, 0) == 0) {
+            std::vector<AlertEvent> pending;
+            HwiAlertCallback callback;
+            void* context;
+            Monitor::Enter(alertLock);
+            try {
+                pending.swap(*alertQueue);
+                Volatile::Write(alertsQueued, 0);
+                callback = alertCallback;
+                context = alertContext;
+            }
+            finally {
+                Monitor::Exit(alertLock);
+            }
+
+            try {
+                for (const AlertEvent& entry : pending) {
+                    if (callback) {
+                        HwiAlert alert = {};
+                        alert.ruleId = entry.ruleId;
+                        alert.slot = entry.slot;
+                        alert.firing = entry.firing ? 1 : 0;
+                        alert.value = entry.value;
+                        alert.timestamp = entry.timestamp;
+                        strncpy_s(alert.identifier, entry.identifier.c_str(), _TRUNCATE);
+                        callback(&alert, context);
+                    }
+
+                    try {
+                        AlertChanged(ToSensorAlert(entry));
+                    }
+                    catch (Exception^) {
+                        Interlocked::Increment(alertHandlerErrors);  // 不讓處理函數的錯誤中斷取樣
+                    }
+                    Interlocked::Increment(alertsDelivered);
+                }
+            }
+            finally {
+                Interlocked::Exchange(alertDispatching, 0);
+            }
+        }
+    }
+
+    array<SensorAlert>^ HardwareInfo::GetActiveAlerts() {
+        std::vector<AlertEvent> firing;
+        alerts->Firing(firing);
+
+        array<SensorAlert>^ result = gcnew array<SensorAlert>(static_cast<int>(firing.size()));
+        for (int i = 0; i < result->Length; i++) result[i] = ToSensorAlert(firing[i]);
+        return result;
+    }
+
+    System::String^ HardwareInfo::GetAlertStats() {
+        long long evaluations = alerts->Evaluations();
+        long long nanoseconds = alerts->EvaluationNanoseconds();
+        json result = {
+            { "Rules", alerts->RuleCount() },
+            { "Instances", alerts->InstanceCount() },  // 編譯後的 (規則, 感測器) 數
+            { "Evaluations", evaluations },
+            { "AverageEvaluationUs", evaluations > 0 ? nanoseconds / 1000.0 / evaluations : 0.0 },  // 每次發布的評估耗時 (含編譯)
+            { "Delivered", Interlocked::Read(alertsDelivered) },
+            { "HandlerErrors", Interlocked::Read(alertHandlerErrors) }
+        };
+
+        return msclr::interop::marshal_as<System::String^>(result.dump(DUMP_JSON_INDENT));
+    }
+}
@@ -0,0 +1,99 @@
+﻿#include "pch.h"
+
+#include "HardwareInfoDll.h"
+
+#include <algorithm>
+
+using namespace System;
+
+namespace HardwareInfoDll {
+    void HardwareInfo::StartDeltaStream(int capacity) {
+        if (capacity < 1) throw gcnew ArgumentOutOfRangeException("capacity");
+
+        deltaStream->Start(static_cast<size_t>(capacity));
+        PublishSnapshot();  // 第一個批次包含目前所有感測器
+    }
+
+    void HardwareInfo::StopDeltaStream() {
+        deltaStream->Stop();
+    }
+
+    void HardwareInfo::SetDeadband(System::String^ identifierPattern, float absolute, float relative) {
+        if (!(absolute >= 0.0f)) throw gcnew ArgumentOutOfRangeException("absolute");
+        if (!(relative >= 0.0f)) throw gcnew ArgumentOutOfRangeException("relative");
+
+        Deadband deadband;
+        deadband.absolute = absolute;
+        deadband.relative = relative;
+        deltaStream->SetDeadband(identifierPattern != nullptr ? ToUtf8String(identifierPattern) : std::string(), deadband);
+    }
+
+    void HardwareInfo::ClearDeadbands() {
+        deltaStream->ClearDeadbands();
+    }
+
+    array<SensorDeltaBatch>^ HardwareInfo::ReadDeltas(long long afterSequence, int timeoutMilliseconds) {
+        if (afterSequence < 0) throw gcnew ArgumentOutOfRangeException("afterSequence");
+
+        std::vector<DeltaBatch> batches;
+        if (!deltaStream->Read(static_cast<uint64_t>(afterSequence), batches, timeoutMilliseconds)) return nullptr;
+
+        array<SensorDeltaBatch>^ result = gcnew array<SensorDeltaBatch>(static_cast<int>(batches.size()));
+        for (int i = 0; i < result->Length; i++) {
+            const DeltaBatch& batch = batches[i];
+            array<SensorDelta>^ changes = gcnew array<SensorDelta>(static_cast<int>(batch.entries.size()));
+            for (int k = 0; k < changes->Length; k++) {
+                changes[k].Slot = static_cast<int>(batch.entries[k].slot);
+                changes[k].Value = batch.entries[k].value;
+            }
+
+            result[i].Sequence = static_cast<long long>(batch.sequence);
+            result[i].Timestamp = batch.timestamp;
+            result[i].CatalogVersion = static_cast<int>(batch.catalogVersion);
+            result[i].Changes = changes;
+        }
+        return result;
+    }
+
+    int HardwareInfo::CopyDeltas(uint64_t afterSequence, HwiDelta* entries, int capacity, int timeoutMs) {
+        std::vector<DeltaBatch> batches;
+        if (!deltaStream->Read(afterSequence, batches, timeoutMs)) return -1;
+
+        // 只複製完整的批次，呼叫端由最後一個項目的序號繼續讀取
+        int count = 0;
+        for (const DeltaBatch& batch : batches) {
+            int size = static_cast<int>(batch.entries.size());
+            if (count + size > capacity) {
+                if (count == 0) return -size - 1;
+                break;
+            }
+
+            for (const DeltaEntry& entry : batch.entries) {
+                entries[count].sequence = batch.sequence;
+                entries[count].slot = entry.slot;
+                entries[count].value = entry.value;
+                count++;
+            }
+        }
+        return count;
+    }
+
+    int HardwareInfo::CopyDeltaBaseline(float* values, int capacity, uint64_t* sequence) {
+        std::vector<float> baseline;
+        uint64_t current = deltaStream->Baseline(baseline);
+        if (sequence) *sequence = current;
+
+        int count = static_cast<int>(baseline.size());
+        if (values) std::copy_n(baseline.data(), std::min(count, capacity), values);
+        return count;
+    }
+
+    array<float>^ HardwareInfo::GetDeltaBaseline(long long% sequence) {
+        std::vector<float> values;
+        sequence = static_cast<long long>(deltaStream->Baseline(values));
+
+        array<float>^ result = gcnew array<float>(static_cast<int>(values.size()));
+        for (int i = 0; i < result->Length; i++) result[i] = values[i];
+        return result;
+    }
+}
@@ -0,0 +1,52 @@
+﻿#include "pch.h"
+
+#include "HardwareInfoDll.h"
+
+using namespace System;
+
+namespace HardwareInfoDll {
+    void HardwareInfo::AddDerivedMetric(HardwareType type, System::String^ sensorPattern, DerivedMetricKind kind, float parameter, System::String^ label) {
+        if (kind < DerivedMetricKind::Rate || kind > DerivedMetricKind::Throttling) throw gcnew ArgumentOutOfRangeException("kind");
+        if (kind != DerivedMetricKind::Rate && !(parameter > 0.0f)) throw gcnew ArgumentOutOfRangeException("parameter");
+
+        DerivedRule rule;
+        rule.kind = static_cast<int>(kind);
+        rule.hardwareMask = HardwareTypeBit(static_cast<int>(type));
+        rule.pattern = String::IsNullOrEmpty(sensorPattern) ? "*" : ToUtf8String(sensorPattern);
+        rule.parameter = parameter;
+        if (kind == DerivedMetricKind::Throttling) {
+            rule.sensorType = ClockSensor;
+            rule.outputType = FactorSensor;
+        }
+        if (!String::IsNullOrEmpty(label)) rule.label = ToUtf8String(label);
+
+        ChangeDerivedRules(std::vector<DerivedRule>(1, rule), true);
+    }
+
+    void HardwareInfo::ClearDerivedMetrics() {
+        ChangeDerivedRules(std::vector<DerivedRule>(), false);
+    }
+
+    void HardwareInfo::ResetDerivedMetrics() {
+        ChangeDerivedRules(DerivedMetrics::DefaultRules(), false);
+    }
+
+    void HardwareInfo::ChangeDerivedRules(const std::vector<DerivedRule>& rules, bool append) {
+        WaitForStartup();  // 背景開啟的類別完成時需要寫入鎖
+
+        bindingLock->EnterWriteLock();  // 背景取樣的讀取鎖結束後才重新配置槽位
+        try {
+            if (append) {
+                for (const DerivedRule& rule : rules) derived->AddRule(rule);
+            }
+            else {
+                derived->SetRules(rules);
+            }
+            RebindSensors();
+        }
+        finally {
+            bindingLock->ExitWriteLock();
+        }
+        DispatchAlerts();  // 重新繫結時發布所產生的事件，在釋放寫入鎖後送出
+    }
+}
@@ -0,0 +1,127 @@
+﻿#include "pch.h"
+
+#include "HardwareInfoDll.h"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <msclr\marshal_cppstd.h>
+
+using namespace System;
+using namespace LibreHardwareMonitor::Hardware;
+using json = nlohmann::json;
+
+#define DUMP_JSON_INDENT -1  // -1 表示不使用縮排
+
+namespace HardwareInfoDll {
+    // 與 Get*Info 相同的類別名稱，最後一個為沒有對應 Get*Info 的硬體
+    static const char* const categoryNames[InfoCategoryCount + 1] = { "CPU", "GPU", "Memory", "Storage", "Network", "Device", "Other" };
+
+    // 轉換耗時分布為 JSON 格式 (微秒)
+    static json ToJson(const LatencyHistogram& histogram) {
+        return {
+            { "Count", histogram.Count() },
+            { "MeanUs", histogram.Mean() / 1000.0 },
+            { "P50Us", histogram.Percentile(0.50) / 1000.0 },
+            { "P90Us", histogram.Percentile(0.90) / 1000.0 },
+            { "P99Us", histogram.Percentile(0.99) / 1000.0 },
+            { "MaxUs", histogram.Max() / 1000.0 }
+        };
+    }
+
+    void HardwareInfo::EnableDiagnostics(bool enabled) {
+        diagnostics->Enable(enabled);
+    }
+
+    void HardwareInfo::ResetDiagnostics() {
+        bindingLock->EnterReadLock();
+        try {
+            diagnostics->Reset();
+        }
+        finally {
+            bindingLock->ExitReadLock();
+        }
+    }
+
+    // 轉換自我量測為 JSON 格式
+    System::String^ HardwareInfo::GetDiagnostics() {
+        int64_t now = DiagnosticsClock();
+
+        json hardware = json::array();
+        json handlers = json::object();
+        bindingLock->EnterReadLock();  // 背景取樣時避免與重新繫結同時進行
+        try {
+            size_t count = std::min(model->bindings.size(), diagnostics->BindingCount());
+            for (size_t i = 0; i < count; ++i) {
+                const SourceHardware& descriptor = model->boundHardware[i];
+                int64_t lastUpdate = diagnostics->LastUpdate(i);
+                hardware.push_back({
+                    { "Identifier", descriptor.identifier },
+                    { "Name", descriptor.name },
+                    { "HardwareType", msclr::interop::marshal_as<std::string>(static_cast<HardwareType>(descriptor.hardwareType).ToString()) },
+                    { "Update", ToJson(diagnostics->Update(i)) },
+                    { "AgeUs", lastUpdate ? (now - lastUpdate) / 1000 : -1 }  // 距離最後一次更新 (尚未記錄時為 -1)
+                });
+            }
+
+            for (int category = 0; category <= InfoCategoryCount; category++) {
+                LatencyHistogram merged;
+                diagnostics->MergeHandler(*model, category, merged);
+                if (merged.Count()) handlers[categoryNames[category]] = ToJson(merged);
+            }
+        }
+        finally {
+            bindingLock->ExitReadLock();
+        }
+
+        json serializers = json::object();
+        json cacheHits = json::object();
+        const char* serializerNames[] = { "Dom", "Streaming" };
+        for (int kind = 0; kind < 2; kind++) {
+            json categories = json::object();
+            for (int category = 0; category < InfoCategoryCount; category++) {
+                if (diagnostics->Serializer(kind, category).Count()) categories[categoryNames[category]] = ToJson(diagnostics->Serializer(kind, category));
+            }
+            serializers[serializerNames[kind]] = std::move(categories);
+        }
+        for (int category = 0; category < InfoCategoryCount; category++) {
+            cacheHits[categoryNames[category]] = diagnostics->CacheHits(category);
+        }
+
+        // 最新 frame 的年齡 (尚未發布時為 -1)
+        long long frameAge = -1;
+        {
+            FrameLease<HardwareFrame> lease(*frames);
+            if (lease.Get()) {
+                long long published = lease.Get()->Header().timestamp;
+                frameAge = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count() - published;
+            }
+        }
+
+        json result = {
+            { "Enabled", diagnostics->Enabled() },
+            { "PollCount", pollCount },
+            { "FrameAgeUs", frameAge },
+            { "PublishedFrames", frames->Published() },
+            { "DroppedFrames", frames->Dropped() },
+            { "Gpu", {
+                { "Scheduled", diagnostics->GpuScheduledCount() },
+                { "Skipped", diagnostics->GpuSkippedCount() },  // WaitOne(0) 失敗而略過的更新
+                { "Overlapped", diagnostics->GpuOverlappedCount() }  // 排入時前一次更新尚未結束
+            } },
+            { "Hardware", std::move(hardware) },
+            { "Handlers", std::move(handlers) },
+            { "Serializers", std::move(serializers) },
+            { "CacheHits", std::move(cacheHits) },
+            { "Deltas", {
+                { "Sequence", deltaStream->Sequence() },
+                { "Emitted", deltaStream->Emitted() },  // 送出的感測器總數
+                { "Suppressed", deltaStream->Suppressed() }  // 數值改變但在門檻內
+            } },
+            { "Publish", ToJson(diagnostics->Publish()) },
+            { "ReadAge", ToJson(diagnostics->ReadAge()) }
+        };
+
+        return FromUtf8String(result.dump(DUMP_JSON_INDENT));
+    }
+}
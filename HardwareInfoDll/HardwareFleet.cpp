@@ -0,0 +1,190 @@
+﻿#include "pch.h"
+
+#include "HardwareInfoDll.h"
+
+#include <nlohmann/json.hpp>
+#include <msclr\marshal_cppstd.h>
+
+using namespace System;
+using namespace System::Threading;
+using json = nlohmann::json;
+
+#define DUMP_JSON_INDENT -1  // -1 表示不使用縮排
+
+namespace HardwareInfoDll {
+    static const long long CatalogResendMicroseconds = 10000000;  // 目錄每 10 秒重送 (收集端可能晚於送出端啟動)
+
+    // NaN (沒有主機有數值) 輸出為 null
+    static json FleetValue(double value) {
+        return value == value ? json(value) : json(nullptr);
+    }
+
+    bool HardwareInfo::StartFleetSender(System::String^ endpoint, System::String^ hostName, System::String^ group, int intervalMilliseconds) {
+        if (endpoint == nullptr) throw gcnew ArgumentNullException("endpoint");
+        if (intervalMilliseconds < 0) throw gcnew ArgumentOutOfRangeException("intervalMilliseconds");
+
+        FleetSender* sender = new FleetSender();
+        if (!sender->Open(ToUtf8String(endpoint), ToUtf8String(hostName == nullptr ? Environment::MachineName : hostName),
+            group == nullptr ? std::string() : ToUtf8String(group), intervalMilliseconds * 1000LL, CatalogResendMicroseconds)) {
+            delete sender;
+            return false;  // 端點格式不正確或無法建立 socket
+        }
+
+        AcquirePublishing();
+        FleetSender* previous = fleetSender;
+        fleetSender = sender;
+        Interlocked::Exchange(publishing, 0);
+        delete previous;
+
+        PublishSnapshot();
+        return true;
+    }
+
+    void HardwareInfo::StopFleetSender() {
+        AcquirePublishing();
+        FleetSender* sender = fleetSender;
+        fleetSender = nullptr;
+        Interlocked::Exchange(publishing, 0);
+        delete sender;
+    }
+
+    // 轉換送出統計為 JSON 格式 (未送出時為 null)
+    System::String^ HardwareInfo::GetFleetSenderStats() {
+        json result = nullptr;
+
+        AcquirePublishing();  // 避免與 StopFleetSender 同時進行
+        try {
+            if (fleetSender) {
+                FleetSenderStats stats = fleetSender->Stats();
+                result = {
+                    { "Samples", stats.samples },
+                    { "Datagrams", stats.datagrams },
+                    { "Bytes", stats.bytes },
+                    { "Catalogs", stats.catalogs },
+                    { "Errors", stats.errors }
+                };
+            }
+        }
+        finally {
+            Interlocked::Exchange(publishing, 0);
+        }
+
+        return msclr::interop::marshal_as<System::String^>(result.dump(DUMP_JSON_INDENT));
+    }
+
+    HardwareFleetCollector::HardwareFleetCollector(System::String^ endpoint) {
+        if (endpoint == nullptr) throw gcnew ArgumentNullException("endpoint");
+
+        collector = new FleetCollector();
+        if (!collector->Start(ToUtf8String(endpoint))) {
+            delete collector;
+            collector = nullptr;
+            throw gcnew InvalidOperationException("無法在 " + endpoint + " 接收");
+        }
+    }
+
+    HardwareFleetCollector::~HardwareFleetCollector() {
+        this->!HardwareFleetCollector();
+    }
+
+    HardwareFleetCollector::!HardwareFleetCollector() {
+        delete collector;  // 等待接收執行緒結束
+        collector = nullptr;
+    }
+
+    FleetCollector& HardwareFleetCollector::Collector() {
+        if (!collector) throw gcnew ObjectDisposedException("HardwareFleetCollector");
+        return *collector;
+    }
+
+    void HardwareFleetCollector::AddRule(System::String^ name, HardwareType type, SensorType sensorType, System::String^ sensorPattern, FleetReduction reduction, bool byGroup) {
+        if (String::IsNullOrEmpty(name)) throw gcnew ArgumentNullException("name");
+        if (reduction < FleetReduction::Max || reduction > FleetReduction::Average) throw gcnew ArgumentOutOfRangeException("reduction");
+
+        FleetRule rule;
+        rule.name = ToUtf8String(name);
+        rule.hardwareMask = HardwareTypeBit(static_cast<int>(type));
+        rule.sensorType = static_cast<int>(sensorType);
+        rule.pattern = String::IsNullOrEmpty(sensorPattern) ? "*" : ToUtf8String(sensorPattern);
+        rule.reduce = static_cast<int>(reduction);
+        rule.byGroup = byGroup;
+        Collector().AddRule(rule);
+    }
+
+    void HardwareFleetCollector::ClearRules() {
+        Collector().SetRules(std::vector<FleetRule>());
+    }
+
+    void HardwareFleetCollector::SetHostTimeout(int milliseconds) {
+        if (milliseconds <= 0) throw gcnew ArgumentOutOfRangeException("milliseconds");
+        Collector().SetHostTimeout(milliseconds * 1000000LL);
+    }
+
+    int HardwareFleetCollector::GetPort() {
+        return Collector().Port();
+    }
+
+    // 轉換彙總為 JSON 格式
+    System::String^ HardwareFleetCollector::GetAggregates() {
+        std::vector<FleetAggregateValue> aggregates;
+        Collector().Aggregates(aggregates);
+
+        json result = json::array();
+        for (const FleetAggregateValue& aggregate : aggregates) {
+            result.push_back({
+                { "Rule", aggregate.rule },
+                { "Group", aggregate.group },
+                { "Reduction", FleetReduceName(aggregate.reduce) },
+                { "Value", FleetValue(aggregate.value) },
+                { "Hosts", aggregate.hosts }
+            });
+        }
+
+        return msclr::interop::marshal_as<System::String^>(result.dump(DUMP_JSON_INDENT));
+    }
+
+    // 轉換主機狀態為 JSON 格式
+    System::String^ HardwareFleetCollector::GetHosts() {
+        std::vector<FleetHostInfo> hosts;
+        Collector().Hosts(hosts);
+
+        json result = json::array();
+        for (const FleetHostInfo& host : hosts) {
+            result.push_back({
+                { "Name", host.name },
+                { "Group", host.group },
+                { "Active", host.active },
+                { "Sensors", host.sensorCount },
+                { "Sequence", host.sequence },
+                { "Timestamp", host.timestamp },
+                { "AgeMs", host.ageMilliseconds },
+                { "Samples", host.samples },
+                { "Duplicates", host.duplicates },
+                { "Stale", host.stale }
+            });
+        }
+
+        return msclr::interop::marshal_as<System::String^>(result.dump(DUMP_JSON_INDENT));
+    }
+
+    // 轉換接收統計為 JSON 格式
+    System::String^ HardwareFleetCollector::GetStats() {
+        FleetCollectorStats stats = Collector().Stats();
+        json result = {
+            { "Datagrams", stats.datagrams },
+            { "Batches", stats.batches },
+            { "DatagramsPerBatch", stats.batches ? static_cast<double>(stats.datagrams) / stats.batches : 0.0 },
+            { "Invalid", stats.invalid },
+            { "Duplicates", stats.duplicates },
+            { "Stale", stats.stale },
+            { "WaitingCatalog", stats.waitingCatalog },
+            { "Expired", stats.expired },
+            { "AverageIngestNs", stats.datagrams ? static_cast<double>(stats.ingestNanoseconds) / stats.datagrams : 0.0 },  // 每個封包
+            { "Hosts", stats.hosts },
+            { "ActiveHosts", stats.activeHosts },
+            { "Aggregates", stats.aggregates }
+        };
+
+        return msclr::interop::marshal_as<System::String^>(result.dump(DUMP_JSON_INDENT));
+    }
+}
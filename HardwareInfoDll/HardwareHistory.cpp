@@ -0,0 +1,94 @@
+﻿#include "pch.h"
+
+#include "HardwareInfoDll.h"
+
+#include <nlohmann/json.hpp>
+#include <msclr\marshal_cppstd.h>
+
+using namespace System;
+using namespace LibreHardwareMonitor::Hardware;
+using json = nlohmann::json;
+
+#define DUMP_JSON_INDENT -1  // -1 表示不使用縮排
+
+namespace HardwareInfoDll {
+    static const long long MicrosecondsPerSecond = 1000000;
+
+    array<SensorHistoryPoint>^ HardwareInfo::GetHistory(System::String^ sensorId, long long from, long long to, int resolutionSeconds) {
+        if (sensorId == nullptr) throw gcnew ArgumentNullException("sensorId");
+
+        std::string identifier = ToUtf8String(sensorId);  // 目錄中的 Identifier 為 UTF-8
+        int slot = -1;
+        bindingLock->EnterReadLock();  // 背景取樣時避免與重新繫結同時進行
+        try {
+            auto found = slotIndex->find(identifier);
+            if (found != slotIndex->end()) slot = static_cast<int>(found->second);
+        }
+        finally {
+            bindingLock->ExitReadLock();
+        }
+
+        if (slot < 0) return gcnew array<SensorHistoryPoint>(0);
+        return GetHistory(slot, from, to, resolutionSeconds);
+    }
+
+    array<SensorHistoryPoint>^ HardwareInfo::GetHistory(int slot, long long from, long long to, int resolutionSeconds) {
+        if (slot < 0) return gcnew array<SensorHistoryPoint>(0);
+
+        std::vector<int64_t> timestamps;
+        std::vector<HistoryPoint> points;
+        history->Query(static_cast<size_t>(slot), from, to, resolutionSeconds * MicrosecondsPerSecond, timestamps, points);
+
+        array<SensorHistoryPoint>^ result = gcnew array<SensorHistoryPoint>(static_cast<int>(points.size()));
+        for (int i = 0; i < result->Length; i++) {
+            const HistoryPoint& point = points[i];
+            result[i].Timestamp = timestamps[i];
+            result[i].Min = point.min;
+            result[i].Max = point.max;
+            result[i].Average = point.average;
+            result[i].Last = point.last;
+            result[i].Count = static_cast<int>(point.count);
+        }
+        return result;
+    }
+
+    void HardwareInfo::ConfigureHistory(array<int>^ resolutionSeconds, array<int>^ capacities, int maxSensors) {
+        if (resolutionSeconds == nullptr) throw gcnew ArgumentNullException("resolutionSeconds");
+        if (capacities == nullptr) throw gcnew ArgumentNullException("capacities");
+        if (resolutionSeconds->Length != capacities->Length)
+            throw gcnew ArgumentException("resolutionSeconds 與 capacities 的長度必須相同");
+        if (maxSensors < 0) throw gcnew ArgumentOutOfRangeException("maxSensors");
+
+        std::vector<HistoryLevel> levels;
+        for (int i = 0; i < resolutionSeconds->Length; i++) {
+            if (resolutionSeconds[i] < 0 || capacities[i] <= 0) throw gcnew ArgumentOutOfRangeException("capacities");
+
+            HistoryLevel level;
+            level.resolution = resolutionSeconds[i] * MicrosecondsPerSecond;
+            level.capacity = static_cast<size_t>(capacities[i]);
+            levels.push_back(level);
+        }
+        history->Configure(levels, static_cast<size_t>(maxSensors));
+    }
+
+    // 轉換歷史設定為 JSON 格式
+    System::String^ HardwareInfo::GetHistoryInfo() {
+        json levels = json::array();
+        for (const HistoryLevel& level : history->Levels()) {
+            levels.push_back({
+                { "ResolutionSeconds", level.resolution / MicrosecondsPerSecond },
+                { "Capacity", level.capacity }
+            });
+        }
+
+        json result = {
+            { "Levels", std::move(levels) },
+            { "Sensors", history->SensorCount() },
+            { "MaxSensors", history->MaxSensors() },
+            { "BytesPerSensor", history->BytesPerSensor() },
+            { "MemoryBytes", history->MemoryBytes() }
+        };
+
+        return msclr::interop::marshal_as<System::String^>(result.dump(DUMP_JSON_INDENT));
+    }
+}
@@ -0,0 +1,432 @@
+﻿#include "pch.h"
+
+#define HWI_EXPORTS
+#include "HardwareInfoApi.h"
+#include "HardwareInfoDll.h"
+
+#include <vcclr.h>
+#include <algorithm>
+#include <stdint.h>
+#include <string.h>
+
+using namespace HardwareInfoDll;
+
+// 原生呼叫端持有的控制代碼
+struct HwiHandle {
+    gcroot<HardwareInfo^> info;
+};
+
+struct HwiSharedReader {
+    SharedSnapshotReader reader;
+};
+
+struct HwiCollector {
+    FleetCollector collector;
+    std::vector<FleetAggregateValue> aggregates;  // hwi_collector_read 的暫存
+};
+
+extern "C" {
+    HWI_API HwiHandle* hwi_open(void) {
+        try {
+            HwiHandle* handle = new HwiHandle();
+            handle->info = gcnew HardwareInfo();
+            return handle;
+        }
+        catch (System::Exception^) {
+            return nullptr;
+        }
+    }
+
+    HWI_API void hwi_close(HwiHandle* handle) {
+        if (!handle) return;
+
+        try {
+            HardwareInfo^ info = handle->info;
+            delete info;  // 呼叫 ~HardwareInfo 關閉 Computer
+        }
+        catch (System::Exception^) {
+            // 關閉失敗時仍釋放控制代碼，受控例外不能離開 C 介面
+        }
+        delete handle;
+    }
+
+    HWI_API HwiHandle* hwi_open_background(void) {
+        try {
+            HwiHandle* handle = new HwiHandle();
+            handle->info = HardwareInfo::OpenInBackground();
+            return handle;
+        }
+        catch (System::Exception^) {
+            return nullptr;
+        }
+    }
+
+    HWI_API int hwi_wait_ready(HwiHandle* handle, int hardwareType, int timeoutMs) {
+        if (!handle || hardwareType < -1 || hardwareType > BatteryHardware || timeoutMs < -1) return -1;
+
+        try {
+            System::Threading::Tasks::Task^ ready = hardwareType < 0 ? handle->info->WhenReady() : handle->info->WhenReady(static_cast<HardwareType>(hardwareType));
+            return ready->Wait(timeoutMs) ? 1 : 0;
+        }
+        catch (System::Exception^) {  // 開啟失敗 (AggregateException) 或 HardwareInfo 已結束
+            return -1;
+        }
+    }
+
+    HWI_API HwiHandle* hwi_open_on_demand(void) {
+        try {
+            HwiHandle* handle = new HwiHandle();
+            handle->info = HardwareInfo::CreateOnDemand();
+            return handle;
+        }
+        catch (System::Exception^) {
+            return nullptr;
+        }
+    }
+
+    HWI_API int hwi_subscribe(HwiHandle* handle, int hardwareType, const char* pattern) {
+        if (!handle || hardwareType < 0 || hardwareType > BatteryHardware) return -1;
+
+        try {
+            System::String^ managedPattern = pattern ? gcnew System::String(reinterpret_cast<signed char*>(const_cast<char*>(pattern)), 0, static_cast<int>(strlen(pattern)), System::Text::Encoding::UTF8) : nullptr;
+            return handle->info->AddSubscription(hardwareType, managedPattern);
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API int hwi_unsubscribe(HwiHandle* handle, int subscription) {
+        if (!handle) return -1;
+
+        try {
+            handle->info->Unsubscribe(subscription);
+            return 0;
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API int hwi_sample(HwiHandle* handle) {
+        if (!handle) return -1;
+
+        try {
+            handle->info->SaveAllHardware();
+            return 0;
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API uint32_t hwi_snapshot_size(HwiHandle* handle) {
+        if (!handle) return 0;
+
+        try {
+            return static_cast<uint32_t>(handle->info->GetSnapshotSize());
+        }
+        catch (System::Exception^) {
+            return 0;
+        }
+    }
+
+    HWI_API int32_t hwi_copy_snapshot(HwiHandle* handle, void* buffer, uint32_t size) {
+        if (!handle || !buffer) return -1;
+
+        try {
+            return handle->info->CopySnapshot(System::IntPtr(buffer), static_cast<int>(std::min<uint32_t>(size, INT32_MAX)));
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API uint32_t hwi_catalog_version(HwiHandle* handle) {
+        if (!handle) return 0;
+
+        try {
+            return static_cast<uint32_t>(handle->info->GetCatalogVersion());
+        }
+        catch (System::Exception^) {
+            return 0;
+        }
+    }
+
+    HWI_API int32_t hwi_copy_catalog(HwiHandle* handle, HwiCatalogEntry* entries, uint32_t capacity) {
+        if (!handle || (!entries && capacity)) return -1;
+
+        try {
+            return handle->info->CopyCatalog(entries, static_cast<int>(std::min<uint32_t>(capacity, INT32_MAX)));
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API int hwi_publish_shared(HwiHandle* handle, const char* name, uint32_t capacity) {
+        if (!handle || !name || capacity == 0) return -1;
+
+        try {
+            System::String^ managedName = gcnew System::String(reinterpret_cast<signed char*>(const_cast<char*>(name)), 0, static_cast<int>(strlen(name)), System::Text::Encoding::UTF8);
+            return handle->info->StartSharedPublisher(managedName, static_cast<int>(capacity)) ? 0 : -1;
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API int hwi_serve_metrics(HwiHandle* handle, const char* address, int port) {
+        if (!handle || port < 0 || port > 65535) return -1;
+
+        try {
+            System::String^ managedAddress = address ? gcnew System::String(reinterpret_cast<signed char*>(const_cast<char*>(address)), 0, static_cast<int>(strlen(address)), System::Text::Encoding::UTF8) : "127.0.0.1";
+            if (!handle->info->StartMetricsServer(managedAddress, port)) return -1;
+            return handle->info->GetMetricsPort();
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API int hwi_start_deltas(HwiHandle* handle, uint32_t capacity) {
+        if (!handle || capacity == 0 || capacity > INT32_MAX) return -1;
+
+        try {
+            handle->info->StartDeltaStream(static_cast<int>(capacity));
+            return 0;
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API int hwi_set_deadband(HwiHandle* handle, const char* pattern, float absolute, float relative) {
+        if (!handle || !(absolute >= 0.0f) || !(relative >= 0.0f)) return -1;
+
+        try {
+            System::String^ managedPattern = pattern ? gcnew System::String(reinterpret_cast<signed char*>(const_cast<char*>(pattern)), 0, static_cast<int>(strlen(pattern)), System::Text::Encoding::UTF8) : nullptr;
+            handle->info->SetDeadband(managedPattern, absolute, relative);
+            return 0;
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API int32_t hwi_read_deltas(HwiHandle* handle, uint64_t afterSequence, HwiDelta* entries, uint32_t capacity, int timeoutMs) {
+        if (!handle || (!entries && capacity)) return -1;
+
+        try {
+            return handle->info->CopyDeltas(afterSequence, entries, static_cast<int>(std::min<uint32_t>(capacity, INT32_MAX)), timeoutMs);
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API int32_t hwi_delta_baseline(HwiHandle* handle, float* values, uint32_t capacity, uint64_t* sequence) {
+        if (!handle) return -1;
+
+        try {
+            return handle->info->CopyDeltaBaseline(values, static_cast<int>(std::min<uint32_t>(capacity, INT32_MAX)), sequence);
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API int hwi_add_derived(HwiHandle* handle, int hardwareType, const char* pattern, int kind, float parameter, const char* label) {
+        if (!handle || hardwareType < 0 || hardwareType > BatteryHardware) return -1;
+
+        try {
+            System::String^ managedPattern = pattern ? gcnew System::String(reinterpret_cast<signed char*>(const_cast<char*>(pattern)), 0, static_cast<int>(strlen(pattern)), System::Text::Encoding::UTF8) : nullptr;
+            System::String^ managedLabel = label ? gcnew System::String(reinterpret_cast<signed char*>(const_cast<char*>(label)), 0, static_cast<int>(strlen(label)), System::Text::Encoding::UTF8) : nullptr;
+            handle->info->AddDerivedMetric(static_cast<HardwareType>(hardwareType), managedPattern, static_cast<DerivedMetricKind>(kind), parameter, managedLabel);
+            return 0;
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API int hwi_add_alert(HwiHandle* handle, int hardwareType, int sensorType, const char* pattern, int condition, float threshold, float hysteresis, float durationSeconds) {
+        if (!handle || hardwareType < -1 || hardwareType > BatteryHardware) return -1;
+
+        try {
+            System::String^ managedPattern = pattern ? gcnew System::String(reinterpret_cast<signed char*>(const_cast<char*>(pattern)), 0, static_cast<int>(strlen(pattern)), System::Text::Encoding::UTF8) : nullptr;
+            return handle->info->AddAlert(hardwareType < 0 ? 0xFFFFFFFF : HardwareTypeBit(hardwareType), sensorType, managedPattern, condition, threshold, hysteresis, durationSeconds);
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API int hwi_remove_alert(HwiHandle* handle, int rule) {
+        if (!handle) return -1;
+
+        try {
+            return handle->info->RemoveAlertRule(rule) ? 0 : -1;
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API void hwi_set_alert_callback(HwiHandle* handle, HwiAlertCallback callback, void* context) {
+        if (!handle) return;
+
+        try {
+            handle->info->SetAlertCallback(callback, context);
+        }
+        catch (System::Exception^) {
+            // 受控例外不能離開 C 介面
+        }
+    }
+
+    HWI_API int hwi_start_series(HwiHandle* handle, const char* directory, int intervalMs) {
+        if (!handle || !directory || intervalMs < 0) return -1;
+
+        try {
+            System::String^ managedDirectory = gcnew System::String(reinterpret_cast<signed char*>(const_cast<char*>(directory)), 0, static_cast<int>(strlen(directory)), System::Text::Encoding::UTF8);
+            return handle->info->StartSeriesRecording(managedDirectory, intervalMs) ? 0 : -1;
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API void hwi_stop_series(HwiHandle* handle) {
+        if (!handle) return;
+
+        try {
+            handle->info->StopSeriesRecording();
+        }
+        catch (System::Exception^) {
+            // 受控例外不能離開 C 介面
+        }
+    }
+
+    HWI_API int hwi_fleet_send(HwiHandle* handle, const char* endpoint, const char* hostName, const char* group, int intervalMs) {
+        if (!handle || !endpoint || intervalMs < 0) return -1;
+
+        try {
+            System::String^ managedHost = hostName ? gcnew System::String(reinterpret_cast<signed char*>(const_cast<char*>(hostName)), 0, static_cast<int>(strlen(hostName)), System::Text::Encoding::UTF8) : nullptr;
+            System::String^ managedGroup = group ? gcnew System::String(reinterpret_cast<signed char*>(const_cast<char*>(group)), 0, static_cast<int>(strlen(group)), System::Text::Encoding::UTF8) : nullptr;
+            System::String^ managedEndpoint = gcnew System::String(reinterpret_cast<signed char*>(const_cast<char*>(endpoint)), 0, static_cast<int>(strlen(endpoint)), System::Text::Encoding::UTF8);
+            return handle->info->StartFleetSender(managedEndpoint, managedHost, managedGroup, intervalMs) ? 0 : -1;
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API void hwi_fleet_stop(HwiHandle* handle) {
+        if (!handle) return;
+
+        try {
+            handle->info->StopFleetSender();
+        }
+        catch (System::Exception^) {
+            // 受控例外不能離開 C 介面
+        }
+    }
+
+    HWI_API HwiCollector* hwi_collector_open(const char* endpoint) {
+        if (!endpoint) return nullptr;
+
+        HwiCollector* collector = nullptr;
+        try {
+            collector = new HwiCollector();
+            if (collector->collector.Start(endpoint)) return collector;
+        }
+        catch (System::Exception^) {
+            // 原生例外 (例如無法建立接收執行緒) 在 /clr 程式碼中以 SEHException 攔截
+        }
+        delete collector;
+        return nullptr;
+    }
+
+    HWI_API void hwi_collector_close(HwiCollector* collector) {
+        delete collector;  // 等待接收執行緒結束
+    }
+
+    HWI_API int hwi_collector_add_rule(HwiCollector* collector, const char* name, int hardwareType, int sensorType, const char* pattern, int reduce, int byGroup) {
+        if (!collector || !name || !*name || reduce < FleetMax || reduce > FleetAverage) return -1;
+
+        try {
+            FleetRule rule;
+            rule.name = name;
+            rule.hardwareMask = hardwareType < 0 ? 0xFFFFFFFF : HardwareTypeBit(hardwareType);
+            rule.sensorType = sensorType;
+            rule.pattern = pattern && *pattern ? pattern : "*";
+            rule.reduce = reduce;
+            rule.byGroup = byGroup != 0;
+            collector->collector.AddRule(rule);
+            return 0;
+        }
+        catch (System::Exception^) {
+            return -1;
+        }
+    }
+
+    HWI_API int32_t hwi_collector_read(HwiCollector* collector, HwiFleetAggregate* aggregates, uint32_t capacity) {
+        if (!collector) return 0;
+
+        try {
+            collector->collector.Aggregates(collector->aggregates);
+        }
+        catch (System::Exception^) {
+            return 0;
+        }
+        uint32_t count = aggregates ? std::min(capacity, static_cast<uint32_t>(collector->aggregates.size())) : 0;
+        for (uint32_t i = 0; i < count; i++) {
+            const FleetAggregateValue& source = collector->aggregates[i];
+            HwiFleetAggregate& target = aggregates[i];
+            memset(&target, 0, sizeof(target));
+            strncpy_s(target.rule, source.rule.c_str(), _TRUNCATE);
+            strncpy_s(target.group, source.group.c_str(), _TRUNCATE);
+            target.reduce = source.reduce;
+            target.hosts = source.hosts;
+            target.value = source.value;
+        }
+        return static_cast<int32_t>(collector->aggregates.size());
+    }
+
+    HWI_API HwiSharedReader* hwi_shared_open(const char* name) {
+        if (!name) return nullptr;
+
+        HwiSharedReader* reader = nullptr;
+        try {
+            reader = new HwiSharedReader();
+            if (reader->reader.Open(name)) return reader;
+        }
+        catch (System::Exception^) {
+        }
+        delete reader;
+        return nullptr;
+    }
+
+    HWI_API void hwi_shared_close(HwiSharedReader* reader) {
+        delete reader;
+    }
+
+    HWI_API int32_t hwi_shared_read(HwiSharedReader* reader, void* buffer, uint32_t size) {
+        if (!reader) return 0;
+        return reader->reader.Read(buffer, buffer ? size : 0);
+    }
+
+    HWI_API int32_t hwi_shared_copy_catalog(HwiSharedReader* reader, HwiCatalogEntry* entries, uint32_t capacity, uint32_t* catalogVersion) {
+        if (!reader) return -1;
+        return reader->reader.ReadCatalog(entries, entries ? capacity : 0, catalogVersion);
+    }
+
+    HWI_API int64_t hwi_shared_age(HwiSharedReader* reader) {
+        if (!reader) return -1;
+        return reader->reader.AgeMicroseconds();
+    }
+
+    HWI_API int hwi_shared_publisher_alive(HwiSharedReader* reader) {
+        return reader && reader->reader.PublisherAlive() ? 1 : 0;
+    }
+}
@@ -0,0 +1,135 @@
+﻿#pragma once
+
+// 原生 (C ABI) 介面：固定版面的二進位快照，讀取一次取樣只需要一次 memcpy
+
+#include "SnapshotLayout.h"
+
+#ifdef HWI_EXPORTS
+#define HWI_API __declspec(dllexport)
+#else
+#define HWI_API __declspec(dllimport)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    typedef struct HwiHandle HwiHandle;
+
+    // 受控例外不會離開這個介面：失敗時回傳 -1 (回傳大小或版本的函數回傳 0，回傳控制代碼的函數回傳 NULL)
+
+    // 建立/釋放 HardwareInfo (失敗時回傳 NULL)
+    HWI_API HwiHandle* hwi_open(void);
+    HWI_API void hwi_close(HwiHandle* handle);
+
+    // 立即回傳，硬體類別在背景平行開啟 (以 hwi_wait_ready 等待)
+    HWI_API HwiHandle* hwi_open_background(void);
+
+    // 等待 hardwareType 所屬的類別開啟完成 (hardwareType 為 -1 時等待所有類別)，
+    // 完成回傳 1、逾時回傳 0、開啟失敗回傳 -1；timeoutMs 為 -1 時不逾時
+    HWI_API int hwi_wait_ready(HwiHandle* handle, int hardwareType, int timeoutMs);
+
+    // 建立不開啟任何硬體類別的 HardwareInfo，之後以 hwi_subscribe 開啟需要的類別
+    HWI_API HwiHandle* hwi_open_on_demand(void);
+
+    // 訂閱 hardwareType (HardwareType 數值) 中感測器名稱符合 pattern ('*'、'?'，NULL 表示全部) 的硬體，
+    // 之後取樣只更新有訂閱需要的硬體。成功回傳訂閱識別碼 (大於 0)，失敗回傳 -1
+    HWI_API int hwi_subscribe(HwiHandle* handle, int hardwareType, const char* pattern);
+
+    // 取消訂閱 (最後一個訂閱取消後恢復更新所有硬體)，成功回傳 0
+    HWI_API int hwi_unsubscribe(HwiHandle* handle, int subscription);
+
+    // 取樣一次 (SaveAllHardware)，成功回傳 0
+    HWI_API int hwi_sample(HwiHandle* handle);
+
+    // 目前快照所需的位元組數 (標頭 + 數值)
+    HWI_API uint32_t hwi_snapshot_size(HwiHandle* handle);
+
+    // 複製快照到 buffer，回傳複製的位元組數；buffer 不足時回傳負的所需大小
+    HWI_API int32_t hwi_copy_snapshot(HwiHandle* handle, void* buffer, uint32_t size);
+
+    HWI_API uint32_t hwi_catalog_version(HwiHandle* handle);
+
+    // 複製目錄到 entries，回傳感測器總數 (可能大於 capacity)
+    HWI_API int32_t hwi_copy_catalog(HwiHandle* handle, HwiCatalogEntry* entries, uint32_t capacity);
+
+    // 開始將每次取樣發布到具名共享記憶體，成功回傳 0 (名稱已被使用時回傳 -1)
+    HWI_API int hwi_publish_shared(HwiHandle* handle, const char* name, uint32_t capacity);
+
+    // 在 address:port 提供 OpenMetrics (GET /metrics)，address 為 NULL 時只接受本機連線；
+    // port 為 0 時由系統指定。成功回傳實際的連接埠，失敗回傳 -1
+    HWI_API int hwi_serve_metrics(HwiHandle* handle, const char* address, int port);
+
+    // 開始記錄變化並保留最近 capacity 個批次，成功回傳 0
+    HWI_API int hwi_start_deltas(HwiHandle* handle, uint32_t capacity);
+
+    // 設定 Identifier 符合 pattern 的感測器門檻 (見 HardwareInfo::SetDeadband)，成功回傳 0
+    HWI_API int hwi_set_deadband(HwiHandle* handle, const char* pattern, float absolute, float relative);
+
+    // 複製 afterSequence 之後的變化 (只複製完整的批次)，沒有新批次時最多等待 timeoutMs 毫秒。
+    // 回傳項目數；批次已被覆寫時回傳 -1 (以 hwi_delta_baseline 重新同步)，capacity 放不下下一個批次時回傳負的所需項目數 - 1
+    HWI_API int32_t hwi_read_deltas(HwiHandle* handle, uint64_t afterSequence, HwiDelta* entries, uint32_t capacity, int timeoutMs);
+
+    // 複製每個槽位最後送出的數值與對應的序號，回傳槽位總數 (可能大於 capacity)
+    HWI_API int32_t hwi_delta_baseline(HwiHandle* handle, float* values, uint32_t capacity, uint64_t* sequence);
+
+    // 新增衍生指標 (kind：0 速率、1 EWMA、2 平均、3 高溫降頻，見 HardwareInfo::AddDerivedMetric)，
+    // label 為 NULL 時使用預設名稱。成功回傳 0 (目錄版本會遞增)
+    HWI_API int hwi_add_derived(HwiHandle* handle, int hardwareType, const char* pattern, int kind, float parameter, const char* label);
+
+    // 新增警示規則 (hardwareType、sensorType 為 -1 表示所有類型；condition：0 大於、1 小於、2 每秒上升、3 每秒下降，
+    // 見 HardwareInfo::AddAlertRule)。回傳規則編號，失敗回傳 -1
+    HWI_API int hwi_add_alert(HwiHandle* handle, int hardwareType, int sensorType, const char* pattern, int condition, float threshold, float hysteresis, float durationSeconds);
+
+    // 移除警示規則，成功回傳 0
+    HWI_API int hwi_remove_alert(HwiHandle* handle, int rule);
+
+    // 設定警示的回呼 (callback 為 NULL 時取消)：在取樣的執行緒上於 frame 發布後依序呼叫，alert 只在呼叫期間有效。
+    // 回呼中不可呼叫 hwi_close (會停止取樣，而取樣執行緒無法等待自己結束)，請交給其他執行緒
+    HWI_API void hwi_set_alert_callback(HwiHandle* handle, HwiAlertCallback callback, void* context);
+
+    // 開始將取樣 (至少間隔 intervalMs 毫秒) 錄製到 directory (UTF-8) 的壓縮區段檔，成功回傳 0。
+    // 讀取端可直接編譯 SeriesRecorder.cpp 使用 SeriesReader (不需要此 DLL)
+    HWI_API int hwi_start_series(HwiHandle* handle, const char* directory, int intervalMs);
+    HWI_API void hwi_stop_series(HwiHandle* handle);
+
+    // 開始將取樣 (至少間隔 intervalMs 毫秒) 送到收集端 ("udp://位址:連接埠" 或 "unix:路徑")，hostName 為 NULL 時使用電腦名稱，成功回傳 0
+    HWI_API int hwi_fleet_send(HwiHandle* handle, const char* endpoint, const char* hostName, const char* group, int intervalMs);
+    HWI_API void hwi_fleet_stop(HwiHandle* handle);
+
+    // 集中收集端 (不需要 hwi_open；不想載入此 DLL 的原生程式可直接編譯 FleetCollector.cpp)
+    typedef struct HwiCollector HwiCollector;
+
+    // 在端點開始接收並使用預設規則 (失敗時回傳 NULL)
+    HWI_API HwiCollector* hwi_collector_open(const char* endpoint);
+    HWI_API void hwi_collector_close(HwiCollector* collector);
+
+    // 加入彙總規則 (hardwareType 為 -1 表示所有類型，reduce 與 HwiFleetAggregate::reduce 相同)，成功回傳 0
+    HWI_API int hwi_collector_add_rule(HwiCollector* collector, const char* name, int hardwareType, int sensorType, const char* pattern, int reduce, int byGroup);
+
+    // 複製目前的彙總，回傳彙總總數 (可能大於 capacity)
+    HWI_API int32_t hwi_collector_read(HwiCollector* collector, HwiFleetAggregate* aggregates, uint32_t capacity);
+
+    // 共享記憶體讀取端 (不需要 hwi_open；不想載入此 DLL 的原生程式可直接編譯 SharedSnapshot.cpp)
+    typedef struct HwiSharedReader HwiSharedReader;
+
+    // 以唯讀方式開啟 (失敗時回傳 NULL)
+    HWI_API HwiSharedReader* hwi_shared_open(const char* name);
+    HWI_API void hwi_shared_close(HwiSharedReader* reader);
+
+    // 複製最新快照，回傳位元組數；buffer 不足時回傳負的所需大小；發布者寫入中卡住時回傳 0
+    HWI_API int32_t hwi_shared_read(HwiSharedReader* reader, void* buffer, uint32_t size);
+
+    // 複製目錄，回傳感測器總數 (可能大於 capacity)，失敗時回傳 -1；
+    // catalogVersion 為這份目錄的版本，與快照標頭的 catalogVersion 相同時目錄對應該快照
+    HWI_API int32_t hwi_shared_copy_catalog(HwiSharedReader* reader, HwiCatalogEntry* entries, uint32_t capacity, uint32_t* catalogVersion);
+
+    // 距離最後一次發布的時間 (微秒)，尚未發布或已停止時回傳 -1
+    HWI_API int64_t hwi_shared_age(HwiSharedReader* reader);
+
+    // 發布者的處理程序是否仍然存在 (1/0)
+    HWI_API int hwi_shared_publisher_alive(HwiSharedReader* reader);
+
+#ifdef __cplusplus
+}
+#endif
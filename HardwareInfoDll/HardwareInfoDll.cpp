@@ -1,260 +1,215 @@
 #include "pch.h"
 
 #include "HardwareInfoDll.h"
+#include "InfoSerializer.h"
+#include "SensorDescriptors.h"
 
 #include <string>
 #include <nlohmann/json.hpp>
 #include <unordered_map>
 #include <msclr\marshal_cppstd.h>
-#include <bitset>
+#include <algorithm>
 #include <regex>
-#include <locale>
-#include <codecvt>
 #include <chrono>
 #include <thread>
 #include <future>
+#include <cstring>
 
 #using "LibreHardwareMonitorLib.dll"
 using namespace System;
 using namespace System::Threading;
 using namespace System::Threading::Tasks;
-using namespace System::Collections::Generic;
 using namespace LibreHardwareMonitor::Hardware;
 using json = nlohmann::json;
 
-#define MAX_CORE_NUM 64
 #define DUMP_JSON_INDENT -1  // -1 ܤϥY
 
 namespace HardwareInfoDll {
-    using HardwareHandler = void(*)(IHardware^, HardwareInfo^);
-
-    // wqwBz
-    void HandleCPU(IHardware^ hardware, HardwareInfo^ hw) {
-        hw->cpuInfo->Name = msclr::interop::marshal_as<std::string>(hardware->Name);
-
-        auto sensors = hardware->Sensors;
-        for (int i = 0; i < sensors->Length; ++i) {
-            ISensor^ sensor = sensors[i];
-            auto sensorValue = sensor->Value;
-            if (!sensorValue.HasValue) continue;
-
-            std::string sensorName = msclr::interop::marshal_as<std::string>(sensor->Name);
-
-            // ھڶǷPó]m
-            switch (sensor->SensorType) {
-                case SensorType::Load:
-                    if (sensorName == "CPU Total")
-                        hw->cpuInfo->CPUUsage = sensorValue.Value;
-                    else if (sensorName.find("CPU Core Max") == 0)
-                        hw->cpuInfo->MaxCoreUsage = sensorValue.Value;
-                    else if (sensorName.find("CPU Core") == 0)
-                        hw->cpuInfo->CoreLoad[sensorName] = sensorValue.Value;
-                    break;
-
-                case SensorType::Temperature:
-                    if (sensorName == "Core Max")
-                        hw->cpuInfo->MaxTemperature = sensorValue.Value;
-                    else if (sensorName == "CPU Package")
-                        hw->cpuInfo->PackageTemperature = sensorValue.Value;
-                    else if (sensorName == "Core Average")
-                        hw->cpuInfo->AverageTemperature = sensorValue.Value;
-                    else if (sensorName.find("CPU Core") == 0)
-                        hw->cpuInfo->CoreTemperature[sensorName] = sensorValue.Value;
-                    break;
-
-                case SensorType::Clock:
-                    if (sensorName.find("CPU Core") == 0)
-                        hw->cpuInfo->CoreClock[sensorName] = sensorValue.Value;
-                    else if (sensorName == "Bus Speed")
-                        hw->cpuInfo->BusSpeed = sensorValue.Value;
-                    break;
-
-                case SensorType::Voltage:
-                    if (sensorName.find("CPU Core #") == 0)
-                        hw->cpuInfo->CoreVoltage[sensorName] = sensorValue.Value;
-                    else if (sensorName == "CPU Core")
-                        hw->cpuInfo->CPUVoltage = sensorValue.Value;
-                    break;
-
-                case SensorType::Power:
-                    if (sensorName == "CPU Package")
-                        hw->cpuInfo->PackagePower = sensorValue.Value;
-                    else if (sensorName == "CPU Cores")
-                        hw->cpuInfo->CoresPower = sensorValue.Value;
-                    break;
-            }
-        }
+    bool HardwareInfo::BindingsStale() {
+        return source->TopologyVersion() != boundTopology;
+    }
 
-        std::bitset<MAX_CORE_NUM> coreExists;
+    long long HardwareInfo::StringConversions() {
+        return computerSource ? computerSource->StringConversions() : 0;
+    }
 
-        for (const auto& pair : hw->cpuInfo->CoreLoad) {
-            //std::smatch match;
-            if (pair.first.find("CPU Core #") == 0) {
-                int coreNumber = std::stoi(pair.first.substr(10)); // qTwm^Ʀr
-                coreExists.set(coreNumber);
-            }
+    void HardwareInfo::RebindSensors() {
+        gpuUpdateMutex->WaitOne();  // ݶi椤 GPU sAקKŪ쥢Ī
+
+        // OGC|ݼAܮɡAU@|sô
+        boundTopology = source->TopologyVersion();
+        std::vector<SourceHardware> hardware;
+        source->Enumerate(hardware);
+        model->Rebind(hardware);
+        derived->Rebind(*model);  // lͫЪѦ챵bӷP
+        CpuTopology topology;
+        source->DescribeCpuTopology(topology);
+        topologyAggregates->Rebind(*model, topology);  // ݼJ`Ѧ챵blͫФ
+        diagnostics->Resize(model->bindings.size());
+        UpdateSubscribed();
+
+        bindCount++;
+        catalogVersion++;  // frame bUgJɨ̷s
+        conversionsAtLastBind = StringConversions();
+
+        // cwءAҦO֨
+        for (int category = 0; category < InfoCategoryCount; category++) {
+            Interlocked::Increment(categoryGeneration[category]);
         }
-
-        hw->cpuInfo->Cores = static_cast<int>(coreExists.count());
-        hw->cpuInfo->Threads = static_cast<int>(hw->cpuInfo->CoreLoad.size()); // ƶqiHϥ CoreLoad jp
+        PublishSnapshot();
+        gpuUpdateMutex->ReleaseMutex();
     }
 
-    void HandleGPU(IHardware^ hardware, HardwareInfo^ hw) {
-        auto& gpuMap = *hw->gpuInfoMap;
+    bool HardwareInfo::PollHardware(size_t bindingIndex) {
+        diagnostics->Fetch(*model, *source, bindingIndex);  // ӷ Update() b~
 
-        std::string hardwareName = msclr::interop::marshal_as<std::string>(hardware->Name);
-
-        auto& gpuSensors = gpuMap[hardwareName];
-
-        auto sensors = hardware->Sensors;
-        for (int i = 0; i < sensors->Length; ++i) {
-            ISensor^ sensor = sensors[i];
-            if (!sensor->Value.HasValue) continue;
+        // ƭȻPlͫФ@_MΡAWriteFrame |ݨP@ӵwus@b
+        bool changed = false;
+        model->LockValues();
+        try {
+            changed = diagnostics->Apply(*model, bindingIndex);
+            if (derived->Active(bindingIndex) && derived->Update(*model, bindingIndex, DiagnosticsClock())) changed = true;
+            if (topologyAggregates->Active(bindingIndex) && topologyAggregates->Update(*model, bindingIndex)) changed = true;
+        }
+        finally {
+            model->UnlockValues();
+        }
 
-            std::string sensorName = msclr::interop::marshal_as<std::string>(sensor->Name);
-            std::string sensorType = msclr::interop::marshal_as<std::string>(sensor->SensorType.ToString());
+        // uƭȯuܪO~ JSON ֨
+        int category = model->bindings[bindingIndex].category;
+        if (changed && category < InfoCategoryCount)
+            Interlocked::Increment(categoryGeneration[category]);
+        return changed;
+    }
 
-            gpuSensors[sensorName] = GpuSensorInfo(sensorType, sensor->Value.Value);
+    void HardwareInfo::PollBindings(bool gpu) {
+        for (size_t i = 0; i < model->bindings.size(); ++i) {
+            const HardwareBinding& binding = model->bindings[i];
+            if (binding.isGpu == gpu && binding.subscribed) PollHardware(i);
         }
     }
 
-    void HandleMemory(IHardware^ hardware, HardwareInfo^ hw) {
-        std::string hardwareName = msclr::interop::marshal_as<std::string>(hardware->Name);
-
-        hw->memoryInfo->name = hardwareName;
+    // C++/CLI @
+    void HardwareInfo::SaveAllHardware() {
+        if (samplingActive) return;  // IˤAIsݥuŪ̷s
+        EnsureBindings();
 
-        auto sensors = hardware->Sensors;
-        for (int i = 0; i < sensors->Length; ++i) {
-            ISensor^ sensor = sensors[i];
-            if (!sensor->Value.HasValue) continue;
+        // Du{Bz CPU/Memory/Storage/Network (ŪGI}ҪOɷ|sô)
+        bindingLock->EnterReadLock();
+        try {
+            PollBindings(false);
+            pollCount++;
+            PublishSnapshot();
+        }
+        finally {
+            bindingLock->ExitReadLock();
+        }
+        DispatchAlerts();
 
-            std::string sensorName = msclr::interop::marshal_as<std::string>(sensor->Name);
+        // ϥ Task Bz GPU s]D^ASq\ݭn GPU ɤƤJ
+        if (!gpuSubscribed) return;
+        diagnostics->GpuScheduled();
+        Task::Run(gcnew Action(this, &HardwareInfo::RunGpuUpdate));
+    }
 
-            if (sensorName == "Memory Used")
-                hw->memoryInfo->memoryUsed = sensor->Value.Value;
-            else if (sensorName == "Memory Available")
-                hw->memoryInfo->memoryAvailable = sensor->Value.Value;
-            else if (sensorName == "Memory")
-                hw->memoryInfo->memoryUtilization = sensor->Value.Value;
-            else if (sensorName == "Virtual Memory Used")
-                hw->memoryInfo->virtualMemoryUsed = sensor->Value.Value;
-            else if (sensorName == "Virtual Memory Available")
-                hw->memoryInfo->virtualMemoryAvailable = sensor->Value.Value;
-            else if (sensorName == "Virtual Memory")
-                hw->memoryInfo->virtualMemoryUtilization = sensor->Value.Value;
+    void HardwareInfo::RunGpuUpdate() {
+        try {
+            UpdateGpuData();
+        }
+        finally {
+            diagnostics->GpuFinished();
         }
     }
 
-    void HandleStorage(IHardware^ hardware, HardwareInfo^ hw) {
-        std::string hardwareName = msclr::interop::marshal_as<std::string>(hardware->Name);
-
-        auto& storageMap = *hw->storageInfoMap;
-        storageMap[hardwareName] = StorageInfo();
-
-        auto sensors = hardware->Sensors;
-        for (int i = 0; i < sensors->Length; ++i) {
-            ISensor^ sensor = sensors[i];
-            if (!sensor->Value.HasValue) continue;
-
-            std::string sensorName = msclr::interop::marshal_as<std::string>(sensor->Name);
-
-            if (sensorName == "Used Space")
-                storageMap[hardwareName].usedSpace = sensor->Value.Value;
-            else if (sensorName == "Read Activity")
-                storageMap[hardwareName].readActivity = sensor->Value.Value;
-            else if (sensorName == "Write Activity")
-                storageMap[hardwareName].writeActivity = sensor->Value.Value;
-            else if (sensorName == "Total Activity")
-                storageMap[hardwareName].totalActivity = sensor->Value.Value;
-            else if (sensorName == "Read Rate")
-                storageMap[hardwareName].readRate = sensor->Value.Value;
-            else if (sensorName == "Write Rate")
-                storageMap[hardwareName].writeRate = sensor->Value.Value;
+    void HardwareInfo::UpdateGpuData() {
+        bindingLock->EnterReadLock();  // oŪAo MutexAsô (gJ) ɤ|۵
+        try {
+            if (gpuUpdateMutex->WaitOne(0)) {
+                PollBindings(true);
+                PublishSnapshot();
+                gpuUpdateMutex->ReleaseMutex();  // 
+            }
+            else {
+                diagnostics->GpuSkipped();  // e@s|AL
+            }
+        }
+        finally {
+            bindingLock->ExitReadLock();
         }
+        DispatchAlerts();
     }
 
-    void HandleNetwork(IHardware^ hardware, HardwareInfo^ hw) {
-        std::wstring hardwareName = msclr::interop::marshal_as<std::wstring>(hardware->Name);
-
-        auto& networkMap = *hw->networkInfoMap;
-        networkMap[hardwareName] = NetworkInfo();
-
-        auto sensors = hardware->Sensors;
-        for (int i = 0; i < sensors->Length; ++i) {
-            ISensor^ sensor = sensors[i];
-            if (!sensor->Value.HasValue) continue;
-
-            std::string sensorName = msclr::interop::marshal_as<std::string>(sensor->Name);
+    // ثeɶ (Unix epoch L)
+    static long long NowMicroseconds() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
 
-            if (sensorName == "Data Uploaded")
-                networkMap[hardwareName].dataUploaded = sensor->Value.Value;
-            else if (sensorName == "Data Downloaded")
-                networkMap[hardwareName].dataDownloaded = sensor->Value.Value;
-            else if (sensorName == "Upload Speed")
-                networkMap[hardwareName].uploadSpeed = sensor->Value.Value;
-            else if (sensorName == "Download Speed")
-                networkMap[hardwareName].downloadSpeed = sensor->Value.Value;
-            else if (sensorName == "Network utilization")
-                networkMap[hardwareName].networkUtilization = sensor->Value.Value;
+    // i঳hӰPɭnDoGSHboɥѦۤvgJ frameA
+    // _hdUаOAѥboAo@ ()
+    void HardwareInfo::PublishSnapshot() {
+        Interlocked::Exchange(publishPending, 1);
+        while (Volatile::Read(publishPending) != 0 && Interlocked::CompareExchange(publishing, 1, 0) == 0) {
+            Interlocked::Exchange(publishPending, 0);
+            WriteFrame();
+            Interlocked::Exchange(publishing, 0);
         }
+        DispatchAlerts();  // ôɯdIsݦbeX
     }
 
-    void HandleBattery(IHardware^ hardware, HardwareInfo^ hw) {
-        std::string hardwareName = msclr::interop::marshal_as<std::string>(hardware->Name);
+    void HardwareInfo::WriteFrame() {
+        int index;
+        HardwareFrame* frame = frames->BeginWrite(index);
+        if (!frame) return;  // Ҧ frame QŪ̥eΡALo (pJ DroppedFrames)
 
-        auto sensors = hardware->Sensors;
-        for (int i = 0; i < sensors->Length; ++i) {
-            ISensor^ sensor = sensors[i];
-            if (!sensor->Value.HasValue) continue;
+        int64_t start = diagnostics->Enabled() ? DiagnosticsClock() : 0;
 
+        // O@NAƻsƭȡG@Nuiƭ¡A| JSON ֨d¸
+        for (int category = 0; category < InfoCategoryCount; category++) {
+            frame->generation[category] = Interlocked::Read(categoryGeneration[category]);
         }
-    }
-
-    // ϥ std::unordered_map Ӻ޲zwBz
-    std::unordered_map<size_t, HardwareHandler> hardwareHandlers = {
-        { (size_t)HardwareType::Cpu, &HandleCPU },
-        { (size_t)HardwareType::GpuNvidia, &HandleGPU },
-        { (size_t)HardwareType::GpuAmd, &HandleGPU },
-        { (size_t)HardwareType::GpuIntel, &HandleGPU },
-        { (size_t)HardwareType::Memory, &HandleMemory },
-        { (size_t)HardwareType::Storage, &HandleStorage },
-        { (size_t)HardwareType::Network, &HandleNetwork }
-        //{ (size_t)HardwareType::Battery, &HandleBattery }  // qwȮɤBz
-    };
 
-    // C++/CLI Bs@
-    void HardwareInfo::SaveAllHardware() {
-        // Du{Bz CPU/Memory/Storage/Network
-        for (int i = 0; i < this->computer->Hardware->Count; i++) {
-            IHardware^ hardware = this->computer->Hardware[i];
-            if (hardware->HardwareType != HardwareType::GpuNvidia &&
-                hardware->HardwareType != HardwareType::GpuAmd &&
-                hardware->HardwareType != HardwareType::GpuIntel) {
-                hardware->Update();
-                hardwareHandlers[(size_t)hardware->HardwareType](hardware, this);
-            }
+        // LsեiPɦbMμƭȡG LockValues ɨCӵw骺ƭȳO㪺@
+        model->LockValues();
+        try {
+            if (frame->catalogVersion != catalogVersion) model->BuildFrameLayout(*frame, catalogVersion);
+            model->FillFrame(*frame);
+        }
+        finally {
+            model->UnlockValues();
         }
 
-        // ϥ Task Bz GPU s]D^
-        Task::Run(gcnew Action(this, &HardwareInfo::UpdateGpuData));
+        auto header = reinterpret_cast<HwiSnapshotHeader*>(frame->snapshot.data());
+        header->sequence = ++snapshotSequence;
+        header->timestamp = NowMicroseconds();
+        history->Record(header->timestamp, frame->Values(), frame->fields.size());
+        if (sharedWriter) PublishShared(*frame);
+        if (traceWriter) RecordTrace(*frame);
+        if (seriesRecorder) seriesRecorder->Record(model->slots, frame->catalogVersion, header->timestamp, frame->Values(), frame->fields.size());
+        if (metricsExporter) metricsExporter->Prepare(*frame, *model);
+        if (fleetSender) fleetSender->Send(model->slots, frame->catalogVersion, header->sequence, header->timestamp, frame->Values(), frame->fields.size());  // DAFjɲL
+        deltaStream->Record(model->slots, frame->Values(), frame->fields.size(), header->timestamp, frame->catalogVersion);  // ήɤo
+        if (alerts->Evaluate(model->slots, frame->catalogVersion, header->timestamp, frame->Values(), frame->fields.size(), *alertScratch)) QueueAlerts();  // SWhɤo
+
+        frames->Publish(index);
+        if (start) diagnostics->RecordPublish(DiagnosticsClock() - start);
     }
 
-    void HardwareInfo::UpdateGpuData() {
-        if (gpuUpdateMutex->WaitOne(0)) {
-            for (int i = 0; i < this->computer->Hardware->Count; i++) {
-                IHardware^ hardware = this->computer->Hardware[i];
-                if (hardware->HardwareType == HardwareType::GpuNvidia ||
-                    hardware->HardwareType == HardwareType::GpuAmd ||
-                    hardware->HardwareType == HardwareType::GpuIntel) {
-                    hardware->Update();
-                    hardwareHandlers[(size_t)hardware->HardwareType](hardware, this);
-                }
+    void HardwareInfo::PrintAllHardware() {
+        // XέӷS ComputerA̼ѦX̷sƭ
+        if (computer == nullptr) {
+            for (size_t slot = 0; slot < sensorSlots->size(); ++slot) {
+                const SensorSlot& sensorSlot = (*sensorSlots)[slot];
+                System::Console::WriteLine(System::String::Format(
+                    "Hardware: {0}, HardwareType: {1}, Sensor: {2}, Value: {3}, Type: {4}",
+                    FromUtf8String(sensorSlot.hardwareName),
+                    static_cast<HardwareType>(sensorSlot.hardwareType).ToString(),
+                    FromUtf8String(sensorSlot.name),
+                    (*sensorValues)[slot].ToString(),
+                    static_cast<SensorType>(sensorSlot.sensorType).ToString()));
             }
-            gpuUpdateMutex->ReleaseMutex();  // 
+            return;
         }
-    }
 
-    void HardwareInfo::PrintAllHardware() {
         // MҦw
         for (int i = 0; i < this->computer->Hardware->Count; i++) {
             IHardware^ hardware = this->computer->Hardware[i];
@@ -285,39 +240,164 @@ namespace HardwareInfoDll {
         }
     }
 
-    // ഫ CPU Tc JSON 榡
     System::String^ HardwareInfo::GetCPUInfo() {
+        return GetCachedJson(CpuCategory);
+    }
+
+    System::String^ HardwareInfo::GetGPUInfo() {
+        return GetCachedJson(GpuCategory);
+    }
+
+    System::String^ HardwareInfo::GetMemoryInfo() {
+        return GetCachedJson(MemoryCategory);
+    }
+
+    System::String^ HardwareInfo::GetStorageInfo() {
+        return GetCachedJson(StorageCategory);
+    }
+
+    System::String^ HardwareInfo::GetNetworkInfo() {
+        return GetCachedJson(NetworkCategory);
+    }
+
+    System::String^ HardwareInfo::GetDeviceInfo() {
+        return GetCachedJson(DeviceCategory);
+    }
+
+    // ƥ@NSܮɪ^ǤW@rAsǦC
+    System::String^ HardwareInfo::GetCachedJson(InfoCategory category) {
+        FrameLease<HardwareFrame> lease(*frames);
+        const HardwareFrame* frame = lease.Get();
+        if (!frame) return "null";
+
+        long long generation = frame->generation[category];
+        bool measure = diagnostics->Enabled();
+        if (measure) diagnostics->RecordReadAge((NowMicroseconds() - frame->Header().timestamp) * 1000);
+
+        CachedJson^ cached = cachedJson[category];
+        if (cached != nullptr && cached->Generation == generation) {
+            diagnostics->RecordCacheHit(category);
+            return cached->Text;
+        }
+
+        // @NPeӦۦP@ frame
+        int64_t start = measure ? DiagnosticsClock() : 0;
+        System::String^ text = SerializeCategory(category, *frame);
+        if (measure) diagnostics->RecordSerialize(static_cast<int>(serializerKind), category, DiagnosticsClock() - start);
+        cachedJson[category] = gcnew CachedJson(text, generation);
+        return text;
+    }
+
+    System::String^ HardwareInfo::SerializeCategory(InfoCategory category, const HardwareFrame& frame) {
+        if (serializerKind == JsonSerializerKind::Dom) {
+            switch (category) {
+                case CpuCategory: return SerializeCPUInfoDom(frame);
+                case GpuCategory: return SerializeGPUInfoDom(frame);
+                case MemoryCategory: return SerializeMemoryInfoDom(frame);
+                case StorageCategory: return SerializeStorageInfoDom(frame);
+                case NetworkCategory: return SerializeNetworkInfoDom(frame);
+                default: return SerializeDeviceInfoDom(frame);
+            }
+        }
+
+        // X UTF-16AgL UTF-8 rP Encoding::UTF8 ഫ
+        std::u16string text;
+        SerializeInfo(category, frame, text);
+        return FromUtf16String(text);
+    }
+
+    // ҦOӦۦP@ frameFƥ@NSܮɪ^ǤW@r
+    System::String^ HardwareInfo::GetAllInfo() {
+        FrameLease<HardwareFrame> lease(*frames);
+        const HardwareFrame* frame = lease.Get();
+        if (!frame) return "null";
+
+        // @Nu|WA`MۦPܨCOS
+        long long generation = 0;
+        for (int category = 0; category < InfoCategoryCount; category++) {
+            generation += frame->generation[category];
+        }
+
+        Monitor::Enter(allInfoLock);
+        try {
+            if (allInfoText != nullptr && allInfoGeneration == generation) return allInfoText;
+
+            allInfoText = SerializeAll(*frame);
+            allInfoGeneration = generation;
+            return allInfoText;
+        }
+        finally {
+            Monitor::Exit(allInfoLock);
+        }
+    }
+
+    // ƨϥΦP@ UTF-16 wİϡACIsutm^Ǫ System::String (Monitor iJAGetAllInfo w)
+    System::String^ HardwareInfo::SerializeAll(const HardwareFrame& frame) {
+        Monitor::Enter(allInfoLock);
+        try {
+            allInfoBuffer->clear();
+            SerializeAllInfo(frame, *allInfoBuffer);
+            return FromUtf16String(*allInfoBuffer);
+        }
+        finally {
+            Monitor::Exit(allInfoLock);
+        }
+    }
+
+    void HardwareInfo::SetJsonSerializer(JsonSerializerKind kind) {
+        serializerKind = kind;
+        InvalidateJsonCache();
+    }
+
+    void HardwareInfo::InvalidateJsonCache() {
+        for (int category = 0; category < InfoCategoryCount; category++) {
+            cachedJson[category] = nullptr;
+        }
+
+        Monitor::Enter(allInfoLock);
+        allInfoText = nullptr;
+        Monitor::Exit(allInfoLock);
+    }
+
+    // NC֤߰}C٭즨 { W: ƭ }  JSON A쥻X榡
+    static json ToJson(const CoreSeries& series) {
+        json result = json::object();
+        for (size_t i = 0; i < series.Values.size(); ++i) {
+            result[series.Names[i]] = series.Values[i];
+        }
+        return result;
+    }
+
+    // yz
+    template <typename Info, size_t N>
+    static void AddFields(json& result, const SensorTable<Info, N>& table, const Info& info) {
+        for (const auto& descriptor : table) result[descriptor.key] = info.*(descriptor.field);
+    }
+
+    // ഫ CPU Tc JSON 榡
+    System::String^ HardwareInfo::SerializeCPUInfoDom(const HardwareFrame& frame) {
         // ഫ JSON 榡
         json result = {
-            { "Name", cpuInfo->Name },
-            { "CPUUsage", cpuInfo->CPUUsage },
-            { "MaxCoreUsage", cpuInfo->MaxCoreUsage },
-            { "CoreLoad", cpuInfo->CoreLoad },
-            { "CoreTemperature", cpuInfo->CoreTemperature },
-            { "CoreVoltage", cpuInfo->CoreVoltage },
-            { "CoreClock", cpuInfo->CoreClock },
-            { "MaxTemperature", cpuInfo->MaxTemperature },
-            { "PackageTemperature", cpuInfo->PackageTemperature },
-            { "AverageTemperature", cpuInfo->AverageTemperature },
-            { "BusSpeed", cpuInfo->BusSpeed },
-            { "CPUVoltage", cpuInfo->CPUVoltage },
-            { "PackagePower", cpuInfo->PackagePower },
-            { "CoresPower", cpuInfo->CoresPower },
-            { "Cores", cpuInfo->Cores },
-            { "Threads", cpuInfo->Threads }
+            { "Name", frame.cpu.Name },
+            { "Cores", frame.cpu.Cores },
+            { "Threads", frame.cpu.Threads }
         };
+        AddFields(result, CpuFields, frame.cpu);
+        for (const auto& descriptor : CpuSeries) result[descriptor.key] = ToJson(frame.cpu.*(descriptor.series));
+        if (!frame.cpu.Derived.Values.empty()) result["Derived"] = ToJson(frame.cpu.Derived);  // lͫ (SɤX)
+        if (!frame.cpu.Topology.Values.empty()) result["Topology"] = ToJson(frame.cpu.Topology);  // ݼJ`
 
-        // N JSON ഫ std::stringAAন System::String^
-        return msclr::interop::marshal_as<System::String^>(result.dump(DUMP_JSON_INDENT));
+        // N JSON ഫ std::string (UTF-8)AAন System::String^
+        return FromUtf8String(result.dump(DUMP_JSON_INDENT));
     }
 
     // ഫ GPU Tc JSON 榡
-    System::String^ HardwareInfo::GetGPUInfo() {
+    System::String^ HardwareInfo::SerializeGPUInfoDom(const HardwareFrame& frame) {
         // ഫ JSON 榡
         json result;
 
         // bj餺Bz GPU T
-        for (auto& gpu : *gpuInfoMap) {
+        for (auto& gpu : frame.gpu) {
             json gpuJson;
 
             // NCӷPTxsb JSON 榡
@@ -331,65 +411,50 @@ namespace HardwareInfoDll {
             result[gpu.first] = std::move(gpuJson);  // ϥ std::move u
         }
 
-        // N JSON ഫ std::stringAAন System::String^
-        return msclr::interop::marshal_as<System::String^>(result.dump(DUMP_JSON_INDENT));
+        // N JSON ഫ std::string (UTF-8)AAন System::String^
+        return FromUtf8String(result.dump(DUMP_JSON_INDENT));
     }
 
     // ഫOTc JSON 榡
-    System::String^ HardwareInfo::GetMemoryInfo() {
+    System::String^ HardwareInfo::SerializeMemoryInfoDom(const HardwareFrame& frame) {
         // ഫ JSON 榡
         json result = {
-            { "Name", memoryInfo->name },
-            { "MemoryUsed", memoryInfo->memoryUsed },
-            { "MemoryAvailable", memoryInfo->memoryAvailable },
-            { "MemoryUtilization", memoryInfo->memoryUtilization },
-            { "VirtualMemoryUsed", memoryInfo->virtualMemoryUsed },
-            { "VirtualMemoryAvailable", memoryInfo->virtualMemoryAvailable },
-            { "VirtualMemoryUtilization", memoryInfo->virtualMemoryUtilization }
+            { "Name", frame.memory.name }
         };
-        // N JSON ഫ std::stringAAন System::String^
-        return msclr::interop::marshal_as<System::String^>(result.dump(DUMP_JSON_INDENT));
+        AddFields(result, MemoryFields, frame.memory);
+        if (!frame.memory.derived.Values.empty()) result["Derived"] = ToJson(frame.memory.derived);
+        // N JSON ഫ std::string (UTF-8)AAন System::String^
+        return FromUtf8String(result.dump(DUMP_JSON_INDENT));
     }
 
     // ഫxsTc JSON 榡
-    System::String^ HardwareInfo::GetStorageInfo() {
+    System::String^ HardwareInfo::SerializeStorageInfoDom(const HardwareFrame& frame) {
         // ഫ JSON 榡
         json result;
 
         // bj餺BzxsT
-        for (auto& storage : *storageInfoMap) {
-            json storageJson = {
-                { "UsedSpace", storage.second.usedSpace },
-                { "ReadActivity", storage.second.readActivity },
-                { "WriteActivity", storage.second.writeActivity },
-                { "TotalActivity", storage.second.totalActivity },
-                { "ReadRate", storage.second.readRate },
-                { "WriteRate", storage.second.writeRate }
-            };
+        for (auto& storage : frame.storage) {
+            json storageJson = json::object();
+            AddFields(storageJson, StorageFields, storage.second);
+            if (!storage.second.derived.Values.empty()) storageJson["Derived"] = ToJson(storage.second.derived);
             result[storage.first] = std::move(storageJson);
         }
 
-        // N JSON ഫ std::stringAAন System::String^
-        return msclr::interop::marshal_as<System::String^>(result.dump(DUMP_JSON_INDENT));
+        // N JSON ഫ std::string (UTF-8)AAন System::String^
+        return FromUtf8String(result.dump(DUMP_JSON_INDENT));
     }
 
     // ഫTc JSON 榡
-    System::String^ HardwareInfo::GetNetworkInfo() {
+    System::String^ HardwareInfo::SerializeNetworkInfoDom(const HardwareFrame& frame) {
         json result;
 
         try {
-            for (auto& network : *networkInfoMap) {
-                // ϥ std::wstring_convert ഫ std::wstring  std::string (UTF-8 sX)
-                std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-                std::string networkKey = converter.to_bytes(network.first); // N std::wstring ഫ std::string
-
-                json networkJson = {
-                    { "DataUploaded", network.second.dataUploaded },
-                    { "DataDownloaded", network.second.dataDownloaded },
-                    { "UploadSpeed", network.second.uploadSpeed },
-                    { "DownloadSpeed", network.second.downloadSpeed },
-                    { "NetworkUtilization", network.second.networkUtilization }
-                };
+            for (auto& network : frame.network) {
+                std::string networkKey = WideToUtf8(network.first);  // N std::wstring ഫ std::string (UTF-8ANzন@Ӧr)
+
+                json networkJson = json::object();
+                AddFields(networkJson, NetworkFields, network.second);
+                if (!network.second.derived.Values.empty()) networkJson["Derived"] = ToJson(network.second.derived);
                 result[networkKey] = std::move(networkJson);  // ϥ std::string @
                 //Console::WriteLine(gcnew String(networkKey.c_str(), 0, networkKey.length(), System::Text::Encoding::UTF8));
             }
@@ -404,4 +469,200 @@ namespace HardwareInfoDll {
             return "Error during JSON serialization";
         }
     }
-}
\ No newline at end of file
+
+    // ഫDOBSuper I/OBECBBqPqT JSON 榡
+    System::String^ HardwareInfo::SerializeDeviceInfoDom(const HardwareFrame& frame) {
+        json result;
+
+        for (auto& device : frame.devices) {
+            json deviceJson = {
+                { "Type", HardwareTypeName(device.second.hardwareType) }
+            };
+            if (device.second.hardwareType == BatteryHardware) AddFields(deviceJson, BatteryFields, device.second.battery);
+            for (const SensorGroup& group : device.second.groups) deviceJson[SensorTypeName(group.sensorType)] = ToJson(group.sensors);  // ̷P
+            if (!device.second.derived.Values.empty()) deviceJson["Derived"] = ToJson(device.second.derived);
+            result[device.first] = std::move(deviceJson);
+        }
+
+        return FromUtf8String(result.dump(DUMP_JSON_INDENT));
+    }
+
+    // ഫôέp JSON 榡GíwAU StringConversionsSinceBind  0
+    System::String^ HardwareInfo::GetBindingStats() {
+        json result = {
+            { "BindCount", bindCount },
+            { "PollCount", pollCount },
+            { "Slots", sensorSlots->size() },
+            { "BoundSensors", model->boundSlots.size() },
+            { "DerivedMetrics", derived->Count() },
+            { "TopologyAggregates", topologyAggregates->Count() },
+            { "Subscriptions", subscriptions->Count() },
+            { "SubscribedHardware", subscribedHardware },  // ݭnsw (Sq\ɬ)
+            { "StringConversions", StringConversions() },
+            { "StringConversionsSinceBind", StringConversions() - conversionsAtLastBind }
+        };
+
+        return msclr::interop::marshal_as<System::String^>(result.dump(DUMP_JSON_INDENT));
+    }
+
+    int HardwareInfo::GetSnapshotSize() {
+        FrameLease<HardwareFrame> lease(*frames);
+        return lease.Get() ? static_cast<int>(lease.Get()->snapshot.size()) : 0;
+    }
+
+    int HardwareInfo::CopySnapshot(array<System::Byte>^ buffer) {
+        if (buffer == nullptr) return -GetSnapshotSize();
+        if (buffer->Length == 0) return CopySnapshot(System::IntPtr::Zero, 0);
+
+        pin_ptr<System::Byte> pinned = &buffer[0];
+        return CopySnapshot(System::IntPtr(pinned), buffer->Length);
+    }
+
+    int HardwareInfo::CopySnapshot(System::IntPtr buffer, int size) {
+        FrameLease<HardwareFrame> lease(*frames);
+        const HardwareFrame* frame = lease.Get();
+        if (!frame) return 0;
+
+        int required = static_cast<int>(frame->snapshot.size());
+        if (size < required) return -required;
+
+        std::memcpy(buffer.ToPointer(), frame->snapshot.data(), required);
+        return required;
+    }
+
+    int HardwareInfo::CopyValues(array<float>^ values) {
+        FrameLease<HardwareFrame> lease(*frames);
+        const HardwareFrame* frame = lease.Get();
+        if (!frame) return 0;
+
+        int count = static_cast<int>(frame->Header().sensorCount);
+        if (values == nullptr || values->Length < count) return -count;
+        if (count == 0) return 0;
+
+        pin_ptr<float> pinned = &values[0];
+        std::memcpy(pinned, frame->snapshot.data() + sizeof(HwiSnapshotHeader), count * sizeof(float));
+        return count;
+    }
+
+    HardwareSnapshot^ HardwareInfo::AcquireSnapshot() {
+        int index;
+        const HardwareFrame* frame = frames->Acquire(index);
+        if (!frame) return nullptr;
+        return gcnew HardwareSnapshot(this, frame, index);
+    }
+
+    void HardwareInfo::ReleaseFrame(int index) {
+        if (frames) frames->Release(index);  // HardwareInfo wɤݭnk
+    }
+
+    HardwareSnapshot::HardwareSnapshot(HardwareInfo^ info, const HardwareFrame* pinnedFrame, int index)
+        : owner(info), frame(pinnedFrame), frameIndex(index) {}
+
+    HardwareSnapshot::~HardwareSnapshot() {
+        this->!HardwareSnapshot();
+    }
+
+    HardwareSnapshot::!HardwareSnapshot() {
+        if (frame) {
+            owner->ReleaseFrame(frameIndex);
+            frame = nullptr;
+        }
+    }
+
+    const HardwareFrame& HardwareSnapshot::Frame() {
+        if (!frame) throw gcnew System::ObjectDisposedException("HardwareSnapshot");
+        return *frame;
+    }
+
+    long long HardwareSnapshot::GetSequence() {
+        return static_cast<long long>(Frame().Header().sequence);
+    }
+
+    long long HardwareSnapshot::GetTimestamp() {
+        return Frame().Header().timestamp;
+    }
+
+    int HardwareSnapshot::GetCatalogVersion() {
+        return static_cast<int>(Frame().catalogVersion);
+    }
+
+    int HardwareSnapshot::GetSize() {
+        return static_cast<int>(Frame().snapshot.size());
+    }
+
+    System::IntPtr HardwareSnapshot::GetPointer() {
+        return System::IntPtr(const_cast<unsigned char*>(Frame().snapshot.data()));
+    }
+
+    System::String^ HardwareSnapshot::GetCPUInfo() {
+        return owner->SerializeCategory(CpuCategory, Frame());
+    }
+
+    System::String^ HardwareSnapshot::GetGPUInfo() {
+        return owner->SerializeCategory(GpuCategory, Frame());
+    }
+
+    System::String^ HardwareSnapshot::GetMemoryInfo() {
+        return owner->SerializeCategory(MemoryCategory, Frame());
+    }
+
+    System::String^ HardwareSnapshot::GetStorageInfo() {
+        return owner->SerializeCategory(StorageCategory, Frame());
+    }
+
+    System::String^ HardwareSnapshot::GetNetworkInfo() {
+        return owner->SerializeCategory(NetworkCategory, Frame());
+    }
+
+    System::String^ HardwareSnapshot::GetDeviceInfo() {
+        return owner->SerializeCategory(DeviceCategory, Frame());
+    }
+
+    System::String^ HardwareSnapshot::GetAllInfo() {
+        return owner->SerializeAll(Frame());
+    }
+
+    int HardwareInfo::GetCatalogVersion() {
+        return static_cast<int>(catalogVersion);
+    }
+
+    // ഫPؿ JSON 榡 (uݦb GetCatalogVersion ܮɭso)
+    System::String^ HardwareInfo::GetCatalog() {
+        json sensors = json::array();
+        bindingLock->EnterReadLock();  // IˮקKPsôPɶi
+        try {
+            for (size_t slot = 0; slot < sensorSlots->size(); ++slot) {
+                const SensorSlot& sensorSlot = (*sensorSlots)[slot];
+                sensors.push_back({
+                    { "Slot", slot },
+                    { "Identifier", sensorSlot.identifier },
+                    { "Hardware", sensorSlot.hardwareName },
+                    { "HardwareType", msclr::interop::marshal_as<std::string>(static_cast<HardwareType>(sensorSlot.hardwareType).ToString()) },
+                    { "Name", sensorSlot.name },
+                    { "SensorType", msclr::interop::marshal_as<std::string>(static_cast<SensorType>(sensorSlot.sensorType).ToString()) },
+                    { "Unit", UnitOf(sensorSlot.sensorType) }
+                });
+            }
+        }
+        finally {
+            bindingLock->ExitReadLock();
+        }
+
+        json result = {
+            { "CatalogVersion", catalogVersion },
+            { "Sensors", std::move(sensors) }
+        };
+
+        return msclr::interop::marshal_as<System::String^>(result.dump(DUMP_JSON_INDENT, ' ', true));
+    }
+
+    int HardwareInfo::CopyCatalog(HwiCatalogEntry* entries, int capacity) {
+        bindingLock->EnterReadLock();
+        try {
+            return model->FillCatalog(entries, capacity);
+        }
+        finally {
+            bindingLock->ExitReadLock();
+        }
+    }
+}
@@ -1,7 +1,27 @@
 ﻿#pragma once
 
+#include <atomic>
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include <vcclr.h>
+
+#include "SnapshotLayout.h"
+#include "HardwareModel.h"
+#include "SensorModel.h"
+#include "AdaptiveSampling.h"
+#include "AlertRules.h"
+#include "DeltaStream.h"
+#include "DerivedMetrics.h"
+#include "Diagnostics.h"
+#include "FleetCollector.h"
+#include "FramePublisher.h"
+#include "MetricsExporter.h"
+#include "SensorHistory.h"
+#include "SeriesRecorder.h"
+#include "SharedSnapshot.h"
+#include "Subscriptions.h"
+#include "TopologyAggregates.h"
 
 #using "LibreHardwareMonitorLib.dll"
 using namespace LibreHardwareMonitor::Hardware;
@@ -26,103 +46,439 @@ namespace HardwareInfoDll {
         virtual void VisitParameter(LibreHardwareMonitor::Hardware::IParameter^ parameter) {}
     };
 
-    // 定義 CPU 資訊結構
-    struct CpuInfo {
-        std::string Name;
-        float CPUUsage = 0.0;
-        float MaxCoreUsage = 0.0;
-        std::unordered_map<std::string, float> CoreLoad;
-        std::unordered_map<std::string, float> CoreTemperature;
-        std::unordered_map<std::string, float> CoreVoltage;
-        std::unordered_map<std::string, float> CoreClock;
-        float MaxTemperature = 0.0;
-        float PackageTemperature = 0.0;
-        float AverageTemperature = 0.0;
-        float BusSpeed = 0.0;
-        float CPUVoltage = 0.0;
-        float PackagePower = 0.0;
-        float CoresPower = 0.0;
-        int Cores = 0;
-        int Threads = 0;
-    };
-
-    struct GpuSensorInfo {
-        std::string Type;
-        float Value = 0.0;
-
-        GpuSensorInfo() {}
-        GpuSensorInfo(const std::string& type, float value) : Type(type), Value(value) {}
-    };
-
-    struct MemoryInfo {
-        std::string name;  // hardware name
-        float memoryUsed = 0.0;  // 已使用記憶體
-        float memoryAvailable = 0.0;  // 可用記憶體
-        float memoryUtilization = 0.0;  // 記憶體使用率
-        float virtualMemoryUsed = 0.0;  // 已使用虛擬記憶體
-        float virtualMemoryAvailable = 0.0;  // 可用虛擬記憶體
-        float virtualMemoryUtilization = 0.0;  // 虛擬記憶體使用率
-    };
-
-    struct StorageInfo {
-        float usedSpace = 0.0;  // 已使用空間
-        float readActivity = 0.0;  // 讀取活動
-        float writeActivity = 0.0;  // 寫入活動
-        float totalActivity = 0.0;  // 總活動
-        float readRate = 0.0;  // 讀取速度
-        float writeRate = 0.0;  // 寫入速度
-    };
-
-    struct NetworkInfo {
-        float dataUploaded = 0.0;  // 上傳數據
-        float dataDownloaded = 0.0;  // 下載數據
-        float uploadSpeed = 0.0;  // 上傳速度
-        float downloadSpeed = 0.0;  // 下載速度
-        float networkUtilization = 0.0;  // 網路利用率
+    std::string ToUtf8String(System::String^ value);  // 轉成 UTF-8 (marshal_as<std::string> 會轉成系統 ANSI 字碼頁)
+
+    System::String^ FromUtf8String(const std::string& value);  // 由 UTF-8 轉回 System::String
+
+    System::String^ FromUtf16String(const std::u16string& value);  // 由 UTF-16 緩衝區直接建立 System::String (不轉換)
+
+    ref class ComputerEvents;
+
+    // Computer 的類別開關 (Is*Enabled)，一個類別可能涵蓋多種 HardwareType
+    enum ComputerClass {
+        CpuClass,
+        MemoryClass,
+        GpuClass,
+        MotherboardClass,
+        ControllerClass,
+        NetworkClass,
+        StorageClass,
+        PsuClass,
+        BatteryClass,
+        ComputerClassCount
+    };
+
+    int ClassOf(int hardwareType);  // HardwareType 所屬的類別
+
+    uint32_t ClassHardwareMask(int computerClass);  // 類別涵蓋的 SourceHardwareType 位元
+
+    const char* ClassName(int computerClass);
+
+    // 開啟一個類別的耗時 (毫秒)
+    struct ClassStartup {
+        bool opened = false;
+        double openMs = 0.0;  // 建立群組 (Is*Enabled = true)
+        double updateMs = 0.0;  // 第一次 Update()
+        double readyAtMs = 0.0;  // 從開始開啟到資料可讀 (含重新繫結與發布)
+        int hardwareCount = 0;
+    };
+
+    // LibreHardwareMonitor 來源：列舉時把 IHardware/ISensor 轉成描述 (只在拓撲改變時轉換字串)，
+    // 更新時只呼叫 IHardware::Update() (子硬體先更新上層) 並讀取 ISensor::Value
+    class ComputerSource : public SensorSource {
+        gcroot<Computer^> computer;
+        gcroot<array<IHardware^>^> hardware;  // 最後一次列舉的硬體 (子硬體攤平在上層之後)
+        gcroot<array<int>^> parents;  // 與 hardware 對齊的上層位置 (-1 表示頂層)
+        gcroot<array<array<ISensor^>^>^> sensors;  // 與 hardware 對齊的感測器
+        gcroot<ComputerEvents^> events;  // 硬體/感測器新增移除時遞增 topologyVersion
+        gcroot<System::Object^> enableLock;  // 同時只有一個執行緒開關類別
+        std::atomic<unsigned int> topologyVersion{ 0 };  // 平行開啟類別時事件可能同時觸發
+        long long stringConversions = 0;  // 字串轉換次數 (穩定狀態應維持不變)
+        uint32_t enabledMask = 0;  // 要求開啟的硬體類型
+        bool classEnabled[ComputerClassCount] = {};  // 已開啟的類別
+        bool opened = false;  // 已呼叫 Computer::Open()
+        long long startedAt;  // 建立時的 Stopwatch 刻度 (readyAtMs 的起點)
+        double computerOpenMs = 0.0;  // Computer::Open() 的耗時 (驅動程式與 SMBIOS)
+        ClassStartup startup[ComputerClassCount];
+
+        public:
+        explicit ComputerSource(Computer^ monitoredComputer);
+        ~ComputerSource();
+
+        void Enumerate(std::vector<SourceHardware>& result) override;
+        void Update(size_t hardwareIndex, float* values) override;
+        void EnableHardware(uint32_t typeMask) override;
+
+        // 平行開啟 typeMask 需要的類別，每個類別建立群組並完成第一次 Update() 後，
+        // 在開啟它的執行緒呼叫 classReady(類別)；Computer 尚未開啟時只記錄 typeMask
+        void EnableHardware(uint32_t typeMask, System::Action<int>^ classReady);
+
+        void Open();  // 開啟 Computer (不含任何類別，只載入驅動程式與 SMBIOS)
+        void OpenClass(int computerClass);  // 開啟一個類別並更新一次 (不同類別可同時呼叫)
+
+        double ElapsedMs() const;  // 距離建立的時間
+
+        double ComputerOpenMs() const {
+            return computerOpenMs;
+        }
+
+        ClassStartup& Startup(int computerClass) {
+            return startup[computerClass];
+        }
+
+        unsigned int TopologyVersion() const override {
+            return topologyVersion.load();
+        }
+
+        void Invalidate() {
+            topologyVersion.fetch_add(1);
+        }
+
+        long long StringConversions() const {
+            return stringConversions;
+        }
+    };
+
+    // 背景取樣群組：每個 HardwareType 有自己的週期與工作執行緒
+    struct SamplingGroup {
+        int hardwareType = 0;  // HardwareType
+        volatile int intervalMs = 1000;  // 取樣週期 (毫秒)
+        long long updates = 0;  // 完成的取樣次數
+        long long missedDeadlines = 0;  // 因為更新太慢而錯過的週期數
+        double lastDurationMs = 0.0;  // 最近一次更新花費的時間
+        double maxDurationMs = 0.0;  // 最長一次更新花費的時間
+    };
+
+    // JSON 序列化方式
+    public enum class JsonSerializerKind {
+        Dom,  // 建立 nlohmann::json DOM 後 dump()
+        Streaming  // 直接由結構串流輸出
+    };
+
+    // 衍生指標的計算方式 (與 DerivedKind 相同的數值)
+    public enum class DerivedMetricKind {
+        Rate,  // 累計值每秒的變化 x parameter
+        Ewma,  // 指數加權移動平均，parameter 為時間常數 (秒)
+        Average,  // 最近 parameter 次更新的平均
+        Throttling  // 時脈感測器：同名溫度達到 parameter (°C) 且時脈低於峰值 10% 時為 1
+    };
+
+    // 快取的 JSON 結果，以單一參考整體替換，避免文字與世代不一致
+    ref class CachedJson {
+        public:
+        System::String^ Text;
+        long long Generation;
+
+        CachedJson(System::String^ text, long long generation) : Text(text), Generation(generation) {}
+    };
+
+    // 歷史查詢結果的一個區間
+    public value struct SensorHistoryPoint {
+        long long Timestamp;  // 區間起始時間 (Unix epoch 微秒)
+        float Min;
+        float Max;
+        float Average;
+        float Last;
+        int Count;  // 區間內的樣本數 (0 表示沒有數值)
+    };
+
+    // 時間序列錄製讀回的一筆樣本
+    public value struct SensorSeriesPoint {
+        long long Timestamp;  // 取樣時間 (Unix epoch 微秒，毫秒精度)
+        float Value;
+    };
+
+    // 變化串流中的一個感測器
+    public value struct SensorDelta {
+        int Slot;  // 槽位 (與 CopyValues、GetCatalog 相同)
+        float Value;  // NaN 表示感測器不再有數值
     };
 
+    // 一次發布中超過門檻的感測器
+    public value struct SensorDeltaBatch {
+        long long Sequence;  // 連續遞增，不連續時表示有批次遺失 (需要重新同步)
+        long long Timestamp;  // 取樣時間 (Unix epoch 微秒)
+        int CatalogVersion;  // 目錄版本
+        array<SensorDelta>^ Changes;
+    };
+
+    // 警示規則的條件 (與 AlertCondition 相同的數值)
+    public enum class SensorAlertCondition {
+        Above,  // 數值大於 threshold
+        Below,  // 數值小於 threshold
+        Rising,  // 每秒上升超過 threshold
+        Falling  // 每秒下降超過 threshold
+    };
+
+    // 警示的觸發或解除
+    public value struct SensorAlert {
+        int RuleId;  // AddAlertRule 回傳的編號
+        int Slot;  // 槽位 (與 CopyValues、GetCatalog 相同)
+        System::String^ Identifier;
+        bool Firing;  // true 為觸發、false 為解除
+        float Value;  // 當時的數值 (變化率條件為每秒變化)
+        long long Timestamp;  // 取樣時間 (Unix epoch 微秒)
+    };
+
+    public delegate void SensorAlertHandler(SensorAlert alert);
+
+    // 集中收集的彙總方式 (與 FleetReduce 相同的數值)：每台主機與跨主機使用相同的方式
+    public enum class FleetReduction {
+        Max,
+        Min,
+        Sum,
+        Average
+    };
+
+    ref class SamplingWorker;
+    ref class HardwareSnapshot;
+    ref class HardwareSubscription;
+    ref class HardwareInfoView;
+
     public ref class HardwareInfo {
-        Computer^ computer = gcnew Computer();
+        Computer^ computer;  // LibreHardwareMonitor (使用合成或重播來源時為 nullptr)
         System::Threading::Mutex^ gpuUpdateMutex = gcnew System::Threading::Mutex();  // Mutex 用來避免重入
 
-        // 定義硬體處理函數
+        // 感測器來源與繫結 (穩定狀態下輪詢只複製浮點數，不做任何字串處理)
+        SensorSource* source;  // 硬體描述與數值的來源
+        ComputerSource* computerSource = nullptr;  // source 為 LibreHardwareMonitor 時指向同一個物件
+        SensorModel* model;  // 槽位、結構欄位與每個硬體的繫結區段
+        unsigned int boundTopology = 0;  // 繫結時的來源拓撲版本
+        long long bindCount = 0;  // 重新繫結次數
+        long long pollCount = 0;  // 輪詢次數
+        long long conversionsAtLastBind = 0;  // 最後一次繫結後的字串轉換總數
+
+        void Initialize(SensorSource* sensorSource);  // 配置原生狀態並完成第一次繫結
+        bool BindingsStale();  // 來源的硬體或感測器集合已改變
+        void RebindSensors();  // 重新列舉並解析所有感測器的槽位
+        void EnsureBindings();  // 需要時在寫入鎖內重新繫結
+        void PollBindings(bool gpu);  // 只複製浮點數到已繫結的槽位
+        long long StringConversions();  // 來源的字串轉換總數
+        void RunGpuUpdate();  // SaveAllHardware 排入的 GPU 更新 (記錄重疊與略過)
+
+        // 自我量測 (Update()、處理函數、序列化耗時與資料年齡)
+        PollDiagnostics* diagnostics;
+
+        // JSON 快取 (資料沒有改變時直接重用上一次的結果)
+        array<long long>^ categoryGeneration = gcnew array<long long>(InfoCategoryCount);  // 每個類別的資料世代
+        array<CachedJson^>^ cachedJson = gcnew array<CachedJson^>(InfoCategoryCount);  // 每個類別的快取結果
+        JsonSerializerKind serializerKind = JsonSerializerKind::Streaming;  // 目前使用的序列化方式
+
+        System::String^ GetCachedJson(InfoCategory category);  // 世代未變時回傳快取
+        System::String^ SerializeCPUInfoDom(const HardwareFrame& frame);
+        System::String^ SerializeGPUInfoDom(const HardwareFrame& frame);
+        System::String^ SerializeMemoryInfoDom(const HardwareFrame& frame);
+        System::String^ SerializeStorageInfoDom(const HardwareFrame& frame);
+        System::String^ SerializeNetworkInfoDom(const HardwareFrame& frame);
+        System::String^ SerializeDeviceInfoDom(const HardwareFrame& frame);
+
+        // GetAllInfo 的 UTF-16 緩衝區與快取 (以 allInfoLock 保護)
+        System::Object^ allInfoLock = gcnew System::Object();
+        std::u16string* allInfoBuffer;  // 重複使用，穩定狀態下不配置
+        System::String^ allInfoText;  // 上一次的結果
+        long long allInfoGeneration = -1;  // allInfoText 對應的世代總和
+
+        // 發布的 frame (讀者固定 frame 讀取，不會阻塞取樣)
+        FramePublisher<HardwareFrame>* frames;
+        unsigned long long snapshotSequence = 0;  // 取樣序號
+        unsigned int catalogVersion = 0;  // 目錄版本
+        int publishPending = 0;  // 有新的數值等待發布
+        int publishing = 0;  // 有執行緒正在寫入 frame
+
+        void PublishSnapshot();  // 將 sensorValues 發布為新的 frame
+        void WriteFrame();  // 寫入並發布一個 frame (同時只有一個執行緒)
+
+        // 感測器歷史 (每次發布 frame 時記錄)
+        SensorHistory* history;
+
+        // 共享記憶體發布 (其他處理程序不需要自己開啟 Computer)
+        SharedSnapshotWriter* sharedWriter = nullptr;
+        std::vector<HwiCatalogEntry>* sharedCatalog;  // 目錄暫存 (只在目錄改變時使用)
+        unsigned int sharedCatalogVersion = 0;  // 已寫入共享記憶體的目錄版本
+
+        void AcquirePublishing();  // 等待目前的 frame 寫入結束並暫停發布
+        void PublishShared(const HardwareFrame& frame);  // 將 frame 寫入共享記憶體
+
+        // 軌跡錄製 (可用 CreateReplay 重播)
+        TraceWriter* traceWriter = nullptr;
+        unsigned int traceCatalogVersion = 0;  // 已寫入軌跡的目錄版本
+
+        void RecordTrace(const HardwareFrame& frame);  // 將 frame 的來源數值寫入軌跡
+
+        // 時間序列錄製 (壓縮的欄式區段檔，長期保存)
+        SeriesRecorder* seriesRecorder = nullptr;
+
+        // 集中收集的送出端 (每次發布 frame 時送出，未達間隔時略過)
+        FleetSender* fleetSender = nullptr;
+
+        // OpenMetrics 端點 (範本只在目錄改變時產生)
+        MetricsExporter* metricsExporter = nullptr;
+
+        // 變化串流 (只送出超過門檻的感測器)
+        DeltaStream* deltaStream;
+
+        // 衍生指標 (每個硬體更新後計算，重新繫結時依規則配置槽位)
+        DerivedMetrics* derived;
+
+        void ChangeDerivedRules(const std::vector<DerivedRule>& rules, bool append);  // 加入或替換規則並重新繫結
+
+        // 拓撲彙總 (CPU 更新後計算各封裝、L3 網域與效能/效率核心的統計，重新繫結時依拓撲分組)
+        TopologyAggregates* topologyAggregates;
+
+        // 警示規則 (每次發布 frame 時評估，事件在 frame 發布後依序送出)
+        AlertEngine* alerts;
+        std::vector<AlertEvent>* alertScratch;  // 評估結果 (只有發布 frame 的執行緒使用)
+        std::vector<AlertEvent>* alertQueue;  // 等待送出的事件 (以 alertLock 保護)
+        System::Object^ alertLock = gcnew System::Object();
+        int alertsQueued = 0;  // alertQueue 有事件
+        int alertDispatching = 0;  // 有執行緒正在送出事件
+        long long alertsDelivered = 0;
+        long long alertHandlerErrors = 0;  // AlertChanged 處理函數丟出的例外數
+        HwiAlertCallback alertCallback = nullptr;  // C 介面的回呼 (以 alertLock 保護)
+        void* alertContext = nullptr;
+
+        void QueueAlerts();  // 將 alertScratch 加入 alertQueue
+        void DispatchAlerts();  // 送出等待中的事件 (同時只有一個執行緒，依發生順序；持有繫結鎖時不送出)
+
+        // 訂閱 (只更新訂閱需要的硬體，只開啟訂閱到的類別)
+        SubscriptionSet* subscriptions;
+        uint32_t defaultHardware = 0xFFFFFFFF;  // 沒有任何訂閱時開啟的類別
+        uint32_t enabledHardware = 0xFFFFFFFF;  // 目前開啟的類別
+        uint32_t subscribedTypes = 0xFFFFFFFF;  // 有需要更新的硬體的類型 (背景取樣依此建立群組)
+        uint32_t sampledTypes = 0;  // 背景取樣群組涵蓋的類型
+        size_t subscribedHardware = 0;  // 需要更新的硬體數
+        bool gpuSubscribed = true;  // 有需要更新的 GPU (沒有時 SaveAllHardware 不排入 GPU 更新)
+
+        // 背景開啟 (各類別平行開啟，每個類別完成時重新繫結並發布)
+        System::Threading::Tasks::Task^ startupTask;  // 所有類別開啟完成
+        array<System::Threading::Tasks::TaskCompletionSource<bool>^>^ classReady;  // 每個 ComputerClass 開啟完成
+
+        void OpenComputer(uint32_t hardwareMask, bool wait);  // 建立 Computer 並在背景開啟 hardwareMask 的類別
+        void RunStartup();  // 背景開啟的工作
+        void OnClassReady(int computerClass);  // 類別開啟完成：重新繫結並發布
+        void WaitForStartup();  // 等待背景開啟結束 (開啟失敗時不丟出例外)
+        void ApplySubscriptions();  // 在寫入鎖內依訂閱開關類別並重新計算需要更新的硬體
+        void UpdateSubscribed();  // 依訂閱設定每個繫結是否需要更新 (繫結改變後呼叫)
+        void RestartSamplingIfNeeded();  // 訂閱的類型改變時重建背景取樣群組
+
+        // 背景取樣 (呼叫端不再需要自己執行 Update())
+        std::vector<SamplingGroup>* samplingGroups;  // 執行中的取樣群組
+        std::unordered_map<int, int>* samplingIntervals;  // HardwareType -> 取樣週期 (毫秒)
+        System::Collections::Generic::List<System::Threading::Thread^>^ samplingThreads = gcnew System::Collections::Generic::List<System::Threading::Thread^>();
+        System::Threading::ManualResetEvent^ samplingStop = gcnew System::Threading::ManualResetEvent(false);  // 通知工作執行緒結束
+        System::Threading::ReaderWriterLockSlim^ bindingLock = gcnew System::Threading::ReaderWriterLockSlim();  // 更新時讀取鎖，重新繫結時寫入鎖
+        volatile bool samplingActive = false;  // 背景取樣中
+
+        // 處理程序共用的取樣核心 (Attach 建立，最後一個 view Dispose 時關閉，以 sharedLock 保護)
+        static System::Object^ sharedLock = gcnew System::Object();
+        static HardwareInfo^ sharedCore;
+        static int sharedViews = 0;
+        static int unrestrictedViews = 0;  // 沒有自己訂閱的 view (需要預設的所有類別)
+        static System::Collections::Generic::List<HardwareSubscription^>^ defaultSubscriptions;  // 有 view 訂閱時代替其他 view 訂閱預設類別
+
+        static void UpdateDefaultSubscriptions();  // 依 view 的訂閱狀態加入或移除 defaultSubscriptions
+        AdaptiveSampler* adaptiveSampler;  // 依變化率與 CPU 預算決定各群組的實際週期 (停用時只統計耗時)
+
+        internal:
+        bool PollHardware(size_t bindingIndex);  // 更新單一硬體並複製數值，回傳是否有數值改變
+        void SamplingLoop(SamplingWorker^ worker);  // 取樣群組的工作執行緒
+        System::String^ SerializeCategory(InfoCategory category, const HardwareFrame& frame);  // 依序列化方式產生 JSON
+        void ReleaseFrame(int index);  // HardwareSnapshot 釋放固定的 frame
+        System::String^ SerializeAll(const HardwareFrame& frame);  // 以共用的 UTF-16 緩衝區輸出所有類別
+
+        // 使用指定的來源 (取得 sensorSource 的擁有權)
+        HardwareInfo(SensorSource* sensorSource) {
+            Initialize(sensorSource);
+        }
+
+        // 使用 LibreHardwareMonitor，沒有任何訂閱時開啟 hardwareMask 中的類別 (wait 為 false 時在背景開啟)
+        HardwareInfo(uint32_t hardwareMask, bool wait) {
+            OpenComputer(hardwareMask, wait);
+        }
+
+        int AddSubscription(int hardwareType, System::String^ sensorPattern);  // 登記訂閱，回傳識別碼
+        unsigned long long LatestSequence();  // 最新 frame 的取樣序號 (尚未發布時為 0)
+        void EnsureDeltaStream();  // 變化串流尚未開始時以預設容量開始 (view 共用)
+        static HardwareSubscription^ SubscribeShared(bool firstSubscription, HardwareType type, System::String^ sensorPattern);  // view 的訂閱 (第一個訂閱時不再需要預設類別)
+        static void Detach(System::Collections::Generic::List<HardwareSubscription^>^ subscriptions, bool unrestricted);  // view Dispose 時呼叫
+        void Unsubscribe(int id);  // 移除訂閱 (HardwareSubscription::Dispose 呼叫)
+
+        // 定義硬體處理函數 (指向 model 內的結構)
         public:
         CpuInfo* cpuInfo;  // CPU 資訊
-        std::unordered_map<std::string, std::unordered_map<std::string, GpuSensorInfo>>* gpuInfoMap;  // GPU 資訊
+        GpuInfoMap* gpuInfoMap;  // GPU 資訊
         MemoryInfo* memoryInfo;  // 記憶體資訊
-        std::unordered_map<std::string, StorageInfo>* storageInfoMap;  // 儲存資訊
-        std::unordered_map<std::wstring, NetworkInfo>* networkInfoMap;  // 網路資訊
+        StorageInfoMap* storageInfoMap;  // 儲存資訊
+        NetworkInfoMap* networkInfoMap;  // 網路資訊
+        DeviceInfoMap* deviceInfoMap;  // 主機板、Super I/O、EC、散熱控制器、電源供應器與電池資訊
+
+        std::vector<SensorSlot>* sensorSlots;  // 感測器槽位
+        std::vector<float>* sensorValues;  // 槽位對應的最新數值
+        std::unordered_map<std::string, size_t>* slotIndex;  // Identifier -> 槽位
 
         // TODO: 請在此新增此類別的方法。
         public:
         HardwareInfo() {
-            this->computer->IsCpuEnabled = true;
-            this->computer->IsGpuEnabled = true;
-            this->computer->IsMemoryEnabled = true;
-            //this->computer->IsMotherboardEnabled = true;
-            this->computer->IsNetworkEnabled = true;
-            this->computer->IsStorageEnabled = true;
-            //this->computer->IsPsuEnabled = true;
-            //this->computer->IsBatteryEnabled = true;
-            this->computer->Open();
-            this->computer->Accept(gcnew UpdateVisitor());
-
-            cpuInfo = new CpuInfo();  // 初始化 CPU 資訊
-            gpuInfoMap = new std::unordered_map<std::string, std::unordered_map<std::string, GpuSensorInfo>>();  // 初始化 GPU 資訊
-            memoryInfo = new MemoryInfo();  // 初始化記憶體資訊
-            storageInfoMap = new std::unordered_map<std::string, StorageInfo>;  // 初始化儲存資訊
-            networkInfoMap = new std::unordered_map<std::wstring, NetworkInfo>;  // 初始化網路資訊
+            OpenComputer(DefaultHardwareMask, true);  // CPU、GPU、記憶體、網路與儲存 (平行開啟，完成後才回傳)
         }
         ~HardwareInfo() {
-            this->computer->Close();
+            WaitForStartup();  // 開啟中的類別完成後才能關閉 Computer
+            StopSampling();
+            StopSharedPublisher();
+            StopTraceRecording();
+            StopSeriesRecording();  // 寫入未滿的區塊與區段索引
+            StopMetricsServer();
+            StopFleetSender();
+            StopDeltaStream();  // 喚醒等待 ReadDeltas 的執行緒
 
-            delete cpuInfo;
-            delete gpuInfoMap;
-            delete memoryInfo;
-            delete storageInfoMap;
-            delete networkInfoMap;
+            delete source;  // 先取消硬體事件再關閉 Computer
+            source = nullptr;
+            computerSource = nullptr;
+            if (computer != nullptr) this->computer->Close();
+
+            delete model;
+            delete subscriptions;
+            subscriptions = nullptr;  // 之後 Dispose 的 HardwareSubscription 不再有作用
+            delete diagnostics;
+            delete samplingGroups;
+            delete samplingIntervals;
+            delete adaptiveSampler;
+            delete frames;
+            frames = nullptr;
+            delete history;
+            delete sharedCatalog;
+            delete deltaStream;
+            delete derived;
+            delete topologyAggregates;
+            delete alerts;
+            delete alertScratch;
+            delete alertQueue;
+            delete allInfoBuffer;
         }
 
+        static HardwareInfo^ CreateSynthetic(int threads, int gpus, int disks, int nics);  // 使用合成拓撲 (不需要感測器硬體或系統管理員權限，效能測試用)
+
+        static HardwareInfo^ CreateReplay(System::String^ path);  // 重播 StartTraceRecording 錄製的軌跡 (無法讀取時丟出 ArgumentException)
+
+        static HardwareInfo^ CreateOnDemand();  // 不開啟任何硬體類別，只依 Subscribe 開啟需要的類別 (輕量代理程式用)
+
+        // 立即回傳，預設類別在背景平行開啟；每個類別開啟完成時即可讀取 (CPU 與記憶體不必等待儲存或 GPU)
+        static HardwareInfo^ OpenInBackground();
+
+        // 連接到處理程序共用的取樣核心：第一個 Attach 以 OpenInBackground 開啟並啟動背景取樣，之後的 Attach 只建立 view。
+        // 多個外掛各自 Attach 時只有一個 Computer 與一組取樣執行緒，輪詢成本與 view 的數量無關；最後一個 view Dispose 時關閉核心
+        static HardwareInfoView^ Attach();
+
+        static int GetAttachedViews();  // 目前連接到共用核心的 view 數
+
+        System::Threading::Tasks::Task^ WhenReady();  // 所有類別開啟完成 (開啟失敗時為 Faulted)
+
+        System::Threading::Tasks::Task^ WhenReady(HardwareType type);  // type 所屬的類別開啟完成 (沒有要開啟的類別時已完成)
+
+        bool IsReady();  // 所有類別開啟完成
+
+        System::String^ GetStartupStats();  // 獲取開啟各階段的耗時 (Computer::Open、各類別建立群組、第一次 Update() 與可讀取的時間)
+
         void PrintAllHardware();  // 保存所有硬體資訊
 
         void SaveAllHardware();  // 保存所有硬體資訊
@@ -138,5 +494,325 @@ namespace HardwareInfoDll {
         System::String^ GetStorageInfo();  // 獲取儲存資訊
 
         System::String^ GetNetworkInfo();  // 獲取網路資訊
+
+        // 獲取主機板、Super I/O、EC、散熱控制器、電源供應器與電池資訊：{ 硬體名稱: { "Type", 每種感測器類型 { 名稱: 數值 } } }，
+        // 電池另有 ChargeLevel、RemainingCapacity 等欄位。這些類別預設不開啟，請先以 Subscribe 訂閱 (沒有任何裝置時為 null)
+        System::String^ GetDeviceInfo();
+
+        // 一次獲取所有類別 { "CPU", "GPU", "Memory", "Storage", "Network", "Device" } (各類別與 Get*Info 相同，來自同一次取樣)，
+        // 直接輸出 UTF-16，每次呼叫最多配置一個字串 (資料沒有改變時不配置)
+        System::String^ GetAllInfo();
+
+        void SetJsonSerializer(JsonSerializerKind kind);  // 切換序列化方式 (會清除快取)
+
+        void InvalidateJsonCache();  // 清除 JSON 快取 (效能測試用)
+
+        System::String^ GetBindingStats();  // 獲取繫結統計 (用來確認穩定狀態沒有字串處理)
+
+        void SetSamplingInterval(HardwareType type, int milliseconds);  // 設定某類硬體的取樣週期
+
+        int GetSamplingInterval(HardwareType type);  // 獲取某類硬體的取樣週期 (毫秒)
+
+        void StartSampling();  // 啟動背景取樣 (之後 SaveAllHardware 不再需要呼叫)
+
+        void StopSampling();  // 停止背景取樣並等待工作執行緒結束 (在取樣執行緒上呼叫時丟出 InvalidOperationException)
+
+        // 依各群組最近的變化率調整取樣週期 (設定週期的 1/4 到 16 倍)：數值變化快時縮短，穩定時每次最多延長一倍。
+        // cpuBudgetPercent 大於 0 時估計取樣使用的 CPU (單一核心的百分比，例如 0.5)，超過時同比例延長所有群組的週期
+        void EnableAdaptiveSampling(double cpuBudgetPercent);
+
+        void DisableAdaptiveSampling();  // 恢復固定週期並取消 CPU 預算
+
+        System::String^ GetSamplingStats();  // 獲取各群組的取樣次數、耗時、錯過的週期、實際週期與 CPU 預算使用量
+
+        int GetSnapshotSize();  // 快照位元組數 (標頭 + 數值)
+
+        int CopySnapshot(array<System::Byte>^ buffer);  // 複製快照，buffer 不足時回傳負的所需大小
+
+        int CopySnapshot(System::IntPtr buffer, int size);  // 複製快照到非受控記憶體
+
+        int CopyValues(array<float>^ values);  // 只複製數值 (依槽位排列)
+
+        HardwareSnapshot^ AcquireSnapshot();  // 固定最新的 frame (使用完畢請 Dispose)，尚無資料時回傳 nullptr
+
+        array<SensorHistoryPoint>^ GetHistory(System::String^ sensorId, long long from, long long to, int resolutionSeconds);  // 獲取歷史 (依 Identifier)
+
+        array<SensorHistoryPoint>^ GetHistory(int slot, long long from, long long to, int resolutionSeconds);  // 獲取歷史 (依槽位)
+
+        void ConfigureHistory(array<int>^ resolutionSeconds, array<int>^ capacities, int maxSensors);  // 重新設定歷史解析度 (清除既有歷史)
+
+        System::String^ GetHistoryInfo();  // 獲取歷史設定與記憶體用量
+
+        bool StartSharedPublisher(System::String^ name, int capacity);  // 開始將每次取樣發布到具名共享記憶體 (名稱已被使用時回傳 false)
+
+        void StopSharedPublisher();  // 停止發布並移除共享記憶體
+
+        int GetCatalogVersion();  // 目錄版本 (感測器集合改變時遞增)
+
+        System::String^ GetCatalog();  // 獲取感測器目錄 (名稱、類型、單位)
+
+        bool StartTraceRecording(System::String^ path);  // 開始將每次取樣錄製到軌跡檔 (無法建立時回傳 false)
+
+        void StopTraceRecording();  // 停止錄製並關閉軌跡檔
+
+        // 開始將取樣 (至少間隔 intervalMilliseconds) 錄製到 directory 的壓縮區段檔 (hwts-*.hwts)，
+        // 數值沒有改變時每個只需 1 位元；區段依大小或涵蓋時間輪替，感測器集合改變時也換新的區段。
+        // 壓縮與寫入在背景執行緒進行，目錄不存在或無法建立檔案時回傳 false
+        bool StartSeriesRecording(System::String^ directory, int intervalMilliseconds);
+
+        bool StartSeriesRecording(System::String^ directory, int intervalMilliseconds, long long maxSegmentBytes, int maxSegmentSeconds);
+
+        void StopSeriesRecording();  // 停止錄製 (寫入未滿的區塊與區段索引)
+
+        System::String^ GetSeriesRecordingStats();  // 獲取錄製的區段數、取樣數與每個數值的位元組數 (未錄製時為 null)
+
+        // 讀回 directory 中 Identifier 為 sensorId 的感測器在 [from, to] (Unix epoch 微秒) 的樣本，
+        // 只解碼時間重疊的區塊中的這一個感測器 (錄製中的區段也可讀取，不需要 HardwareInfo)
+        static array<SensorSeriesPoint>^ ReadSeries(System::String^ directory, System::String^ sensorId, long long from, long long to);
+
+        bool StartMetricsServer(int port);  // 在 127.0.0.1:port 提供 GET /metrics (OpenMetrics)，port 為 0 時由系統指定，無法接受連線時回傳 false
+
+        bool StartMetricsServer(System::String^ address, int port);  // 在指定的 IPv4 位址提供 GET /metrics (例如 "0.0.0.0" 讓其他主機 scrape)
+
+        void StopMetricsServer();  // 停止 OpenMetrics 端點
+
+        int GetMetricsPort();  // OpenMetrics 端點實際使用的連接埠 (未啟動時為 0)
+
+        // 開始將取樣 (至少間隔 intervalMilliseconds) 送到 HardwareFleetCollector：endpoint 為 "udp://位址:連接埠" (IPv4) 或 "unix:路徑"，
+        // hostName 為 null 時使用電腦名稱，group 為彙總的分組 (例如機櫃)。不等待收集端，端點不正確時回傳 false
+        bool StartFleetSender(System::String^ endpoint, System::String^ hostName, System::String^ group, int intervalMilliseconds);
+
+        void StopFleetSender();
+
+        System::String^ GetFleetSenderStats();  // 獲取送出的取樣數、封包數、位元組數與失敗數 (未送出時為 null)
+
+        void EnableDiagnostics(bool enabled);  // 開始/停止記錄耗時 (GPU 略過與重疊次數一律記錄)
+
+        void ResetDiagnostics();  // 清除所有耗時與計數
+
+        System::String^ GetDiagnostics();  // 獲取各硬體 Update()、處理函數與序列化的耗時分布、GPU 略過次數與資料年齡
+
+        // 登記需要的資料：之後只更新至少被一個訂閱需要的硬體 (有感測器名稱符合 sensorPattern 的同類型硬體)，
+        // 並只開啟訂閱到的類別。sensorPattern 可使用 '*' 與 '?' (不分大小寫)，nullptr 表示所有感測器。
+        // Dispose 取消訂閱；最後一個訂閱取消後恢復更新所有硬體
+        HardwareSubscription^ Subscribe(HardwareType type, System::String^ sensorPattern);
+
+        void StartDeltaStream(int capacity);  // 開始記錄變化並保留最近 capacity 個批次 (第一個批次包含所有感測器)
+
+        void StopDeltaStream();  // 停止記錄變化
+
+        // 設定 Identifier 符合 identifierPattern ('*'、'?') 的感測器門檻：與上次送出的數值相差超過
+        // max(absolute, relative x |上次送出的數值|) 才送出，後設定的規則優先 (沒有規則時數值改變就送出)
+        void SetDeadband(System::String^ identifierPattern, float absolute, float relative);
+
+        void ClearDeadbands();  // 清除所有門檻規則
+
+        // 取得 afterSequence 之後的批次，沒有新批次時最多等待 timeoutMilliseconds。
+        // 回傳 nullptr 表示之後的批次已被覆寫，請以 GetDeltaBaseline 或 CopyValues 重新同步
+        array<SensorDeltaBatch>^ ReadDeltas(long long afterSequence, int timeoutMilliseconds);
+
+        array<float>^ GetDeltaBaseline(long long% sequence);  // 每個槽位最後送出的數值與對應的序號 (重新同步用)
+
+        // 新增衍生指標：type 中名稱符合 sensorPattern ('*'、'?') 的感測器每次更新後計算 kind，
+        // 結果為名稱加上 label (nullptr 時為 "Rate"、"EWMA"、"Average"、"Throttling") 的額外感測器，
+        // 出現在目錄、快照、OpenMetrics、歷史、變化串流與 Get*Info 的 "Derived" 中 (目錄版本會遞增)
+        void AddDerivedMetric(HardwareType type, System::String^ sensorPattern, DerivedMetricKind kind, float parameter, System::String^ label);
+
+        void ClearDerivedMetrics();  // 移除所有衍生指標 (包含預設的規則)
+
+        void ResetDerivedMetrics();  // 恢復預設的衍生指標 (網路/儲存數據速率、負載 EWMA 與平均、高溫降頻)
+
+        // 新增警示規則：type 中類型為 sensorType 且名稱符合 sensorPattern ('*'、'?'，以 '/' 開頭時比對 Identifier) 的感測器，
+        // 條件持續 durationSeconds 秒後觸發，回到 threshold 另一側超過 hysteresis 才解除 (Rising/Falling 的 threshold 為每秒變化)。
+        // 規則在目錄改變時編譯為連續陣列，每次發布以 SIMD 一次比較 8 個實例。回傳規則編號
+        int AddAlertRule(HardwareType type, SensorType sensorType, System::String^ sensorPattern, SensorAlertCondition condition, float threshold, float hysteresis, float durationSeconds);
+
+        int AddAlertRule(SensorType sensorType, System::String^ sensorPattern, SensorAlertCondition condition, float threshold, float hysteresis, float durationSeconds);  // 所有硬體類型
+
+        bool RemoveAlertRule(int ruleId);  // 移除規則 (觸發中的警示不送出解除)
+
+        void ClearAlertRules();  // 移除所有警示規則
+
+        array<SensorAlert>^ GetActiveAlerts();  // 目前觸發中的警示 (Timestamp 為觸發時間)
+
+        System::String^ GetAlertStats();  // 獲取規則數、實例數、評估次數與耗時、送出的事件數
+
+        // 警示觸發或解除：在取樣的執行緒上於 frame 發布後依序呼叫 (背景取樣時為取樣執行緒)，請勿長時間阻塞。
+        // 處理函數丟出的例外會被忽略並計入 GetAlertStats。處理函數不可同步停止取樣 (StopSampling 或 Dispose)，
+        // 取樣執行緒無法等待自己結束；需要時請排入其他執行緒 (例如 Task::Run)
+        event SensorAlertHandler^ AlertChanged;
+
+        internal:
+        int CopyCatalog(HwiCatalogEntry* entries, int capacity);  // 複製目錄 (C 介面使用)
+        int CopyDeltas(uint64_t afterSequence, HwiDelta* entries, int capacity, int timeoutMs);  // 複製變化 (C 介面使用)
+        int CopyDeltaBaseline(float* values, int capacity, uint64_t* sequence);  // 複製重新同步用的數值 (C 介面使用)
+        int AddAlert(uint32_t hardwareMask, int sensorType, System::String^ sensorPattern, int condition, float threshold, float hysteresis, float durationSeconds);  // 驗證並加入規則 (sensorType 為 -1 表示所有類型)
+        void SetAlertCallback(HwiAlertCallback callback, void* context);  // 設定 C 介面的回呼 (NULL 表示取消)
+    };
+
+    // 固定的一次取樣：Dispose 前內容不會改變，各項資料彼此一致
+    // 固定期間該 frame 不會被覆寫；長時間持有多個快照時取樣端會略過發布
+    public ref class HardwareSnapshot {
+        HardwareInfo^ owner;
+        const HardwareFrame* frame;
+        int frameIndex;
+
+        const HardwareFrame& Frame();  // 已 Dispose 時丟出 ObjectDisposedException
+
+        internal:
+        HardwareSnapshot(HardwareInfo^ info, const HardwareFrame* pinnedFrame, int index);
+
+        public:
+        ~HardwareSnapshot();
+        !HardwareSnapshot();
+
+        long long GetSequence();  // 取樣序號
+
+        long long GetTimestamp();  // 取樣時間 (Unix epoch 微秒)
+
+        int GetCatalogVersion();  // 目錄版本
+
+        int GetSize();  // 快照位元組數 (標頭 + 數值)
+
+        System::IntPtr GetPointer();  // 快照位址，Dispose 前有效 (只讀)
+
+        System::String^ GetCPUInfo();
+
+        System::String^ GetGPUInfo();
+
+        System::String^ GetMemoryInfo();
+
+        System::String^ GetStorageInfo();
+
+        System::String^ GetNetworkInfo();
+
+        System::String^ GetDeviceInfo();
+
+        System::String^ GetAllInfo();  // 所有類別 (與 HardwareInfo::GetAllInfo 格式相同)
+    };
+
+    // 一個訂閱：Dispose 前持續有效 (沒有 Dispose 時維持到 HardwareInfo 結束)
+    public ref class HardwareSubscription {
+        HardwareInfo^ owner;
+        int id;
+        HardwareType hardwareType;
+        System::String^ pattern;
+
+        internal:
+        HardwareSubscription(HardwareInfo^ info, int subscriptionId, HardwareType type, System::String^ sensorPattern);
+
+        public:
+        ~HardwareSubscription();
+
+        HardwareType GetHardwareType();
+
+        System::String^ GetSensorPattern();  // 感測器名稱樣式 ("*" 表示所有感測器)
+    };
+
+    // 共用取樣核心的 view (HardwareInfo::Attach 建立)：不擁有 Computer 或 Get*Info 結構，讀取核心發布的 frame。
+    // 每個 view 有自己的讀取游標 (快照與變化串流) 與訂閱；沒有訂閱的 view 需要預設的所有類別。
+    // Dispose 時取消自己的訂閱並釋放核心的參考 (請務必 Dispose，否則核心會保留到處理程序結束)
+    public ref class HardwareInfoView {
+        HardwareInfo^ core;
+        long long cursor = 0;  // 最後讀取的取樣序號
+        long long deltaCursor = 0;  // 變化串流中最後讀取的批次序號
+        System::Collections::Generic::List<HardwareSubscription^>^ subscriptions = gcnew System::Collections::Generic::List<HardwareSubscription^>();
+
+        HardwareInfo^ Core();  // 已 Dispose 時丟出 ObjectDisposedException
+
+        internal:
+        HardwareInfoView(HardwareInfo^ sharedCore);
+
+        public:
+        ~HardwareInfoView();
+
+        System::Threading::Tasks::Task^ WhenReady();  // 核心的所有類別開啟完成
+
+        System::String^ GetCPUInfo();
+
+        System::String^ GetGPUInfo();
+
+        System::String^ GetMemoryInfo();
+
+        System::String^ GetStorageInfo();
+
+        System::String^ GetNetworkInfo();
+
+        System::String^ GetDeviceInfo();
+
+        System::String^ GetAllInfo();
+
+        bool HasNewData();  // 核心在這個 view 上一次 AcquireSnapshot 或 CopyValues 之後有新的取樣
+
+        long long GetCursor();  // 這個 view 最後讀取的取樣序號
+
+        HardwareSnapshot^ AcquireSnapshot();  // 固定最新的 frame 並前進游標 (使用完畢請 Dispose)
+
+        int CopyValues(array<float>^ values);  // 只複製數值並前進游標
+
+        int GetCatalogVersion();
+
+        System::String^ GetCatalog();
+
+        // 訂閱核心的硬體 (所有 view 的訂閱取聯集)，view Dispose 時一併取消
+        HardwareSubscription^ Subscribe(HardwareType type, System::String^ sensorPattern);
+
+        // 以這個 view 的游標讀取變化串流 (第一次讀取時核心開始記錄)。
+        // 回傳 nullptr 表示之後的批次已被覆寫，請以 GetDeltaBaseline 重新同步
+        array<SensorDeltaBatch>^ ReadDeltas(int timeoutMilliseconds);
+
+        array<float>^ GetDeltaBaseline();  // 每個槽位最後送出的數值，並將游標移到對應的序號
+
+        System::String^ GetSamplingStats();  // 核心的取樣統計
+    };
+
+    // 讀取其他處理程序以 StartSharedPublisher 發布的快照，不需要開啟 Computer，讀取時不使用系統呼叫或鎖
+    public ref class SharedHardwareReader {
+        SharedSnapshotReader* reader;
+
+        SharedSnapshotReader& Reader();  // 已 Dispose 時丟出 ObjectDisposedException
+
+        public:
+        SharedHardwareReader(System::String^ name);  // 找不到或版面不相容時丟出 InvalidOperationException
+        ~SharedHardwareReader();
+        !SharedHardwareReader();
+
+        int CopySnapshot(array<System::Byte>^ buffer);  // 複製最新快照 (與 HardwareInfo::CopySnapshot 相同版面)，發布者寫入中卡住時回傳 0
+
+        array<System::String^>^ GetIdentifiers();  // 依槽位排列的感測器識別碼
+
+        long long GetAgeMicroseconds();  // 距離最後一次發布的時間 (尚未發布或已停止時為 -1)
+
+        bool IsPublisherAlive();  // 發布者的處理程序是否仍然存在
+
+        bool IsStale(int maxAgeMilliseconds);  // 超過 maxAgeMilliseconds 沒有發布或發布者已結束
+    };
+
+    // 接收多台主機以 StartFleetSender 送出的取樣，增量維護跨主機的彙總 (不需要開啟 Computer)。
+    // 預設規則為各分組的最高 CPU 溫度、各分組與所有主機的 CPU 封裝功率總和、所有主機的 CPU 核心功率總和
+    public ref class HardwareFleetCollector {
+        FleetCollector* collector;
+
+        FleetCollector& Collector();  // 已 Dispose 時丟出 ObjectDisposedException
+
+        public:
+        HardwareFleetCollector(System::String^ endpoint);  // "udp://位址:連接埠" (連接埠為 0 時由系統指定) 或 "unix:路徑"，無法接收時丟出 InvalidOperationException
+        ~HardwareFleetCollector();
+        !HardwareFleetCollector();
+
+        // 新增彙總：每台主機先彙總 type 中類型為 sensorType 且名稱符合 sensorPattern 的感測器，再彙總所有 (byGroup 時為同一分組的) 主機
+        void AddRule(System::String^ name, HardwareType type, SensorType sensorType, System::String^ sensorPattern, FleetReduction reduction, bool byGroup);
+
+        void ClearRules();  // 移除所有規則 (包含預設規則)
+
+        void SetHostTimeout(int milliseconds);  // 超過此時間沒有封包的主機移出彙總 (預設 10 秒)
+
+        int GetPort();  // UDP 實際使用的連接埠 (Unix datagram 為 0)
+
+        System::String^ GetAggregates();  // 獲取目前的彙總 (規則、分組、數值、主機數)
+
+        System::String^ GetHosts();  // 獲取各主機的名稱、分組、最新序號、距離最後一個封包的時間與重複/過期的封包數
+
+        System::String^ GetStats();  // 獲取接收的封包數、批次數、去除的封包數與 Ingest 耗時
     };
 }
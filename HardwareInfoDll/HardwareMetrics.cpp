@@ -0,0 +1,45 @@
+﻿#include "pch.h"
+
+#include "HardwareInfoDll.h"
+
+using namespace System;
+using namespace System::Threading;
+
+namespace HardwareInfoDll {
+    bool HardwareInfo::StartMetricsServer(int port) {
+        return StartMetricsServer("127.0.0.1", port);
+    }
+
+    bool HardwareInfo::StartMetricsServer(System::String^ address, int port) {
+        if (address == nullptr) throw gcnew ArgumentNullException("address");
+        if (port < 0 || port > 65535) throw gcnew ArgumentOutOfRangeException("port");
+
+        StopMetricsServer();  // 同時只有一個端點
+
+        MetricsExporter* exporter = new MetricsExporter(*frames);
+        if (!exporter->Start(ToUtf8String(address), port)) {
+            delete exporter;
+            return false;  // 位址無效或連接埠已被使用
+        }
+
+        AcquirePublishing();
+        metricsExporter = exporter;
+        Interlocked::Exchange(publishing, 0);
+
+        PublishSnapshot();  // 讓最新的 frame 帶有範本，第一次 scrape 就有資料
+        return true;
+    }
+
+    void HardwareInfo::StopMetricsServer() {
+        AcquirePublishing();
+        MetricsExporter* exporter = metricsExporter;
+        metricsExporter = nullptr;
+        Interlocked::Exchange(publishing, 0);
+        delete exporter;  // 等待服務執行緒結束 (frame 仍持有的範本由 shared_ptr 釋放)
+    }
+
+    int HardwareInfo::GetMetricsPort() {
+        MetricsExporter* exporter = metricsExporter;
+        return exporter ? exporter->Port() : 0;
+    }
+}
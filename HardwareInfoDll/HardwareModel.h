@@ -0,0 +1,180 @@
+﻿#pragma once
+
+// Get*Info 與快照使用的資料結構 (純原生，受控與原生的編譯單元共用)
+
+#include "SnapshotLayout.h"
+
+#include <stddef.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace HardwareInfoDll {
+    // 每核心/執行緒數值：連續陣列依核心或執行緒編號排列，大小由偵測到的拓撲決定
+    struct CoreSeries {
+        std::vector<std::string> Names;  // 感測器名稱 (JSON 輸出用)
+        std::vector<float> Values;  // 與 Names 對齊的數值
+
+        void Clear() {
+            Names.clear();
+            Values.clear();
+        }
+    };
+
+    // 定義 CPU 資訊結構
+    struct CpuInfo {
+        std::string Name;
+        float CPUUsage = 0.0;
+        float MaxCoreUsage = 0.0;
+        CoreSeries CoreLoad;  // 依執行緒排列
+        CoreSeries CoreTemperature;  // 依核心排列
+        CoreSeries CoreVoltage;  // 依核心排列
+        CoreSeries CoreClock;  // 依核心排列
+        std::vector<int> ThreadCore;  // 每個執行緒所屬的核心編號 (從 1 開始)
+        CoreSeries Derived;  // 衍生指標 (依名稱輸出，沒有時不輸出)
+        CoreSeries Topology;  // 拓撲彙總：各封裝、L3 網域與效能/效率核心的最小、最大、平均與 P95 (沒有時不輸出)
+        float MaxTemperature = 0.0;
+        float PackageTemperature = 0.0;
+        float AverageTemperature = 0.0;
+        float BusSpeed = 0.0;
+        float CPUVoltage = 0.0;
+        float PackagePower = 0.0;
+        float CoresPower = 0.0;
+        int Cores = 0;
+        int Threads = 0;
+    };
+
+    struct GpuSensorInfo {
+        std::string Type;
+        float Value = 0.0;
+
+        GpuSensorInfo() {}
+        GpuSensorInfo(const std::string& type, float value) : Type(type), Value(value) {}
+    };
+
+    struct MemoryInfo {
+        std::string name;  // hardware name
+        float memoryUsed = 0.0;  // 已使用記憶體
+        float memoryAvailable = 0.0;  // 可用記憶體
+        float memoryUtilization = 0.0;  // 記憶體使用率
+        float virtualMemoryUsed = 0.0;  // 已使用虛擬記憶體
+        float virtualMemoryAvailable = 0.0;  // 可用虛擬記憶體
+        float virtualMemoryUtilization = 0.0;  // 虛擬記憶體使用率
+        CoreSeries derived;  // 衍生指標
+    };
+
+    struct StorageInfo {
+        float usedSpace = 0.0;  // 已使用空間
+        float readActivity = 0.0;  // 讀取活動
+        float writeActivity = 0.0;  // 寫入活動
+        float totalActivity = 0.0;  // 總活動
+        float readRate = 0.0;  // 讀取速度
+        float writeRate = 0.0;  // 寫入速度
+        CoreSeries derived;  // 衍生指標 (活動的平均等)
+    };
+
+    struct NetworkInfo {
+        float dataUploaded = 0.0;  // 上傳數據
+        float dataDownloaded = 0.0;  // 下載數據
+        float uploadSpeed = 0.0;  // 上傳速度
+        float downloadSpeed = 0.0;  // 下載速度
+        float networkUtilization = 0.0;  // 網路利用率
+        CoreSeries derived;  // 衍生指標 (累計數據的速率等)
+    };
+
+    struct BatteryInfo {
+        float chargeLevel = 0.0;  // 電量 (%)
+        float degradationLevel = 0.0;  // 老化程度 (%)
+        float voltage = 0.0;  // 電壓
+        float chargeCurrent = 0.0;  // 充電電流
+        float dischargeCurrent = 0.0;  // 放電電流
+        float chargeRate = 0.0;  // 充電功率
+        float dischargeRate = 0.0;  // 放電功率
+        float designedCapacity = 0.0;  // 設計容量 (mWh)
+        float fullChargedCapacity = 0.0;  // 充滿時的容量
+        float remainingCapacity = 0.0;  // 剩餘容量
+        float remainingTime = 0.0;  // 估計的剩餘時間 (秒)
+    };
+
+    // 同一種類型的感測器 (名稱依晶片而異，依名稱輸出)
+    struct SensorGroup {
+        int sensorType = 0;  // SensorType
+        CoreSeries sensors;
+    };
+
+    // 主機板、Super I/O、EC、散熱控制器、電源供應器與電池
+    struct DeviceInfo {
+        int hardwareType = 0;  // HardwareType
+        BatteryInfo battery;  // 電池的欄位 (只有電池輸出)
+        std::vector<SensorGroup> groups;  // 沒有對應欄位的感測器，依 SensorType 排列
+        CoreSeries derived;  // 衍生指標
+    };
+
+    using GpuInfoMap = std::unordered_map<std::string, std::unordered_map<std::string, GpuSensorInfo>>;
+    using StorageInfoMap = std::unordered_map<std::string, StorageInfo>;
+    using NetworkInfoMap = std::unordered_map<std::wstring, NetworkInfo>;
+    using DeviceInfoMap = std::unordered_map<std::string, DeviceInfo>;
+
+    // 感測器槽位：以感測器 Identifier 為鍵，只在列舉/硬體變動時解析一次 (字串為 UTF-8)
+    struct SensorSlot {
+        std::string identifier;  // 感測器識別碼
+        std::string hardwareName;  // 所屬硬體名稱 (目錄用)
+        std::string name;  // 感測器名稱 (目錄用)
+        int hardwareType = 0;  // HardwareType
+        int sensorType = 0;  // SensorType
+        float* field = nullptr;  // 綁定的結構欄位 (nullptr 表示只保存在 values)
+    };
+
+    // Get*Info 對應的資料類別
+    enum InfoCategory {
+        CpuCategory,
+        GpuCategory,
+        MemoryCategory,
+        StorageCategory,
+        NetworkCategory,
+        DeviceCategory,  // 主機板、Super I/O、EC、散熱控制器、電源供應器與電池
+        InfoCategoryCount,
+        NoCategory = InfoCategoryCount  // 沒有對應的 Get*Info
+    };
+
+    // 每個硬體在來源數值中對應的區段
+    struct HardwareBinding {
+        size_t hardwareIndex = 0;  // 在 SensorSource::Enumerate 結果中的位置
+        size_t firstSensor = 0;  // 起始位置
+        size_t sensorCount = 0;  // 感測器數量
+        int hardwareType = 0;  // HardwareType
+        bool isGpu = false;  // GPU 由 UpdateGpuData 另外處理
+        int category = NoCategory;  // 數值改變時要遞增世代的類別
+        bool subscribed = true;  // 有訂閱需要此硬體 (沒有任何訂閱時全部為 true)
+    };
+
+    struct MetricsTemplate;
+
+    // 一次發布的完整資料：Get*Info 與二進位快照都由同一個 frame 產生，彼此一致
+    struct HardwareFrame {
+        unsigned int catalogVersion = 0;  // 版面對應的目錄版本 (0 表示尚未建立)
+        long long generation[InfoCategoryCount] = {};  // 寫入時各類別的資料世代
+        CpuInfo cpu;
+        GpuInfoMap gpu;
+        MemoryInfo memory;
+        StorageInfoMap storage;
+        NetworkInfoMap network;
+        DeviceInfoMap devices;
+        std::vector<float*> fields;  // 槽位對應到本 frame 內的欄位 (nullptr 表示沒有欄位)
+        std::vector<unsigned char> snapshot;  // HwiSnapshotHeader + float[sensorCount]
+        std::shared_ptr<const MetricsTemplate> metrics;  // 目錄對應的 OpenMetrics 範本 (沒有匯出時為 nullptr)
+
+        const HwiSnapshotHeader& Header() const {
+            return *reinterpret_cast<const HwiSnapshotHeader*>(snapshot.data());
+        }
+
+        float* Values() {
+            return reinterpret_cast<float*>(snapshot.data() + sizeof(HwiSnapshotHeader));
+        }
+
+        const float* Values() const {
+            return reinterpret_cast<const float*>(snapshot.data() + sizeof(HwiSnapshotHeader));
+        }
+    };
+}
@@ -0,0 +1,268 @@
+﻿#include "pch.h"
+
+#include "HardwareInfoDll.h"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <msclr\marshal_cppstd.h>
+
+using namespace System;
+using namespace System::Diagnostics;
+using namespace System::Threading;
+using namespace System::Threading::Tasks;
+using namespace LibreHardwareMonitor::Hardware;
+using json = nlohmann::json;
+
+#define DUMP_JSON_INDENT -1  // -1 表示不使用縮排
+
+namespace HardwareInfoDll {
+    // 預設取樣週期 (毫秒)：變化快的硬體取樣較頻繁，更新昂貴的儲存裝置較少
+    static int DefaultSamplingInterval(HardwareType type) {
+        switch (type) {
+            case HardwareType::Cpu: return 250;
+            case HardwareType::GpuNvidia:
+            case HardwareType::GpuAmd:
+            case HardwareType::GpuIntel: return 500;
+            case HardwareType::Memory: return 1000;
+            case HardwareType::Network: return 1000;
+            case HardwareType::Storage: return 5000;
+            default: return 1000;
+        }
+    }
+
+    // 所有群組共用的時鐘 (毫秒)，自適應取樣以此計算變化率與平均 CPU 使用量
+    static double SamplingClock() {
+        return Stopwatch::GetTimestamp() * 1000.0 / Stopwatch::Frequency;
+    }
+
+    // 取樣群組的工作執行緒，同一群組的多個裝置平行更新
+    ref class SamplingWorker {
+        HardwareInfo^ info;
+        int groupIndex;
+        std::vector<size_t>* due;  // 本次要更新的繫結索引
+        Action<int>^ updateOne;  // 重複使用，避免每次配置委派
+        long long updateTicks;  // 本次各裝置更新耗時的總和 (Stopwatch 刻度)
+
+        void UpdateOne(int index) {
+            long long start = Stopwatch::GetTimestamp();
+            info->PollHardware((*due)[index]);
+            Interlocked::Add(updateTicks, Stopwatch::GetTimestamp() - start);
+        }
+
+        public:
+        SamplingWorker(HardwareInfo^ hardwareInfo, int group) : info(hardwareInfo), groupIndex(group) {
+            due = new std::vector<size_t>();
+            updateOne = gcnew Action<int>(this, &SamplingWorker::UpdateOne);
+        }
+
+        std::vector<size_t>& Due() {
+            return *due;
+        }
+
+        int GroupIndex() {
+            return groupIndex;
+        }
+
+        void Run() {
+            try {
+                info->SamplingLoop(this);
+            }
+            finally {
+                delete due;
+                due = nullptr;
+            }
+        }
+
+        // 回傳各裝置更新耗時的總和 (毫秒)，平行更新時大於經過時間
+        double UpdateDue() {
+            updateTicks = 0;
+            if (due->size() == 1) UpdateOne(0);
+            else if (due->size() > 1) Parallel::For(0, static_cast<int>(due->size()), updateOne);
+            return updateTicks * 1000.0 / Stopwatch::Frequency;
+        }
+    };
+
+    void HardwareInfo::EnsureBindings() {
+        if (!BindingsStale()) return;
+
+        bindingLock->EnterWriteLock();
+        try {
+            if (BindingsStale()) RebindSensors();
+        }
+        finally {
+            bindingLock->ExitWriteLock();
+        }
+        DispatchAlerts();  // 重新繫結時發布所產生的事件，在釋放寫入鎖後送出
+    }
+
+    void HardwareInfo::SetSamplingInterval(HardwareType type, int milliseconds) {
+        if (milliseconds < 1) milliseconds = 1;
+        (*samplingIntervals)[static_cast<int>(type)] = milliseconds;
+
+        // 執行中的群組在下一個週期套用
+        for (auto& group : *samplingGroups) {
+            if (group.hardwareType == static_cast<int>(type)) group.intervalMs = milliseconds;
+        }
+    }
+
+    int HardwareInfo::GetSamplingInterval(HardwareType type) {
+        auto found = samplingIntervals->find(static_cast<int>(type));
+        return found != samplingIntervals->end() ? found->second : DefaultSamplingInterval(type);
+    }
+
+    void HardwareInfo::StartSampling() {
+        if (samplingActive) return;
+
+        EnsureBindings();
+
+        // 目前存在且有訂閱需要的每個 HardwareType 各建立一個群組
+        samplingGroups->clear();
+        sampledTypes = subscribedTypes;
+        for (auto& binding : model->bindings) {
+            if (!binding.subscribed) continue;
+
+            int type = binding.hardwareType;
+            bool exists = std::any_of(samplingGroups->begin(), samplingGroups->end(), [type](const SamplingGroup& group) {
+                return group.hardwareType == type;
+            });
+            if (exists) continue;
+
+            SamplingGroup group;
+            group.hardwareType = type;
+            group.intervalMs = GetSamplingInterval(static_cast<HardwareType>(type));
+            samplingGroups->push_back(group);
+        }
+
+        adaptiveSampler->Reset(samplingGroups->size(), SamplingClock());
+        samplingStop->Reset();
+        samplingActive = true;
+
+        for (int i = 0; i < static_cast<int>(samplingGroups->size()); i++) {
+            SamplingWorker^ worker = gcnew SamplingWorker(this, i);
+            Thread^ thread = gcnew Thread(gcnew ThreadStart(worker, &SamplingWorker::Run));
+            thread->IsBackground = true;
+            thread->Name = "HardwareInfo sampler (" + static_cast<HardwareType>((*samplingGroups)[i].hardwareType).ToString() + ")";
+            samplingThreads->Add(thread);
+            thread->Start();
+        }
+    }
+
+    void HardwareInfo::StopSampling() {
+        if (!samplingActive) return;
+
+        // 取樣執行緒 (例如 AlertChanged 處理函數) 等待自己結束會永遠阻塞
+        if (samplingThreads->Contains(Thread::CurrentThread))
+            throw gcnew InvalidOperationException("無法在取樣執行緒上停止取樣 (例如在 AlertChanged 處理函數中)，請改由其他執行緒呼叫");
+
+        samplingStop->Set();
+        for each (Thread^ thread in samplingThreads) {
+            thread->Join();
+        }
+        samplingThreads->Clear();
+        samplingActive = false;
+    }
+
+    void HardwareInfo::SamplingLoop(SamplingWorker^ worker) {
+        SamplingGroup& group = (*samplingGroups)[worker->GroupIndex()];
+        double nextDue = SamplingClock();  // 下一次取樣的時間 (毫秒)
+
+        for (;;) {
+            int wait = static_cast<int>(std::max(0.0, nextDue - SamplingClock()));
+            if (samplingStop->WaitOne(wait)) break;
+
+            double start = SamplingClock();
+            double end = start;
+            double interval = group.intervalMs;
+
+            EnsureBindings();
+            bindingLock->EnterReadLock();
+            try {
+                auto& due = worker->Due();
+                due.clear();
+                for (size_t i = 0; i < model->bindings.size(); ++i) {
+                    const HardwareBinding& binding = model->bindings[i];
+                    if (binding.hardwareType == group.hardwareType && binding.subscribed) due.push_back(i);
+                }
+
+                double updateStart = SamplingClock();
+                double updateMs = worker->UpdateDue();
+                double updateEnd = SamplingClock();
+                PublishSnapshot();
+                end = SamplingClock();
+
+                // 耗時以各裝置更新時間的總和取代平行更新的經過時間；由變化率與預算決定下一個週期
+                double cost = (end - start) - (updateEnd - updateStart) + updateMs;
+                interval = adaptiveSampler->Observe(worker->GroupIndex(), end, group.intervalMs, cost, *model, due);
+            }
+            finally {
+                bindingLock->ExitReadLock();
+            }
+            DispatchAlerts();
+
+            group.updates++;
+            group.lastDurationMs = end - start;
+            group.maxDurationMs = std::max(group.maxDurationMs, group.lastDurationMs);
+
+            // 更新超過一個週期時，跳過已錯過的週期並記錄
+            nextDue += interval;
+            if (end > nextDue) {
+                long long missed = static_cast<long long>((end - nextDue) / interval) + 1;
+                group.missedDeadlines += missed;
+                nextDue += missed * interval;
+            }
+        }
+    }
+
+    void HardwareInfo::EnableAdaptiveSampling(double cpuBudgetPercent) {
+        if (!(cpuBudgetPercent >= 0.0)) throw gcnew ArgumentOutOfRangeException("cpuBudgetPercent");
+
+        AdaptiveSamplingOptions options = adaptiveSampler->Options();
+        options.enabled = true;
+        options.cpuBudget = cpuBudgetPercent / 100.0;
+        adaptiveSampler->Configure(options);  // 執行中的群組在下一次取樣套用
+    }
+
+    void HardwareInfo::DisableAdaptiveSampling() {
+        AdaptiveSamplingOptions options = adaptiveSampler->Options();
+        options.enabled = false;
+        options.cpuBudget = 0.0;
+        adaptiveSampler->Configure(options);
+    }
+
+    // 轉換取樣統計為 JSON 格式
+    System::String^ HardwareInfo::GetSamplingStats() {
+        json groups = json::array();
+        for (size_t i = 0; i < samplingGroups->size(); ++i) {
+            const SamplingGroup& group = (*samplingGroups)[i];
+            AdaptiveGroupStats adaptive = adaptiveSampler->Stats(i);
+            double effective = adaptive.observations > 0 ? adaptive.effectiveIntervalMs : static_cast<double>(group.intervalMs);
+            groups.push_back({
+                { "HardwareType", msclr::interop::marshal_as<std::string>(static_cast<HardwareType>(group.hardwareType).ToString()) },
+                { "IntervalMs", static_cast<int>(group.intervalMs) },
+                { "EffectiveIntervalMs", effective },  // 自適應與預算延長後實際使用的週期
+                { "EffectiveRateHz", effective > 0.0 ? 1000.0 / effective : 0.0 },
+                { "Volatility", adaptive.volatility },  // 平均相對變化率 (每秒)
+                { "UpdateCostMs", adaptive.costMs },  // 每次取樣耗時的移動平均 (平行更新的裝置相加)
+                { "Updates", group.updates },
+                { "MissedDeadlines", group.missedDeadlines },
+                { "LastUpdateMs", group.lastDurationMs },
+                { "MaxUpdateMs", group.maxDurationMs }
+            });
+        }
+
+        AdaptiveSamplingOptions options = adaptiveSampler->Options();
+        json result = {
+            { "Active", static_cast<bool>(samplingActive) },
+            { "Adaptive", options.enabled },
+            { "CpuBudgetPercent", options.cpuBudget * 100.0 },  // 0 表示不限制
+            { "CpuUsePercent", adaptiveSampler->EstimatedCpu() * 100.0 },  // 以目前週期估計
+            { "AverageCpuPercent", adaptiveSampler->AverageCpu(SamplingClock()) * 100.0 },  // StartSampling 之後實際的平均
+            { "BudgetStretch", adaptiveSampler->Stretch() },  // 為了符合預算延長週期的倍數
+            { "PublishedFrames", frames->Published() },
+            { "DroppedFrames", frames->Dropped() },  // 所有 frame 都被讀者固定而略過的發布
+            { "Groups", std::move(groups) }
+        };
+
+        return msclr::interop::marshal_as<System::String^>(result.dump(DUMP_JSON_INDENT));
+    }
+}
@@ -0,0 +1,111 @@
+﻿#include "pch.h"
+
+#include "HardwareInfoDll.h"
+
+#include <nlohmann/json.hpp>
+#include <msclr\marshal_cppstd.h>
+
+using namespace System;
+using namespace System::Threading;
+using json = nlohmann::json;
+
+#define DUMP_JSON_INDENT -1  // -1 表示不使用縮排
+
+namespace HardwareInfoDll {
+    static const long long MicrosecondsPerSecond = 1000000;
+
+    bool HardwareInfo::StartSeriesRecording(System::String^ directory, int intervalMilliseconds) {
+        return StartSeriesRecording(directory, intervalMilliseconds, 64LL << 20, 86400);
+    }
+
+    bool HardwareInfo::StartSeriesRecording(System::String^ directory, int intervalMilliseconds, long long maxSegmentBytes, int maxSegmentSeconds) {
+        if (directory == nullptr) throw gcnew ArgumentNullException("directory");
+        if (intervalMilliseconds < 0) throw gcnew ArgumentOutOfRangeException("intervalMilliseconds");
+        if (maxSegmentBytes <= 0) throw gcnew ArgumentOutOfRangeException("maxSegmentBytes");
+        if (maxSegmentSeconds <= 0) throw gcnew ArgumentOutOfRangeException("maxSegmentSeconds");
+
+        SeriesRecorderOptions options;
+        options.directory = ToUtf8String(directory);
+        options.interval = intervalMilliseconds * 1000LL;
+        options.maxSegmentBytes = static_cast<uint64_t>(maxSegmentBytes);
+        options.maxSegmentDuration = maxSegmentSeconds * MicrosecondsPerSecond;
+
+        SeriesRecorder* recorder = new SeriesRecorder();
+        if (!recorder->Start(options)) {
+            delete recorder;
+            return false;  // 目錄不存在或無法建立檔案
+        }
+
+        AcquirePublishing();
+        SeriesRecorder* previous = seriesRecorder;
+        seriesRecorder = recorder;
+        Interlocked::Exchange(publishing, 0);
+        delete previous;  // 寫入未滿的區塊與索引
+
+        PublishSnapshot();
+        return true;
+    }
+
+    void HardwareInfo::StopSeriesRecording() {
+        AcquirePublishing();
+        SeriesRecorder* recorder = seriesRecorder;
+        seriesRecorder = nullptr;
+        Interlocked::Exchange(publishing, 0);
+        delete recorder;  // 等待寫入執行緒寫完區塊與索引
+    }
+
+    // 轉換錄製統計為 JSON 格式 (未錄製時為 null)
+    System::String^ HardwareInfo::GetSeriesRecordingStats() {
+        json result = nullptr;
+
+        AcquirePublishing();  // 避免與 StopSeriesRecording 同時進行
+        try {
+            if (seriesRecorder) {
+                SeriesRecorderStats stats = seriesRecorder->Stats();
+                result = {
+                    { "Segments", stats.segments },
+                    { "Blocks", stats.blocks },
+                    { "Samples", stats.samples },
+                    { "Values", stats.values },
+                    { "Bytes", stats.bytes },
+                    { "BytesPerValue", stats.values ? static_cast<double>(stats.bytes) / stats.values : 0.0 },
+                    { "DroppedBlocks", stats.droppedBlocks },
+                    { "WriteErrors", stats.writeErrors }
+                };
+            }
+        }
+        finally {
+            Interlocked::Exchange(publishing, 0);
+        }
+
+        return msclr::interop::marshal_as<System::String^>(result.dump(DUMP_JSON_INDENT));
+    }
+
+    array<SensorSeriesPoint>^ HardwareInfo::ReadSeries(System::String^ directory, System::String^ sensorId, long long from, long long to) {
+        if (directory == nullptr) throw gcnew ArgumentNullException("directory");
+        if (sensorId == nullptr) throw gcnew ArgumentNullException("sensorId");
+
+        // 檔名為建立時間 (固定寬度)，依名稱排序即為時間順序
+        array<String^>^ files = IO::Directory::GetFiles(directory, "hwts-*.hwts");
+        Array::Sort(files, StringComparer::Ordinal);
+
+        std::string identifier = ToUtf8String(sensorId);
+        std::vector<int64_t> timestamps;
+        std::vector<float> values;
+        for each (String^ file in files) {
+            SeriesReader reader;
+            if (!reader.Open(ToUtf8String(file))) continue;  // 還沒有資料或不是區段檔
+            if (reader.BlockCount() == 0 || reader.LastTimestamp() < from || reader.FirstTimestamp() > to) continue;
+
+            int column = reader.Find(identifier);
+            if (column >= 0) reader.Scan(static_cast<size_t>(column), from, to, timestamps, values);
+        }
+
+        array<SensorSeriesPoint>^ result = gcnew array<SensorSeriesPoint>(static_cast<int>(values.size()));
+        for (int i = 0; i < result->Length; i++) {
+            result[i].Timestamp = timestamps[i];
+            result[i].Value = values[i];
+        }
+        return result;
+    }
+}
@@ -0,0 +1,118 @@
+﻿#include "pch.h"
+
+#include "HardwareInfoDll.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace System;
+using namespace System::Text;
+using namespace System::Threading;
+
+namespace HardwareInfoDll {
+    // 暫停發布 frame 以便替換 sharedWriter (發布只會延後到下一次取樣)
+    void HardwareInfo::AcquirePublishing() {
+        while (Interlocked::CompareExchange(publishing, 1, 0) != 0) Thread::Yield();
+    }
+
+    bool HardwareInfo::StartSharedPublisher(System::String^ name, int capacity) {
+        if (name == nullptr) throw gcnew ArgumentNullException("name");
+        if (capacity <= 0) throw gcnew ArgumentOutOfRangeException("capacity");
+
+        SharedSnapshotWriter* writer = new SharedSnapshotWriter();
+        if (!writer->Create(ToUtf8String(name), static_cast<uint32_t>(capacity))) {
+            delete writer;
+            return false;  // 名稱已被其他發布者使用
+        }
+
+        AcquirePublishing();
+        SharedSnapshotWriter* previous = sharedWriter;
+        sharedWriter = writer;
+        sharedCatalogVersion = 0;  // 下一次發布時寫入目錄
+        Interlocked::Exchange(publishing, 0);
+        delete previous;
+
+        PublishSnapshot();
+        return true;
+    }
+
+    void HardwareInfo::StopSharedPublisher() {
+        AcquirePublishing();
+        SharedSnapshotWriter* writer = sharedWriter;
+        sharedWriter = nullptr;
+        Interlocked::Exchange(publishing, 0);
+        delete writer;
+    }
+
+    // 由 WriteFrame 呼叫 (同時只有一個執行緒)，目錄只在版本改變時重新寫入
+    void HardwareInfo::PublishShared(const HardwareFrame& frame) {
+        if (sharedCatalogVersion != frame.catalogVersion) {
+            sharedCatalog->resize(std::min<size_t>(sensorSlots->size(), sharedWriter->Capacity()));
+            int count = model->FillCatalog(sharedCatalog->data(), static_cast<int>(sharedCatalog->size()));
+            sharedWriter->PublishCatalog(sharedCatalog->data(), static_cast<uint32_t>(std::min<size_t>(count, sharedCatalog->size())), frame.catalogVersion);
+            sharedCatalogVersion = frame.catalogVersion;
+        }
+        sharedWriter->Publish(frame.snapshot.data(), frame.snapshot.size());
+    }
+
+    SharedHardwareReader::SharedHardwareReader(System::String^ name) {
+        if (name == nullptr) throw gcnew ArgumentNullException("name");
+
+        reader = new SharedSnapshotReader();
+        if (!reader->Open(ToUtf8String(name))) {
+            delete reader;
+            reader = nullptr;
+            throw gcnew InvalidOperationException("找不到共享快照 " + name);
+        }
+    }
+
+    SharedHardwareReader::~SharedHardwareReader() {
+        this->!SharedHardwareReader();
+    }
+
+    SharedHardwareReader::!SharedHardwareReader() {
+        delete reader;
+        reader = nullptr;
+    }
+
+    SharedSnapshotReader& SharedHardwareReader::Reader() {
+        if (!reader) throw gcnew ObjectDisposedException("SharedHardwareReader");
+        return *reader;
+    }
+
+    int SharedHardwareReader::CopySnapshot(array<System::Byte>^ buffer) {
+        if (buffer == nullptr || buffer->Length == 0) return Reader().Read(nullptr, 0);
+
+        pin_ptr<System::Byte> pinned = &buffer[0];
+        return Reader().Read(pinned, static_cast<uint32_t>(buffer->Length));
+    }
+
+    array<System::String^>^ SharedHardwareReader::GetIdentifiers() {
+        int count = Reader().ReadCatalog(nullptr, 0, nullptr);
+        if (count < 0) return nullptr;  // 發布者一直處於寫入中
+
+        std::vector<HwiCatalogEntry> entries(count);
+        count = Reader().ReadCatalog(entries.data(), static_cast<uint32_t>(entries.size()), nullptr);
+        if (count < 0) return nullptr;
+
+        array<System::String^>^ identifiers = gcnew array<System::String^>(std::min(count, static_cast<int>(entries.size())));
+        for (int i = 0; i < identifiers->Length; i++) {
+            signed char* identifier = reinterpret_cast<signed char*>(entries[i].identifier);
+            identifiers[i] = gcnew System::String(identifier, 0, static_cast<int>(std::strlen(entries[i].identifier)), Encoding::UTF8);
+        }
+        return identifiers;
+    }
+
+    long long SharedHardwareReader::GetAgeMicroseconds() {
+        return Reader().AgeMicroseconds();
+    }
+
+    bool SharedHardwareReader::IsPublisherAlive() {
+        return Reader().PublisherAlive();
+    }
+
+    bool SharedHardwareReader::IsStale(int maxAgeMilliseconds) {
+        long long age = Reader().AgeMicroseconds();
+        return age < 0 || age > maxAgeMilliseconds * 1000LL || !Reader().PublisherAlive();
+    }
+}
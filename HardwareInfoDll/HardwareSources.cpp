@@ -0,0 +1,408 @@
+﻿#include "pch.h"
+
+#include "HardwareInfoDll.h"
+
+#include <msclr\marshal_cppstd.h>
+
+using namespace System;
+using namespace System::Diagnostics;
+using namespace System::Text;
+using namespace System::Threading;
+using namespace System::Threading::Tasks;
+using namespace LibreHardwareMonitor::Hardware;
+
+namespace HardwareInfoDll {
+    std::string ToUtf8String(System::String^ value) {
+        array<System::Byte>^ bytes = Encoding::UTF8->GetBytes(value);
+        if (bytes->Length == 0) return std::string();
+
+        pin_ptr<System::Byte> pinned = &bytes[0];
+        return std::string(reinterpret_cast<const char*>(pinned), bytes->Length);
+    }
+
+    System::String^ FromUtf8String(const std::string& value) {
+        if (value.empty()) return System::String::Empty;
+
+        signed char* text = reinterpret_cast<signed char*>(const_cast<char*>(value.data()));
+        return gcnew System::String(text, 0, static_cast<int>(value.size()), Encoding::UTF8);
+    }
+
+    System::String^ FromUtf16String(const std::u16string& value) {
+        if (value.empty()) return System::String::Empty;
+        return gcnew System::String(const_cast<wchar_t*>(reinterpret_cast<const wchar_t*>(value.data())), 0, static_cast<int>(value.size()));
+    }
+
+    // 硬體/感測器新增或移除時通知 ComputerSource (事件由 LibreHardwareMonitor 的執行緒觸發)
+    ref class ComputerEvents {
+        ComputerSource* source;
+
+        public:
+        ComputerEvents(ComputerSource* owner) : source(owner) {}
+
+        void OnHardwareChanged(IHardware^ hardware) {
+            source->Invalidate();
+        }
+
+        void OnSensorChanged(ISensor^ sensor) {
+            source->Invalidate();
+        }
+    };
+
+    ComputerSource::ComputerSource(Computer^ monitoredComputer) {
+        // SourceHardwareType/SourceSensorType 依 LibreHardwareMonitor 0.9.4 的數值定義，升級後需重新確認
+        Debug::Assert(static_cast<int>(HardwareType::Cpu) == CpuHardware && static_cast<int>(HardwareType::Battery) == BatteryHardware);
+        Debug::Assert(static_cast<int>(SensorType::Load) == LoadSensor && static_cast<int>(SensorType::Humidity) == HumiditySensor);
+
+        computer = monitoredComputer;
+        startedAt = Stopwatch::GetTimestamp();
+        enableLock = gcnew Object();
+        hardware = gcnew array<IHardware^>(0);
+        parents = gcnew array<int>(0);
+        sensors = gcnew array<array<ISensor^>^>(0);
+        events = gcnew ComputerEvents(this);
+        computer->HardwareAdded += gcnew HardwareEventHandler(events, &ComputerEvents::OnHardwareChanged);
+        computer->HardwareRemoved += gcnew HardwareEventHandler(events, &ComputerEvents::OnHardwareChanged);
+    }
+
+    ComputerSource::~ComputerSource() {
+        ComputerEvents^ handlers = events;
+        computer->HardwareAdded -= gcnew HardwareEventHandler(handlers, &ComputerEvents::OnHardwareChanged);
+        computer->HardwareRemoved -= gcnew HardwareEventHandler(handlers, &ComputerEvents::OnHardwareChanged);
+        for each (IHardware^ entry in static_cast<array<IHardware^>^>(hardware)) {
+            entry->SensorAdded -= gcnew SensorEventHandler(handlers, &ComputerEvents::OnSensorChanged);
+            entry->SensorRemoved -= gcnew SensorEventHandler(handlers, &ComputerEvents::OnSensorChanged);
+        }
+    }
+
+    // 依 UpdateVisitor 的順序攤平子硬體 (Super I/O 與 EC 是主機板的子硬體)，上層永遠排在子硬體之前
+    static void Flatten(IHardware^ entry, int parent, Collections::Generic::List<IHardware^>^ flattened, Collections::Generic::List<int>^ parents) {
+        int index = flattened->Count;
+        flattened->Add(entry);
+        parents->Add(parent);
+        for each (IHardware^ child in entry->SubHardware) {
+            Flatten(child, index, flattened, parents);
+        }
+    }
+
+    // 只在拓撲改變時執行，所有字串轉換都在這裡完成
+    void ComputerSource::Enumerate(std::vector<SourceHardware>& result) {
+        ComputerEvents^ handlers = events;
+
+        // 取消舊硬體的感測器事件
+        for each (IHardware^ entry in static_cast<array<IHardware^>^>(hardware)) {
+            entry->SensorAdded -= gcnew SensorEventHandler(handlers, &ComputerEvents::OnSensorChanged);
+            entry->SensorRemoved -= gcnew SensorEventHandler(handlers, &ComputerEvents::OnSensorChanged);
+        }
+
+        // 每個子硬體各自成為一個項目 (各自繫結、各自訂閱感測器事件)
+        auto flattened = gcnew Collections::Generic::List<IHardware^>();
+        auto flattenedParents = gcnew Collections::Generic::List<int>();
+        for each (IHardware^ entry in computer->Hardware) {
+            Flatten(entry, -1, flattened, flattenedParents);
+        }
+        array<IHardware^>^ currentHardware = flattened->ToArray();
+        array<int>^ currentParents = flattenedParents->ToArray();
+        array<array<ISensor^>^>^ currentSensors = gcnew array<array<ISensor^>^>(currentHardware->Length);
+
+        result.clear();
+        result.resize(currentHardware->Length);
+        for (int i = 0; i < currentHardware->Length; i++) {
+            IHardware^ entry = currentHardware[i];
+            entry->SensorAdded += gcnew SensorEventHandler(handlers, &ComputerEvents::OnSensorChanged);
+            entry->SensorRemoved += gcnew SensorEventHandler(handlers, &ComputerEvents::OnSensorChanged);
+
+            SourceHardware& descriptor = result[i];
+            descriptor.identifier = ToUtf8String(entry->Identifier->ToString());
+            descriptor.name = ToUtf8String(entry->Name);
+            descriptor.hardwareType = static_cast<int>(entry->HardwareType);
+            descriptor.parent = currentParents[i];
+            stringConversions += 2;
+
+            array<ISensor^>^ entrySensors = entry->Sensors;
+            currentSensors[i] = entrySensors;
+            descriptor.sensors.resize(entrySensors->Length);
+            for (int k = 0; k < entrySensors->Length; k++) {
+                ISensor^ sensor = entrySensors[k];
+                SourceSensor& sensorDescriptor = descriptor.sensors[k];
+                sensorDescriptor.identifier = ToUtf8String(sensor->Identifier->ToString());
+                sensorDescriptor.name = ToUtf8String(sensor->Name);
+                sensorDescriptor.sensorType = static_cast<int>(sensor->SensorType);
+                stringConversions += 2;
+
+                auto sensorValue = sensor->Value;
+                if (sensorValue.HasValue) sensorDescriptor.value = sensorValue.Value;
+            }
+        }
+
+        hardware = currentHardware;
+        parents = currentParents;
+        sensors = currentSensors;
+    }
+
+    // 先更新上層再更新自己 (與 UpdateVisitor 相同)。上層也會被它自己的繫結與其他子硬體更新，
+    // 因此每個 IHardware::Update() 都在它的 Monitor 內執行，同一個硬體不會同時被更新 (沒有競爭時成本可忽略)
+    static void UpdateWithParents(array<IHardware^>^ entries, array<int>^ parents, int index) {
+        if (parents[index] >= 0) UpdateWithParents(entries, parents, parents[index]);
+
+        IHardware^ entry = entries[index];
+        Monitor::Enter(entry);
+        try {
+            entry->Update();
+        }
+        finally {
+            Monitor::Exit(entry);
+        }
+    }
+
+    void ComputerSource::Update(size_t hardwareIndex, float* values) {
+        int index = static_cast<int>(hardwareIndex);
+        UpdateWithParents(hardware, parents, index);
+
+        // 只讀取數值，不做任何字串處理或配置
+        array<ISensor^>^ entrySensors = static_cast<array<array<ISensor^>^>^>(sensors)[index];
+        for (int k = 0; k < entrySensors->Length; k++) {
+            auto sensorValue = entrySensors[k]->Value;
+            values[k] = sensorValue.HasValue ? sensorValue.Value : std::numeric_limits<float>::quiet_NaN();
+        }
+    }
+
+    int ClassOf(int hardwareType) {
+        switch (hardwareType) {
+            case CpuHardware: return CpuClass;
+            case MemoryHardware: return MemoryClass;
+            case GpuNvidiaHardware:
+            case GpuAmdHardware:
+            case GpuIntelHardware: return GpuClass;
+            case MotherboardHardware:
+            case SuperIOHardware:
+            case EmbeddedControllerHardware: return MotherboardClass;
+            case CoolerHardware: return ControllerClass;
+            case NetworkHardware: return NetworkClass;
+            case StorageHardware: return StorageClass;
+            case PsuHardware: return PsuClass;
+            default: return BatteryClass;
+        }
+    }
+
+    uint32_t ClassHardwareMask(int computerClass) {
+        uint32_t mask = 0;
+        for (int type = MotherboardHardware; type <= BatteryHardware; type++) {
+            if (ClassOf(type) == computerClass) mask |= HardwareTypeBit(type);
+        }
+        return mask;
+    }
+
+    const char* ClassName(int computerClass) {
+        static const char* const names[ComputerClassCount] = { "Cpu", "Memory", "Gpu", "Motherboard", "Controller", "Network", "Storage", "Psu", "Battery" };
+        return computerClass >= 0 && computerClass < ComputerClassCount ? names[computerClass] : "Unknown";
+    }
+
+    static void SetClassEnabled(Computer^ computer, int computerClass, bool enabled) {
+        switch (computerClass) {
+            case CpuClass: computer->IsCpuEnabled = enabled; break;
+            case MemoryClass: computer->IsMemoryEnabled = enabled; break;
+            case GpuClass: computer->IsGpuEnabled = enabled; break;
+            case MotherboardClass: computer->IsMotherboardEnabled = enabled; break;
+            case ControllerClass: computer->IsControllerEnabled = enabled; break;
+            case NetworkClass: computer->IsNetworkEnabled = enabled; break;
+            case StorageClass: computer->IsStorageEnabled = enabled; break;
+            case PsuClass: computer->IsPsuEnabled = enabled; break;
+            case BatteryClass: computer->IsBatteryEnabled = enabled; break;
+        }
+    }
+
+    // Parallel::For 的工作 (C++/CLI 沒有受控 lambda)
+    ref class ClassOpener {
+        ComputerSource* source;
+        array<int>^ classes;
+        Action<int>^ classReady;
+
+        public:
+        ClassOpener(ComputerSource* owner, array<int>^ opening, Action<int>^ ready) : source(owner), classes(opening), classReady(ready) {}
+
+        void Open(int index) {
+            source->OpenClass(classes[index]);
+            if (classReady != nullptr) classReady(classes[index]);
+        }
+    };
+
+    double ComputerSource::ElapsedMs() const {
+        return (Stopwatch::GetTimestamp() - startedAt) * 1000.0 / Stopwatch::Frequency;
+    }
+
+    void ComputerSource::Open() {
+        Monitor::Enter(static_cast<Object^>(enableLock));
+        try {
+            if (opened) return;
+
+            long long start = Stopwatch::GetTimestamp();
+            computer->Open();
+            computerOpenMs = (Stopwatch::GetTimestamp() - start) * 1000.0 / Stopwatch::Frequency;
+            opened = true;
+        }
+        finally {
+            Monitor::Exit(static_cast<Object^>(enableLock));
+        }
+    }
+
+    // 建立群組 (Is*Enabled = true) 並更新一次：部分感測器在第一次 Update() 後才出現，
+    // 否則依感測器名稱比對的訂閱會找不到它們。LibreHardwareMonitor 0.9.4 在 lock 外建立群組、
+    // 在 lock 內加入，因此不同類別可以由不同執行緒同時開啟
+    void ComputerSource::OpenClass(int computerClass) {
+        ClassStartup& timing = startup[computerClass];
+        long long start = Stopwatch::GetTimestamp();
+        SetClassEnabled(computer, computerClass, true);
+        long long created = Stopwatch::GetTimestamp();
+
+        uint32_t types = ClassHardwareMask(computerClass);
+        UpdateVisitor^ visitor = gcnew UpdateVisitor();
+        int count = 0;
+        for each (IHardware^ entry in computer->Hardware) {
+            if (!(types & HardwareTypeBit(static_cast<int>(entry->HardwareType)))) continue;
+
+            entry->Accept(visitor);
+            count++;
+        }
+
+        timing.opened = true;
+        timing.openMs = (created - start) * 1000.0 / Stopwatch::Frequency;
+        timing.updateMs = (Stopwatch::GetTimestamp() - created) * 1000.0 / Stopwatch::Frequency;
+        timing.hardwareCount = count;
+    }
+
+    void ComputerSource::EnableHardware(uint32_t typeMask) {
+        EnableHardware(typeMask, nullptr);
+    }
+
+    // 一個 Is*Enabled 可能涵蓋多種 HardwareType，任一種被要求時開啟。
+    // 開啟或關閉類別時 LibreHardwareMonitor 觸發 HardwareAdded/HardwareRemoved (遞增 topologyVersion)
+    void ComputerSource::EnableHardware(uint32_t typeMask, Action<int>^ classReady) {
+        Monitor::Enter(static_cast<Object^>(enableLock));
+        try {
+            enabledMask = typeMask;
+            if (!opened) return;  // Open() 之後再開啟
+
+            // 關閉 (移除群組很快) 並列出需要開啟的類別
+            System::Collections::Generic::List<int>^ opening = gcnew System::Collections::Generic::List<int>();
+            for (int computerClass = 0; computerClass < ComputerClassCount; computerClass++) {
+                bool wanted = (typeMask & ClassHardwareMask(computerClass)) != 0;
+                if (wanted == classEnabled[computerClass]) continue;
+
+                if (wanted) opening->Add(computerClass);
+                else SetClassEnabled(computer, computerClass, false);
+                classEnabled[computerClass] = wanted;
+            }
+
+            // 建立群組與第一次 Update() 是開啟的主要成本 (儲存裝置的 WMI 查詢、GPU 驅動程式初始化)，各類別平行進行
+            ClassOpener^ opener = gcnew ClassOpener(this, opening->ToArray(), classReady);
+            if (opening->Count == 1) opener->Open(0);
+            else if (opening->Count > 1) Parallel::For(0, opening->Count, gcnew Action<int>(opener, &ClassOpener::Open));
+        }
+        finally {
+            Monitor::Exit(static_cast<Object^>(enableLock));
+        }
+    }
+
+    void HardwareInfo::Initialize(SensorSource* sensorSource) {
+        source = sensorSource;
+        model = new SensorModel();
+        diagnostics = new PollDiagnostics();
+        subscriptions = new SubscriptionSet();
+        deltaStream = new DeltaStream();
+        derived = new DerivedMetrics();
+        topologyAggregates = new TopologyAggregates();
+        alerts = new AlertEngine();
+        alertScratch = new std::vector<AlertEvent>();
+        alertQueue = new std::vector<AlertEvent>();
+        allInfoBuffer = new std::u16string();
+
+        cpuInfo = &model->cpu;
+        gpuInfoMap = &model->gpu;
+        memoryInfo = &model->memory;
+        storageInfoMap = &model->storage;
+        networkInfoMap = &model->network;
+        deviceInfoMap = &model->devices;
+        sensorSlots = &model->slots;
+        sensorValues = &model->values;
+        slotIndex = &model->slotIndex;
+
+        samplingGroups = new std::vector<SamplingGroup>();
+        samplingIntervals = new std::unordered_map<int, int>();
+        adaptiveSampler = new AdaptiveSampler();
+        frames = new FramePublisher<HardwareFrame>();
+        history = new SensorHistory(SensorHistory::DefaultLevels(), SensorHistory::DefaultMaxSensors);
+        sharedCatalog = new std::vector<HwiCatalogEntry>();
+
+        // 合成與重播來源沒有開啟階段
+        startupTask = Task::CompletedTask;
+        classReady = gcnew array<TaskCompletionSource<bool>^>(ComputerClassCount);
+        for (int computerClass = 0; computerClass < ComputerClassCount; computerClass++) {
+            classReady[computerClass] = gcnew TaskCompletionSource<bool>();
+            classReady[computerClass]->SetResult(true);
+        }
+
+        RebindSensors();  // 建立第一個 frame，讀者從一開始就有資料可讀
+    }
+
+    HardwareInfo^ HardwareInfo::CreateSynthetic(int threads, int gpus, int disks, int nics) {
+        if (threads < 1) throw gcnew ArgumentOutOfRangeException("threads");
+        if (gpus < 0) throw gcnew ArgumentOutOfRangeException("gpus");
+        if (disks < 0) throw gcnew ArgumentOutOfRangeException("disks");
+        if (nics < 0) throw gcnew ArgumentOutOfRangeException("nics");
+
+        SyntheticTopology topology;
+        topology.threads = threads;
+        topology.gpus = gpus;
+        topology.disks = disks;
+        topology.nics = nics;
+        return gcnew HardwareInfo(new SyntheticSource(topology));
+    }
+
+    HardwareInfo^ HardwareInfo::CreateReplay(System::String^ path) {
+        if (path == nullptr) throw gcnew ArgumentNullException("path");
+
+        ReplaySource* replay = new ReplaySource();
+        if (!replay->Load(msclr::interop::marshal_as<std::string>(path))) {  // fopen 使用系統 ANSI 字碼頁
+            delete replay;
+            throw gcnew ArgumentException("無法讀取軌跡檔 " + path, "path");
+        }
+        return gcnew HardwareInfo(replay);
+    }
+
+    bool HardwareInfo::StartTraceRecording(System::String^ path) {
+        if (path == nullptr) throw gcnew ArgumentNullException("path");
+
+        TraceWriter* writer = new TraceWriter();
+        if (!writer->Open(msclr::interop::marshal_as<std::string>(path))) {
+            delete writer;
+            return false;
+        }
+
+        AcquirePublishing();
+        TraceWriter* previous = traceWriter;
+        traceWriter = writer;
+        traceCatalogVersion = 0;  // 下一次發布時寫入拓撲
+        System::Threading::Interlocked::Exchange(publishing, 0);
+        delete previous;
+
+        PublishSnapshot();
+        return true;
+    }
+
+    void HardwareInfo::StopTraceRecording() {
+        AcquirePublishing();
+        TraceWriter* writer = traceWriter;
+        traceWriter = nullptr;
+        System::Threading::Interlocked::Exchange(publishing, 0);
+        delete writer;
+    }
+
+    // 由 WriteFrame 呼叫 (同時只有一個執行緒)，記錄來源的原始數值，拓撲只在目錄版本改變時重新寫入
+    void HardwareInfo::RecordTrace(const HardwareFrame& frame) {
+        if (traceCatalogVersion != frame.catalogVersion) {
+            traceWriter->WriteTopology(model->boundHardware);
+            traceCatalogVersion = frame.catalogVersion;
+        }
+        traceWriter->WriteFrame(frame.Header().timestamp, model->sourceValues.data(), model->sourceValues.size());
+    }
+}
@@ -0,0 +1,109 @@
+﻿#include "pch.h"
+
+#include "HardwareInfoDll.h"
+
+#include <nlohmann/json.hpp>
+
+using namespace System;
+using namespace System::Threading::Tasks;
+using namespace LibreHardwareMonitor::Hardware;
+using json = nlohmann::json;
+
+#define DUMP_JSON_INDENT -1  // -1 表示不使用縮排
+
+namespace HardwareInfoDll {
+    // 先以空的拓撲完成初始化 (讀者立即有 frame 可讀)，Computer::Open() 與各類別在背景開啟
+    void HardwareInfo::OpenComputer(uint32_t hardwareMask, bool wait) {
+        computer = gcnew Computer();
+        computerSource = new ComputerSource(computer);
+        computerSource->EnableHardware(hardwareMask);  // 開啟前只記錄要開啟的類別
+        defaultHardware = hardwareMask;
+        enabledHardware = hardwareMask;
+        Initialize(computerSource);
+
+        for (int computerClass = 0; computerClass < ComputerClassCount; computerClass++) {
+            if (hardwareMask & ClassHardwareMask(computerClass)) classReady[computerClass] = gcnew TaskCompletionSource<bool>();
+        }
+        startupTask = Task::Run(gcnew Action(this, &HardwareInfo::RunStartup));
+
+        if (wait) startupTask->GetAwaiter().GetResult();  // 丟出原本的例外 (不包成 AggregateException)
+    }
+
+    void HardwareInfo::RunStartup() {
+        try {
+            computerSource->Open();
+            computerSource->EnableHardware(enabledHardware, gcnew Action<int>(this, &HardwareInfo::OnClassReady));
+        }
+        catch (Exception^ error) {
+            for each (TaskCompletionSource<bool>^ ready in classReady) ready->TrySetException(error);
+            throw;
+        }
+    }
+
+    // 在開啟該類別的執行緒呼叫：重新繫結會發布新的 frame (數值來自第一次 Update())，之後 Get*Info 即可讀取
+    void HardwareInfo::OnClassReady(int computerClass) {
+        EnsureBindings();
+        RestartSamplingIfNeeded();  // 開啟期間已啟動背景取樣時 (例如 Attach)，為新出現的類型建立群組
+        computerSource->Startup(computerClass).readyAtMs = computerSource->ElapsedMs();
+        classReady[computerClass]->TrySetResult(true);
+    }
+
+    void HardwareInfo::WaitForStartup() {
+        try {
+            startupTask->Wait();
+        }
+        catch (AggregateException^) {
+            // 開啟失敗已由 WhenReady 回報
+        }
+    }
+
+    HardwareInfo^ HardwareInfo::CreateOnDemand() {
+        return gcnew HardwareInfo(0u, true);
+    }
+
+    HardwareInfo^ HardwareInfo::OpenInBackground() {
+        return gcnew HardwareInfo(DefaultHardwareMask, false);
+    }
+
+    Task^ HardwareInfo::WhenReady() {
+        return startupTask;
+    }
+
+    Task^ HardwareInfo::WhenReady(HardwareType type) {
+        return classReady[ClassOf(static_cast<int>(type))]->Task;
+    }
+
+    bool HardwareInfo::IsReady() {
+        return startupTask->IsCompleted;
+    }
+
+    // 轉換開啟各階段的耗時為 JSON 格式 (毫秒)
+    System::String^ HardwareInfo::GetStartupStats() {
+        json classes = json::array();
+        double computerOpenMs = 0.0;
+        if (computerSource) {
+            computerOpenMs = computerSource->ComputerOpenMs();
+            for (int computerClass = 0; computerClass < ComputerClassCount; computerClass++) {
+                const ClassStartup& timing = computerSource->Startup(computerClass);
+                if (!timing.opened) continue;
+
+                classes.push_back({
+                    { "Class", ClassName(computerClass) },
+                    { "Hardware", timing.hardwareCount },
+                    { "OpenMs", timing.openMs },  // 建立群組
+                    { "FirstUpdateMs", timing.updateMs },
+                    { "ReadyAtMs", timing.readyAtMs }  // 從開始開啟到可讀取 (0 表示尚未完成)
+                });
+            }
+        }
+
+        json result = {
+            { "Ready", IsReady() },
+            { "Faulted", startupTask->IsFaulted },
+            { "ComputerOpenMs", computerOpenMs },  // 驅動程式與 SMBIOS
+            { "Classes", std::move(classes) }
+        };
+
+        return FromUtf8String(result.dump(DUMP_JSON_INDENT));
+    }
+}
@@ -0,0 +1,113 @@
+﻿#include "pch.h"
+
+#include "HardwareInfoDll.h"
+
+using namespace System;
+using namespace System::Threading;
+
+namespace HardwareInfoDll {
+    HardwareSubscription^ HardwareInfo::Subscribe(HardwareType type, System::String^ sensorPattern) {
+        System::String^ pattern = String::IsNullOrEmpty(sensorPattern) ? "*" : sensorPattern;
+        int id = AddSubscription(static_cast<int>(type), pattern);
+        return gcnew HardwareSubscription(this, id, type, pattern);
+    }
+
+    int HardwareInfo::AddSubscription(int hardwareType, System::String^ sensorPattern) {
+        std::string pattern = sensorPattern != nullptr ? ToUtf8String(sensorPattern) : std::string();
+        WaitForStartup();  // 背景開啟的類別完成時需要寫入鎖，開啟期間不能在寫入鎖內開關類別
+
+        int id;
+        bindingLock->EnterWriteLock();  // 背景取樣的讀取鎖結束後才開關類別
+        try {
+            id = subscriptions->Add(hardwareType, pattern);
+            ApplySubscriptions();
+        }
+        finally {
+            bindingLock->ExitWriteLock();
+        }
+        DispatchAlerts();  // 重新繫結時發布所產生的事件，在釋放寫入鎖後送出
+
+        RestartSamplingIfNeeded();
+        return id;
+    }
+
+    void HardwareInfo::Unsubscribe(int id) {
+        if (!subscriptions) return;  // HardwareInfo 已結束
+        WaitForStartup();
+
+        bindingLock->EnterWriteLock();
+        try {
+            if (subscriptions->Remove(id)) ApplySubscriptions();
+        }
+        finally {
+            bindingLock->ExitWriteLock();
+        }
+        DispatchAlerts();
+
+        RestartSamplingIfNeeded();
+    }
+
+    void HardwareInfo::ApplySubscriptions() {
+        // 沒有任何訂閱時恢復預設的類別
+        uint32_t wanted = subscriptions->Empty() ? defaultHardware : subscriptions->TypeMask();
+        if (wanted != enabledHardware) {
+            gpuUpdateMutex->WaitOne();  // 關閉類別前等待進行中的 GPU 更新結束
+            try {
+                source->EnableHardware(wanted);
+            }
+            finally {
+                gpuUpdateMutex->ReleaseMutex();
+            }
+            enabledHardware = wanted;
+        }
+
+        if (BindingsStale()) RebindSensors();  // 重新繫結時一併套用訂閱
+        else UpdateSubscribed();
+    }
+
+    void HardwareInfo::UpdateSubscribed() {
+        subscribedHardware = subscriptions->Apply(*model);
+
+        subscribedTypes = 0;
+        gpuSubscribed = false;
+        for (auto& binding : model->bindings) {
+            if (!binding.subscribed) continue;
+
+            subscribedTypes |= HardwareTypeBit(binding.hardwareType);
+            if (binding.isGpu) gpuSubscribed = true;
+        }
+    }
+
+    // 取樣群組在啟動時依類型建立，訂閱或開啟的類別改變需要的類型時重新啟動 (不能在寫入鎖內等待工作執行緒)。
+    // 各類別平行開啟時可能同時呼叫，以 samplingThreads 序列化
+    void HardwareInfo::RestartSamplingIfNeeded() {
+        Monitor::Enter(samplingThreads);
+        try {
+            if (!samplingActive || subscribedTypes == sampledTypes) return;
+
+            StopSampling();
+            StartSampling();
+        }
+        finally {
+            Monitor::Exit(samplingThreads);
+        }
+    }
+
+    HardwareSubscription::HardwareSubscription(HardwareInfo^ info, int subscriptionId, HardwareType type, System::String^ sensorPattern)
+        : owner(info), id(subscriptionId), hardwareType(type), pattern(sensorPattern) {}
+
+    HardwareSubscription::~HardwareSubscription() {
+        if (owner == nullptr) return;
+
+        owner->Unsubscribe(id);
+        owner = nullptr;
+    }
+
+    HardwareType HardwareSubscription::GetHardwareType() {
+        return hardwareType;
+    }
+
+    System::String^ HardwareSubscription::GetSensorPattern() {
+        return pattern;
+    }
+}
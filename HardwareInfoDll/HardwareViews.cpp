@@ -0,0 +1,215 @@
+﻿#include "pch.h"
+
+#include "HardwareInfoDll.h"
+
+using namespace System;
+using namespace System::Collections::Generic;
+using namespace System::Threading;
+using namespace System::Threading::Tasks;
+
+namespace HardwareInfoDll {
+    HardwareInfoView^ HardwareInfo::Attach() {
+        Monitor::Enter(sharedLock);
+        try {
+            if (sharedCore == nullptr) {
+                sharedCore = OpenInBackground();
+                sharedCore->StartSampling();  // 之後 view 只讀取發布的 frame，不呼叫 SaveAllHardware
+            }
+
+            sharedViews++;
+            unrestrictedViews++;
+            UpdateDefaultSubscriptions();  // 其他 view 已有訂閱時，這個 view 仍需要預設的所有類別
+            return gcnew HardwareInfoView(sharedCore);
+        }
+        finally {
+            Monitor::Exit(sharedLock);
+        }
+    }
+
+    int HardwareInfo::GetAttachedViews() {
+        Monitor::Enter(sharedLock);
+        try {
+            return sharedViews;
+        }
+        finally {
+            Monitor::Exit(sharedLock);
+        }
+    }
+
+    // 沒有任何訂閱時核心更新預設的所有類別；有 view 訂閱後，其他沒有訂閱的 view 改由 defaultSubscriptions 代表
+    void HardwareInfo::UpdateDefaultSubscriptions() {
+        bool needed = unrestrictedViews > 0 && unrestrictedViews < sharedViews;
+        if (needed && defaultSubscriptions == nullptr) {
+            defaultSubscriptions = gcnew List<HardwareSubscription^>();
+            for (int type = 0; type < 32; type++) {
+                if (DefaultHardwareMask & (1u << type)) defaultSubscriptions->Add(sharedCore->Subscribe(static_cast<HardwareType>(type), nullptr));
+            }
+        }
+        else if (!needed && defaultSubscriptions != nullptr) {
+            for each (HardwareSubscription^ subscription in defaultSubscriptions) delete subscription;
+            defaultSubscriptions = nullptr;
+        }
+    }
+
+    HardwareSubscription^ HardwareInfo::SubscribeShared(bool firstSubscription, HardwareType type, System::String^ sensorPattern) {
+        Monitor::Enter(sharedLock);
+        try {
+            HardwareSubscription^ subscription = sharedCore->Subscribe(type, sensorPattern);  // 先加入再調整預設訂閱，中間不會變成沒有訂閱
+            if (firstSubscription) {
+                unrestrictedViews--;
+                UpdateDefaultSubscriptions();
+            }
+            return subscription;
+        }
+        finally {
+            Monitor::Exit(sharedLock);
+        }
+    }
+
+    void HardwareInfo::Detach(List<HardwareSubscription^>^ subscriptions, bool unrestricted) {
+        Monitor::Enter(sharedLock);
+        try {
+            for each (HardwareSubscription^ subscription in subscriptions) delete subscription;  // 已 Dispose 的訂閱不會重複取消
+
+            sharedViews--;
+            if (unrestricted) unrestrictedViews--;
+
+            if (sharedViews == 0) {
+                // 最後一個 view：停止取樣並關閉 Computer，下一次 Attach 重新開啟
+                HardwareInfo^ core = sharedCore;
+                sharedCore = nullptr;
+                defaultSubscriptions = nullptr;  // 隨核心結束
+                delete core;
+            }
+            else {
+                UpdateDefaultSubscriptions();
+            }
+        }
+        finally {
+            Monitor::Exit(sharedLock);
+        }
+    }
+
+    unsigned long long HardwareInfo::LatestSequence() {
+        FrameLease<HardwareFrame> lease(*frames);
+        return lease.Get() ? lease.Get()->Header().sequence : 0;
+    }
+
+    void HardwareInfo::EnsureDeltaStream() {
+        Monitor::Enter(sharedLock);  // 兩個 view 同時第一次讀取時只開始一次 (開始會清除既有批次)
+        try {
+            if (!deltaStream->Active()) StartDeltaStream(static_cast<int>(DeltaStream::DefaultCapacity));
+        }
+        finally {
+            Monitor::Exit(sharedLock);
+        }
+    }
+
+    HardwareInfoView::HardwareInfoView(HardwareInfo^ sharedCore) : core(sharedCore) {}
+
+    HardwareInfoView::~HardwareInfoView() {
+        if (core == nullptr) return;
+
+        core = nullptr;
+        HardwareInfo::Detach(subscriptions, subscriptions->Count == 0);
+        subscriptions->Clear();
+    }
+
+    HardwareInfo^ HardwareInfoView::Core() {
+        HardwareInfo^ info = core;
+        if (info == nullptr) throw gcnew ObjectDisposedException("HardwareInfoView");
+        return info;
+    }
+
+    Task^ HardwareInfoView::WhenReady() {
+        return Core()->WhenReady();
+    }
+
+    System::String^ HardwareInfoView::GetCPUInfo() {
+        return Core()->GetCPUInfo();
+    }
+
+    System::String^ HardwareInfoView::GetGPUInfo() {
+        return Core()->GetGPUInfo();
+    }
+
+    System::String^ HardwareInfoView::GetMemoryInfo() {
+        return Core()->GetMemoryInfo();
+    }
+
+    System::String^ HardwareInfoView::GetStorageInfo() {
+        return Core()->GetStorageInfo();
+    }
+
+    System::String^ HardwareInfoView::GetNetworkInfo() {
+        return Core()->GetNetworkInfo();
+    }
+
+    System::String^ HardwareInfoView::GetDeviceInfo() {
+        return Core()->GetDeviceInfo();
+    }
+
+    System::String^ HardwareInfoView::GetAllInfo() {
+        return Core()->GetAllInfo();
+    }
+
+    bool HardwareInfoView::HasNewData() {
+        return static_cast<long long>(Core()->LatestSequence()) > cursor;
+    }
+
+    long long HardwareInfoView::GetCursor() {
+        return cursor;
+    }
+
+    HardwareSnapshot^ HardwareInfoView::AcquireSnapshot() {
+        HardwareSnapshot^ snapshot = Core()->AcquireSnapshot();
+        if (snapshot != nullptr) cursor = snapshot->GetSequence();
+        return snapshot;
+    }
+
+    int HardwareInfoView::CopyValues(array<float>^ values) {
+        HardwareInfo^ info = Core();
+        long long sequence = static_cast<long long>(info->LatestSequence());  // 複製前讀取，游標不會超過複製的資料
+        int count = info->CopyValues(values);
+        if (count > 0) cursor = sequence;
+        return count;
+    }
+
+    int HardwareInfoView::GetCatalogVersion() {
+        return Core()->GetCatalogVersion();
+    }
+
+    System::String^ HardwareInfoView::GetCatalog() {
+        return Core()->GetCatalog();
+    }
+
+    HardwareSubscription^ HardwareInfoView::Subscribe(HardwareType type, System::String^ sensorPattern) {
+        Core();
+        HardwareSubscription^ subscription = HardwareInfo::SubscribeShared(subscriptions->Count == 0, type, sensorPattern);
+        subscriptions->Add(subscription);
+        return subscription;
+    }
+
+    array<SensorDeltaBatch>^ HardwareInfoView::ReadDeltas(int timeoutMilliseconds) {
+        HardwareInfo^ info = Core();
+        info->EnsureDeltaStream();
+
+        array<SensorDeltaBatch>^ batches = info->ReadDeltas(deltaCursor, timeoutMilliseconds);
+        if (batches != nullptr && batches->Length > 0) deltaCursor = batches[batches->Length - 1].Sequence;
+        return batches;
+    }
+
+    array<float>^ HardwareInfoView::GetDeltaBaseline() {
+        HardwareInfo^ info = Core();
+        info->EnsureDeltaStream();
+
+        long long sequence;
+        array<float>^ values = info->GetDeltaBaseline(sequence);
+        deltaCursor = sequence;
+        return values;
+    }
+
+    System::String^ HardwareInfoView::GetSamplingStats() {
+        return Core()->GetSamplingStats();
+    }
+}
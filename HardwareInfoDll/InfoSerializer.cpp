@@ -0,0 +1,178 @@
+﻿#include "InfoSerializer.h"
+#include "SensorDescriptors.h"
+
+namespace HardwareInfoDll {
+    template <typename Writer>
+    static void WriteCoreSeries(Writer& writer, const char* key, const CoreSeries& series) {
+        writer.Key(key);
+        writer.BeginObject();
+        for (size_t i = 0; i < series.Values.size(); ++i) {
+            writer.Member(series.Names[i], series.Values[i]);
+        }
+        writer.EndObject();
+    }
+
+    // 描述表中的欄位 (依表的順序)
+    template <typename Writer, typename Info, size_t N>
+    static void WriteFields(Writer& writer, const SensorTable<Info, N>& table, const Info& info) {
+        for (const auto& descriptor : table) writer.Member(descriptor.key, info.*(descriptor.field));
+    }
+
+    // 串流輸出 CPU 資訊 (欄位與 SerializeCPUInfoDom 相同)
+    template <typename Writer>
+    void WriteCPUInfo(Writer& writer, const CpuInfo& cpu) {
+        writer.BeginObject();
+        writer.Member("Name", cpu.Name);
+        WriteFields(writer, CpuFields, cpu);
+        for (const auto& descriptor : CpuSeries) WriteCoreSeries(writer, descriptor.key, cpu.*(descriptor.series));
+        writer.Member("Cores", cpu.Cores);
+        writer.Member("Threads", cpu.Threads);
+        if (!cpu.Derived.Values.empty()) WriteCoreSeries(writer, "Derived", cpu.Derived);
+        if (!cpu.Topology.Values.empty()) WriteCoreSeries(writer, "Topology", cpu.Topology);
+        writer.EndObject();
+    }
+
+    template <typename Writer>
+    void WriteGPUInfo(Writer& writer, const GpuInfoMap& gpuMap) {
+        writer.BeginObject();
+        for (auto& gpu : gpuMap) {
+            writer.Key(gpu.first);
+            writer.BeginObject();
+            for (auto& sensor : gpu.second) {
+                writer.Key(sensor.first);
+                writer.BeginObject();
+                writer.Member("Type", sensor.second.Type);
+                writer.Member("Value", sensor.second.Value);
+                writer.EndObject();
+            }
+            writer.EndObject();
+        }
+        writer.EndObject();
+    }
+
+    template <typename Writer>
+    void WriteMemoryInfo(Writer& writer, const MemoryInfo& memory) {
+        writer.BeginObject();
+        writer.Member("Name", memory.name);
+        WriteFields(writer, MemoryFields, memory);
+        if (!memory.derived.Values.empty()) WriteCoreSeries(writer, "Derived", memory.derived);
+        writer.EndObject();
+    }
+
+    template <typename Writer>
+    void WriteStorageInfo(Writer& writer, const StorageInfoMap& storageMap) {
+        writer.BeginObject();
+        for (auto& storage : storageMap) {
+            writer.Key(storage.first);
+            writer.BeginObject();
+            WriteFields(writer, StorageFields, storage.second);
+            if (!storage.second.derived.Values.empty()) WriteCoreSeries(writer, "Derived", storage.second.derived);
+            writer.EndObject();
+        }
+        writer.EndObject();
+    }
+
+    // 網路名稱為 std::wstring，直接以 \uXXXX 輸出，不需要 std::wstring_convert
+    template <typename Writer>
+    void WriteNetworkInfo(Writer& writer, const NetworkInfoMap& networkMap) {
+        writer.BeginObject();
+        for (auto& network : networkMap) {
+            writer.Key(network.first);
+            writer.BeginObject();
+            WriteFields(writer, NetworkFields, network.second);
+            if (!network.second.derived.Values.empty()) WriteCoreSeries(writer, "Derived", network.second.derived);
+            writer.EndObject();
+        }
+        writer.EndObject();
+    }
+
+    // { 硬體名稱: { "Type", 電池欄位 (只有電池), 每種感測器類型 { 名稱: 數值 }, "Derived" } }
+    template <typename Writer>
+    void WriteDeviceInfo(Writer& writer, const DeviceInfoMap& deviceMap) {
+        writer.BeginObject();
+        for (auto& device : deviceMap) {
+            writer.Key(device.first);
+            writer.BeginObject();
+            writer.Member("Type", HardwareTypeName(device.second.hardwareType));
+            if (device.second.hardwareType == BatteryHardware) WriteFields(writer, BatteryFields, device.second.battery);
+            for (const SensorGroup& group : device.second.groups) WriteCoreSeries(writer, SensorTypeName(group.sensorType), group.sensors);
+            if (!device.second.derived.Values.empty()) WriteCoreSeries(writer, "Derived", device.second.derived);
+            writer.EndObject();
+        }
+        writer.EndObject();
+    }
+
+    // 沒有任何裝置時與 DOM 路徑一樣輸出 null
+    template <typename Writer>
+    static void WriteInfo(Writer& writer, InfoCategory category, const HardwareFrame& frame) {
+        switch (category) {
+            case CpuCategory:
+                WriteCPUInfo(writer, frame.cpu);
+                break;
+            case GpuCategory:
+                if (frame.gpu.empty()) writer.Null();
+                else WriteGPUInfo(writer, frame.gpu);
+                break;
+            case MemoryCategory:
+                WriteMemoryInfo(writer, frame.memory);
+                break;
+            case StorageCategory:
+                if (frame.storage.empty()) writer.Null();
+                else WriteStorageInfo(writer, frame.storage);
+                break;
+            case NetworkCategory:
+                if (frame.network.empty()) writer.Null();
+                else WriteNetworkInfo(writer, frame.network);
+                break;
+            default:
+                if (frame.devices.empty()) writer.Null();
+                else WriteDeviceInfo(writer, frame.devices);
+                break;
+        }
+    }
+
+    template <typename Writer>
+    static void WriteAllInfo(Writer& writer, const HardwareFrame& frame) {
+        static const char* const names[InfoCategoryCount] = { "CPU", "GPU", "Memory", "Storage", "Network", "Device" };
+
+        writer.BeginObject();
+        for (int category = 0; category < InfoCategoryCount; category++) {
+            writer.Key(names[category]);
+            WriteInfo(writer, static_cast<InfoCategory>(category), frame);
+        }
+        writer.EndObject();
+    }
+
+    void SerializeInfo(InfoCategory category, const HardwareFrame& frame, std::string& text) {
+        JsonWriter writer(text);
+        WriteInfo(writer, category, frame);
+    }
+
+    void SerializeInfo(InfoCategory category, const HardwareFrame& frame, std::u16string& text) {
+        Utf16JsonWriter writer(text);
+        WriteInfo(writer, category, frame);
+    }
+
+    void SerializeAllInfo(const HardwareFrame& frame, std::string& text) {
+        JsonWriter writer(text);
+        WriteAllInfo(writer, frame);
+    }
+
+    void SerializeAllInfo(const HardwareFrame& frame, std::u16string& text) {
+        Utf16JsonWriter writer(text);
+        WriteAllInfo(writer, frame);
+    }
+
+    template void WriteCPUInfo(JsonWriter&, const CpuInfo&);
+    template void WriteCPUInfo(Utf16JsonWriter&, const CpuInfo&);
+    template void WriteGPUInfo(JsonWriter&, const GpuInfoMap&);
+    template void WriteGPUInfo(Utf16JsonWriter&, const GpuInfoMap&);
+    template void WriteMemoryInfo(JsonWriter&, const MemoryInfo&);
+    template void WriteMemoryInfo(Utf16JsonWriter&, const MemoryInfo&);
+    template void WriteStorageInfo(JsonWriter&, const StorageInfoMap&);
+    template void WriteStorageInfo(Utf16JsonWriter&, const StorageInfoMap&);
+    template void WriteNetworkInfo(JsonWriter&, const NetworkInfoMap&);
+    template void WriteNetworkInfo(Utf16JsonWriter&, const NetworkInfoMap&);
+    template void WriteDeviceInfo(JsonWriter&, const DeviceInfoMap&);
+    template void WriteDeviceInfo(Utf16JsonWriter&, const DeviceInfoMap&);
+}
@@ -0,0 +1,27 @@
+﻿#pragma once
+
+// 串流式 Get*Info 輸出 (與 nlohmann::json DOM 路徑的輸出相同)，可直接輸出 UTF-16，純原生程式碼
+
+#include "HardwareModel.h"
+#include "JsonWriter.h"
+
+#include <string>
+
+namespace HardwareInfoDll {
+    // Writer 為 JsonWriter (UTF-8) 或 Utf16JsonWriter (UTF-16)
+    template <typename Writer> void WriteCPUInfo(Writer& writer, const CpuInfo& cpu);
+    template <typename Writer> void WriteGPUInfo(Writer& writer, const GpuInfoMap& gpuMap);
+    template <typename Writer> void WriteMemoryInfo(Writer& writer, const MemoryInfo& memory);
+    template <typename Writer> void WriteStorageInfo(Writer& writer, const StorageInfoMap& storageMap);
+    template <typename Writer> void WriteNetworkInfo(Writer& writer, const NetworkInfoMap& networkMap);
+    template <typename Writer> void WriteDeviceInfo(Writer& writer, const DeviceInfoMap& deviceMap);
+
+    // 將 frame 中一個類別輸出為 JSON 附加到 text，沒有任何裝置時與 DOM 路徑一樣輸出 null
+    void SerializeInfo(InfoCategory category, const HardwareFrame& frame, std::string& text);
+    void SerializeInfo(InfoCategory category, const HardwareFrame& frame, std::u16string& text);
+
+    // 一次輸出所有類別 { "CPU": ..., "GPU": ..., "Memory": ..., "Storage": ..., "Network": ..., "Device": ... }，
+    // 每個類別與 SerializeInfo 的輸出相同 (同一個 frame，彼此一致)
+    void SerializeAllInfo(const HardwareFrame& frame, std::string& text);
+    void SerializeAllInfo(const HardwareFrame& frame, std::u16string& text);
+}
@@ -0,0 +1,237 @@
+﻿#pragma once
+
+#include <string>
+#include <charconv>
+#include <cmath>
+
+namespace HardwareInfoDll {
+    // 串流式 JSON 輸出：直接由結構寫入字串，不建立 nlohmann::json DOM。
+    // Output 為 std::string 時輸出 UTF-8；為 std::u16string 時直接輸出 UTF-16 (窄字串視為 UTF-8 逐字解碼)，
+    // 受控端可由緩衝區直接建立 System::String，不需要中間的 UTF-8 字串與 Encoding::UTF8 轉換
+    template <typename Output>
+    class BasicJsonWriter {
+        using Unit = typename Output::value_type;
+
+        Output& out;  // 輸出緩衝區 (呼叫端可重複使用以避免配置)
+        unsigned long long hasItem = 0;  // 每一層是否已經寫過元素 (位元 n 對應第 n 層，用來決定逗號)
+        int depth = 0;  // 目前巢狀深度 (最多 64 層)
+        bool afterKey = false;  // 剛寫完鍵，下一個值不需要逗號
+
+        void Put(char c) {
+            out.push_back(static_cast<Unit>(c));
+        }
+
+        // 只用於 ASCII (符號、數字與跳脫序列)
+        void Raw(const char* text, size_t length) {
+            if constexpr (sizeof(Unit) == 1) {
+                out.append(text, length);
+            }
+            else {
+                for (size_t i = 0; i < length; ++i) out.push_back(static_cast<Unit>(text[i]));
+            }
+        }
+
+        void Raw(const char* text) {
+            Raw(text, std::char_traits<char>::length(text));
+        }
+
+        void Separator() {
+            if (afterKey) {
+                afterKey = false;
+                return;
+            }
+            if (depth > 0) {
+                unsigned long long bit = 1ull << (depth - 1);
+                if (hasItem & bit) Put(',');
+                hasItem |= bit;
+            }
+        }
+
+        // 解碼 text[i] 開始的一個 UTF-8 字元，回傳位元組數 (不合法的序列為 U+FFFD)
+        static size_t DecodeUtf8(const char* text, size_t length, size_t i, unsigned int& codePoint) {
+            unsigned char lead = static_cast<unsigned char>(text[i]);
+            size_t size;
+            if (lead < 0x80) { codePoint = lead; return 1; }
+            else if ((lead & 0xE0) == 0xC0) { codePoint = lead & 0x1F; size = 2; }
+            else if ((lead & 0xF0) == 0xE0) { codePoint = lead & 0x0F; size = 3; }
+            else if ((lead & 0xF8) == 0xF0) { codePoint = lead & 0x07; size = 4; }
+            else { codePoint = 0xFFFD; return 1; }
+
+            if (i + size > length) {
+                codePoint = 0xFFFD;
+                return length - i;
+            }
+            for (size_t k = 1; k < size; ++k) {
+                unsigned char next = static_cast<unsigned char>(text[i + k]);
+                if ((next & 0xC0) != 0x80) {
+                    codePoint = 0xFFFD;
+                    return k;
+                }
+                codePoint = (codePoint << 6) | (next & 0x3F);
+            }
+            return size;
+        }
+
+        // 非 ASCII 的字元：UTF-8 輸出時原樣複製位元組 (與 dump() 相同)，UTF-16 輸出時解碼後寫入 (BMP 以外為代理對)
+        size_t NonAscii(const char* text, size_t length, size_t i) {
+            if constexpr (sizeof(Unit) == 1) {
+                out.push_back(static_cast<Unit>(text[i]));
+                return 1;
+            }
+            else {
+                unsigned int codePoint;
+                size_t size = DecodeUtf8(text, length, i, codePoint);
+                if (codePoint > 0xFFFF) {
+                    codePoint -= 0x10000;
+                    out.push_back(static_cast<Unit>(0xD800 + (codePoint >> 10)));
+                    out.push_back(static_cast<Unit>(0xDC00 + (codePoint & 0x3FF)));
+                }
+                else {
+                    out.push_back(static_cast<Unit>(codePoint));
+                }
+                return size;
+            }
+        }
+
+        void Escaped(const char* text, size_t length) {
+            Put('"');
+            size_t i = 0;
+            while (i < length) {
+                unsigned char c = static_cast<unsigned char>(text[i]);
+                switch (c) {
+                    case '"': Raw("\\\"", 2); break;
+                    case '\\': Raw("\\\\", 2); break;
+                    case '\b': Raw("\\b", 2); break;
+                    case '\f': Raw("\\f", 2); break;
+                    case '\n': Raw("\\n", 2); break;
+                    case '\r': Raw("\\r", 2); break;
+                    case '\t': Raw("\\t", 2); break;
+                    default:
+                        if (c < 0x20) EscapeUnit(c);
+                        else if (c < 0x80) Put(static_cast<char>(c));
+                        else {
+                            i += NonAscii(text, length, i);
+                            continue;
+                        }
+                        break;
+                }
+                i++;
+            }
+            Put('"');
+        }
+
+        // 寬字元一律以 \uXXXX 輸出 (與 dump(-1, ' ', true) 相同)，避免額外的 UTF-8 轉換
+        void Escaped(const wchar_t* text, size_t length) {
+            Put('"');
+            for (size_t i = 0; i < length; ++i) {
+                unsigned int c = static_cast<unsigned int>(text[i]);
+                if (c == '"') Raw("\\\"", 2);
+                else if (c == '\\') Raw("\\\\", 2);
+                else if (c < 0x20 || c > 0x7E) EscapeUnit(c);
+                else Put(static_cast<char>(c));
+            }
+            Put('"');
+        }
+
+        void EscapeUnit(unsigned int unit) {
+            static const char hex[] = "0123456789abcdef";
+            char buffer[6] = { '\\', 'u', hex[(unit >> 12) & 0xF], hex[(unit >> 8) & 0xF], hex[(unit >> 4) & 0xF], hex[unit & 0xF] };
+            Raw(buffer, sizeof(buffer));
+        }
+
+        public:
+        explicit BasicJsonWriter(Output& output) : out(output) {}
+
+        void BeginObject() {
+            Separator();
+            Put('{');
+            hasItem &= ~(1ull << depth);
+            depth++;
+        }
+
+        void EndObject() {
+            Put('}');
+            depth--;
+        }
+
+        void Key(const char* key) {
+            Separator();
+            Escaped(key, std::char_traits<char>::length(key));
+            Put(':');
+            afterKey = true;
+        }
+
+        void Key(const std::string& key) {
+            Separator();
+            Escaped(key.data(), key.size());
+            Put(':');
+            afterKey = true;
+        }
+
+        void Key(const std::wstring& key) {
+            Separator();
+            Escaped(key.data(), key.size());
+            Put(':');
+            afterKey = true;
+        }
+
+        void Null() {
+            Separator();
+            Raw("null", 4);
+        }
+
+        void Value(const std::string& value) {
+            Separator();
+            Escaped(value.data(), value.size());
+        }
+
+        void Value(const char* value) {
+            Separator();
+            Escaped(value, std::char_traits<char>::length(value));
+        }
+
+        void Value(long long value) {
+            Separator();
+            char buffer[24];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            Raw(buffer, result.ptr - buffer);
+        }
+
+        void Value(int value) {
+            Value(static_cast<long long>(value));
+        }
+
+        // 浮點數以 double 最短可還原表示輸出，數值與 nlohmann::json 的 dump() 相同
+        void Value(float value) {
+            Separator();
+            double number = value;
+            if (!std::isfinite(number)) {
+                Raw("null", 4);
+                return;
+            }
+
+            char buffer[32];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+            Raw(buffer, result.ptr - buffer);
+
+            // 整數值補上 ".0"，保持浮點數型別
+            bool integral = true;
+            for (char* p = buffer; p != result.ptr; ++p) {
+                if (*p == '.' || *p == 'e' || *p == 'n' || *p == 'i') {
+                    integral = false;
+                    break;
+                }
+            }
+            if (integral) Raw(".0", 2);
+        }
+
+        template <typename TKey, typename TValue>
+        void Member(const TKey& key, const TValue& value) {
+            Key(key);
+            Value(value);
+        }
+    };
+
+    using JsonWriter = BasicJsonWriter<std::string>;  // UTF-8
+    using Utf16JsonWriter = BasicJsonWriter<std::u16string>;  // UTF-16 (System::String 的編碼)
+}
@@ -0,0 +1,434 @@
+﻿#include "MetricsExporter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <system_error>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace HardwareInfoDll {
+    namespace {
+#ifdef _WIN32
+        typedef SOCKET Socket;
+        const Socket InvalidSocket = INVALID_SOCKET;
+
+        void CloseSocket(Socket socket) {
+            closesocket(socket);
+        }
+#else
+        typedef int Socket;
+        const Socket InvalidSocket = -1;
+
+        void CloseSocket(Socket socket) {
+            close(socket);
+        }
+#endif
+
+        const size_t MaxValueLength = 24;  // 一個數值的最大字元數 (float/uint64/double 的最短表示)
+        const size_t HeaderRoom = 256;  // 回應標頭保留的空間 (放在內容之前，一次送出)
+        const size_t MaxRequest = 8192;  // 請求標頭的上限
+        const int AcceptPollMs = 200;  // 等待連線的間隔 (同時檢查是否要停止)
+        const int ReceiveTimeoutMs = 2000;
+
+        // SensorType 對應的指標家族 (名稱必須以單位結尾)
+        struct MetricFamily {
+            const char* name;
+            const char* unit;  // 空字串表示沒有單位
+            const char* help;
+        };
+
+        const MetricFamily families[SensorTypeCount] = {
+            { "hwi_voltage_volts", "volts", "Voltage sensors." },
+            { "hwi_current_amperes", "amperes", "Current sensors." },
+            { "hwi_power_watts", "watts", "Power sensors." },
+            { "hwi_clock_megahertz", "megahertz", "Clock sensors." },
+            { "hwi_temperature_celsius", "celsius", "Temperature sensors." },
+            { "hwi_load_percent", "percent", "Load sensors." },
+            { "hwi_frequency_hertz", "hertz", "Frequency sensors." },
+            { "hwi_fan_rpm", "rpm", "Fan speed sensors." },
+            { "hwi_flow_liters_per_hour", "liters_per_hour", "Flow sensors." },
+            { "hwi_control_percent", "percent", "Control (fan/pump duty) sensors." },
+            { "hwi_level_percent", "percent", "Level sensors." },
+            { "hwi_factor", "", "Factor sensors." },
+            { "hwi_data_gigabytes", "gigabytes", "Data sensors." },
+            { "hwi_small_data_megabytes", "megabytes", "Small data sensors." },
+            { "hwi_throughput_bytes_per_second", "bytes_per_second", "Throughput sensors." },
+            { "hwi_time_span_seconds", "seconds", "Time span sensors." },
+            { "hwi_energy_milliwatt_hours", "milliwatt_hours", "Energy sensors." },
+            { "hwi_noise_decibels", "decibels", "Noise sensors (dBA)." },
+            { "hwi_conductivity_microsiemens_per_centimeter", "microsiemens_per_centimeter", "Conductivity sensors." },
+            { "hwi_humidity_percent", "percent", "Humidity sensors." }
+        };
+
+        // 標籤值的跳脫 (\\、\" 與 \n)
+        void AppendLabel(std::string& text, const char* name, const std::string& value) {
+            text += name;
+            text += "=\"";
+            for (char c : value) {
+                if (c == '\\') text += "\\\\";
+                else if (c == '"') text += "\\\"";
+                else if (c == '\n') text += "\\n";
+                else text += c;
+            }
+            text += '"';
+        }
+
+        void AppendFamily(std::string& text, const char* name, const char* type, const char* unit, const char* help) {
+            text += "# TYPE ";
+            text += name;
+            text += ' ';
+            text += type;
+            text += '\n';
+            if (*unit) {
+                text += "# UNIT ";
+                text += name;
+                text += ' ';
+                text += unit;
+                text += '\n';
+            }
+            text += "# HELP ";
+            text += name;
+            text += ' ';
+            text += help;
+            text += '\n';
+        }
+
+        char* WriteFloat(char* out, char* end, float value) {
+            if (value != value) {
+                std::memcpy(out, "NaN", 3);
+                return out + 3;
+            }
+            if (value == std::numeric_limits<float>::infinity()) {
+                std::memcpy(out, "+Inf", 4);
+                return out + 4;
+            }
+            if (value == -std::numeric_limits<float>::infinity()) {
+                std::memcpy(out, "-Inf", 4);
+                return out + 4;
+            }
+            return std::to_chars(out, end, value).ptr;
+        }
+
+        bool SendAll(Socket socket, const char* data, size_t size) {
+            while (size > 0) {
+                int chunk = size > 1 << 30 ? 1 << 30 : static_cast<int>(size);
+                int sent = send(socket, data, chunk, 0);
+                if (sent <= 0) return false;
+                data += sent;
+                size -= static_cast<size_t>(sent);
+            }
+            return true;
+        }
+
+        // 讀取到標頭結束 (空行) 為止，不處理內容 (GET 沒有內容)
+        bool ReceiveRequest(Socket socket, char* buffer, size_t capacity, size_t& length) {
+            length = 0;
+            while (length < capacity - 1) {
+                int received = recv(socket, buffer + length, static_cast<int>(capacity - 1 - length), 0);
+                if (received <= 0) return false;
+                length += static_cast<size_t>(received);
+                buffer[length] = '\0';
+                if (std::strstr(buffer, "\r\n\r\n") || std::strstr(buffer, "\n\n")) return true;
+            }
+            return false;
+        }
+
+        // 不分大小寫搜尋 (標頭名稱不分大小寫)
+        bool ContainsIgnoreCase(const char* text, const char* pattern) {
+            size_t length = std::strlen(pattern);
+            for (; *text; ++text) {
+                size_t i = 0;
+                while (i < length && text[i] && std::tolower(static_cast<unsigned char>(text[i])) == std::tolower(static_cast<unsigned char>(pattern[i]))) ++i;
+                if (i == length) return true;
+            }
+            return false;
+        }
+    }
+
+    size_t MetricsTemplate::MaxSize() const {
+        return text.size() + lines.size() * MaxValueLength;
+    }
+
+    std::shared_ptr<const MetricsTemplate> BuildMetricsTemplate(const SensorModel& model, unsigned int catalogVersion) {
+        auto metrics = std::make_shared<MetricsTemplate>();
+        metrics->catalogVersion = catalogVersion;
+
+        // 目前繫結的槽位與衍生指標 (同一個 SensorType 必須連續輸出)
+        std::vector<size_t> bound;
+        bound.reserve(model.boundSlots.size() + model.derivedSlots.size());
+        for (size_t slot : model.boundSlots) {
+            if (slot != SensorModel::Unbound) bound.push_back(slot);
+        }
+        bound.insert(bound.end(), model.derivedSlots.begin(), model.derivedSlots.end());
+        std::sort(bound.begin(), bound.end(), [&model](size_t a, size_t b) {
+            int typeA = model.slots[a].sensorType;
+            int typeB = model.slots[b].sensorType;
+            return typeA != typeB ? typeA < typeB : a < b;
+        });
+        bound.erase(std::unique(bound.begin(), bound.end()), bound.end());
+
+        std::string& text = metrics->text;
+        text.reserve(bound.size() * 160);
+        int family = -1;
+        for (size_t slot : bound) {
+            const SensorSlot& sensorSlot = model.slots[slot];
+            if (sensorSlot.sensorType < 0 || sensorSlot.sensorType >= SensorTypeCount) continue;
+
+            if (sensorSlot.sensorType != family) {
+                family = sensorSlot.sensorType;
+                AppendFamily(text, families[family].name, "gauge", families[family].unit, families[family].help);
+            }
+
+            text += families[family].name;
+            text += '{';
+            AppendLabel(text, "hardware", sensorSlot.hardwareName);
+            text += ',';
+            AppendLabel(text, "hardware_type", HardwareTypeName(sensorSlot.hardwareType));
+            text += ',';
+            AppendLabel(text, "sensor", sensorSlot.name);
+            text += ',';
+            AppendLabel(text, "identifier", sensorSlot.identifier);
+            text += "} ";
+            metrics->lines.push_back({ text.size(), static_cast<uint32_t>(slot) });
+            text += '\n';
+        }
+
+        AppendFamily(text, "hwi_samples", "counter", "", "Samples published since the collector started.");
+        text += "hwi_samples_total ";
+        metrics->lines.push_back({ text.size(), MetricsTemplate::SequenceValue });
+        text += '\n';
+
+        AppendFamily(text, "hwi_sample_timestamp_seconds", "gauge", "seconds", "Unix time of the latest sample.");
+        text += "hwi_sample_timestamp_seconds ";
+        metrics->lines.push_back({ text.size(), MetricsTemplate::TimestampValue });
+        text += "\n# EOF\n";
+        return metrics;
+    }
+
+    size_t RenderMetrics(const MetricsTemplate& metrics, const HardwareFrame& frame, char* buffer, size_t capacity) {
+        if (capacity < metrics.MaxSize()) return 0;
+
+        const HwiSnapshotHeader& header = frame.Header();
+        const float* values = frame.Values();
+        const char* text = metrics.text.data();
+        char* out = buffer;
+        char* end = buffer + capacity;
+        size_t position = 0;
+
+        for (const auto& line : metrics.lines) {
+            size_t length = line.textEnd - position;
+            std::memcpy(out, text + position, length);
+            out += length;
+            position = line.textEnd;
+
+            if (line.source == MetricsTemplate::SequenceValue) out = std::to_chars(out, end, header.sequence).ptr;
+            else if (line.source == MetricsTemplate::TimestampValue) out = std::to_chars(out, end, header.timestamp / 1e6).ptr;
+            else out = WriteFloat(out, end, line.source < header.sensorCount ? values[line.source] : std::numeric_limits<float>::quiet_NaN());
+        }
+
+        size_t length = metrics.text.size() - position;
+        std::memcpy(out, text + position, length);
+        out += length;
+        return static_cast<size_t>(out - buffer);
+    }
+
+    struct MetricsExporter::Impl {
+        FramePublisher<HardwareFrame>& frames;
+        Socket listener = InvalidSocket;
+        std::thread thread;
+        std::atomic<bool> stopping{ false };
+        std::atomic<long long> scrapes{ 0 };
+        int port = 0;
+        std::vector<char> response;  // 只由服務執行緒使用，範本變大時才重新配置
+        char request[MaxRequest];
+
+        explicit Impl(FramePublisher<HardwareFrame>& publisher) : frames(publisher) {}
+
+        void Serve();
+        void Handle(Socket client);
+        bool Respond(Socket client, const char* status, const char* contentType, const char* body, size_t length);
+    };
+
+    void MetricsExporter::Impl::Serve() {
+        while (!stopping.load()) {
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(listener, &readable);
+            timeval timeout = { 0, AcceptPollMs * 1000 };
+            if (select(static_cast<int>(listener + 1), &readable, nullptr, nullptr, &timeout) <= 0) continue;
+
+            Socket client = accept(listener, nullptr, nullptr);
+            if (client == InvalidSocket) continue;
+
+            // 用戶端不送出請求時不會讓服務執行緒一直等待
+#ifdef _WIN32
+            DWORD receiveTimeout = ReceiveTimeoutMs;
+#else
+            timeval receiveTimeout = { ReceiveTimeoutMs / 1000, (ReceiveTimeoutMs % 1000) * 1000 };
+#endif
+            setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&receiveTimeout), sizeof(receiveTimeout));
+            Handle(client);
+            CloseSocket(client);
+        }
+    }
+
+    // 內容放在 HeaderRoom 之後，標頭寫在緊接內容之前，整個回應一次送出
+    bool MetricsExporter::Impl::Respond(Socket client, const char* status, const char* contentType, const char* body, size_t length) {
+        char header[HeaderRoom];
+        int headerLength = std::snprintf(header, sizeof(header),
+            "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n", status, contentType, length);
+        if (headerLength <= 0 || static_cast<size_t>(headerLength) >= sizeof(header)) return false;
+
+        if (body == response.data() + HeaderRoom) {
+            char* start = response.data() + HeaderRoom - headerLength;
+            std::memcpy(start, header, headerLength);
+            return SendAll(client, start, headerLength + length);
+        }
+        return SendAll(client, header, headerLength) && SendAll(client, body, length);
+    }
+
+    void MetricsExporter::Impl::Handle(Socket client) {
+        size_t length;
+        if (!ReceiveRequest(client, request, sizeof(request), length)) return;
+
+        if (std::strncmp(request, "GET ", 4) != 0) {
+            const char body[] = "Method Not Allowed\n";
+            Respond(client, "405 Method Not Allowed", "text/plain; charset=utf-8", body, sizeof(body) - 1);
+            return;
+        }
+
+        const char* path = request + 4;
+        size_t pathLength = std::strcspn(path, " ?\r\n");
+        if (!((pathLength == 8 && std::strncmp(path, "/metrics", 8) == 0) || (pathLength == 1 && path[0] == '/'))) {
+            const char body[] = "Not Found\n";
+            Respond(client, "404 Not Found", "text/plain; charset=utf-8", body, sizeof(body) - 1);
+            return;
+        }
+
+        // Prometheus 以 Accept 要求 OpenMetrics；其他用戶端使用文字格式 0.0.4 (相同內容，# EOF 與 # UNIT 視為註解)
+        const char* contentType = ContainsIgnoreCase(request, "application/openmetrics-text")
+            ? "application/openmetrics-text; version=1.0.0; charset=utf-8"
+            : "text/plain; version=0.0.4; charset=utf-8";
+
+        FrameLease<HardwareFrame> lease(frames);
+        const HardwareFrame* frame = lease.Get();
+        const MetricsTemplate* metrics = frame ? frame->metrics.get() : nullptr;
+        if (!metrics) {
+            const char body[] = "No sample published yet\n";
+            Respond(client, "503 Service Unavailable", "text/plain; charset=utf-8", body, sizeof(body) - 1);
+            return;
+        }
+
+        size_t capacity = metrics->MaxSize();
+        if (response.size() < HeaderRoom + capacity) response.resize(HeaderRoom + capacity + capacity / 4);
+
+        char* body = response.data() + HeaderRoom;
+        size_t bodyLength = RenderMetrics(*metrics, *frame, body, response.size() - HeaderRoom);
+        if (Respond(client, "200 OK", contentType, body, bodyLength)) scrapes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    MetricsExporter::MetricsExporter(FramePublisher<HardwareFrame>& frames) : impl(new Impl(frames)) {}
+
+    MetricsExporter::~MetricsExporter() {
+        Stop();
+        delete impl;
+    }
+
+    bool MetricsExporter::Start(const std::string& address, int port) {
+        Stop();
+
+#ifdef _WIN32
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0) return false;
+#endif
+
+        sockaddr_in endpoint = {};
+        endpoint.sin_family = AF_INET;
+        endpoint.sin_port = htons(static_cast<unsigned short>(port));
+        Socket listener = InvalidSocket;
+        if (port >= 0 && port <= 65535 && inet_pton(AF_INET, address.c_str(), &endpoint.sin_addr) == 1) {
+            listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        }
+
+        bool listening = false;
+        if (listener != InvalidSocket) {
+#ifndef _WIN32
+            int reuse = 1;  // 重新啟動時不必等待 TIME_WAIT
+            setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#endif
+            listening = bind(listener, reinterpret_cast<sockaddr*>(&endpoint), sizeof(endpoint)) == 0 && listen(listener, 16) == 0;
+        }
+        if (!listening) {
+            if (listener != InvalidSocket) CloseSocket(listener);
+#ifdef _WIN32
+            WSACleanup();
+#endif
+            return false;
+        }
+
+        sockaddr_in bound = {};
+        socklen_t boundLength = sizeof(bound);
+        getsockname(listener, reinterpret_cast<sockaddr*>(&bound), &boundLength);
+
+        impl->listener = listener;
+        impl->port = ntohs(bound.sin_port);
+        impl->stopping.store(false);
+        try {
+            impl->thread = std::thread([this] { impl->Serve(); });
+        }
+        catch (const std::system_error&) {  // 無法建立執行緒：關閉監聽通訊端，與繫結失敗相同回傳 false
+            CloseSocket(listener);
+            impl->listener = InvalidSocket;
+            impl->port = 0;
+#ifdef _WIN32
+            WSACleanup();
+#endif
+            return false;
+        }
+        return true;
+    }
+
+    void MetricsExporter::Stop() {
+        if (impl->listener == InvalidSocket) return;
+
+        impl->stopping.store(true);
+        impl->thread.join();
+        CloseSocket(impl->listener);
+        impl->listener = InvalidSocket;
+        impl->port = 0;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+
+    void MetricsExporter::Prepare(HardwareFrame& frame, const SensorModel& model) {
+        if (!current || current->catalogVersion != frame.catalogVersion) current = BuildMetricsTemplate(model, frame.catalogVersion);
+        frame.metrics = current;
+    }
+
+    int MetricsExporter::Port() const {
+        return impl->port;
+    }
+
+    long long MetricsExporter::Scrapes() const {
+        return impl->scrapes.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,66 @@
+﻿#pragma once
+
+// OpenMetrics 匯出：目錄改變時預先產生每一行的文字 (指標名稱、標籤)，
+// 每次 scrape 只把數值依序填入預先配置的緩衝區，不配置記憶體也不處理字串。
+// 內建的 HTTP 端點只處理 GET /metrics，每個連線回應一次後關閉。
+// 純原生程式碼 (Windows 使用 Winsock，其他平台使用 BSD socket)，由 HardwareInfo 與效能測試共用。
+
+#include "FramePublisher.h"
+#include "HardwareModel.h"
+#include "SensorModel.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace HardwareInfoDll {
+    // 一個目錄版本的文字範本：依序輸出 text 到 lines[i].textEnd，再輸出 lines[i].source 的數值
+    struct MetricsTemplate {
+        static const uint32_t SequenceValue = 0xFFFFFFFF;  // 取樣序號
+        static const uint32_t TimestampValue = 0xFFFFFFFE;  // 取樣時間 (秒)
+
+        struct Line {
+            size_t textEnd;
+            uint32_t source;  // 槽位或 SequenceValue/TimestampValue
+        };
+
+        unsigned int catalogVersion = 0;
+        std::string text;  // 所有固定的文字 (含 # TYPE/# UNIT/# HELP 與 # EOF)
+        std::vector<Line> lines;
+
+        size_t MaxSize() const;  // 輸出的最大位元組數
+    };
+
+    // 依目前繫結的感測器與衍生指標產生範本 (同一種 SensorType 為一個指標家族，標籤為硬體與感測器名稱)
+    std::shared_ptr<const MetricsTemplate> BuildMetricsTemplate(const SensorModel& model, unsigned int catalogVersion);
+
+    // 依範本輸出 frame 的數值，回傳位元組數 (capacity 小於 MaxSize() 時回傳 0)
+    size_t RenderMetrics(const MetricsTemplate& metrics, const HardwareFrame& frame, char* buffer, size_t capacity);
+
+    class MetricsExporter {
+        struct Impl;
+        Impl* impl;
+
+        std::shared_ptr<const MetricsTemplate> current;  // 最新目錄的範本 (只由寫入端存取)
+
+        public:
+        explicit MetricsExporter(FramePublisher<HardwareFrame>& frames);
+        ~MetricsExporter();
+
+        MetricsExporter(const MetricsExporter&) = delete;
+        MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+        // 在 address:port 開始接受連線 (port 為 0 時由系統指定)，失敗時回傳 false
+        bool Start(const std::string& address, int port);
+        void Stop();  // 停止並等待服務執行緒結束
+
+        // 寫入端在發布 frame 前呼叫：目錄改變時重建範本，並讓 frame 指向目前的範本
+        void Prepare(HardwareFrame& frame, const SensorModel& model);
+
+        int Port() const;  // 實際使用的連接埠 (尚未開始時為 0)
+
+        long long Scrapes() const;  // 成功回應的 /metrics 次數
+    };
+}
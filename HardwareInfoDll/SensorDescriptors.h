@@ -0,0 +1,183 @@
+﻿#pragma once
+
+// 感測器描述表：每種硬體一張表，將 LibreHardwareMonitor 的感測器 (類型 + 名稱) 對應到 Get*Info 結構的欄位與 JSON 名稱
+// (記憶體、儲存裝置與網路與描述表加入前相同，只比對名稱)。
+// 表在編譯期建立完美雜湊 (每個名稱獨占一個桶)，繫結時每個感測器只需一次雜湊與一次字串比較；
+// 繫結函數、串流與 DOM 序列化都由表產生，新增欄位只需修改結構與表。
+// 名稱依晶片而異的硬體 (主機板、Super I/O、EC、散熱控制器、電源供應器) 沒有固定名稱，依感測器類型分組。
+// 純原生程式碼 (只有標頭)，受控與原生的編譯單元共用。
+
+#include "HardwareModel.h"
+#include "SensorSource.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace HardwareInfoDll {
+    // 一個欄位：類型與名稱都相同的感測器繫結到 Info::*field
+    template <typename Info>
+    struct FieldDescriptor {
+        int sensorType;  // SourceSensorType
+        const char* sensorName;  // 感測器名稱 (完全相同才符合)
+        const char* key;  // JSON 名稱
+        float Info::* field;
+    };
+
+    // 每核心陣列：類型相同且名稱以 prefix 開頭的感測器依核心/執行緒編號排列
+    template <typename Info>
+    struct SeriesDescriptor {
+        int sensorType;
+        const char* prefix;
+        const char* key;
+        CoreSeries Info::* series;
+    };
+
+    const int AnySensorType = -1;  // 只比對名稱的表在雜湊中使用的類型
+
+    constexpr size_t NameLength(const char* text) {
+        size_t length = 0;
+        while (text[length]) ++length;
+        return length;
+    }
+
+    // FNV-1a (含感測器類型)，seed 由 MakeSensorTable 在編譯期尋找
+    constexpr uint32_t SensorNameHash(int sensorType, const char* name, size_t length, uint32_t seed) {
+        uint32_t hash = (2166136261u ^ seed) * 16777619u;
+        hash = (hash ^ static_cast<uint32_t>(sensorType)) * 16777619u;
+        for (size_t i = 0; i < length; ++i) hash = (hash ^ static_cast<unsigned char>(name[i])) * 16777619u;
+        return hash ^ (hash >> 16);
+    }
+
+    // 大於等於 4N 的 2 的次方 (負載不超過 1/4，通常前幾個 seed 就沒有碰撞)
+    constexpr size_t SensorTableBuckets(size_t count) {
+        size_t buckets = 4;
+        while (buckets < count * 4) buckets *= 2;
+        return buckets;
+    }
+
+    template <typename Info, size_t N>
+    struct SensorTable {
+        static constexpr size_t BucketCount = SensorTableBuckets(N);
+        static constexpr uint32_t NoSeed = 0xFFFFFFFF;
+
+        FieldDescriptor<Info> fields[N];  // 依 JSON 輸出順序
+        bool matchType;  // false 時只比對名稱 (sensorType 僅供參考)
+        uint32_t seed;
+        unsigned char buckets[BucketCount];  // 欄位編號 + 1 (0 表示空桶)
+
+        constexpr bool Valid() const {  // 找到沒有碰撞的 seed (類型與名稱重複時為 false)
+            return seed != NoSeed;
+        }
+
+        constexpr const FieldDescriptor<Info>* begin() const {
+            return fields;
+        }
+
+        constexpr const FieldDescriptor<Info>* end() const {
+            return fields + N;
+        }
+
+        // 找不到時回傳 nullptr
+        const FieldDescriptor<Info>* Find(int sensorType, const std::string& name) const {
+            if (!matchType) sensorType = AnySensorType;
+            size_t bucket = SensorNameHash(sensorType, name.data(), name.size(), seed) & (BucketCount - 1);
+            unsigned int entry = buckets[bucket];
+            if (entry == 0) return nullptr;
+
+            const FieldDescriptor<Info>& field = fields[entry - 1];
+            return (!matchType || field.sensorType == sensorType) && name == field.sensorName ? &field : nullptr;
+        }
+    };
+
+    // matchType 為 false 時只依名稱比對 (記憶體、儲存裝置與網路的名稱不會重複，類型依驅動程式版本可能不同)
+    template <typename Info, size_t N>
+    constexpr SensorTable<Info, N> MakeSensorTable(const FieldDescriptor<Info> (&fields)[N], bool matchType = true) {
+        static_assert(N < 255, "欄位編號以 unsigned char 保存");
+
+        SensorTable<Info, N> table = {};
+        for (size_t i = 0; i < N; ++i) table.fields[i] = fields[i];
+        table.matchType = matchType;
+
+        for (uint32_t seed = 0; seed < 4096; ++seed) {
+            for (size_t bucket = 0; bucket < table.BucketCount; ++bucket) table.buckets[bucket] = 0;
+
+            bool collision = false;
+            for (size_t i = 0; i < N && !collision; ++i) {
+                size_t bucket = SensorNameHash(matchType ? fields[i].sensorType : AnySensorType, fields[i].sensorName, NameLength(fields[i].sensorName), seed) & (table.BucketCount - 1);
+                if (table.buckets[bucket]) collision = true;
+                else table.buckets[bucket] = static_cast<unsigned char>(i + 1);
+            }
+            if (!collision) {
+                table.seed = seed;
+                return table;
+            }
+        }
+        table.seed = table.NoSeed;
+        return table;
+    }
+
+    constexpr auto CpuFields = MakeSensorTable<CpuInfo>({
+        { LoadSensor, "CPU Total", "CPUUsage", &CpuInfo::CPUUsage },
+        { LoadSensor, "CPU Core Max", "MaxCoreUsage", &CpuInfo::MaxCoreUsage },
+        { TemperatureSensor, "Core Max", "MaxTemperature", &CpuInfo::MaxTemperature },
+        { TemperatureSensor, "CPU Package", "PackageTemperature", &CpuInfo::PackageTemperature },
+        { TemperatureSensor, "Core Average", "AverageTemperature", &CpuInfo::AverageTemperature },
+        { ClockSensor, "Bus Speed", "BusSpeed", &CpuInfo::BusSpeed },
+        { VoltageSensor, "CPU Core", "CPUVoltage", &CpuInfo::CPUVoltage },
+        { PowerSensor, "CPU Package", "PackagePower", &CpuInfo::PackagePower },
+        { PowerSensor, "CPU Cores", "CoresPower", &CpuInfo::CoresPower }
+    });
+
+    // 沒有對應欄位時依序比對 (每核心電壓需要 '#'，與 CPUVoltage 的 "CPU Core" 區分)
+    constexpr SeriesDescriptor<CpuInfo> CpuSeries[] = {
+        { LoadSensor, "CPU Core", "CoreLoad", &CpuInfo::CoreLoad },
+        { TemperatureSensor, "CPU Core", "CoreTemperature", &CpuInfo::CoreTemperature },
+        { VoltageSensor, "CPU Core #", "CoreVoltage", &CpuInfo::CoreVoltage },
+        { ClockSensor, "CPU Core", "CoreClock", &CpuInfo::CoreClock }
+    };
+
+    constexpr auto MemoryFields = MakeSensorTable<MemoryInfo>({
+        { DataSensor, "Memory Used", "MemoryUsed", &MemoryInfo::memoryUsed },
+        { DataSensor, "Memory Available", "MemoryAvailable", &MemoryInfo::memoryAvailable },
+        { LoadSensor, "Memory", "MemoryUtilization", &MemoryInfo::memoryUtilization },
+        { DataSensor, "Virtual Memory Used", "VirtualMemoryUsed", &MemoryInfo::virtualMemoryUsed },
+        { DataSensor, "Virtual Memory Available", "VirtualMemoryAvailable", &MemoryInfo::virtualMemoryAvailable },
+        { LoadSensor, "Virtual Memory", "VirtualMemoryUtilization", &MemoryInfo::virtualMemoryUtilization }
+    }, false);
+
+    constexpr auto StorageFields = MakeSensorTable<StorageInfo>({
+        { LoadSensor, "Used Space", "UsedSpace", &StorageInfo::usedSpace },
+        { LoadSensor, "Read Activity", "ReadActivity", &StorageInfo::readActivity },
+        { LoadSensor, "Write Activity", "WriteActivity", &StorageInfo::writeActivity },
+        { LoadSensor, "Total Activity", "TotalActivity", &StorageInfo::totalActivity },
+        { ThroughputSensor, "Read Rate", "ReadRate", &StorageInfo::readRate },
+        { ThroughputSensor, "Write Rate", "WriteRate", &StorageInfo::writeRate }
+    }, false);
+
+    constexpr auto NetworkFields = MakeSensorTable<NetworkInfo>({
+        { DataSensor, "Data Uploaded", "DataUploaded", &NetworkInfo::dataUploaded },
+        { DataSensor, "Data Downloaded", "DataDownloaded", &NetworkInfo::dataDownloaded },
+        { ThroughputSensor, "Upload Speed", "UploadSpeed", &NetworkInfo::uploadSpeed },
+        { ThroughputSensor, "Download Speed", "DownloadSpeed", &NetworkInfo::downloadSpeed },
+        { LoadSensor, "Network utilization", "NetworkUtilization", &NetworkInfo::networkUtilization }
+    }, false);
+
+    // 充電與放電時 LibreHardwareMonitor 使用不同的名稱
+    constexpr auto BatteryFields = MakeSensorTable<BatteryInfo>({
+        { LevelSensor, "Charge Level", "ChargeLevel", &BatteryInfo::chargeLevel },
+        { LevelSensor, "Degradation Level", "DegradationLevel", &BatteryInfo::degradationLevel },
+        { VoltageSensor, "Voltage", "Voltage", &BatteryInfo::voltage },
+        { CurrentSensor, "Charge Current", "ChargeCurrent", &BatteryInfo::chargeCurrent },
+        { CurrentSensor, "Discharge Current", "DischargeCurrent", &BatteryInfo::dischargeCurrent },
+        { PowerSensor, "Charge Rate", "ChargeRate", &BatteryInfo::chargeRate },
+        { PowerSensor, "Discharge Rate", "DischargeRate", &BatteryInfo::dischargeRate },
+        { EnergySensor, "Designed Capacity", "DesignedCapacity", &BatteryInfo::designedCapacity },
+        { EnergySensor, "Full Charged Capacity", "FullChargedCapacity", &BatteryInfo::fullChargedCapacity },
+        { EnergySensor, "Remaining Capacity", "RemainingCapacity", &BatteryInfo::remainingCapacity },
+        { TimeSpanSensor, "Remaining Time (Estimated)", "RemainingTime", &BatteryInfo::remainingTime }
+    });
+
+    static_assert(CpuFields.Valid() && MemoryFields.Valid() && StorageFields.Valid() && NetworkFields.Valid() && BatteryFields.Valid(),
+        "描述表中有重複的感測器類型與名稱");
+}
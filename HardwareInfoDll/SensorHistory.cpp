@@ -0,0 +1,221 @@
+﻿#include "SensorHistory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+
+namespace HardwareInfoDll {
+    namespace {
+        // 一個解析度的環狀緩衝區，所有感測器共用區間的起始時間
+        struct Level {
+            HistoryLevel config;
+            std::vector<int64_t> starts;  // 每個位置的區間起始時間
+            std::vector<HistoryPoint> points;  // 依感測器排列：points[sensor * capacity + position]
+            size_t head = 0;  // 最新區間的位置
+            size_t size = 0;  // 已使用的區間數量
+
+            // 由舊到新的第 i 個區間在緩衝區中的位置
+            size_t Position(size_t index) const {
+                return (head + config.capacity - size + 1 + index) % config.capacity;
+            }
+        };
+
+        const HistoryPoint EmptyPoint = {
+            std::numeric_limits<float>::quiet_NaN(),
+            std::numeric_limits<float>::quiet_NaN(),
+            std::numeric_limits<float>::quiet_NaN(),
+            std::numeric_limits<float>::quiet_NaN(),
+            0
+        };
+
+        // 將一個樣本併入區間統計 (平均值以遞增方式維護，不需要保留樣本)
+        inline void Fold(HistoryPoint& point, float value) {
+            if (point.count == 0) {
+                point.min = point.max = point.average = point.last = value;
+                point.count = 1;
+                return;
+            }
+            point.min = std::min(point.min, value);
+            point.max = std::max(point.max, value);
+            point.count++;
+            point.average += (value - point.average) / static_cast<float>(point.count);
+            point.last = value;
+        }
+    }
+
+    struct SensorHistory::Impl {
+        std::vector<Level> levels;
+        size_t sensors = 0;
+        size_t maxSensors = 0;
+        mutable std::shared_mutex lock;  // 記錄時獨占，查詢時共用
+
+        void Configure(const std::vector<HistoryLevel>& configs, size_t limit) {
+            levels.clear();
+            for (const HistoryLevel& config : configs) {
+                if (config.capacity == 0 || config.resolution < 0) continue;
+
+                Level level;
+                level.config = config;
+                level.starts.assign(config.capacity, 0);
+                levels.push_back(std::move(level));
+            }
+
+            // 由細到粗排列，查詢時依序尋找
+            std::sort(levels.begin(), levels.end(), [](const Level& a, const Level& b) {
+                return a.config.resolution < b.config.resolution;
+            });
+            sensors = 0;
+            maxSensors = limit;
+        }
+
+        // 新的槽位加在尾端，既有感測器的資料不需要搬移
+        void Grow(size_t count) {
+            size_t target = std::min(count, maxSensors);
+            if (target <= sensors) return;
+
+            for (Level& level : levels) {
+                level.points.resize(target * level.config.capacity, EmptyPoint);
+            }
+            sensors = target;
+        }
+    };
+
+    std::vector<HistoryLevel> SensorHistory::DefaultLevels() {
+        const int64_t second = 1000000;
+        return {
+            { 0, 120 },
+            { 10 * second, 180 },
+            { 60 * second, 240 },
+            { 3600 * second, 48 }
+        };
+    }
+
+    SensorHistory::SensorHistory(const std::vector<HistoryLevel>& levels, size_t maxSensors) : impl(new Impl()) {
+        impl->Configure(levels, maxSensors);
+    }
+
+    SensorHistory::~SensorHistory() {
+        delete impl;
+    }
+
+    void SensorHistory::Configure(const std::vector<HistoryLevel>& levels, size_t maxSensors) {
+        std::unique_lock<std::shared_mutex> guard(impl->lock);
+        impl->Configure(levels, maxSensors);
+    }
+
+    void SensorHistory::Record(int64_t timestamp, const float* values, size_t count) {
+        std::unique_lock<std::shared_mutex> guard(impl->lock);
+        impl->Grow(count);
+
+        size_t sensors = impl->sensors;
+        size_t recorded = std::min(count, sensors);
+        for (Level& level : impl->levels) {
+            size_t capacity = level.config.capacity;
+            int64_t resolution = level.config.resolution;
+            int64_t start = timestamp;
+            if (resolution > 0) {
+                start = timestamp / resolution * resolution;
+                if (timestamp < 0 && start != timestamp) start -= resolution;
+            }
+
+            // 進入新的區間時清空該位置；時間倒退時併入目前區間，保持起始時間遞增
+            bool advance = level.size == 0 || start > level.starts[level.head];
+            if (advance) {
+                level.head = level.size == 0 ? 0 : (level.head + 1) % capacity;
+                level.size = std::min(level.size + 1, capacity);
+                level.starts[level.head] = start;
+            }
+
+            HistoryPoint* point = level.points.data() + level.head;
+            for (size_t sensor = 0; sensor < sensors; ++sensor, point += capacity) {
+                if (advance) *point = EmptyPoint;
+                if (sensor < recorded && !std::isnan(values[sensor])) Fold(*point, values[sensor]);
+            }
+        }
+    }
+
+    int64_t SensorHistory::Query(size_t sensor, int64_t from, int64_t to, int64_t resolution,
+        std::vector<int64_t>& timestamps, std::vector<HistoryPoint>& points) const {
+        timestamps.clear();
+        points.clear();
+
+        std::shared_lock<std::shared_mutex> guard(impl->lock);
+
+        const Level* selected = nullptr;
+        for (const Level& level : impl->levels) {
+            if (level.config.resolution <= resolution) selected = &level;
+        }
+        if (!selected) return -1;
+
+        const Level& level = *selected;
+        int64_t width = level.config.resolution;
+        if (sensor >= impl->sensors || level.size == 0 || from > to) return width;
+
+        // 區間起始時間遞增，以二分搜尋找出與 [from, to] 重疊的範圍
+        auto lowerBound = [&](auto predicate) {
+            size_t low = 0, high = level.size;
+            while (low < high) {
+                size_t middle = (low + high) / 2;
+                if (predicate(level.starts[level.Position(middle)])) high = middle;
+                else low = middle + 1;
+            }
+            return low;
+        };
+        size_t first = lowerBound([&](int64_t start) { return width > 0 ? start + width > from : start >= from; });
+        size_t last = lowerBound([&](int64_t start) { return start > to; });
+        if (first >= last) return width;
+
+        size_t count = last - first;
+        timestamps.resize(count);
+        points.resize(count);
+
+        // 環狀緩衝區最多分成兩段連續記憶體
+        size_t capacity = level.config.capacity;
+        const HistoryPoint* sensorPoints = level.points.data() + sensor * capacity;
+        size_t position = level.Position(first);
+        size_t leading = std::min(count, capacity - position);
+        std::memcpy(timestamps.data(), level.starts.data() + position, leading * sizeof(int64_t));
+        std::memcpy(points.data(), sensorPoints + position, leading * sizeof(HistoryPoint));
+        if (leading < count) {
+            std::memcpy(timestamps.data() + leading, level.starts.data(), (count - leading) * sizeof(int64_t));
+            std::memcpy(points.data() + leading, sensorPoints, (count - leading) * sizeof(HistoryPoint));
+        }
+        return width;
+    }
+
+    std::vector<HistoryLevel> SensorHistory::Levels() const {
+        std::shared_lock<std::shared_mutex> guard(impl->lock);
+        std::vector<HistoryLevel> levels;
+        for (const Level& level : impl->levels) levels.push_back(level.config);
+        return levels;
+    }
+
+    size_t SensorHistory::SensorCount() const {
+        std::shared_lock<std::shared_mutex> guard(impl->lock);
+        return impl->sensors;
+    }
+
+    size_t SensorHistory::MaxSensors() const {
+        std::shared_lock<std::shared_mutex> guard(impl->lock);
+        return impl->maxSensors;
+    }
+
+    size_t SensorHistory::BytesPerSensor() const {
+        std::shared_lock<std::shared_mutex> guard(impl->lock);
+        size_t bytes = 0;
+        for (const Level& level : impl->levels) bytes += level.config.capacity * sizeof(HistoryPoint);
+        return bytes;
+    }
+
+    size_t SensorHistory::MemoryBytes() const {
+        std::shared_lock<std::shared_mutex> guard(impl->lock);
+        size_t bytes = 0;
+        for (const Level& level : impl->levels) {
+            bytes += level.points.capacity() * sizeof(HistoryPoint) + level.starts.capacity() * sizeof(int64_t);
+        }
+        return bytes;
+    }
+}
@@ -0,0 +1,64 @@
+﻿#pragma once
+
+// 感測器歷史：每個感測器在多個解析度各有一個固定容量的環狀緩衝區，
+// 每次取樣以 O(1) 更新各解析度目前區間的 min/max/avg/last，查詢不需要掃描原始樣本。
+// 純原生程式碼 (不使用 /clr)，記憶體用量只由設定決定：感測器數量 x BytesPerSensor()。
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace HardwareInfoDll {
+    // 一個解析度的設定
+    struct HistoryLevel {
+        int64_t resolution = 0;  // 區間長度 (微秒)，0 表示保存每一次取樣
+        size_t capacity = 0;  // 保留的區間數量
+    };
+
+    // 一個區間的統計 (沒有數值的區間 count 為 0，其餘欄位為 NaN)
+    struct HistoryPoint {
+        float min;
+        float max;
+        float average;
+        float last;
+        uint32_t count;  // 區間內的樣本數
+    };
+
+    class SensorHistory {
+        struct Impl;
+        Impl* impl;
+
+        public:
+        static const size_t DefaultMaxSensors = 8192;
+
+        // 預設解析度：原始 120 筆、10 秒 x 30 分鐘、1 分鐘 x 4 小時、1 小時 x 2 天 (每個感測器約 11.5 KB)
+        static std::vector<HistoryLevel> DefaultLevels();
+
+        SensorHistory(const std::vector<HistoryLevel>& levels, size_t maxSensors);
+        ~SensorHistory();
+
+        SensorHistory(const SensorHistory&) = delete;
+        SensorHistory& operator=(const SensorHistory&) = delete;
+
+        // 重新設定解析度 (清除所有歷史)
+        void Configure(const std::vector<HistoryLevel>& levels, size_t maxSensors);
+
+        // 記錄一次取樣，values 依槽位排列 (NaN 表示沒有數值)；超過 maxSensors 的槽位不記錄
+        void Record(int64_t timestamp, const float* values, size_t count);
+
+        // 取得 [from, to] 區間的歷史 (時間為 Unix epoch 微秒)，結果由舊到新連續排列。
+        // 使用解析度不大於 resolution 的最粗層級，回傳實際使用的解析度 (沒有符合的層級時回傳 -1)
+        int64_t Query(size_t sensor, int64_t from, int64_t to, int64_t resolution,
+            std::vector<int64_t>& timestamps, std::vector<HistoryPoint>& points) const;
+
+        std::vector<HistoryLevel> Levels() const;
+
+        size_t SensorCount() const;  // 目前記錄的感測器數量
+
+        size_t MaxSensors() const;
+
+        size_t BytesPerSensor() const;  // 每個感測器固定使用的位元組數
+
+        size_t MemoryBytes() const;  // 目前配置的位元組數
+    };
+}
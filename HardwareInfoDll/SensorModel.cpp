@@ -0,0 +1,521 @@
+﻿#include "SensorModel.h"
+#include "SensorDescriptors.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+namespace HardwareInfoDll {
+    using HardwareBinder = void(*)(const SourceHardware&, SensorModel&);
+
+    bool IsGpuType(int hardwareType) {
+        return hardwareType == GpuNvidiaHardware ||
+            hardwareType == GpuAmdHardware ||
+            hardwareType == GpuIntelHardware;
+    }
+
+    InfoCategory CategoryOf(int hardwareType) {
+        switch (hardwareType) {
+            case CpuHardware: return CpuCategory;
+            case GpuNvidiaHardware:
+            case GpuAmdHardware:
+            case GpuIntelHardware: return GpuCategory;
+            case MemoryHardware: return MemoryCategory;
+            case StorageHardware: return StorageCategory;
+            case NetworkHardware: return NetworkCategory;
+            case MotherboardHardware:
+            case SuperIOHardware:
+            case CoolerHardware:
+            case EmbeddedControllerHardware:
+            case PsuHardware:
+            case BatteryHardware: return DeviceCategory;
+            default: return NoCategory;
+        }
+    }
+
+    // 等待依拓撲配置陣列後才繫結的每核心感測器
+    struct CoreSensor {
+        size_t sensorIndex;  // 在 hardware.sensors 中的位置
+        int core;  // 核心編號 (從 1 開始，0 表示名稱中沒有編號)
+        int thread;  // 執行緒編號 (從 1 開始，0 表示名稱中沒有編號)
+        int series;  // 在 CpuSeries 中的位置
+    };
+
+    static const size_t CpuSeriesCount = sizeof(CpuSeries) / sizeof(CpuSeries[0]);
+    static const size_t CoreLoadSeries = 0;  // CpuSeries 的第一項，用來計算核心/執行緒數量
+
+    // 沒有對應欄位的感測器在 CpuSeries 中的位置 (不是每核心感測器時回傳 -1)
+    static int CpuSeriesFor(const SourceSensor& sensor) {
+        for (size_t s = 0; s < CpuSeriesCount; ++s) {
+            if (sensor.sensorType == CpuSeries[s].sensorType && sensor.name.compare(0, NameLength(CpuSeries[s].prefix), CpuSeries[s].prefix) == 0)
+                return static_cast<int>(s);
+        }
+        return -1;
+    }
+
+    // 解析 "CPU Core #12" 或 "CPU Core #12 Thread #2" 中的核心與執行緒編號
+    static void ParseCoreName(const std::string& name, int& core, int& thread) {
+        core = 0;
+        thread = 0;
+
+        size_t pos = name.find('#');
+        if (pos == std::string::npos) return;
+        core = std::atoi(name.c_str() + pos + 1);
+
+        pos = name.find('#', pos + 1);
+        if (pos == std::string::npos) return;
+        thread = std::atoi(name.c_str() + pos + 1);
+    }
+
+    // 依描述表繫結名稱符合的感測器；沒有對應欄位的感測器加入 unmatched (nullptr 時只保存在槽位)
+    template <typename Info, size_t N>
+    static void BindFields(const SourceHardware& hardware, SensorModel& model, const SensorTable<Info, N>& table, Info& info, std::vector<size_t>* unmatched) {
+        for (size_t i = 0; i < hardware.sensors.size(); ++i) {
+            const SourceSensor& sensor = hardware.sensors[i];
+            const FieldDescriptor<Info>* descriptor = table.Find(sensor.sensorType, sensor.name);
+            if (descriptor) model.Bind(hardware, i, &(info.*(descriptor->field)));
+            else if (unmatched) unmatched->push_back(i);
+            else model.Bind(hardware, i, nullptr);
+        }
+    }
+
+    // 定義硬體繫結函數：只在首次列舉或硬體集合改變時執行，解析每個感測器對應的欄位
+    void BindCPU(const SourceHardware& hardware, SensorModel& model) {
+        CpuInfo& cpu = model.cpu;
+        cpu.Name = hardware.name;
+
+        std::vector<size_t> unmatched;
+        BindFields(hardware, model, CpuFields, cpu, &unmatched);
+
+        std::vector<CoreSensor> coreSensors;
+        for (size_t i : unmatched) {
+            const SourceSensor& sensor = hardware.sensors[i];
+            int series = CpuSeriesFor(sensor);
+            if (series < 0) {
+                model.Bind(hardware, i, nullptr);
+                continue;
+            }
+
+            CoreSensor coreSensor;
+            coreSensor.sensorIndex = i;
+            ParseCoreName(sensor.name, coreSensor.core, coreSensor.thread);
+            coreSensor.series = series;
+            coreSensors.push_back(coreSensor);
+        }
+
+        // 依核心/執行緒編號排序，沒有編號的放在最後
+        std::stable_sort(coreSensors.begin(), coreSensors.end(), [](const CoreSensor& a, const CoreSensor& b) {
+            unsigned int coreA = static_cast<unsigned int>(a.core - 1), coreB = static_cast<unsigned int>(b.core - 1);
+            return coreA != coreB ? coreA < coreB : a.thread < b.thread;
+        });
+
+        // Values 已由 SizeCoreSeries 依所有 CPU 決定大小 (繫結後不會重新配置)，
+        // 多個 CPU 封裝依序接在前一個封裝之後，下一個位置即為 Names 的大小；核心編號也接續前一個封裝
+        int coreOffset = cpu.Cores;
+        int lastCore = 0;
+        int cores = 0;
+        for (const auto& coreSensor : coreSensors) {
+            CoreSeries& series = cpu.*(CpuSeries[coreSensor.series].series);
+            size_t index = series.Names.size();
+            series.Names.push_back(hardware.sensors[coreSensor.sensorIndex].name);
+            model.Bind(hardware, coreSensor.sensorIndex, &series.Values[index]);
+
+            if (coreSensor.series == CoreLoadSeries) {
+                cpu.ThreadCore.push_back(coreSensor.core > 0 ? coreSensor.core + coreOffset : 0);
+                if (coreSensor.core > 0 && coreSensor.core != lastCore) {
+                    lastCore = coreSensor.core;
+                    cores++;
+                }
+            }
+        }
+
+        // 核心/執行緒數量只在拓撲改變時計算一次
+        cpu.Cores = coreOffset + cores;
+        cpu.Threads = static_cast<int>(cpu.ThreadCore.size());
+    }
+
+    // 在繫結任何 CPU 之前，依所有 CPU 硬體的每核心感測器數量一次配置 Values；
+    // 逐一配置時第二個 CPU 封裝會重新配置陣列，使第一個封裝已繫結的欄位指標失效
+    static void SizeCoreSeries(const std::vector<SourceHardware>& hardware, CpuInfo& cpu) {
+        size_t counts[CpuSeriesCount] = {};
+        for (const auto& entry : hardware) {
+            if (entry.hardwareType != CpuHardware) continue;
+
+            for (const auto& sensor : entry.sensors) {
+                if (CpuFields.Find(sensor.sensorType, sensor.name)) continue;  // 與 BindCPU 相同：欄位優先
+                int series = CpuSeriesFor(sensor);
+                if (series >= 0) counts[series]++;
+            }
+        }
+
+        for (size_t series = 0; series < CpuSeriesCount; ++series) {
+            CoreSeries& coreSeries = cpu.*(CpuSeries[series].series);
+            coreSeries.Names.reserve(counts[series]);
+            coreSeries.Values.assign(counts[series], 0.0f);
+        }
+    }
+
+    void BindGPU(const SourceHardware& hardware, SensorModel& model) {
+        auto& gpuSensors = model.gpu[hardware.name];
+
+        for (size_t i = 0; i < hardware.sensors.size(); ++i) {
+            const SourceSensor& sensor = hardware.sensors[i];
+
+            auto& gpuSensor = gpuSensors[sensor.name];
+            gpuSensor.Type = SensorTypeName(sensor.sensorType);  // 類型字串只在繫結時產生
+
+            model.Bind(hardware, i, &gpuSensor.Value);
+        }
+    }
+
+    void BindMemory(const SourceHardware& hardware, SensorModel& model) {
+        model.memory.name = hardware.name;
+        BindFields(hardware, model, MemoryFields, model.memory, nullptr);
+    }
+
+    void BindStorage(const SourceHardware& hardware, SensorModel& model) {
+        auto& storage = model.storage[hardware.name];  // unordered_map 的元素位址在 rehash 後仍然有效
+        BindFields(hardware, model, StorageFields, storage, nullptr);
+    }
+
+    void BindNetwork(const SourceHardware& hardware, SensorModel& model) {
+        auto& network = model.network[Utf8ToWide(hardware.name)];
+        BindFields(hardware, model, NetworkFields, network, nullptr);
+    }
+
+    // 主機板、Super I/O、EC、散熱控制器、電源供應器與電池：電池的固定名稱繫結到欄位，其餘依感測器類型分組
+    void BindDevice(const SourceHardware& hardware, SensorModel& model) {
+        DeviceInfo& device = model.devices[hardware.name];
+        device.hardwareType = hardware.hardwareType;
+
+        std::vector<size_t> unmatched;
+        if (hardware.hardwareType == BatteryHardware) BindFields(hardware, model, BatteryFields, device.battery, &unmatched);
+        else for (size_t i = 0; i < hardware.sensors.size(); ++i) unmatched.push_back(i);
+
+        std::stable_sort(unmatched.begin(), unmatched.end(), [&](size_t a, size_t b) {
+            return hardware.sensors[a].sensorType < hardware.sensors[b].sensorType;
+        });
+
+        // 先決定每組的大小，繫結後就不會再重新配置 (同名的硬體接在後面，不改變已繫結的組)
+        size_t firstGroup = device.groups.size();
+        for (size_t i : unmatched) {
+            const SourceSensor& sensor = hardware.sensors[i];
+            if (device.groups.size() == firstGroup || device.groups.back().sensorType != sensor.sensorType) {
+                device.groups.emplace_back();
+                device.groups.back().sensorType = sensor.sensorType;
+            }
+            device.groups.back().sensors.Names.push_back(sensor.name);
+        }
+        for (size_t g = firstGroup; g < device.groups.size(); ++g) device.groups[g].sensors.Values.assign(device.groups[g].sensors.Names.size(), 0.0f);
+
+        size_t group = firstGroup;
+        size_t next = 0;
+        for (size_t i : unmatched) {
+            if (next == device.groups[group].sensors.Values.size()) {
+                group++;
+                next = 0;
+            }
+            model.Bind(hardware, i, &device.groups[group].sensors.Values[next++]);
+        }
+    }
+
+    // 使用 std::unordered_map 來管理硬體繫結函數
+    static const std::unordered_map<int, HardwareBinder> hardwareBinders = {
+        { CpuHardware, &BindCPU },
+        { GpuNvidiaHardware, &BindGPU },
+        { GpuAmdHardware, &BindGPU },
+        { GpuIntelHardware, &BindGPU },
+        { MemoryHardware, &BindMemory },
+        { StorageHardware, &BindStorage },
+        { NetworkHardware, &BindNetwork },
+        { MotherboardHardware, &BindDevice },
+        { SuperIOHardware, &BindDevice },
+        { CoolerHardware, &BindDevice },
+        { EmbeddedControllerHardware, &BindDevice },
+        { PsuHardware, &BindDevice },
+        { BatteryHardware, &BindDevice }
+    };
+
+    void SensorModel::Rebind(const std::vector<SourceHardware>& hardware) {
+        // 清除舊的欄位，槽位依 Identifier 保留
+        cpu.CoreLoad.Clear();
+        cpu.CoreTemperature.Clear();
+        cpu.CoreVoltage.Clear();
+        cpu.CoreClock.Clear();
+        cpu.ThreadCore.clear();
+        cpu.Cores = 0;
+        cpu.Derived.Clear();
+        cpu.Topology.Clear();
+        memory.derived.Clear();
+        gpu.clear();
+        storage.clear();
+        network.clear();
+        devices.clear();
+        for (auto& slot : slots) slot.field = nullptr;
+
+        bindings.clear();
+        boundSlots.clear();
+        sourceValues.clear();
+        boundHardware.clear();
+        derivedSlots.clear();
+
+        SizeCoreSeries(hardware, cpu);
+        for (size_t i = 0; i < hardware.size(); ++i) {
+            auto binder = hardwareBinders.find(hardware[i].hardwareType);
+            if (binder == hardwareBinders.end()) continue;
+
+            HardwareBinding binding;
+            binding.hardwareIndex = i;
+            binding.firstSensor = boundSlots.size();
+            binding.sensorCount = hardware[i].sensors.size();
+            binding.hardwareType = hardware[i].hardwareType;
+            binding.isGpu = IsGpuType(hardware[i].hardwareType);
+            binding.category = CategoryOf(hardware[i].hardwareType);
+            bindings.push_back(binding);
+
+            boundSlots.resize(binding.firstSensor + binding.sensorCount, Unbound);
+            sourceValues.resize(binding.firstSensor + binding.sensorCount, std::numeric_limits<float>::quiet_NaN());
+
+            binder->second(hardware[i], *this);
+            boundHardware.push_back(hardware[i]);
+        }
+    }
+
+    void SensorModel::Bind(const SourceHardware& hardware, size_t sensorIndex, float* field) {
+        const SourceSensor& sensor = hardware.sensors[sensorIndex];
+
+        size_t slot = SlotFor(sensor.identifier);
+        SensorSlot& boundSlot = slots[slot];
+        boundSlot.hardwareName = hardware.name;
+        boundSlot.name = sensor.name;
+        boundSlot.hardwareType = hardware.hardwareType;
+        boundSlot.sensorType = sensor.sensorType;
+        boundSlot.field = field;
+
+        if (sensor.value == sensor.value) {  // 不是 NaN
+            values[slot] = sensor.value;
+            if (field) *field = sensor.value;
+        }
+
+        size_t position = bindings.back().firstSensor + sensorIndex;
+        boundSlots[position] = slot;
+        sourceValues[position] = sensor.value;
+    }
+
+    size_t SensorModel::BindDerived(const SensorSlot& description, float* field) {
+        size_t slot = SlotFor(description.identifier);
+        SensorSlot& boundSlot = slots[slot];
+        boundSlot.hardwareName = description.hardwareName;
+        boundSlot.name = description.name;
+        boundSlot.hardwareType = description.hardwareType;
+        boundSlot.sensorType = description.sensorType;
+        boundSlot.field = field;
+        if (field) *field = values[slot];  // 重新繫結後欄位沿用槽位的最新數值
+
+        derivedSlots.push_back(slot);
+        return slot;
+    }
+
+    // 同一個 Identifier 永遠使用同一個槽位
+    size_t SensorModel::SlotFor(const std::string& identifier) {
+        auto found = slotIndex.find(identifier);
+        if (found != slotIndex.end()) return found->second;
+
+        size_t slot = slots.size();
+        SensorSlot newSlot;
+        newSlot.identifier = identifier;
+        slots.push_back(newSlot);
+        values.push_back(0.0f);
+        slotIndex.emplace(identifier, slot);
+        return slot;
+    }
+
+    void SensorModel::LockValues() const {
+        while (valuesLock.test_and_set(std::memory_order_acquire)) std::this_thread::yield();
+    }
+
+    void SensorModel::UnlockValues() const {
+        valuesLock.clear(std::memory_order_release);
+    }
+
+    bool SensorModel::Poll(SensorSource& source, size_t bindingIndex) {
+        Fetch(source, bindingIndex);
+
+        LockValues();
+        bool changed = Apply(bindingIndex);
+        UnlockValues();
+        return changed;
+    }
+
+    void SensorModel::Fetch(SensorSource& source, size_t bindingIndex) {
+        const HardwareBinding& binding = bindings[bindingIndex];
+        source.Update(binding.hardwareIndex, sourceValues.data() + binding.firstSensor);
+    }
+
+    bool SensorModel::Apply(size_t bindingIndex) {
+        const HardwareBinding& binding = bindings[bindingIndex];
+        bool changed = false;
+
+        // 只複製浮點數，不做任何字串處理或配置
+        size_t end = binding.firstSensor + binding.sensorCount;
+        for (size_t i = binding.firstSensor; i < end; ++i) {
+            float value = sourceValues[i];
+            size_t slot = boundSlots[i];
+            if (value != value || slot == Unbound) continue;  // 沒有數值 (NaN) 或沒有繫結
+
+            if (values[slot] != value) changed = true;
+            values[slot] = value;
+            if (slots[slot].field) *slots[slot].field = value;
+        }
+        return changed;
+    }
+
+    // 位址對照：模型結構中的一段記憶體對應到 frame 中的同一段
+    struct AddressRange {
+        const char* source;
+        size_t size;
+        char* target;
+    };
+
+    template <typename T>
+    static void AddRange(std::vector<AddressRange>& ranges, const T* source, T* target, size_t count = 1) {
+        if (count == 0) return;
+        ranges.push_back({ reinterpret_cast<const char*>(source), sizeof(T) * count, reinterpret_cast<char*>(target) });
+    }
+
+    // 只在目錄版本改變時執行：複製結構 (名稱、拓撲) 並把每個槽位的欄位指標轉換到這個 frame
+    void SensorModel::BuildFrameLayout(HardwareFrame& frame, unsigned int catalogVersion) const {
+        frame.cpu = cpu;
+        frame.gpu = gpu;
+        frame.memory = memory;
+        frame.storage = storage;
+        frame.network = network;
+        frame.devices = devices;
+
+        std::vector<AddressRange> ranges;
+        AddRange(ranges, &cpu, &frame.cpu);
+        AddRange(ranges, cpu.CoreLoad.Values.data(), frame.cpu.CoreLoad.Values.data(), cpu.CoreLoad.Values.size());
+        AddRange(ranges, cpu.CoreTemperature.Values.data(), frame.cpu.CoreTemperature.Values.data(), cpu.CoreTemperature.Values.size());
+        AddRange(ranges, cpu.CoreVoltage.Values.data(), frame.cpu.CoreVoltage.Values.data(), cpu.CoreVoltage.Values.size());
+        AddRange(ranges, cpu.CoreClock.Values.data(), frame.cpu.CoreClock.Values.data(), cpu.CoreClock.Values.size());
+        AddRange(ranges, cpu.Derived.Values.data(), frame.cpu.Derived.Values.data(), cpu.Derived.Values.size());
+        AddRange(ranges, cpu.Topology.Values.data(), frame.cpu.Topology.Values.data(), cpu.Topology.Values.size());
+        AddRange(ranges, &memory, &frame.memory);
+        AddRange(ranges, memory.derived.Values.data(), frame.memory.derived.Values.data(), memory.derived.Values.size());
+        for (auto& gpuEntry : gpu) {
+            auto& frameSensors = frame.gpu.find(gpuEntry.first)->second;
+            for (auto& sensor : gpuEntry.second) {
+                AddRange(ranges, &sensor.second, &frameSensors.find(sensor.first)->second);
+            }
+        }
+        for (auto& storageEntry : storage) {
+            StorageInfo& frameStorage = frame.storage.find(storageEntry.first)->second;
+            AddRange(ranges, &storageEntry.second, &frameStorage);
+            AddRange(ranges, storageEntry.second.derived.Values.data(), frameStorage.derived.Values.data(), storageEntry.second.derived.Values.size());
+        }
+        for (auto& networkEntry : network) {
+            NetworkInfo& frameNetwork = frame.network.find(networkEntry.first)->second;
+            AddRange(ranges, &networkEntry.second, &frameNetwork);
+            AddRange(ranges, networkEntry.second.derived.Values.data(), frameNetwork.derived.Values.data(), networkEntry.second.derived.Values.size());
+        }
+        for (auto& deviceEntry : devices) {
+            DeviceInfo& frameDevice = frame.devices.find(deviceEntry.first)->second;
+            AddRange(ranges, &deviceEntry.second.battery, &frameDevice.battery);
+            for (size_t g = 0; g < deviceEntry.second.groups.size(); ++g) {
+                const CoreSeries& sensors = deviceEntry.second.groups[g].sensors;
+                AddRange(ranges, sensors.Values.data(), frameDevice.groups[g].sensors.Values.data(), sensors.Values.size());
+            }
+            AddRange(ranges, deviceEntry.second.derived.Values.data(), frameDevice.derived.Values.data(), deviceEntry.second.derived.Values.size());
+        }
+
+        std::sort(ranges.begin(), ranges.end(), [](const AddressRange& a, const AddressRange& b) {
+            return std::less<const char*>()(a.source, b.source);
+        });
+
+        size_t count = slots.size();
+        frame.fields.assign(count, nullptr);
+        for (size_t slot = 0; slot < count; ++slot) {
+            const char* field = reinterpret_cast<const char*>(slots[slot].field);
+            if (!field) continue;
+
+            auto range = std::upper_bound(ranges.begin(), ranges.end(), field, [](const char* address, const AddressRange& r) {
+                return std::less<const char*>()(address, r.source);
+            });
+            if (range == ranges.begin()) continue;
+            --range;
+            if (field < range->source + range->size)
+                frame.fields[slot] = reinterpret_cast<float*>(range->target + (field - range->source));
+        }
+
+        frame.snapshot.assign(sizeof(HwiSnapshotHeader) + count * sizeof(float), 0);
+        auto header = reinterpret_cast<HwiSnapshotHeader*>(frame.snapshot.data());
+        header->magic = HWI_SNAPSHOT_MAGIC;
+        header->version = HWI_SNAPSHOT_VERSION;
+        header->catalogVersion = catalogVersion;
+        header->sensorCount = static_cast<uint32_t>(count);
+
+        frame.catalogVersion = catalogVersion;
+    }
+
+    void SensorModel::FillFrame(HardwareFrame& frame) const {
+        const float* source = values.data();
+        float* frameValues = frame.Values();
+        float* const* fields = frame.fields.data();
+        size_t count = frame.fields.size();
+        for (size_t slot = 0; slot < count; ++slot) {
+            frameValues[slot] = source[slot];
+            if (fields[slot]) *fields[slot] = source[slot];
+        }
+    }
+
+    // 感測器的單位
+    const char* UnitOf(int sensorType) {
+        switch (sensorType) {
+            case VoltageSensor: return "V";
+            case CurrentSensor: return "A";
+            case PowerSensor: return "W";
+            case ClockSensor: return "MHz";
+            case TemperatureSensor: return "\xC2\xB0" "C";
+            case LoadSensor: return "%";
+            case FrequencySensor: return "Hz";
+            case FanSensor: return "RPM";
+            case FlowSensor: return "L/h";
+            case ControlSensor: return "%";
+            case LevelSensor: return "%";
+            case DataSensor: return "GB";
+            case SmallDataSensor: return "MB";
+            case ThroughputSensor: return "B/s";
+            case TimeSpanSensor: return "s";
+            case EnergySensor: return "mWh";
+            case NoiseSensor: return "dBA";
+            case HumiditySensor: return "%";
+            default: return "";
+        }
+    }
+
+    // 複製字串並截斷，保證以 '\0' 結尾
+    static void CopyTruncated(char* destination, size_t capacity, const std::string& source) {
+        size_t length = source.size() < capacity - 1 ? source.size() : capacity - 1;
+        std::memcpy(destination, source.data(), length);
+        destination[length] = '\0';
+    }
+
+    // 呼叫端需確保繫結不會同時改變
+    int SensorModel::FillCatalog(HwiCatalogEntry* entries, int capacity) const {
+        int count = static_cast<int>(slots.size());
+        for (int slot = 0; slot < count && slot < capacity; ++slot) {
+            const SensorSlot& sensorSlot = slots[slot];
+            HwiCatalogEntry& entry = entries[slot];
+            entry.slot = static_cast<uint32_t>(slot);
+            entry.hardwareType = static_cast<uint16_t>(sensorSlot.hardwareType);
+            entry.sensorType = static_cast<uint16_t>(sensorSlot.sensorType);
+            CopyTruncated(entry.identifier, sizeof(entry.identifier), sensorSlot.identifier);
+            CopyTruncated(entry.hardwareName, sizeof(entry.hardwareName), sensorSlot.hardwareName);
+            CopyTruncated(entry.sensorName, sizeof(entry.sensorName), sensorSlot.name);
+            CopyTruncated(entry.unit, sizeof(entry.unit), UnitOf(sensorSlot.sensorType));
+        }
+        return count;
+    }
+}
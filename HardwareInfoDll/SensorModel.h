@@ -0,0 +1,82 @@
+﻿#pragma once
+
+// 感測器模型：依來源的硬體描述解析每個感測器對應的槽位與結構欄位，
+// 穩定狀態下套用數值只複製浮點數，不做任何字串處理或配置。
+// 純原生程式碼，由 HardwareInfo 與效能測試共用。
+
+#include "HardwareModel.h"
+#include "SensorSource.h"
+
+#include <stddef.h>
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace HardwareInfoDll {
+    class SensorModel {
+        std::string bindingHardwareName;  // 繫結中的硬體名稱
+        mutable std::atomic_flag valuesLock = ATOMIC_FLAG_INIT;  // 見 LockValues
+
+        size_t SlotFor(const std::string& identifier);  // Identifier 的槽位 (沒有時新增)
+
+        public:
+        CpuInfo cpu;
+        GpuInfoMap gpu;
+        MemoryInfo memory;
+        StorageInfoMap storage;
+        NetworkInfoMap network;
+        DeviceInfoMap devices;  // 主機板、Super I/O、EC、散熱控制器、電源供應器與電池
+
+        std::vector<SensorSlot> slots;  // 感測器槽位 (同一個 Identifier 永遠使用同一個槽位)
+        std::vector<float> values;  // 槽位對應的最新數值
+        std::unordered_map<std::string, size_t> slotIndex;  // Identifier -> 槽位
+
+        std::vector<HardwareBinding> bindings;  // 每個已繫結硬體的區段
+        std::vector<size_t> boundSlots;  // 來源感測器 (依 bindings 區段排列) 對應的槽位
+        std::vector<float> sourceValues;  // 來源寫入的數值，與 boundSlots 對齊 (NaN 表示沒有數值)
+        std::vector<SourceHardware> boundHardware;  // 已繫結硬體的描述 (錄製軌跡用)
+        std::vector<size_t> derivedSlots;  // 衍生指標的槽位 (不對應任何來源感測器)
+
+        static constexpr size_t Unbound = static_cast<size_t>(-1);
+
+        // 依描述重新繫結所有感測器 (清除舊的欄位，槽位依 Identifier 保留)
+        void Rebind(const std::vector<SourceHardware>& hardware);
+
+        // 繫結 hardware 的第 sensorIndex 個感測器到槽位及欄位 (由硬體繫結函數呼叫)
+        void Bind(const SourceHardware& hardware, size_t sensorIndex, float* field);
+
+        // 繫結衍生指標到槽位及欄位 (description 提供 Identifier 與目錄資訊，由 DerivedMetrics 與 TopologyAggregates 呼叫)，回傳槽位
+        size_t BindDerived(const SensorSlot& description, float* field);
+
+        // 寫入槽位與欄位 (Apply 與衍生指標) 以及複製到 frame (BuildFrameLayout、FillFrame) 時持有，
+        // 同時取樣的硬體不會讓 frame 含有同一個硬體一半新、一半舊的數值。
+        // 只保護複製浮點數的短區段 (來源的 Update() 在鎖外)，因此以自旋等待
+        void LockValues() const;
+        void UnlockValues() const;
+
+        // 從來源更新一個硬體並套用數值 (套用時取得 LockValues)，回傳是否有數值改變 (不同硬體可同時呼叫)
+        bool Poll(SensorSource& source, size_t bindingIndex);
+
+        // 從來源更新一個硬體，數值寫入 sourceValues (尚未套用，不需要 LockValues)
+        void Fetch(SensorSource& source, size_t bindingIndex);
+
+        // 將 sourceValues 中一個硬體的數值複製到槽位與欄位，回傳是否有數值改變 (呼叫端持有 LockValues)
+        bool Apply(size_t bindingIndex);
+
+        // 依目前的結構重建 frame 的版面 (只在目錄版本改變時需要，呼叫端持有 LockValues)
+        void BuildFrameLayout(HardwareFrame& frame, unsigned int catalogVersion) const;
+
+        // 複製所有槽位的數值到 frame (快照與結構欄位，呼叫端持有 LockValues)
+        void FillFrame(HardwareFrame& frame) const;
+
+        // 複製目錄，回傳項目總數
+        int FillCatalog(HwiCatalogEntry* entries, int capacity) const;
+    };
+
+    const char* UnitOf(int sensorType);  // 感測器的單位 (UTF-8)
+
+    InfoCategory CategoryOf(int hardwareType);  // 硬體對應的 Get*Info 類別
+
+    bool IsGpuType(int hardwareType);
+}
@@ -0,0 +1,586 @@
+﻿#include "SensorSource.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace HardwareInfoDll {
+    static const char TraceMagic[8] = { 'H', 'W', 'I', 'T', 'R', 'A', 'C', 'E' };
+    static const uint32_t TraceVersion = 1;
+
+    const char* SensorTypeName(int sensorType) {
+        static const char* const names[SensorTypeCount] = {
+            "Voltage", "Current", "Power", "Clock", "Temperature", "Load", "Frequency", "Fan", "Flow", "Control",
+            "Level", "Factor", "Data", "SmallData", "Throughput", "TimeSpan", "Energy", "Noise", "Conductivity", "Humidity"
+        };
+        return sensorType >= 0 && sensorType < SensorTypeCount ? names[sensorType] : "Unknown";
+    }
+
+    const char* HardwareTypeName(int hardwareType) {
+        static const char* const names[] = {
+            "Motherboard", "SuperIO", "Cpu", "Memory", "GpuNvidia", "GpuAmd", "GpuIntel", "Storage", "Network",
+            "Cooler", "EmbeddedController", "Psu", "Battery"
+        };
+        return hardwareType >= MotherboardHardware && hardwareType <= BatteryHardware ? names[hardwareType] : "Unknown";
+    }
+
+    std::wstring Utf8ToWide(const std::string& text) {
+        std::wstring result;
+        result.reserve(text.size());
+
+        size_t i = 0;
+        while (i < text.size()) {
+            unsigned char lead = static_cast<unsigned char>(text[i]);
+            unsigned int codePoint;
+            size_t length;
+            if (lead < 0x80) { codePoint = lead; length = 1; }
+            else if ((lead & 0xE0) == 0xC0) { codePoint = lead & 0x1F; length = 2; }
+            else if ((lead & 0xF0) == 0xE0) { codePoint = lead & 0x0F; length = 3; }
+            else if ((lead & 0xF8) == 0xF0) { codePoint = lead & 0x07; length = 4; }
+            else { codePoint = 0xFFFD; length = 1; }
+
+            if (i + length > text.size()) {
+                codePoint = 0xFFFD;
+                length = text.size() - i;
+            }
+            else {
+                for (size_t k = 1; k < length; ++k) {
+                    unsigned char next = static_cast<unsigned char>(text[i + k]);
+                    if ((next & 0xC0) != 0x80) {
+                        codePoint = 0xFFFD;
+                        length = k;
+                        break;
+                    }
+                    codePoint = (codePoint << 6) | (next & 0x3F);
+                }
+            }
+            i += length;
+
+            // wchar_t 為 16 位元 (Windows) 時以代理對表示 BMP 以外的字元
+            if (sizeof(wchar_t) == 2 && codePoint > 0xFFFF) {
+                codePoint -= 0x10000;
+                result.push_back(static_cast<wchar_t>(0xD800 + (codePoint >> 10)));
+                result.push_back(static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF)));
+            }
+            else {
+                result.push_back(static_cast<wchar_t>(codePoint));
+            }
+        }
+        return result;
+    }
+
+    std::string WideToUtf8(const std::wstring& text) {
+        std::string result;
+        result.reserve(text.size());
+
+        for (size_t i = 0; i < text.size(); ++i) {
+            unsigned int codePoint = static_cast<unsigned int>(text[i]);
+            if (sizeof(wchar_t) == 2 && codePoint >= 0xD800 && codePoint <= 0xDFFF) {
+                unsigned int low = i + 1 < text.size() ? static_cast<unsigned int>(text[i + 1]) : 0;
+                if (codePoint <= 0xDBFF && low >= 0xDC00 && low <= 0xDFFF) {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    i++;
+                }
+                else {
+                    codePoint = 0xFFFD;
+                }
+            }
+
+            if (codePoint < 0x80) {
+                result.push_back(static_cast<char>(codePoint));
+            }
+            else if (codePoint < 0x800) {
+                result.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+                result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+            else if (codePoint < 0x10000) {
+                result.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+                result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+            else {
+                result.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+                result.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+                result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+        }
+        return result;
+    }
+
+    // 單調時鐘 (微秒)，只用來計算重播進度
+    static int64_t SteadyMicroseconds() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 合成數值的範圍 (中心值與振幅)，接近真實硬體的量級
+    static void WaveRange(int sensorType, float& base, float& amplitude) {
+        switch (sensorType) {
+            case VoltageSensor: base = 1.1f; amplitude = 0.1f; break;
+            case CurrentSensor: base = 5.0f; amplitude = 3.0f; break;
+            case PowerSensor: base = 60.0f; amplitude = 40.0f; break;
+            case ClockSensor: base = 3500.0f; amplitude = 1000.0f; break;
+            case TemperatureSensor: base = 55.0f; amplitude = 15.0f; break;
+            case LoadSensor: base = 50.0f; amplitude = 45.0f; break;
+            case FanSensor: base = 1500.0f; amplitude = 500.0f; break;
+            case DataSensor: base = 8.0f; amplitude = 4.0f; break;
+            case SmallDataSensor: base = 4096.0f; amplitude = 2048.0f; break;
+            case ThroughputSensor: base = 5.0e6f; amplitude = 5.0e6f; break;
+            default: base = 50.0f; amplitude = 10.0f; break;
+        }
+    }
+
+    // xorshift32，回傳 [0, 1)
+    static float NextRandom(uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return static_cast<float>(state >> 8) / 16777216.0f;
+    }
+
+    // 逐一加入合成硬體的感測器，Identifier 與 LibreHardwareMonitor 相同格式 (/硬體/類型/編號)
+    class SyntheticBuilder {
+        SourceHardware& hardware;
+        std::vector<SyntheticSource::Wave>& waves;
+        uint32_t& random;
+        int typeIndex[SensorTypeCount] = {};
+
+        public:
+        SyntheticBuilder(SourceHardware& target, std::vector<SyntheticSource::Wave>& targetWaves, uint32_t& state)
+            : hardware(target), waves(targetWaves), random(state) {}
+
+        void Add(int sensorType, const std::string& name) {
+            std::string type = SensorTypeName(sensorType);
+            std::transform(type.begin(), type.end(), type.begin(), [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+
+            SourceSensor sensor;
+            sensor.identifier = hardware.identifier + "/" + type + "/" + std::to_string(typeIndex[sensorType]++);
+            sensor.name = name;
+            sensor.sensorType = sensorType;
+            hardware.sensors.push_back(sensor);
+
+            SyntheticSource::Wave wave;
+            WaveRange(sensorType, wave.base, wave.amplitude);
+            wave.phase = NextRandom(random) * 6.2831853f;
+            wave.step = 0.05f + NextRandom(random) * 0.2f;
+            waves.push_back(wave);
+        }
+    };
+
+    SyntheticSource::SyntheticSource(const SyntheticTopology& topology) {
+        uint32_t random = topology.seed ? topology.seed : 1;
+
+        auto addHardware = [&](int hardwareType, const std::string& identifier, const std::string& name) {
+            SourceHardware entry;
+            entry.identifier = identifier;
+            entry.name = name;
+            entry.hardwareType = hardwareType;
+            hardware.push_back(entry);
+            waves.emplace_back();
+            return SyntheticBuilder(hardware.back(), waves.back(), random);
+        };
+
+        // 每個封裝：效能核心 (threadsPerCore 個執行緒) 在前，效率核心 (單執行緒) 在後
+        int threadsPerCore = std::max(1, topology.threadsPerCore);
+        int sockets = std::max(1, topology.sockets);
+        int packageThreads = std::max(1, std::max(1, topology.threads) / sockets);
+        int efficiencyCores = std::min(std::max(0, topology.efficiencyCores), packageThreads - 1);
+        int performanceThreads = packageThreads - efficiencyCores;
+        int performanceCores = (performanceThreads + threadsPerCore - 1) / threadsPerCore;
+        int cores = performanceCores + efficiencyCores;
+        for (int socket = 0; socket < sockets; socket++) {
+            CpuPackageLayout layout;
+            for (int core = 0; core < cores; core++) {
+                CpuCoreLayout coreLayout;
+                coreLayout.domain = topology.coresPerDomain > 0 ? core / topology.coresPerDomain : 0;
+                coreLayout.efficient = core >= performanceCores;
+                coreLayout.threads = coreLayout.efficient ? 1 : std::min(threadsPerCore, performanceThreads - core * threadsPerCore);
+                layout.cores.push_back(coreLayout);
+            }
+            layout.domains = layout.cores.back().domain + 1;
+            layout.hybrid = efficiencyCores > 0;
+            cpuTopology.packages.push_back(layout);
+
+            SyntheticBuilder cpu = addHardware(CpuHardware, "/intelcpu/" + std::to_string(socket), "Synthetic CPU");
+            cpu.Add(LoadSensor, "CPU Total");
+            cpu.Add(LoadSensor, "CPU Core Max");
+            for (int core = 0; core < cores; core++) {
+                int threads = layout.cores[core].threads;
+                for (int thread = 0; thread < threads; thread++) {
+                    std::string name = "CPU Core #" + std::to_string(core + 1);
+                    if (threadsPerCore > 1 && !layout.cores[core].efficient) name += " Thread #" + std::to_string(thread + 1);
+                    cpu.Add(LoadSensor, name);
+                }
+            }
+            cpu.Add(TemperatureSensor, "CPU Package");
+            cpu.Add(TemperatureSensor, "Core Max");
+            cpu.Add(TemperatureSensor, "Core Average");
+            for (int core = 1; core <= cores; core++) cpu.Add(TemperatureSensor, "CPU Core #" + std::to_string(core));
+            cpu.Add(ClockSensor, "Bus Speed");
+            for (int core = 1; core <= cores; core++) cpu.Add(ClockSensor, "CPU Core #" + std::to_string(core));
+            cpu.Add(VoltageSensor, "CPU Core");
+            for (int core = 1; core <= cores; core++) cpu.Add(VoltageSensor, "CPU Core #" + std::to_string(core));
+            cpu.Add(PowerSensor, "CPU Package");
+            cpu.Add(PowerSensor, "CPU Cores");
+        }
+        {
+            SyntheticBuilder memory = addHardware(MemoryHardware, "/ram", "Generic Memory");
+            memory.Add(DataSensor, "Memory Used");
+            memory.Add(DataSensor, "Memory Available");
+            memory.Add(LoadSensor, "Memory");
+            memory.Add(DataSensor, "Virtual Memory Used");
+            memory.Add(DataSensor, "Virtual Memory Available");
+            memory.Add(LoadSensor, "Virtual Memory");
+        }
+        for (int i = 0; i < topology.gpus; i++) {
+            SyntheticBuilder gpu = addHardware(GpuNvidiaHardware, "/gpu-nvidia/" + std::to_string(i), "Synthetic GPU #" + std::to_string(i + 1));
+            gpu.Add(TemperatureSensor, "GPU Core");
+            gpu.Add(TemperatureSensor, "GPU Hot Spot");
+            gpu.Add(LoadSensor, "GPU Core");
+            gpu.Add(LoadSensor, "GPU Memory Controller");
+            gpu.Add(ClockSensor, "GPU Core");
+            gpu.Add(ClockSensor, "GPU Memory");
+            gpu.Add(PowerSensor, "GPU Package");
+            gpu.Add(FanSensor, "GPU Fan 1");
+            gpu.Add(SmallDataSensor, "GPU Memory Used");
+            gpu.Add(SmallDataSensor, "GPU Memory Total");
+        }
+        for (int i = 0; i < topology.disks; i++) {
+            SyntheticBuilder disk = addHardware(StorageHardware, "/nvme/" + std::to_string(i), "Synthetic Disk #" + std::to_string(i + 1));
+            disk.Add(TemperatureSensor, "Temperature");
+            disk.Add(LoadSensor, "Used Space");
+            disk.Add(LoadSensor, "Read Activity");
+            disk.Add(LoadSensor, "Write Activity");
+            disk.Add(LoadSensor, "Total Activity");
+            disk.Add(ThroughputSensor, "Read Rate");
+            disk.Add(ThroughputSensor, "Write Rate");
+        }
+        for (int i = 0; i < topology.nics; i++) {
+            SyntheticBuilder nic = addHardware(NetworkHardware, "/nic/" + std::to_string(i), "Ethernet " + std::to_string(i + 1));
+            nic.Add(DataSensor, "Data Uploaded");
+            nic.Add(DataSensor, "Data Downloaded");
+            nic.Add(ThroughputSensor, "Upload Speed");
+            nic.Add(ThroughputSensor, "Download Speed");
+            nic.Add(LoadSensor, "Network utilization");
+        }
+        for (int i = 0; i < topology.boards; i++) {
+            // 與 LibreHardwareMonitor 相同：主機板本身沒有感測器，Super I/O 是它的子硬體
+            int board = static_cast<int>(hardware.size());
+            addHardware(MotherboardHardware, "/motherboard/" + std::to_string(i), "Synthetic Board #" + std::to_string(i + 1));
+            SyntheticBuilder superIO = addHardware(SuperIOHardware, "/lpc/nct6798d/" + std::to_string(i), "Nuvoton NCT6798D");
+            hardware.back().parent = board;
+            superIO.Add(VoltageSensor, "Vcore");
+            superIO.Add(VoltageSensor, "+3.3V");
+            superIO.Add(VoltageSensor, "+12V");
+            superIO.Add(TemperatureSensor, "CPU");
+            superIO.Add(TemperatureSensor, "Motherboard");
+            superIO.Add(TemperatureSensor, "VRM MOS");
+            superIO.Add(FanSensor, "CPU Fan");
+            superIO.Add(FanSensor, "System Fan #1");
+            superIO.Add(ControlSensor, "CPU Fan");
+            superIO.Add(ControlSensor, "System Fan #1");
+        }
+        for (int i = 0; i < topology.batteries; i++) {
+            SyntheticBuilder battery = addHardware(BatteryHardware, "/battery/" + std::to_string(i), "Synthetic Battery #" + std::to_string(i + 1));
+            battery.Add(LevelSensor, "Charge Level");
+            battery.Add(LevelSensor, "Degradation Level");
+            battery.Add(VoltageSensor, "Voltage");
+            battery.Add(CurrentSensor, "Discharge Current");
+            battery.Add(PowerSensor, "Discharge Rate");
+            battery.Add(EnergySensor, "Designed Capacity");
+            battery.Add(EnergySensor, "Full Charged Capacity");
+            battery.Add(EnergySensor, "Remaining Capacity");
+            battery.Add(TimeSpanSensor, "Remaining Time (Estimated)");
+        }
+
+        updates.assign(hardware.size(), 0);
+    }
+
+    // 只列舉開啟的類別，與 LibreHardwareMonitor 關閉類別時移除硬體 (連同子硬體) 相同
+    void SyntheticSource::Enumerate(std::vector<SourceHardware>& result) {
+        result.clear();
+        enumerated.clear();
+        std::vector<int> position(hardware.size(), -1);  // hardware 索引 -> 在 result 中的位置
+        for (size_t i = 0; i < hardware.size(); ++i) {
+            int type = hardware[i].hardwareType;
+            if (type < 32 && !(enabledMask & (1u << type))) continue;
+
+            int parent = hardware[i].parent;
+            if (parent >= 0 && position[parent] < 0) continue;  // 上層沒有列舉
+
+            position[i] = static_cast<int>(result.size());
+            result.push_back(hardware[i]);
+            result.back().parent = parent >= 0 ? position[parent] : -1;
+            enumerated.push_back(i);
+            const std::vector<Wave>& hardwareWaves = waves[i];
+            for (size_t k = 0; k < hardwareWaves.size(); ++k) {
+                const Wave& wave = hardwareWaves[k];
+                result.back().sensors[k].value = wave.base + wave.amplitude * std::sin(wave.phase + wave.step * updates[i]);
+            }
+        }
+    }
+
+    void SyntheticSource::Update(size_t hardwareIndex, float* values) {
+        size_t index = enumerated[hardwareIndex];
+        uint64_t update = ++updates[index];
+        const std::vector<Wave>& hardwareWaves = waves[index];
+        for (size_t k = 0; k < hardwareWaves.size(); ++k) {
+            const Wave& wave = hardwareWaves[k];
+            values[k] = wave.base + wave.amplitude * std::sin(wave.phase + wave.step * update);
+        }
+    }
+
+    unsigned int SyntheticSource::TopologyVersion() const {
+        return topologyVersion;
+    }
+
+    void SyntheticSource::EnableHardware(uint32_t typeMask) {
+        if (typeMask == enabledMask) return;
+
+        enabledMask = typeMask;
+        topologyVersion++;
+    }
+
+    bool SyntheticSource::DescribeCpuTopology(CpuTopology& topology) {
+        topology = cpuTopology;
+        return true;
+    }
+
+    size_t SyntheticSource::SensorCount() const {
+        size_t count = 0;
+        for (const auto& entry : hardware) count += entry.sensors.size();
+        return count;
+    }
+
+    TraceWriter::~TraceWriter() {
+        Close();
+    }
+
+    bool TraceWriter::Open(const std::string& path) {
+        Close();
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+
+        std::fwrite(TraceMagic, 1, sizeof(TraceMagic), file);
+        std::fwrite(&TraceVersion, sizeof(TraceVersion), 1, file);
+        return true;
+    }
+
+    void TraceWriter::Close() {
+        if (!file) return;
+        std::fclose(file);
+        file = nullptr;
+    }
+
+    static void WriteString(std::FILE* file, const std::string& text) {
+        uint32_t length = static_cast<uint32_t>(text.size());
+        std::fwrite(&length, sizeof(length), 1, file);
+        std::fwrite(text.data(), 1, text.size(), file);
+    }
+
+    void TraceWriter::WriteTopology(const std::vector<SourceHardware>& hardware) {
+        if (!file) return;
+
+        std::fputc('T', file);
+        uint32_t hardwareCount = static_cast<uint32_t>(hardware.size());
+        std::fwrite(&hardwareCount, sizeof(hardwareCount), 1, file);
+        for (const SourceHardware& entry : hardware) {
+            int32_t hardwareType = entry.hardwareType;
+            std::fwrite(&hardwareType, sizeof(hardwareType), 1, file);
+            WriteString(file, entry.identifier);
+            WriteString(file, entry.name);
+
+            uint32_t sensorCount = static_cast<uint32_t>(entry.sensors.size());
+            std::fwrite(&sensorCount, sizeof(sensorCount), 1, file);
+            for (const SourceSensor& sensor : entry.sensors) {
+                int32_t sensorType = sensor.sensorType;
+                std::fwrite(&sensorType, sizeof(sensorType), 1, file);
+                WriteString(file, sensor.identifier);
+                WriteString(file, sensor.name);
+            }
+        }
+    }
+
+    void TraceWriter::WriteFrame(int64_t timestamp, const float* values, size_t count) {
+        if (!file) return;
+
+        std::fputc('F', file);
+        uint32_t valueCount = static_cast<uint32_t>(count);
+        std::fwrite(&timestamp, sizeof(timestamp), 1, file);
+        std::fwrite(&valueCount, sizeof(valueCount), 1, file);
+        std::fwrite(values, sizeof(float), count, file);
+    }
+
+    // 讀取軌跡檔內容時的游標，超出範圍時 ok 變為 false
+    struct TraceCursor {
+        const std::vector<char>& data;
+        size_t position = 0;
+        bool ok = true;
+
+        explicit TraceCursor(const std::vector<char>& bytes) : data(bytes) {}
+
+        bool Read(void* target, size_t size) {
+            if (!ok || data.size() - position < size) return ok = false;
+            std::memcpy(target, data.data() + position, size);
+            position += size;
+            return true;
+        }
+
+        template <typename T>
+        T Read() {
+            T value{};
+            Read(&value, sizeof(value));
+            return value;
+        }
+
+        std::string ReadString() {
+            uint32_t length = Read<uint32_t>();
+            if (!ok || data.size() - position < length) {
+                ok = false;
+                return std::string();
+            }
+            std::string text(data.data() + position, length);
+            position += length;
+            return text;
+        }
+    };
+
+    ReplaySource::ReplaySource(bool realtimePlayback, double playbackSpeed) : realtime(realtimePlayback), speed(playbackSpeed > 0.0 ? playbackSpeed : 1.0) {}
+
+    bool ReplaySource::Load(const std::string& path) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) return false;
+
+        std::vector<char> data;
+        char buffer[65536];
+        size_t read;
+        while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) data.insert(data.end(), buffer, buffer + read);
+        std::fclose(file);
+
+        TraceCursor cursor(data);
+        char magic[sizeof(TraceMagic)];
+        if (!cursor.Read(magic, sizeof(magic)) || std::memcmp(magic, TraceMagic, sizeof(magic)) != 0) return false;
+        if (cursor.Read<uint32_t>() != TraceVersion) return false;
+
+        std::vector<Topology> loadedTopologies;
+        std::vector<Frame> loadedFrames;
+        std::vector<float> loadedValues;
+        while (cursor.ok && cursor.position < data.size()) {
+            char block = cursor.Read<char>();
+            if (block == 'T') {
+                Topology topology;
+                uint32_t hardwareCount = cursor.Read<uint32_t>();
+                for (uint32_t i = 0; i < hardwareCount && cursor.ok; i++) {
+                    SourceHardware entry;
+                    entry.hardwareType = cursor.Read<int32_t>();
+                    entry.identifier = cursor.ReadString();
+                    entry.name = cursor.ReadString();
+
+                    uint32_t sensorCount = cursor.Read<uint32_t>();
+                    for (uint32_t k = 0; k < sensorCount && cursor.ok; k++) {
+                        SourceSensor sensor;
+                        sensor.sensorType = cursor.Read<int32_t>();
+                        sensor.identifier = cursor.ReadString();
+                        sensor.name = cursor.ReadString();
+                        entry.sensors.push_back(sensor);
+                    }
+
+                    topology.offsets.push_back(topology.valueCount);
+                    topology.valueCount += entry.sensors.size();
+                    topology.hardware.push_back(std::move(entry));
+                }
+                loadedTopologies.push_back(std::move(topology));
+            }
+            else if (block == 'F') {
+                if (loadedTopologies.empty()) return false;
+
+                Frame frame;
+                frame.topology = loadedTopologies.size() - 1;
+                frame.timestamp = cursor.Read<int64_t>();
+                frame.offset = loadedValues.size();
+                uint32_t count = cursor.Read<uint32_t>();
+                if (count != loadedTopologies.back().valueCount) return false;
+
+                loadedValues.resize(frame.offset + count);
+                if (!cursor.Read(loadedValues.data() + frame.offset, count * sizeof(float))) return false;
+                loadedFrames.push_back(frame);
+            }
+            else {
+                return false;
+            }
+        }
+        if (!cursor.ok || loadedFrames.empty()) return false;
+
+        topologies = std::move(loadedTopologies);
+        frames = std::move(loadedFrames);
+        values = std::move(loadedValues);
+        manualFrame = 0;
+        startedAt = SteadyMicroseconds();
+        return true;
+    }
+
+    // 即時模式依經過時間換算成錄製時間 (循環播放)，取最後一筆不晚於該時間的取樣
+    size_t ReplaySource::CurrentFrame() const {
+        if (frames.empty()) return 0;
+        if (!realtime) return manualFrame;
+
+        int64_t first = frames.front().timestamp;
+        int64_t last = frames.back().timestamp;
+        int64_t step = frames.size() > 1 ? std::max<int64_t>(1, (last - first) / static_cast<int64_t>(frames.size() - 1)) : 1;
+        int64_t period = last - first + step;
+        int64_t elapsed = static_cast<int64_t>((SteadyMicroseconds() - startedAt) * speed);
+        int64_t target = first + elapsed % period;
+
+        auto next = std::upper_bound(frames.begin(), frames.end(), target, [](int64_t time, const Frame& frame) {
+            return time < frame.timestamp;
+        });
+        return next == frames.begin() ? 0 : static_cast<size_t>(next - frames.begin()) - 1;
+    }
+
+    void ReplaySource::Enumerate(std::vector<SourceHardware>& result) {
+        result.clear();
+        if (frames.empty()) return;
+
+        const Frame& frame = frames[CurrentFrame()];
+        const Topology& topology = topologies[frame.topology];
+        result = topology.hardware;
+
+        const float* frameValues = values.data() + frame.offset;
+        for (size_t i = 0; i < result.size(); ++i) {
+            for (size_t k = 0; k < result[i].sensors.size(); ++k) {
+                result[i].sensors[k].value = frameValues[topology.offsets[i] + k];
+            }
+        }
+        enumerated = frame.topology;
+    }
+
+    void ReplaySource::Update(size_t hardwareIndex, float* target) {
+        if (frames.empty()) return;
+
+        const Frame& frame = frames[CurrentFrame()];
+        const Topology& topology = topologies[enumerated];
+        size_t count = topology.hardware[hardwareIndex].sensors.size();
+
+        // 拓撲已經改變但呼叫端尚未重新列舉：回報沒有數值，等待重新繫結
+        if (frame.topology != enumerated) {
+            std::fill(target, target + count, std::numeric_limits<float>::quiet_NaN());
+            return;
+        }
+        std::memcpy(target, values.data() + frame.offset + topology.offsets[hardwareIndex], count * sizeof(float));
+    }
+
+    unsigned int ReplaySource::TopologyVersion() const {
+        return frames.empty() ? 0 : static_cast<unsigned int>(frames[CurrentFrame()].topology);
+    }
+
+    bool ReplaySource::DescribeCpuTopology(CpuTopology& topology) {
+        topology.packages.clear();  // 錄製的機器不一定是目前的系統
+        return false;
+    }
+
+    void ReplaySource::Advance() {
+        if (!frames.empty()) manualFrame = (manualFrame + 1) % frames.size();
+    }
+}
@@ -0,0 +1,225 @@
+﻿#pragma once
+
+// 感測器來源：繫結與取樣只透過這個介面取得硬體描述與數值，
+// 因此同一套流程可以使用 LibreHardwareMonitor (HardwareInfo 預設)、合成拓撲或錄製的軌跡。
+// 純原生程式碼 (不使用 /clr)，可在沒有感測器硬體的環境 (例如 Linux CI) 執行。
+
+#include "CpuTopology.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace HardwareInfoDll {
+    // 與 LibreHardwareMonitor 0.9.4 HardwareType 的數值相同
+    enum SourceHardwareType {
+        MotherboardHardware,
+        SuperIOHardware,
+        CpuHardware,
+        MemoryHardware,
+        GpuNvidiaHardware,
+        GpuAmdHardware,
+        GpuIntelHardware,
+        StorageHardware,
+        NetworkHardware,
+        CoolerHardware,
+        EmbeddedControllerHardware,
+        PsuHardware,
+        BatteryHardware
+    };
+
+    // 與 LibreHardwareMonitor 0.9.4 SensorType 的數值相同
+    enum SourceSensorType {
+        VoltageSensor,
+        CurrentSensor,
+        PowerSensor,
+        ClockSensor,
+        TemperatureSensor,
+        LoadSensor,
+        FrequencySensor,
+        FanSensor,
+        FlowSensor,
+        ControlSensor,
+        LevelSensor,
+        FactorSensor,
+        DataSensor,
+        SmallDataSensor,
+        ThroughputSensor,
+        TimeSpanSensor,
+        EnergySensor,
+        NoiseSensor,
+        ConductivitySensor,
+        HumiditySensor,
+        SensorTypeCount
+    };
+
+    const char* SensorTypeName(int sensorType);  // 與 SensorType.ToString() 相同
+
+    const char* HardwareTypeName(int hardwareType);  // 與 HardwareType.ToString() 相同
+
+    std::wstring Utf8ToWide(const std::string& text);  // UTF-8 轉寬字元 (Windows 為 UTF-16)
+
+    std::string WideToUtf8(const std::wstring& text);  // 寬字元轉 UTF-8 (正確處理代理對，不合法的代理為 U+FFFD)
+
+    // 感測器描述 (字串為 UTF-8)
+    struct SourceSensor {
+        std::string identifier;
+        std::string name;
+        int sensorType = 0;  // SourceSensorType
+        float value = std::numeric_limits<float>::quiet_NaN();  // 列舉時的數值 (NaN 表示沒有數值)
+    };
+
+    // 硬體描述
+    struct SourceHardware {
+        std::string identifier;
+        std::string name;
+        int hardwareType = 0;  // SourceHardwareType
+        int parent = -1;  // 上層硬體在 Enumerate 結果中的位置 (-1 表示頂層，上層永遠排在子硬體之前)
+        std::vector<SourceSensor> sensors;
+    };
+
+    class SensorSource {
+        public:
+        virtual ~SensorSource() {}
+
+        // 列舉目前的硬體與感測器 (只在拓撲改變時呼叫)
+        virtual void Enumerate(std::vector<SourceHardware>& hardware) = 0;
+
+        // 更新一個硬體並依 sensors 的順序寫入數值 (NaN 表示沒有數值)，同一個硬體不會同時被更新；
+        // 子硬體 (parent >= 0) 由來源負責先更新上層
+        virtual void Update(size_t hardwareIndex, float* values) = 0;
+
+        // 拓撲版本，改變時呼叫端需要重新 Enumerate
+        virtual unsigned int TopologyVersion() const {
+            return 0;
+        }
+
+        // 只開啟 typeMask (SourceHardwareType 位元) 中的硬體類別，關閉其餘類別；
+        // 集合改變時遞增拓撲版本。不支援的來源忽略 (例如重播)
+        virtual void EnableHardware(uint32_t /* typeMask */) {}
+
+        // CPU 拓撲 (依 CPU 硬體的順序)，預設偵測目前的系統；無法取得時回傳 false，拓撲彙總只以封裝分組
+        virtual bool DescribeCpuTopology(CpuTopology& topology) {
+            return DetectCpuTopology(topology);
+        }
+    };
+
+    // 合成拓撲的大小
+    struct SyntheticTopology {
+        int threads = 16;  // CPU 執行緒數量
+        int threadsPerCore = 2;
+        int sockets = 1;  // CPU 封裝數量 (threads 平均分配)
+        int coresPerDomain = 0;  // 每個 L3 網域的核心數 (0 表示整個封裝共用)
+        int efficiencyCores = 0;  // 每個封裝的效率核心 (單執行緒，排在效能核心之後)
+        int gpus = 1;
+        int disks = 2;
+        int nics = 2;
+        int boards = 0;  // 主機板 (Super I/O 為它的子硬體)
+        int batteries = 0;
+        unsigned int seed = 1;  // 數值波形的亂數種子 (相同種子產生相同的序列)
+    };
+
+    // 合成來源：產生與 LibreHardwareMonitor 相同命名的硬體，數值為確定性的波形
+    class SyntheticSource : public SensorSource {
+        public:
+        // 每個感測器的波形參數
+        struct Wave {
+            float base;
+            float amplitude;
+            float step;  // 每次更新的相位增量
+            float phase;
+        };
+
+        private:
+        std::vector<SourceHardware> hardware;
+        std::vector<std::vector<Wave>> waves;  // 與 hardware[].sensors 對齊
+        std::vector<uint64_t> updates;  // 每個硬體的更新次數
+        std::vector<size_t> enumerated;  // 最後一次 Enumerate 的項目對應的 hardware 索引
+        uint32_t enabledMask = 0xFFFFFFFF;  // 開啟的硬體類別
+        unsigned int topologyVersion = 0;
+        CpuTopology cpuTopology;
+
+        public:
+        explicit SyntheticSource(const SyntheticTopology& topology);
+
+        void Enumerate(std::vector<SourceHardware>& result) override;
+        void Update(size_t hardwareIndex, float* values) override;
+        unsigned int TopologyVersion() const override;
+        void EnableHardware(uint32_t typeMask) override;
+        bool DescribeCpuTopology(CpuTopology& topology) override;
+
+        size_t SensorCount() const;
+    };
+
+    // 軌跡檔 (二進位，小端序)：
+    //   "HWITRACE" uint32 版本
+    //   'T' 拓撲：uint32 硬體數；每個硬體 int32 類型、字串 identifier、字串 name、uint32 感測器數；
+    //            每個感測器 int32 類型、字串 identifier、字串 name (字串為 uint32 長度 + UTF-8)
+    //   'F' 取樣：int64 時間 (微秒)、uint32 數量、float 數值 (依拓撲中感測器的順序)
+    class TraceWriter {
+        std::FILE* file = nullptr;
+
+        public:
+        TraceWriter() = default;
+        ~TraceWriter();
+
+        TraceWriter(const TraceWriter&) = delete;
+        TraceWriter& operator=(const TraceWriter&) = delete;
+
+        bool Open(const std::string& path);
+        void Close();
+
+        bool IsOpen() const {
+            return file != nullptr;
+        }
+
+        void WriteTopology(const std::vector<SourceHardware>& hardware);
+        void WriteFrame(int64_t timestamp, const float* values, size_t count);
+    };
+
+    // 重播來源：依錄製時的時間間隔重播軌跡 (播完後從頭開始)，或由呼叫端以 Advance 逐筆前進
+    class ReplaySource : public SensorSource {
+        struct Topology {
+            std::vector<SourceHardware> hardware;
+            std::vector<size_t> offsets;  // 每個硬體第一個數值的位置
+            size_t valueCount = 0;
+        };
+
+        struct Frame {
+            size_t topology;
+            int64_t timestamp;
+            size_t offset;  // 在 values 中的位置
+        };
+
+        std::vector<Topology> topologies;
+        std::vector<Frame> frames;
+        std::vector<float> values;
+        bool realtime;
+        double speed;
+        int64_t startedAt = 0;  // 開始重播的時間 (微秒)
+        size_t manualFrame = 0;  // 非即時模式下目前的取樣
+        size_t enumerated = 0;  // 最後一次 Enumerate 的拓撲
+
+        size_t CurrentFrame() const;
+
+        public:
+        // realtimePlayback 為 false 時只在 Advance 時前進；playbackSpeed 為重播速度倍率
+        explicit ReplaySource(bool realtimePlayback = true, double playbackSpeed = 1.0);
+
+        bool Load(const std::string& path);  // 讀取整個軌跡檔，格式錯誤時回傳 false
+
+        void Enumerate(std::vector<SourceHardware>& result) override;
+        void Update(size_t hardwareIndex, float* values) override;
+        unsigned int TopologyVersion() const override;
+        bool DescribeCpuTopology(CpuTopology& topology) override;  // 軌跡不含拓撲，回傳 false
+
+        void Advance();  // 前進一筆 (非即時模式)
+
+        size_t FrameCount() const {
+            return frames.size();
+        }
+    };
+}
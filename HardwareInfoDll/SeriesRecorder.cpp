@@ -0,0 +1,855 @@
+﻿#include "SeriesRecorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <intrin.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace HardwareInfoDll {
+    // 檔案版面 (little-endian)：
+    //   區段標頭  SegmentMagic、版本、欄數，每一欄 hardwareType、sensorType、identifier、hardwareName、name (字串為長度 + UTF-8)
+    //   區塊      BlockHeader、uint32 offsets[欄數 + 2] (時間欄、每個數值欄與結尾，相對於資料區)、資料區
+    //   索引      每個區塊 { uint64 位置, int64 第一筆, int64 最後一筆 }，最後是 SegmentTrailer (正常結束時才有)
+    namespace {
+        const char SegmentMagic[8] = { 'H', 'W', 'I', 'S', 'E', 'R', 'I', 'E' };
+        const char TrailerMagic[8] = { 'H', 'W', 'I', 'S', 'I', 'D', 'X', '1' };
+        const uint32_t SegmentVersion = 1;
+        const uint32_t BlockMagic = 0x314B4C42;  // "BLK1"
+        const size_t MaxPendingBlocks = 64;  // 寫入端落後超過此數量時捨棄新的區塊
+
+        struct BlockHeader {
+            uint32_t magic;
+            uint32_t size;  // 整個區塊的位元組數 (含標頭與目錄)
+            int64_t first;  // 第一筆取樣 (毫秒)
+            int64_t last;  // 最後一筆取樣 (毫秒)
+            uint32_t samples;
+            uint32_t columns;
+        };
+
+        struct IndexEntry {
+            uint64_t offset;
+            int64_t first;
+            int64_t last;
+        };
+
+        struct SegmentTrailer {
+            uint64_t indexOffset;
+            uint32_t blockCount;
+            uint32_t reserved;
+            char magic[8];
+        };
+
+#ifdef _WIN32
+        // 路徑為 UTF-8 (fopen 使用系統 ANSI 字碼頁)
+        std::wstring WidePath(const std::string& path) {
+            std::wstring wide(MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0), L'\0');
+            if (!wide.empty()) MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide[0], static_cast<int>(wide.size()));
+            return wide;
+        }
+#endif
+
+        std::FILE* CreateSegmentFile(const std::string& path) {
+#ifdef _WIN32
+            return _wfopen(WidePath(path).c_str(), L"wb");
+#else
+            return std::fopen(path.c_str(), "wb");
+#endif
+        }
+
+        void RemoveSegmentFile(const std::string& path) {
+#ifdef _WIN32
+            _wremove(WidePath(path).c_str());
+#else
+            std::remove(path.c_str());
+#endif
+        }
+
+        int64_t NowMicroseconds() {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        // 微秒轉毫秒 (向下取整)
+        int64_t ToMilliseconds(int64_t microseconds) {
+            return microseconds >= 0 ? microseconds / 1000 : -((-microseconds + 999) / 1000);
+        }
+
+        int LeadingZeros(uint32_t value) {
+#ifdef _MSC_VER
+            unsigned long index;
+            return _BitScanReverse(&index, value) ? 31 - static_cast<int>(index) : 32;
+#else
+            return value ? __builtin_clz(value) : 32;
+#endif
+        }
+
+        int TrailingZeros(uint32_t value) {
+#ifdef _MSC_VER
+            unsigned long index;
+            return _BitScanForward(&index, value) ? static_cast<int>(index) : 32;
+#else
+            return value ? __builtin_ctz(value) : 32;
+#endif
+        }
+
+        // 依序寫入位元 (高位在前)，每次最多 32 位元
+        class BitWriter {
+            std::vector<unsigned char>& out;
+            uint64_t accumulator = 0;
+            int pending = 0;  // accumulator 中尚未輸出的位元數 (小於 8)
+
+            public:
+            explicit BitWriter(std::vector<unsigned char>& output) : out(output) {}
+
+            void Write(uint64_t value, int bits) {
+                accumulator = (accumulator << bits) | (value & ((1ull << bits) - 1));
+                pending += bits;
+                while (pending >= 8) {
+                    pending -= 8;
+                    out.push_back(static_cast<unsigned char>(accumulator >> pending));
+                }
+            }
+
+            void Flush() {
+                if (pending) out.push_back(static_cast<unsigned char>(accumulator << (8 - pending)));
+                accumulator = 0;
+                pending = 0;
+            }
+        };
+
+        class BitReader {
+            const unsigned char* data;
+            size_t size;
+            size_t position = 0;  // 位元位置
+
+            public:
+            BitReader(const unsigned char* bytes, size_t length) : data(bytes), size(length) {}
+
+            // 每次取出同一個位元組內的位元，超出範圍的位元視為 0
+            uint64_t Read(int bits) {
+                uint64_t value = 0;
+                while (bits > 0) {
+                    size_t byte = position >> 3;
+                    int offset = static_cast<int>(position & 7);
+                    int take = 8 - offset < bits ? 8 - offset : bits;
+                    unsigned int current = byte < size ? data[byte] : 0;
+                    value = (value << take) | ((current >> (8 - offset - take)) & ((1u << take) - 1));
+                    position += static_cast<size_t>(take);
+                    bits -= take;
+                }
+                return value;
+            }
+
+            bool Bit() {
+                return Read(1) != 0;
+            }
+        };
+
+        // 時間欄：第一筆在區塊標頭，之後為 delta-of-delta
+        //   0 -> 相同間隔；10 + 7 位元 [-63, 64]；110 + 9 位元 [-255, 256]；1110 + 12 位元 [-2047, 2048]；1111 + 64 位元
+        struct TimeEncoder {
+            int64_t previous = 0;
+            int64_t delta = 0;
+
+            void Reset(int64_t first) {
+                previous = first;
+                delta = 0;
+            }
+
+            void Append(BitWriter& writer, int64_t timestamp) {
+                int64_t nextDelta = timestamp - previous;
+                int64_t dod = nextDelta - delta;
+                previous = timestamp;
+                delta = nextDelta;
+
+                if (dod == 0) writer.Write(0, 1);
+                else if (dod >= -63 && dod <= 64) { writer.Write(0x2, 2); writer.Write(static_cast<uint64_t>(dod + 63), 7); }
+                else if (dod >= -255 && dod <= 256) { writer.Write(0x6, 3); writer.Write(static_cast<uint64_t>(dod + 255), 9); }
+                else if (dod >= -2047 && dod <= 2048) { writer.Write(0xE, 4); writer.Write(static_cast<uint64_t>(dod + 2047), 12); }
+                else {
+                    writer.Write(0xF, 4);
+                    writer.Write(static_cast<uint64_t>(dod) >> 32, 32);
+                    writer.Write(static_cast<uint64_t>(dod), 32);
+                }
+            }
+        };
+
+        struct TimeDecoder {
+            int64_t previous;
+            int64_t delta = 0;
+
+            explicit TimeDecoder(int64_t first) : previous(first) {}
+
+            int64_t Next(BitReader& reader) {
+                int64_t dod;
+                if (!reader.Bit()) dod = 0;
+                else if (!reader.Bit()) dod = static_cast<int64_t>(reader.Read(7)) - 63;
+                else if (!reader.Bit()) dod = static_cast<int64_t>(reader.Read(9)) - 255;
+                else if (!reader.Bit()) dod = static_cast<int64_t>(reader.Read(12)) - 2047;
+                else {
+                    uint64_t high = reader.Read(32);
+                    dod = static_cast<int64_t>((high << 32) | reader.Read(32));
+                }
+                // 以無號數相加：損壞的資料只會得到錯誤的時間，不會有號數溢位
+                delta = static_cast<int64_t>(static_cast<uint64_t>(delta) + static_cast<uint64_t>(dod));
+                previous = static_cast<int64_t>(static_cast<uint64_t>(previous) + static_cast<uint64_t>(delta));
+                return previous;
+            }
+        };
+
+        // 數值欄：第一筆為原始 32 位元，之後與前一筆 XOR
+        //   0 -> 相同；10 + 沿用前一次的前導/尾端零區間；11 + 5 位元前導零 + 5 位元 (有效位元數 - 1) + 有效位元
+        struct ValueColumn {
+            std::vector<unsigned char> bytes;
+            BitWriter writer{ bytes };
+            uint32_t previous = 0;
+            int leading = -1;  // 前一次的前導零 (-1 表示沒有可沿用的區間)
+            int trailing = 0;
+            bool first = true;
+
+            ValueColumn() = default;
+            ValueColumn(const ValueColumn&) = delete;
+            ValueColumn& operator=(const ValueColumn&) = delete;
+
+            void Reset() {
+                writer.Flush();
+                bytes.clear();
+                leading = -1;
+                first = true;
+            }
+
+            void Append(float value) {
+                uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                if (first) {
+                    writer.Write(bits, 32);
+                    first = false;
+                }
+                else {
+                    uint32_t x = bits ^ previous;
+                    if (x == 0) {
+                        writer.Write(0, 1);
+                    }
+                    else {
+                        int lz = LeadingZeros(x);
+                        int tz = TrailingZeros(x);
+                        if (leading >= 0 && lz >= leading && tz >= trailing) {
+                            writer.Write(0x2, 2);
+                            writer.Write(x >> trailing, 32 - leading - trailing);
+                        }
+                        else {
+                            int meaningful = 32 - lz - tz;
+                            writer.Write(0x3, 2);
+                            writer.Write(static_cast<uint64_t>(lz), 5);
+                            writer.Write(static_cast<uint64_t>(meaningful - 1), 5);
+                            writer.Write(x >> tz, meaningful);
+                            leading = lz;
+                            trailing = tz;
+                        }
+                    }
+                }
+                previous = bits;
+            }
+        };
+
+        struct ValueDecoder {
+            uint32_t previous = 0;
+            int leading = 0;
+            int trailing = 0;
+            bool first = true;
+
+            float Next(BitReader& reader) {
+                if (first) {
+                    previous = static_cast<uint32_t>(reader.Read(32));
+                    first = false;
+                }
+                else if (reader.Bit()) {
+                    if (reader.Bit()) {
+                        leading = static_cast<int>(reader.Read(5));
+                        int meaningful = static_cast<int>(reader.Read(5)) + 1;
+                        trailing = 32 - leading - meaningful;
+                        if (trailing < 0) trailing = 0;  // 損壞的資料
+                    }
+                    uint32_t x = static_cast<uint32_t>(reader.Read(32 - leading - trailing)) << trailing;
+                    previous ^= x;
+                }
+                float value;
+                std::memcpy(&value, &previous, sizeof(value));
+                return value;
+            }
+        };
+
+        void AppendBytes(std::vector<unsigned char>& out, const void* data, size_t size) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            out.insert(out.end(), bytes, bytes + size);
+        }
+
+        void AppendString(std::vector<unsigned char>& out, const std::string& text) {
+            uint32_t length = static_cast<uint32_t>(text.size());
+            AppendBytes(out, &length, sizeof(length));
+            AppendBytes(out, text.data(), text.size());
+        }
+
+        using Catalog = std::vector<SeriesColumn>;
+
+        // 交給寫入執行緒的區塊
+        struct PendingBlock {
+            std::shared_ptr<const Catalog> catalog;
+            unsigned int catalogVersion;
+            int64_t first;  // 毫秒
+            int64_t last;
+            std::vector<unsigned char> bytes;
+        };
+    }
+
+    struct SeriesRecorder::Impl {
+        SeriesRecorderOptions options;
+        std::atomic<bool> active{ false };
+
+        // 發布端 (Record) 的編碼狀態
+        std::shared_ptr<const Catalog> catalog;
+        unsigned int catalogVersion = 0;
+        std::vector<std::unique_ptr<ValueColumn>> columns;
+        std::vector<unsigned char> timeBytes;
+        BitWriter timeWriter{ timeBytes };
+        TimeEncoder time;
+        int64_t lastRecorded = 0;  // 最後一筆取樣 (微秒，0 表示尚未記錄)
+        int64_t blockFirst = 0;  // 目前區塊的第一筆與最後一筆 (毫秒)
+        int64_t blockLast = 0;
+        uint32_t blockSamples = 0;
+
+        // 與寫入執行緒共用
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<PendingBlock> pending;
+        std::vector<std::vector<unsigned char>> spare;  // 寫完的區塊緩衝區 (重複使用)
+        bool stopping = false;
+        std::thread writer;
+
+        // 寫入執行緒的區段狀態
+        std::FILE* file = nullptr;
+        std::string segmentPath;
+        unsigned int segmentCatalogVersion = 0;
+        bool segmentHasHeader = false;
+        uint64_t segmentBytes = 0;
+        int64_t segmentFirst = 0;  // 毫秒
+        std::vector<IndexEntry> index;
+
+        std::atomic<long long> segments{ 0 };
+        std::atomic<long long> blocks{ 0 };
+        std::atomic<long long> samples{ 0 };
+        std::atomic<long long> values{ 0 };
+        std::atomic<long long> bytes{ 0 };
+        std::atomic<long long> droppedBlocks{ 0 };
+        std::atomic<long long> writeErrors{ 0 };
+
+        bool OpenSegment();
+        void CloseSegment();
+        void WriteBlock(const PendingBlock& block);
+        void WriterLoop();
+        void FlushBlock();
+        void BeginCatalog(const std::vector<SensorSlot>& slots, unsigned int version, size_t count);
+    };
+
+    // 檔名為建立時間 (微秒，固定寬度以便依名稱排序)
+    bool SeriesRecorder::Impl::OpenSegment() {
+        char name[48];
+        std::snprintf(name, sizeof(name), "hwts-%020lld.hwts", static_cast<long long>(NowMicroseconds()));
+        std::string path = options.directory;
+        if (!path.empty() && path.back() != '/' && path.back() != '\\') path += '/';
+        path += name;
+
+        file = CreateSegmentFile(path);
+        if (!file) {
+            writeErrors++;
+            return false;
+        }
+        segmentPath = path;
+        segmentHasHeader = false;
+        segmentBytes = 0;
+        index.clear();
+        segments++;
+        return true;
+    }
+
+    // 寫入區塊索引與結尾 (讀取端以此判斷區段已正常結束)
+    void SeriesRecorder::Impl::CloseSegment() {
+        if (!file) return;
+
+        if (segmentHasHeader) {
+            SegmentTrailer trailer = {};
+            trailer.indexOffset = segmentBytes;
+            trailer.blockCount = static_cast<uint32_t>(index.size());
+            std::memcpy(trailer.magic, TrailerMagic, sizeof(trailer.magic));
+            std::fwrite(index.data(), sizeof(IndexEntry), index.size(), file);
+            std::fwrite(&trailer, sizeof(trailer), 1, file);
+            bytes += static_cast<long long>(index.size() * sizeof(IndexEntry) + sizeof(trailer));
+            std::fclose(file);
+        }
+        else {
+            std::fclose(file);
+            RemoveSegmentFile(segmentPath);  // 沒有任何區塊 (讀取端也無法開啟)
+            segments--;
+        }
+        file = nullptr;
+    }
+
+    void SeriesRecorder::Impl::WriteBlock(const PendingBlock& block) {
+        // 目錄改變、超過大小或涵蓋時間時換新的區段 (剛建立還沒有資料的區段直接使用)
+        if (file && segmentHasHeader) {
+            bool rotate = block.catalogVersion != segmentCatalogVersion ||
+                segmentBytes + block.bytes.size() > options.maxSegmentBytes ||
+                (block.last - segmentFirst) * 1000 > options.maxSegmentDuration;
+            if (rotate) CloseSegment();
+        }
+        if (!file && !OpenSegment()) return;
+
+        if (!segmentHasHeader) {
+            std::vector<unsigned char> header;
+            AppendBytes(header, SegmentMagic, sizeof(SegmentMagic));
+            AppendBytes(header, &SegmentVersion, sizeof(SegmentVersion));
+            uint32_t columnCount = static_cast<uint32_t>(block.catalog->size());
+            AppendBytes(header, &columnCount, sizeof(columnCount));
+            for (const SeriesColumn& column : *block.catalog) {
+                int32_t hardwareType = column.hardwareType;
+                int32_t sensorType = column.sensorType;
+                AppendBytes(header, &hardwareType, sizeof(hardwareType));
+                AppendBytes(header, &sensorType, sizeof(sensorType));
+                AppendString(header, column.identifier);
+                AppendString(header, column.hardwareName);
+                AppendString(header, column.name);
+            }
+            std::fwrite(header.data(), 1, header.size(), file);
+            segmentBytes = header.size();
+            segmentCatalogVersion = block.catalogVersion;
+            segmentFirst = block.first;
+            segmentHasHeader = true;
+            bytes += static_cast<long long>(header.size());
+        }
+
+        IndexEntry entry = { segmentBytes, block.first, block.last };
+        if (std::fwrite(block.bytes.data(), 1, block.bytes.size(), file) != block.bytes.size()) {
+            writeErrors++;
+            CloseSegment();  // 磁碟已滿等錯誤：下一個區塊嘗試新的區段
+            return;
+        }
+        std::fflush(file);  // 讀取端可以讀到完整的區塊
+        index.push_back(entry);
+        segmentBytes += block.bytes.size();
+        bytes += static_cast<long long>(block.bytes.size());
+        blocks++;
+    }
+
+    void SeriesRecorder::Impl::WriterLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [this] { return stopping || !pending.empty(); });
+            while (!pending.empty()) {
+                PendingBlock block = std::move(pending.front());
+                pending.pop_front();
+
+                lock.unlock();
+                WriteBlock(block);
+                lock.lock();
+
+                block.bytes.clear();
+                spare.push_back(std::move(block.bytes));
+            }
+            if (stopping) break;
+        }
+        lock.unlock();
+        CloseSegment();
+    }
+
+    // 將目前的區塊序列化後交給寫入執行緒
+    void SeriesRecorder::Impl::FlushBlock() {
+        if (blockSamples == 0) return;
+
+        std::vector<unsigned char> block;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!spare.empty()) {
+                block = std::move(spare.back());
+                spare.pop_back();
+            }
+        }
+
+        timeWriter.Flush();
+        for (auto& column : columns) column->writer.Flush();
+
+        size_t columnCount = columns.size();
+        std::vector<uint32_t> offsets;
+        offsets.reserve(columnCount + 2);
+        uint32_t offset = 0;
+        offsets.push_back(offset);
+        offset += static_cast<uint32_t>(timeBytes.size());
+        for (auto& column : columns) {
+            offsets.push_back(offset);
+            offset += static_cast<uint32_t>(column->bytes.size());
+        }
+        offsets.push_back(offset);
+
+        BlockHeader header = {};
+        header.magic = BlockMagic;
+        header.size = static_cast<uint32_t>(sizeof(BlockHeader) + offsets.size() * sizeof(uint32_t) + offset);
+        header.first = blockFirst;
+        header.last = blockLast;
+        header.samples = blockSamples;
+        header.columns = static_cast<uint32_t>(columnCount);
+
+        block.reserve(header.size);
+        AppendBytes(block, &header, sizeof(header));
+        AppendBytes(block, offsets.data(), offsets.size() * sizeof(uint32_t));
+        AppendBytes(block, timeBytes.data(), timeBytes.size());
+        for (auto& column : columns) AppendBytes(block, column->bytes.data(), column->bytes.size());
+
+        samples += blockSamples;
+        values += static_cast<long long>(blockSamples) * static_cast<long long>(columnCount);
+
+        timeBytes.clear();
+        for (auto& column : columns) column->Reset();
+        blockSamples = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (pending.size() >= MaxPendingBlocks) {
+                droppedBlocks++;
+                return;
+            }
+            pending.push_back({ catalog, catalogVersion, header.first, header.last, std::move(block) });
+        }
+        wake.notify_one();
+    }
+
+    void SeriesRecorder::Impl::BeginCatalog(const std::vector<SensorSlot>& slots, unsigned int version, size_t count) {
+        auto next = std::make_shared<Catalog>();
+        next->reserve(count);
+        for (size_t slot = 0; slot < count && slot < slots.size(); ++slot) {
+            SeriesColumn column;
+            column.identifier = slots[slot].identifier;
+            column.hardwareName = slots[slot].hardwareName;
+            column.name = slots[slot].name;
+            column.hardwareType = slots[slot].hardwareType;
+            column.sensorType = slots[slot].sensorType;
+            next->push_back(std::move(column));
+        }
+        next->resize(count);  // slots 比數值少時 (不應發生) 補上空白的欄位
+
+        catalog = std::move(next);
+        catalogVersion = version;
+        while (columns.size() < count) columns.push_back(std::make_unique<ValueColumn>());
+        columns.resize(count);
+        for (auto& column : columns) column->Reset();
+    }
+
+    SeriesRecorder::SeriesRecorder() : impl(new Impl()) {}
+
+    SeriesRecorder::~SeriesRecorder() {
+        Stop();
+        delete impl;
+    }
+
+    bool SeriesRecorder::Start(const SeriesRecorderOptions& options) {
+        Stop();
+
+        impl->options = options;
+        if (impl->options.samplesPerBlock == 0) impl->options.samplesPerBlock = 1;
+        if (!impl->OpenSegment()) return false;
+
+        impl->catalog.reset();
+        impl->lastRecorded = 0;
+        impl->blockSamples = 0;
+        impl->stopping = false;
+        impl->writer = std::thread(&Impl::WriterLoop, impl);
+        impl->active = true;
+        return true;
+    }
+
+    void SeriesRecorder::Stop() {
+        if (!impl->active.exchange(false)) return;
+
+        impl->FlushBlock();
+        {
+            std::lock_guard<std::mutex> lock(impl->mutex);
+            impl->stopping = true;
+        }
+        impl->wake.notify_one();
+        impl->writer.join();
+    }
+
+    bool SeriesRecorder::Active() const {
+        return impl->active.load(std::memory_order_relaxed);
+    }
+
+    void SeriesRecorder::Record(const std::vector<SensorSlot>& slots, unsigned int catalogVersion, int64_t timestamp, const float* values, size_t count) {
+        Impl& state = *impl;
+        if (!state.active.load(std::memory_order_relaxed)) return;
+        if (state.lastRecorded && timestamp - state.lastRecorded < state.options.interval) return;
+        state.lastRecorded = timestamp;
+
+        // 感測器集合改變：送出目前的區塊，之後的區塊寫到新的區段
+        if (!state.catalog || state.catalogVersion != catalogVersion || state.columns.size() != count) {
+            state.FlushBlock();
+            state.BeginCatalog(slots, catalogVersion, count);
+        }
+
+        int64_t milliseconds = ToMilliseconds(timestamp);
+        if (state.blockSamples == 0) {
+            state.blockFirst = milliseconds;
+            state.time.Reset(milliseconds);
+        }
+        else {
+            state.time.Append(state.timeWriter, milliseconds);
+        }
+        state.blockLast = milliseconds;
+
+        for (size_t i = 0; i < count; ++i) state.columns[i]->Append(values[i]);
+
+        if (++state.blockSamples >= state.options.samplesPerBlock) state.FlushBlock();
+    }
+
+    SeriesRecorderStats SeriesRecorder::Stats() const {
+        SeriesRecorderStats stats;
+        stats.segments = impl->segments;
+        stats.blocks = impl->blocks;
+        stats.samples = impl->samples;
+        stats.values = impl->values;
+        stats.bytes = impl->bytes;
+        stats.droppedBlocks = impl->droppedBlocks;
+        stats.writeErrors = impl->writeErrors;
+        return stats;
+    }
+
+    SeriesReader::~SeriesReader() {
+        Close();
+    }
+
+    // 讀取映射區域時的游標，超出範圍時 ok 變為 false
+    struct SegmentCursor {
+        const unsigned char* data;
+        size_t size;
+        size_t position = 0;
+        bool ok = true;
+
+        bool Read(void* target, size_t length) {
+            if (!ok || size - position < length) return ok = false;
+            std::memcpy(target, data + position, length);
+            position += length;
+            return true;
+        }
+
+        bool ReadString(std::string& text) {
+            uint32_t length;
+            if (!Read(&length, sizeof(length)) || size - position < length) return ok = false;
+            text.assign(reinterpret_cast<const char*>(data + position), length);
+            position += length;
+            return true;
+        }
+    };
+
+    bool SeriesReader::Open(const std::string& path) {
+        Close();
+
+#ifdef _WIN32
+        HANDLE handle = CreateFileW(WidePath(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER length;
+        if (!GetFileSizeEx(handle, &length) || length.QuadPart < static_cast<LONGLONG>(sizeof(SegmentMagic))) {
+            CloseHandle(handle);
+            return false;
+        }
+        HANDLE view = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!view) {
+            CloseHandle(handle);
+            return false;
+        }
+        data = static_cast<const unsigned char*>(MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0));
+        if (!data) {
+            CloseHandle(view);
+            CloseHandle(handle);
+            return false;
+        }
+        file = handle;
+        mapping = view;
+        size = static_cast<size_t>(length.QuadPart);
+#else
+        int descriptor = ::open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) return false;
+
+        struct stat status;
+        if (fstat(descriptor, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(SegmentMagic))) {
+            ::close(descriptor);
+            return false;
+        }
+        void* address = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, descriptor, 0);
+        ::close(descriptor);
+        if (address == MAP_FAILED) return false;
+        data = static_cast<const unsigned char*>(address);
+        size = static_cast<size_t>(status.st_size);
+#endif
+
+        // 區段標頭與目錄
+        SegmentCursor cursor = { data, size };
+        char magic[sizeof(SegmentMagic)];
+        uint32_t version = 0;
+        uint32_t columnCount = 0;
+        cursor.Read(magic, sizeof(magic));
+        cursor.Read(&version, sizeof(version));
+        cursor.Read(&columnCount, sizeof(columnCount));
+        if (!cursor.ok || std::memcmp(magic, SegmentMagic, sizeof(magic)) != 0 || version != SegmentVersion) {
+            Close();
+            return false;
+        }
+        for (uint32_t i = 0; i < columnCount && cursor.ok; ++i) {
+            SeriesColumn column;
+            int32_t hardwareType = 0;
+            int32_t sensorType = 0;
+            cursor.Read(&hardwareType, sizeof(hardwareType));
+            cursor.Read(&sensorType, sizeof(sensorType));
+            cursor.ReadString(column.identifier);
+            cursor.ReadString(column.hardwareName);
+            cursor.ReadString(column.name);
+            column.hardwareType = hardwareType;
+            column.sensorType = sensorType;
+            columns.push_back(std::move(column));
+        }
+        if (!cursor.ok) {
+            Close();
+            return false;
+        }
+
+        // 正常結束的區段有索引；寫入中或異常結束的區段逐一掃描完整的區塊
+        SegmentTrailer trailer;
+        if (size >= cursor.position + sizeof(trailer)) {
+            std::memcpy(&trailer, data + size - sizeof(trailer), sizeof(trailer));
+            uint64_t indexBytes = static_cast<uint64_t>(trailer.blockCount) * sizeof(IndexEntry);
+            uint64_t indexEnd = size - sizeof(trailer);
+            if (std::memcmp(trailer.magic, TrailerMagic, sizeof(trailer.magic)) == 0 &&
+                trailer.indexOffset >= cursor.position && trailer.indexOffset <= indexEnd && indexEnd - trailer.indexOffset == indexBytes) {
+                blocks.resize(trailer.blockCount);
+                std::memcpy(blocks.data(), data + trailer.indexOffset, indexBytes);
+
+                // 索引中的每個位置都必須能放下區塊標頭，否則視為沒有索引
+                bool valid = true;
+                for (const BlockEntry& entry : blocks) {
+                    if (entry.offset < cursor.position || entry.offset > size || size - entry.offset < sizeof(BlockHeader)) {
+                        valid = false;
+                        break;
+                    }
+                }
+                if (valid) {
+                    complete = true;
+                    return true;
+                }
+                blocks.clear();
+            }
+        }
+
+        size_t offset = cursor.position;
+        while (size - offset >= sizeof(BlockHeader)) {
+            BlockHeader header;
+            std::memcpy(&header, data + offset, sizeof(header));
+            if (header.magic != BlockMagic || header.size < sizeof(header) || size - offset < header.size) break;
+            blocks.push_back({ offset, header.first, header.last });
+            offset += header.size;
+        }
+        return true;
+    }
+
+    void SeriesReader::Close() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(static_cast<HANDLE>(mapping));
+        if (file) CloseHandle(static_cast<HANDLE>(file));
+#else
+        if (data) munmap(const_cast<unsigned char*>(data), size);
+#endif
+        data = nullptr;
+        size = 0;
+        file = nullptr;
+        mapping = nullptr;
+        columns.clear();
+        blocks.clear();
+        complete = false;
+    }
+
+    int SeriesReader::Find(const std::string& identifier) const {
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (columns[i].identifier == identifier) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    int64_t SeriesReader::FirstTimestamp() const {
+        return blocks.empty() ? 0 : blocks.front().first * 1000;
+    }
+
+    int64_t SeriesReader::LastTimestamp() const {
+        return blocks.empty() ? 0 : blocks.back().last * 1000;
+    }
+
+    size_t SeriesReader::Scan(size_t column, int64_t from, int64_t to, std::vector<int64_t>& timestamps, std::vector<float>& values) const {
+        if (column >= columns.size()) return 0;
+
+        int64_t fromMs = ToMilliseconds(from);
+        int64_t toMs = ToMilliseconds(to);
+        size_t appended = 0;
+        for (const BlockEntry& entry : blocks) {
+            if (entry.last < fromMs || entry.first > toMs) continue;
+
+            BlockHeader header;
+            std::memcpy(&header, data + entry.offset, sizeof(header));  // Open 已確認位置能放下標頭
+            uint64_t directoryBytes = (static_cast<uint64_t>(header.columns) + 2) * sizeof(uint32_t);
+            if (header.magic != BlockMagic || column >= header.columns || size - entry.offset < header.size ||
+                header.size < sizeof(header) + directoryBytes) continue;
+
+            // 目錄：時間欄與這一欄的起點/終點
+            const unsigned char* directory = data + entry.offset + sizeof(header);
+            const unsigned char* payload = directory + directoryBytes;
+            uint32_t timeStart, timeEnd, valueStart, valueEnd, payloadEnd;
+            std::memcpy(&timeStart, directory, sizeof(uint32_t));
+            std::memcpy(&timeEnd, directory + sizeof(uint32_t), sizeof(uint32_t));
+            std::memcpy(&valueStart, directory + (column + 1) * sizeof(uint32_t), sizeof(uint32_t));
+            std::memcpy(&valueEnd, directory + (column + 2) * sizeof(uint32_t), sizeof(uint32_t));
+            std::memcpy(&payloadEnd, directory + (static_cast<size_t>(header.columns) + 1) * sizeof(uint32_t), sizeof(uint32_t));
+            if (timeEnd < timeStart || timeEnd > payloadEnd || valueEnd < valueStart || valueEnd > payloadEnd ||
+                static_cast<size_t>(payload - (data + entry.offset)) + payloadEnd > header.size) continue;
+
+            // 第一筆之後每筆取樣在時間欄與數值欄都至少佔 1 位元，損壞的取樣數不會超過欄位內容
+            uint64_t columnBits = static_cast<uint64_t>(std::min(timeEnd - timeStart, valueEnd - valueStart)) * 8;
+            uint32_t samples = static_cast<uint32_t>(std::min<uint64_t>(header.samples, columnBits + 1));
+
+            BitReader timeReader(payload + timeStart, timeEnd - timeStart);
+            BitReader valueReader(payload + valueStart, valueEnd - valueStart);
+            TimeDecoder time(header.first);
+            ValueDecoder value;
+            for (uint32_t i = 0; i < samples; ++i) {
+                int64_t timestamp = i == 0 ? header.first : time.Next(timeReader);
+                float sample = value.Next(valueReader);
+                if (timestamp < fromMs || timestamp > toMs) continue;
+
+                timestamps.push_back(timestamp * 1000);
+                values.push_back(sample);
+                appended++;
+            }
+        }
+        return appended;
+    }
+}
@@ -0,0 +1,119 @@
+﻿#pragma once
+
+// 時間序列錄製：背景將取樣附加到欄式的區段檔 (*.hwts)，供長期容量分析使用。
+// 每個區塊有一個共用的時間欄 (Gorilla delta-of-delta，毫秒精度) 與每個感測器一欄數值 (Gorilla XOR 浮點數壓縮)，
+// 區塊開頭的目錄記錄每一欄的位置，讀取端映射檔案後只解碼時間欄與需要的感測器。
+// 區段依大小或涵蓋時間輪替，感測器集合改變時也換新的區段 (目錄寫在區段開頭)。
+// 純原生程式碼 (Windows 使用檔案對應，其他平台使用 mmap)，讀取端可單獨編譯使用。
+
+#include "HardwareModel.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace HardwareInfoDll {
+    struct SeriesRecorderOptions {
+        std::string directory;  // 區段檔所在的目錄 (UTF-8，需已存在)
+        int64_t interval = 1000000;  // 最小取樣間隔 (微秒)，發布較頻繁時略過
+        uint32_t samplesPerBlock = 600;  // 每個區塊的取樣數 (1 秒間隔時為 10 分鐘)
+        uint64_t maxSegmentBytes = 64ull << 20;  // 區段超過此大小時輪替
+        int64_t maxSegmentDuration = 86400000000LL;  // 區段涵蓋超過此時間 (微秒) 時輪替
+    };
+
+    struct SeriesRecorderStats {
+        long long segments = 0;  // 建立的區段數
+        long long blocks = 0;  // 寫入的區塊數
+        long long samples = 0;  // 記錄的取樣數
+        long long values = 0;  // 記錄的數值數 (取樣數 x 感測器數)
+        long long bytes = 0;  // 寫入的位元組數 (含目錄與索引)
+        long long droppedBlocks = 0;  // 寫入端落後太多而捨棄的區塊
+        long long writeErrors = 0;  // 無法建立或寫入區段的次數
+    };
+
+    class SeriesRecorder {
+        struct Impl;
+        Impl* impl;
+
+        public:
+        SeriesRecorder();
+        ~SeriesRecorder();
+
+        SeriesRecorder(const SeriesRecorder&) = delete;
+        SeriesRecorder& operator=(const SeriesRecorder&) = delete;
+
+        // 建立第一個區段並啟動寫入執行緒，無法建立檔案時回傳 false
+        bool Start(const SeriesRecorderOptions& options);
+
+        // 寫入未滿的區塊與區段索引後結束 (呼叫端需確保 Record 不會同時執行)
+        void Stop();
+
+        bool Active() const;
+
+        // 由發布端呼叫 (同時只有一個執行緒)：距離上一筆未達間隔時直接返回，
+        // 只在記憶體中編碼；區塊滿時交給寫入執行緒 (slots 只在目錄版本改變時讀取)
+        void Record(const std::vector<SensorSlot>& slots, unsigned int catalogVersion, int64_t timestamp, const float* values, size_t count);
+
+        SeriesRecorderStats Stats() const;
+    };
+
+    // 區段中的一個感測器
+    struct SeriesColumn {
+        std::string identifier;
+        std::string hardwareName;
+        std::string name;
+        int hardwareType = 0;
+        int sensorType = 0;
+    };
+
+    // 讀取端：映射一個區段檔 (寫入中的區段只讀到已完成的區塊)
+    class SeriesReader {
+        struct BlockEntry {
+            uint64_t offset;
+            int64_t first;  // 毫秒
+            int64_t last;
+        };
+
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+        void* file = nullptr;  // Windows 檔案與對應控制代碼
+        void* mapping = nullptr;
+        std::vector<SeriesColumn> columns;
+        std::vector<BlockEntry> blocks;
+        bool complete = false;
+
+        public:
+        SeriesReader() = default;
+        ~SeriesReader();
+
+        SeriesReader(const SeriesReader&) = delete;
+        SeriesReader& operator=(const SeriesReader&) = delete;
+
+        // 映射並讀取目錄與區塊索引，不是區段檔或還沒有目錄時回傳 false
+        bool Open(const std::string& path);  // path 為 UTF-8
+        void Close();
+
+        const std::vector<SeriesColumn>& Columns() const {
+            return columns;
+        }
+
+        int Find(const std::string& identifier) const;  // 欄位編號 (沒有時回傳 -1)
+
+        size_t BlockCount() const {
+            return blocks.size();
+        }
+
+        bool Complete() const {  // 區段已正常結束 (有索引)；否則為逐一掃描區塊得到的結果
+            return complete;
+        }
+
+        int64_t FirstTimestamp() const;  // 第一筆取樣 (Unix epoch 微秒，沒有區塊時為 0)
+
+        int64_t LastTimestamp() const;  // 最後一筆取樣
+
+        // 將 column 在 [from, to] (Unix epoch 微秒) 的樣本附加到 timestamps/values，回傳附加的筆數。
+        // 只解碼時間重疊的區塊中的時間欄與這一欄
+        size_t Scan(size_t column, int64_t from, int64_t to, std::vector<int64_t>& timestamps, std::vector<float>& values) const;
+    };
+}
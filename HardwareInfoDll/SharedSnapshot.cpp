@@ -0,0 +1,348 @@
+﻿#include "SharedSnapshot.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace HardwareInfoDll {
+    namespace {
+        const int ReadRetries = 64;  // 讀取時遇到寫入中的最多重試次數
+
+        static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "seqlock 需要與 uint64_t 相同大小的 atomic");
+
+        // 區域中由另一個處理程序同時存取的欄位以 atomic 存取
+        inline std::atomic<uint64_t>& Sequence(const HwiSharedHeader* header) {
+            return *reinterpret_cast<std::atomic<uint64_t>*>(const_cast<uint64_t*>(&header->sequence));
+        }
+
+        inline std::atomic<int64_t>& Heartbeat(const HwiSharedHeader* header) {
+            return *reinterpret_cast<std::atomic<int64_t>*>(const_cast<int64_t*>(&header->heartbeat));
+        }
+
+        int64_t NowMicroseconds() {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        size_t AlignUp(size_t value, size_t alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        uint32_t CurrentProcessId() {
+#ifdef _WIN32
+            return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+            return static_cast<uint32_t>(getpid());
+#endif
+        }
+
+        bool ProcessAlive(uint32_t pid) {
+#ifdef _WIN32
+            HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, pid);
+            if (!process) return false;
+            bool alive = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+            CloseHandle(process);
+            return alive;
+#else
+            return kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+#endif
+        }
+
+#ifdef _WIN32
+        std::wstring MappingName(const std::string& name) {
+            std::wstring wide(MultiByteToWideChar(CP_UTF8, 0, name.c_str(), -1, nullptr, 0), L'\0');
+            MultiByteToWideChar(CP_UTF8, 0, name.c_str(), -1, &wide[0], static_cast<int>(wide.size()));
+            wide.resize(wide.size() - 1);
+            if (wide.find(L'\\') != std::wstring::npos) return wide;  // 已指定命名空間 (例如 Global\name)
+            return L"Local\\" + wide;
+        }
+#else
+        std::string MappingName(const std::string& name) {
+            return "/" + name;
+        }
+#endif
+
+        bool MapRegion(SharedMapping& mapping, const std::string& name, size_t size, bool create) {
+#ifdef _WIN32
+            std::wstring mappingName = MappingName(name);
+            HANDLE handle;
+            if (create) {
+                handle = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                    static_cast<DWORD>(static_cast<unsigned long long>(size) >> 32), static_cast<DWORD>(size), mappingName.c_str());
+                if (handle && GetLastError() == ERROR_ALREADY_EXISTS) {
+                    CloseHandle(handle);  // 已經有其他發布者
+                    return false;
+                }
+            }
+            else {
+                handle = OpenFileMappingW(FILE_MAP_READ, FALSE, mappingName.c_str());
+            }
+            if (!handle) return false;
+
+            void* address = MapViewOfFile(handle, create ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+            if (!address) {
+                CloseHandle(handle);
+                return false;
+            }
+
+            if (!create) {
+                MEMORY_BASIC_INFORMATION info;
+                size = VirtualQuery(address, &info, sizeof(info)) ? info.RegionSize : 0;
+            }
+            mapping.handle = handle;
+#else
+            std::string mappingName = MappingName(name);
+            int fd = create ? shm_open(mappingName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644) : shm_open(mappingName.c_str(), O_RDONLY, 0);
+            if (fd < 0) return false;
+
+            if (create) {
+                if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+                    close(fd);
+                    shm_unlink(mappingName.c_str());
+                    return false;
+                }
+            }
+            else {
+                struct stat info;
+                if (fstat(fd, &info) != 0) {
+                    close(fd);
+                    return false;
+                }
+                size = static_cast<size_t>(info.st_size);
+            }
+
+            void* address = size ? mmap(nullptr, size, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+            close(fd);  // 映射後不再需要檔案描述元
+            if (address == MAP_FAILED) {
+                if (create) shm_unlink(mappingName.c_str());
+                return false;
+            }
+#endif
+            mapping.address = address;
+            mapping.size = size;
+            mapping.name = name;
+            return true;
+        }
+
+        void UnmapRegion(SharedMapping& mapping, bool unlink) {
+            if (!mapping.address) return;
+#ifdef _WIN32
+            (void)unlink;  // 最後一個控制代碼關閉時由系統移除
+            UnmapViewOfFile(mapping.address);
+            CloseHandle(static_cast<HANDLE>(mapping.handle));
+#else
+            munmap(mapping.address, mapping.size);
+            if (unlink) shm_unlink(MappingName(mapping.name).c_str());
+#endif
+            mapping = SharedMapping();
+        }
+
+#ifndef _WIN32
+        // 名稱已存在時判斷是否為異常結束的發布者留下的區域。標頭不完整 (在 Create 寫入 magic 前結束、
+        // 大小為 0 或版本不同) 時不能以 SharedSnapshotReader 開啟，只依標頭中的處理程序 ID 判斷：
+        // 處理程序已不存在或還沒寫入 ID 時都可以移除重建
+        bool AbandonedRegion(const std::string& name) {
+            int fd = shm_open(MappingName(name).c_str(), O_RDONLY, 0);
+            if (fd < 0) return errno == ENOENT;  // 已被移除
+
+            HwiSharedHeader existing = {};
+            struct stat info;
+            bool readable = fstat(fd, &info) == 0;
+            if (readable && static_cast<size_t>(info.st_size) >= sizeof(existing)) {
+                void* address = mmap(nullptr, sizeof(existing), PROT_READ, MAP_SHARED, fd, 0);
+                if (address != MAP_FAILED) {
+                    std::memcpy(&existing, address, sizeof(existing));
+                    munmap(address, sizeof(existing));
+                }
+                else {
+                    readable = false;
+                }
+            }
+            close(fd);
+
+            if (!readable) return false;  // 無法確認時保留 (例如沒有權限)
+            return existing.publisherPid == 0 || !ProcessAlive(existing.publisherPid);
+        }
+#endif
+    }
+
+    SharedSnapshotWriter::~SharedSnapshotWriter() {
+        Close();
+    }
+
+    bool SharedSnapshotWriter::Create(const std::string& name, uint32_t capacity) {
+        Close();
+
+        size_t snapshotOffset = AlignUp(sizeof(HwiSharedHeader), 64);
+        size_t catalogOffset = AlignUp(snapshotOffset + sizeof(HwiSnapshotHeader) + capacity * sizeof(float), 64);
+        size_t size = catalogOffset + capacity * sizeof(HwiCatalogEntry);
+        if (!MapRegion(mapping, name, size, true)) {
+#ifdef _WIN32
+            return false;  // 發布者結束時系統會自動移除對應，存在即表示仍有發布者
+#else
+            // 上一個發布者異常結束時名稱會留下，確認處理程序已不存在後才移除重建
+            if (!AbandonedRegion(name)) return false;
+            shm_unlink(MappingName(name).c_str());
+            if (!MapRegion(mapping, name, size, true)) return false;
+#endif
+        }
+
+        // 處理程序 ID 最先寫入 (新的區域內容為 0)：寫入 magic 前結束時，下一個發布者依此判斷能否移除
+        header = static_cast<HwiSharedHeader*>(mapping.address);
+        header->publisherPid = CurrentProcessId();
+        std::memset(static_cast<unsigned char*>(mapping.address) + sizeof(HwiSharedHeader), 0, size - sizeof(HwiSharedHeader));
+        header->regionSize = size;
+        header->capacity = capacity;
+        header->snapshotOffset = static_cast<uint32_t>(snapshotOffset);
+        header->catalogOffset = static_cast<uint32_t>(catalogOffset);
+        header->version = HWI_SHARED_VERSION;
+
+        // magic 最後寫入：讀者看到 magic 時其餘欄位已經就緒
+        std::atomic_thread_fence(std::memory_order_release);
+        reinterpret_cast<std::atomic<uint32_t>*>(&header->magic)->store(HWI_SHARED_MAGIC, std::memory_order_release);
+        return true;
+    }
+
+    void SharedSnapshotWriter::Close() {
+        if (header) {
+            Heartbeat(header).store(0, std::memory_order_release);  // 讓仍在映射的讀者知道發布已停止
+            header = nullptr;
+        }
+        UnmapRegion(mapping, true);
+    }
+
+    void SharedSnapshotWriter::Publish(const void* snapshot, size_t size) {
+        if (!header || size < sizeof(HwiSnapshotHeader)) return;
+
+        auto region = static_cast<unsigned char*>(mapping.address);
+        HwiSnapshotHeader source;
+        std::memcpy(&source, snapshot, sizeof(source));
+        uint32_t count = source.sensorCount < header->capacity ? source.sensorCount : header->capacity;
+        source.sensorCount = count;
+
+        std::atomic<uint64_t>& sequence = Sequence(header);
+        uint64_t start = sequence.load(std::memory_order_relaxed);
+        sequence.store(start + 1, std::memory_order_relaxed);  // 奇數：寫入中
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::memcpy(region + header->snapshotOffset, &source, sizeof(source));
+        std::memcpy(region + header->snapshotOffset + sizeof(HwiSnapshotHeader),
+            static_cast<const unsigned char*>(snapshot) + sizeof(HwiSnapshotHeader), count * sizeof(float));
+        Heartbeat(header).store(NowMicroseconds(), std::memory_order_relaxed);
+
+        sequence.store(start + 2, std::memory_order_release);
+    }
+
+    void SharedSnapshotWriter::PublishCatalog(const HwiCatalogEntry* entries, uint32_t count, uint32_t catalogVersion) {
+        if (!header) return;
+        if (count > header->capacity) count = header->capacity;
+
+        std::atomic<uint64_t>& sequence = Sequence(header);
+        uint64_t start = sequence.load(std::memory_order_relaxed);
+        sequence.store(start + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::memcpy(static_cast<unsigned char*>(mapping.address) + header->catalogOffset, entries, count * sizeof(HwiCatalogEntry));
+        header->catalogCount = count;
+        header->catalogVersion = catalogVersion;
+
+        sequence.store(start + 2, std::memory_order_release);
+    }
+
+    SharedSnapshotReader::~SharedSnapshotReader() {
+        Close();
+    }
+
+    bool SharedSnapshotReader::Open(const std::string& name) {
+        Close();
+        if (!MapRegion(mapping, name, 0, false)) return false;
+
+        auto candidate = static_cast<const HwiSharedHeader*>(mapping.address);
+        bool valid = mapping.size >= sizeof(HwiSharedHeader)
+            && reinterpret_cast<const std::atomic<uint32_t>*>(&candidate->magic)->load(std::memory_order_acquire) == HWI_SHARED_MAGIC
+            && candidate->version == HWI_SHARED_VERSION
+            && candidate->regionSize <= mapping.size;
+        if (!valid) {
+            UnmapRegion(mapping, false);
+            return false;
+        }
+
+        header = candidate;
+        return true;
+    }
+
+    void SharedSnapshotReader::Close() {
+        header = nullptr;
+        UnmapRegion(mapping, false);
+    }
+
+    int32_t SharedSnapshotReader::Read(void* buffer, uint32_t size) const {
+        if (!header) return 0;
+
+        auto region = static_cast<const unsigned char*>(mapping.address);
+        const std::atomic<uint64_t>& sequence = Sequence(header);
+        for (int attempt = 0; attempt < ReadRetries; ++attempt) {
+            uint64_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1) continue;  // 寫入中
+
+            HwiSnapshotHeader snapshot;
+            std::memcpy(&snapshot, region + header->snapshotOffset, sizeof(snapshot));
+            uint32_t count = snapshot.sensorCount < header->capacity ? snapshot.sensorCount : header->capacity;
+            uint32_t required = static_cast<uint32_t>(sizeof(HwiSnapshotHeader) + count * sizeof(float));
+            if (size >= required) std::memcpy(buffer, region + header->snapshotOffset, required);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) != before) continue;  // 讀取期間有新的發布
+
+            if (size < required) return -static_cast<int32_t>(required);
+            return static_cast<int32_t>(required);
+        }
+        return 0;
+    }
+
+    int32_t SharedSnapshotReader::ReadCatalog(HwiCatalogEntry* entries, uint32_t capacity, uint32_t* catalogVersion) const {
+        if (!header) return -1;
+
+        auto region = static_cast<const unsigned char*>(mapping.address);
+        const std::atomic<uint64_t>& sequence = Sequence(header);
+        for (int attempt = 0; attempt < ReadRetries; ++attempt) {
+            uint64_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1) continue;
+
+            uint32_t count = header->catalogCount < header->capacity ? header->catalogCount : header->capacity;
+            uint32_t copied = count < capacity ? count : capacity;
+            if (entries && copied) std::memcpy(entries, region + header->catalogOffset, copied * sizeof(HwiCatalogEntry));
+            uint32_t version = header->catalogVersion;
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) != before) continue;
+
+            if (catalogVersion) *catalogVersion = version;
+            return static_cast<int32_t>(count);
+        }
+        return -1;
+    }
+
+    int64_t SharedSnapshotReader::AgeMicroseconds() const {
+        if (!header) return -1;
+
+        int64_t heartbeat = Heartbeat(header).load(std::memory_order_acquire);
+        if (heartbeat == 0) return -1;  // 尚未發布或發布者已關閉
+        return NowMicroseconds() - heartbeat;
+    }
+
+    bool SharedSnapshotReader::PublisherAlive() const {
+        return header && header->publisherPid != 0 && ProcessAlive(header->publisherPid);
+    }
+}
@@ -0,0 +1,86 @@
+﻿#pragma once
+
+// 共享記憶體快照：一個處理程序取樣並發布，任意數量的處理程序以唯讀方式映射後直接讀取，
+// 讀取時不需要系統呼叫也不會與發布者競爭鎖 (seqlock)。
+// 純原生程式碼 (Windows 使用具名檔案對應，其他平台使用 shm_open/mmap)，讀者端可單獨編譯使用。
+
+#include "SnapshotLayout.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace HardwareInfoDll {
+    // 區域的對應 (建立或開啟後的位址與大小)
+    struct SharedMapping {
+        void* address = nullptr;
+        size_t size = 0;
+        void* handle = nullptr;  // Windows 檔案對應控制代碼
+        std::string name;  // 區域名稱
+    };
+
+    // 發布端 (每個名稱只能有一個)
+    class SharedSnapshotWriter {
+        SharedMapping mapping;
+        HwiSharedHeader* header = nullptr;
+
+        public:
+        SharedSnapshotWriter() = default;
+        ~SharedSnapshotWriter();
+
+        SharedSnapshotWriter(const SharedSnapshotWriter&) = delete;
+        SharedSnapshotWriter& operator=(const SharedSnapshotWriter&) = delete;
+
+        // 建立區域 (可放 capacity 個感測器)，失敗時回傳 false
+        bool Create(const std::string& name, uint32_t capacity);
+        void Close();
+
+        bool IsOpen() const {
+            return header != nullptr;
+        }
+
+        uint32_t Capacity() const {
+            return header ? header->capacity : 0;
+        }
+
+        // 發布一份快照 (HwiSnapshotHeader + float[])，超過容量的數值會被截斷
+        void Publish(const void* snapshot, size_t size);
+
+        // 發布目錄與其版本 (在同一次 seqlock 寫入中更新，讀者不會讀到新目錄配舊版本)
+        void PublishCatalog(const HwiCatalogEntry* entries, uint32_t count, uint32_t catalogVersion);
+    };
+
+    // 讀取端
+    class SharedSnapshotReader {
+        SharedMapping mapping;
+        const HwiSharedHeader* header = nullptr;
+
+        public:
+        SharedSnapshotReader() = default;
+        ~SharedSnapshotReader();
+
+        SharedSnapshotReader(const SharedSnapshotReader&) = delete;
+        SharedSnapshotReader& operator=(const SharedSnapshotReader&) = delete;
+
+        // 以唯讀方式映射區域，名稱不存在或版面不相容時回傳 false
+        bool Open(const std::string& name);
+        void Close();
+
+        bool IsOpen() const {
+            return header != nullptr;
+        }
+
+        // 複製最新的快照，回傳位元組數；buffer 不足時回傳負的所需大小；
+        // 發布者一直處於寫入中 (例如寫入時當機) 時回傳 0
+        int32_t Read(void* buffer, uint32_t size) const;
+
+        // 複製目錄，回傳項目總數 (可能大於 capacity)；無法取得一致的資料時回傳 -1
+        int32_t ReadCatalog(HwiCatalogEntry* entries, uint32_t capacity, uint32_t* catalogVersion) const;
+
+        // 距離最後一次發布的時間 (微秒)
+        int64_t AgeMicroseconds() const;
+
+        // 發布者的處理程序是否仍然存在
+        bool PublisherAlive() const;
+    };
+}
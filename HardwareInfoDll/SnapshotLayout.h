@@ -0,0 +1,131 @@
+﻿#pragma once
+
+// 二進位快照的固定版面 (C 相容，可直接由原生程式或共享記憶體讀取)
+
+#include <stdint.h>
+
+#define HWI_SNAPSHOT_MAGIC 0x49574853u  // "SHWI"
+#define HWI_SNAPSHOT_VERSION 1u
+
+#define HWI_SHARED_MAGIC 0x4D485348u  // "HSHM"
+#define HWI_SHARED_VERSION 2u  // 2：目錄版本移到 seqlock 保護的區域標頭
+
+#define HWI_FLEET_MAGIC 0x544C4648u  // "HFLT"
+#define HWI_FLEET_VERSION 1u
+#define HWI_FLEET_MAX_DATAGRAM 1400  // 封包上限 (不超過一般網路的 MTU，不需要 IP 分段)
+#define HWI_FLEET_NAME_LENGTH 32
+
+#define HWI_IDENTIFIER_LENGTH 64
+#define HWI_NAME_LENGTH 64
+#define HWI_UNIT_LENGTH 8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    // 快照標頭，後面緊接著 float values[sensorCount] (依槽位排列)
+    typedef struct HwiSnapshotHeader {
+        uint32_t magic;  // HWI_SNAPSHOT_MAGIC
+        uint32_t version;  // HWI_SNAPSHOT_VERSION
+        uint64_t sequence;  // 取樣序號 (每次發布遞增)
+        int64_t timestamp;  // 取樣時間 (Unix epoch 微秒)
+        uint32_t catalogVersion;  // 目錄版本，與 hwi_catalog_version 不同時需重新取得目錄
+        uint32_t sensorCount;  // 數值數量
+    } HwiSnapshotHeader;
+
+    // 感測器目錄項目 (字串為 UTF-8，以 '\0' 結尾，過長時截斷)
+    typedef struct HwiCatalogEntry {
+        uint32_t slot;  // 在 values 中的位置
+        uint16_t hardwareType;  // LibreHardwareMonitor HardwareType
+        uint16_t sensorType;  // LibreHardwareMonitor SensorType
+        char identifier[HWI_IDENTIFIER_LENGTH];
+        char hardwareName[HWI_NAME_LENGTH];
+        char sensorName[HWI_NAME_LENGTH];
+        char unit[HWI_UNIT_LENGTH];
+    } HwiCatalogEntry;
+
+    // 變化串流的一個感測器 (hwi_read_deltas)
+    typedef struct HwiDelta {
+        uint64_t sequence;  // 所屬批次的序號 (連續遞增)
+        uint32_t slot;  // 在 values 中的位置
+        float value;  // NaN 表示感測器不再有數值
+    } HwiDelta;
+
+    // 警示的觸發或解除 (hwi_set_alert_callback)
+    typedef struct HwiAlert {
+        int32_t ruleId;  // hwi_add_alert 回傳的編號
+        uint32_t slot;  // 在 values 中的位置
+        int32_t firing;  // 1 為觸發、0 為解除
+        float value;  // 當時的數值 (變化率條件為每秒變化)
+        int64_t timestamp;  // 取樣時間 (Unix epoch 微秒)
+        char identifier[HWI_IDENTIFIER_LENGTH];
+    } HwiAlert;
+
+    typedef void (*HwiAlertCallback)(const HwiAlert* alert, void* context);
+
+    // 共享記憶體區域的標頭，後面依序為快照 (HwiSnapshotHeader + float[capacity]) 與目錄 (HwiCatalogEntry[capacity])。
+    // sequence 為 seqlock：奇數表示發布者正在寫入，讀者讀取前後的值相同且為偶數時資料才一致
+    typedef struct HwiSharedHeader {
+        uint32_t magic;  // HWI_SHARED_MAGIC
+        uint32_t version;  // HWI_SHARED_VERSION
+        uint64_t regionSize;  // 整個區域的位元組數
+        uint32_t capacity;  // 最多可放的感測器數量
+        uint32_t publisherPid;  // 發布者的處理程序 ID
+        uint64_t sequence;  // seqlock 序號
+        int64_t heartbeat;  // 最後一次發布的時間 (Unix epoch 微秒)，用來判斷發布者是否停止
+        uint32_t snapshotOffset;  // 快照在區域中的位移
+        uint32_t catalogOffset;  // 目錄在區域中的位移
+        uint32_t catalogCount;  // 目錄項目數量
+        uint32_t catalogVersion;  // 目錄的版本 (與目錄在同一次寫入中更新，快照標頭的版本相同時目錄才對應這份快照)
+    } HwiSharedHeader;
+
+    // 集中收集的封包種類
+    enum {
+        HWI_FLEET_VALUES = 1,  // HwiFleetHeader + float[count] (槽位 first 起)
+        HWI_FLEET_CATALOG = 2  // HwiFleetHeader + HwiFleetHost + HwiFleetSensor[count] (槽位 first 起)
+    };
+
+    // 集中收集的封包標頭 (UDP 或 Unix datagram，小端序)：一次取樣依槽位切成多個封包，每個封包可單獨套用。
+    // 收集端依 hostId 與 sequence 去除重複與過期的封包，目錄版本不同時等待新的目錄
+    typedef struct HwiFleetHeader {
+        uint32_t magic;  // HWI_FLEET_MAGIC
+        uint16_t version;  // HWI_FLEET_VERSION
+        uint16_t kind;  // HWI_FLEET_VALUES 或 HWI_FLEET_CATALOG
+        uint64_t hostId;  // 主機名稱的 FNV-1a 雜湊
+        uint32_t instance;  // 送出端啟動時的亂數 (改變時收集端重新開始追蹤序號)
+        uint32_t catalogVersion;  // 目錄版本
+        uint64_t sequence;  // 取樣序號 (同一次取樣的封包相同)
+        int64_t timestamp;  // 取樣時間 (Unix epoch 微秒)
+        uint32_t sensorCount;  // 槽位總數
+        uint32_t first;  // 本封包的第一個槽位
+        uint16_t chunk;  // 本封包在同一次取樣中的編號
+        uint16_t count;  // 本封包的項目數
+        uint32_t reserved;
+    } HwiFleetHeader;
+
+    // 目錄封包的主機描述 (字串為 UTF-8，以 '\0' 結尾)
+    typedef struct HwiFleetHost {
+        char hostName[HWI_FLEET_NAME_LENGTH];
+        char group[HWI_FLEET_NAME_LENGTH];  // 彙總的分組 (例如機櫃)，空字串表示不分組
+    } HwiFleetHost;
+
+    // 目錄封包的一個感測器
+    typedef struct HwiFleetSensor {
+        uint16_t hardwareType;  // LibreHardwareMonitor HardwareType
+        uint16_t sensorType;  // LibreHardwareMonitor SensorType
+        char identifier[HWI_IDENTIFIER_LENGTH];
+        char name[HWI_NAME_LENGTH];
+    } HwiFleetSensor;
+
+    // 收集端的一個彙總結果 (hwi_collector_read)
+    typedef struct HwiFleetAggregate {
+        char rule[HWI_FLEET_NAME_LENGTH];  // 規則名稱
+        char group[HWI_FLEET_NAME_LENGTH];  // 分組 (空字串表示所有主機)
+        int32_t reduce;  // 0 最大、1 最小、2 總和、3 平均
+        uint32_t hosts;  // 有數值的主機數
+        double value;  // NaN 表示沒有主機有數值
+    } HwiFleetAggregate;
+
+#ifdef __cplusplus
+}
+#endif
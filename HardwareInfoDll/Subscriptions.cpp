@@ -0,0 +1,82 @@
+﻿#include "Subscriptions.h"
+
+#include <algorithm>
+
+namespace HardwareInfoDll {
+    static char FoldCase(char value) {
+        return value >= 'A' && value <= 'Z' ? static_cast<char>(value - 'A' + 'a') : value;
+    }
+
+    // 回溯到最後一個 '*'：線性時間，不需要遞迴或配置
+    bool WildcardMatch(const char* pattern, const char* text) {
+        const char* star = nullptr;  // 最後一個 '*' 之後的位置
+        const char* resume = nullptr;  // '*' 目前吸收到的位置
+        while (*text) {
+            if (*pattern == '*') {
+                star = ++pattern;
+                resume = text;
+            }
+            else if (*pattern && (*pattern == '?' || FoldCase(*pattern) == FoldCase(*text))) {
+                pattern++;
+                text++;
+            }
+            else if (star) {
+                pattern = star;
+                text = ++resume;
+            }
+            else {
+                return false;
+            }
+        }
+        while (*pattern == '*') pattern++;
+        return *pattern == 0;
+    }
+
+    int SubscriptionSet::Add(int hardwareType, const std::string& pattern) {
+        Subscription subscription;
+        subscription.id = nextId++;
+        subscription.hardwareType = hardwareType;
+        subscription.pattern = pattern.empty() ? "*" : pattern;
+        subscriptions.push_back(std::move(subscription));
+        return subscriptions.back().id;
+    }
+
+    bool SubscriptionSet::Remove(int id) {
+        auto found = std::find_if(subscriptions.begin(), subscriptions.end(), [id](const Subscription& subscription) {
+            return subscription.id == id;
+        });
+        if (found == subscriptions.end()) return false;
+
+        subscriptions.erase(found);
+        return true;
+    }
+
+    uint32_t SubscriptionSet::TypeMask() const {
+        uint32_t mask = 0;
+        for (auto& subscription : subscriptions) mask |= HardwareTypeBit(subscription.hardwareType);
+        return mask;
+    }
+
+    // 只在訂閱或繫結改變時執行；硬體至少有一個感測器符合某個同類型訂閱的樣式才需要更新
+    size_t SubscriptionSet::Apply(SensorModel& model) const {
+        size_t wanted = 0;
+        for (size_t i = 0; i < model.bindings.size(); ++i) {
+            HardwareBinding& binding = model.bindings[i];
+            const SourceHardware& descriptor = model.boundHardware[i];
+
+            bool subscribed = subscriptions.empty();
+            for (auto& subscription : subscriptions) {
+                if (subscribed) break;
+                if (subscription.hardwareType != binding.hardwareType) continue;
+
+                subscribed = std::any_of(descriptor.sensors.begin(), descriptor.sensors.end(), [&](const SourceSensor& sensor) {
+                    return WildcardMatch(subscription.pattern.c_str(), sensor.name.c_str());
+                });
+            }
+
+            binding.subscribed = subscribed;
+            if (subscribed) wanted++;
+        }
+        return wanted;
+    }
+}
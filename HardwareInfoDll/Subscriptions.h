@@ -0,0 +1,58 @@
+﻿#pragma once
+
+// 訂閱：使用者依 HardwareType 與感測器名稱樣式登記需要的資料，
+// 取樣只更新至少被一個訂閱需要的硬體，來源也只開啟訂閱到的硬體類別。
+// 沒有任何訂閱時維持原本的行為 (更新所有硬體)。
+// 純原生程式碼，由 HardwareInfo 與效能測試共用。
+
+#include "SensorModel.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace HardwareInfoDll {
+    // 萬用字元比對 ('*' 任意長度、'?' 單一字元，ASCII 不分大小寫)
+    bool WildcardMatch(const char* pattern, const char* text);
+
+    // SourceHardwareType 的位元遮罩
+    inline uint32_t HardwareTypeBit(int hardwareType) {
+        return hardwareType >= 0 && hardwareType < 32 ? 1u << hardwareType : 0;
+    }
+
+    // 沒有任何訂閱時 LibreHardwareMonitor 開啟的類別 (主機板、控制器、PSU 與電池需要時以 Subscribe 開啟)
+    const uint32_t DefaultHardwareMask = (1u << CpuHardware) | (1u << GpuNvidiaHardware) | (1u << GpuAmdHardware) | (1u << GpuIntelHardware) |
+        (1u << MemoryHardware) | (1u << NetworkHardware) | (1u << StorageHardware);
+
+    class SubscriptionSet {
+        struct Subscription {
+            int id;
+            int hardwareType;  // SourceHardwareType
+            std::string pattern;  // 感測器名稱樣式 (UTF-8)
+        };
+
+        std::vector<Subscription> subscriptions;
+        int nextId = 1;
+
+        public:
+        // 登記訂閱，回傳識別碼 (pattern 為空時視為 "*")
+        int Add(int hardwareType, const std::string& pattern);
+
+        // 移除訂閱，回傳是否存在
+        bool Remove(int id);
+
+        bool Empty() const {
+            return subscriptions.empty();
+        }
+
+        size_t Count() const {
+            return subscriptions.size();
+        }
+
+        // 訂閱到的硬體類型 (SourceHardwareType 位元遮罩)
+        uint32_t TypeMask() const;
+
+        // 依訂閱設定每個繫結的 subscribed，回傳需要更新的繫結數 (沒有訂閱時全部需要)
+        size_t Apply(SensorModel& model) const;
+    };
+}
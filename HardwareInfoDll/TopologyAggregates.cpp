@@ -0,0 +1,291 @@
+﻿#include "TopologyAggregates.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <limits>
+#include <stdint.h>
+#include <string>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define HWI_TOPOLOGY_SSE2 1
+#endif
+
+namespace HardwareInfoDll {
+    const char* TopologyStatName(int stat) {
+        switch (stat) {
+            case TopologyMin: return "Min";
+            case TopologyMax: return "Max";
+            case TopologyMean: return "Mean";
+            case TopologyP95: return "P95";
+            default: return "Stat";
+        }
+    }
+
+    // 每個指標的來源類型、名稱與 Identifier 用的鍵值
+    struct TopologyMetricDescriptor {
+        int sensorType;
+        const char* name;
+        const char* key;
+    };
+
+    static const TopologyMetricDescriptor TopologyMetrics[TopologyMetricCount] = {
+        { LoadSensor, "Load", "load" },
+        { ClockSensor, "Clock", "clock" },
+        { TemperatureSensor, "Temperature", "temperature" }
+    };
+
+    static const char* const TopologyStatKeys[TopologyStatCount] = { "min", "max", "mean", "p95" };
+
+    // 解析 "CPU Core #12"、"CPU Core #12 Thread #2" (只限負載) 或 "Core #12" (AMD 的每核心時脈) 的核心編號，
+    // 其他名稱 (例如 "CPU Core #1 Distance to TjMax") 回傳 0
+    static int ParseCore(const std::string& name, bool threads) {
+        const char* p = name.c_str();
+        if (name.compare(0, 10, "CPU Core #") == 0) p += 10;
+        else if (name.compare(0, 6, "Core #") == 0) p += 6;
+        else return 0;
+
+        int core = 0;
+        if (!std::isdigit(static_cast<unsigned char>(*p))) return 0;
+        while (std::isdigit(static_cast<unsigned char>(*p))) core = core * 10 + (*p++ - '0');
+        if (*p == '\0') return core;
+
+        if (!threads || std::strncmp(p, " Thread #", 9) != 0 || !std::isdigit(static_cast<unsigned char>(p[9]))) return 0;
+        for (p += 9; std::isdigit(static_cast<unsigned char>(*p)); ++p) {}
+        return *p == '\0' ? core : 0;
+    }
+
+    // 一個分組選取的核心
+    struct TopologySelection {
+        std::string key;  // Identifier 用的鍵值
+        std::string name;
+        int domain;  // L3 網域 (-1 表示不限)
+        int efficient;  // 1 效率核心、0 效能核心 (-1 表示不限)
+    };
+
+    size_t TopologyAggregates::Rebind(SensorModel& model, const CpuTopology& topology) {
+        groups.clear();
+        inputs.clear();
+        firstGroup.assign(1, 0);
+
+        // 先決定所有輸出再取欄位位址：加入名稱時 CoreSeries 的陣列可能重新配置
+        struct Pending {
+            SensorSlot description;
+            size_t index;
+        };
+        std::vector<Pending> pending;  // 每個分組 TopologyStatCount 個
+
+        size_t packages = 0;
+        for (const HardwareBinding& binding : model.bindings) {
+            if (binding.hardwareType == CpuHardware) packages++;
+        }
+
+        size_t package = 0;
+        for (size_t b = 0; b < model.bindings.size(); ++b) {
+            const HardwareBinding& binding = model.bindings[b];
+            const SourceHardware& hardware = model.boundHardware[b];
+            if (binding.hardwareType != CpuHardware) {
+                firstGroup.push_back(groups.size());
+                continue;
+            }
+
+            // 每個指標的來源 (核心編號, 在 sourceValues 的位置)
+            std::vector<std::pair<int, size_t>> sources[TopologyMetricCount];
+            int cores = 0;
+            for (size_t i = 0; i < hardware.sensors.size(); ++i) {
+                const SourceSensor& sensor = hardware.sensors[i];
+                for (int metric = 0; metric < TopologyMetricCount; ++metric) {
+                    if (sensor.sensorType != TopologyMetrics[metric].sensorType) continue;
+                    int core = ParseCore(sensor.name, metric == TopologyLoad);
+                    if (core == 0) continue;
+                    sources[metric].push_back({ core, binding.firstSensor + i });
+                    cores = std::max(cores, core);
+                }
+            }
+
+            const CpuPackageLayout* layout = package < topology.packages.size() && topology.packages[package].cores.size() == static_cast<size_t>(cores)
+                ? &topology.packages[package] : nullptr;
+            std::string prefix = packages > 1 ? "Socket #" + std::to_string(package + 1) + " " : "";
+            package++;
+
+            // 封裝一定輸出；L3 網域只在多於一個時、效能/效率核心只在混合架構時輸出
+            std::vector<TopologySelection> selections = { { "package", "Package", -1, -1 } };
+            if (layout && layout->domains > 1) {
+                for (int domain = 0; domain < layout->domains; ++domain)
+                    selections.push_back({ "l3-" + std::to_string(domain + 1), "L3 #" + std::to_string(domain + 1), domain, -1 });
+            }
+            if (layout && layout->hybrid) {
+                selections.push_back({ "pcores", "P-Cores", -1, 0 });
+                selections.push_back({ "ecores", "E-Cores", -1, 1 });
+            }
+
+            for (const TopologySelection& selection : selections) {
+                for (int metric = 0; metric < TopologyMetricCount; ++metric) {
+                    Group group = {};
+                    group.first = inputs.size();
+                    for (const auto& source : sources[metric]) {
+                        if (layout) {
+                            const CpuCoreLayout& core = layout->cores[source.first - 1];
+                            if (selection.domain >= 0 && core.domain != selection.domain) continue;
+                            if (selection.efficient >= 0 && core.efficient != (selection.efficient == 1)) continue;
+                        }
+                        inputs.push_back(source.second);
+                    }
+                    group.count = inputs.size() - group.first;
+                    if (group.count == 0) continue;
+
+                    // 來源在 sourceValues 中連續時 (常見情形) 以整段複製取代逐一讀取
+                    group.base = inputs[group.first];
+                    group.contiguous = true;
+                    for (size_t i = 1; i < group.count && group.contiguous; ++i) group.contiguous = inputs[group.first + i] == group.base + i;
+
+                    for (int stat = 0; stat < TopologyStatCount; ++stat) {
+                        Pending entry;
+                        entry.description.identifier = hardware.identifier + "/topology/" + selection.key + "/" + TopologyMetrics[metric].key + "/" + TopologyStatKeys[stat];
+                        entry.description.hardwareName = hardware.name;
+                        entry.description.name = prefix + selection.name + " " + TopologyMetrics[metric].name + " " + TopologyStatName(stat);
+                        entry.description.hardwareType = hardware.hardwareType;
+                        entry.description.sensorType = TopologyMetrics[metric].sensorType;
+                        entry.index = model.cpu.Topology.Values.size();
+                        model.cpu.Topology.Names.push_back(entry.description.name);
+                        model.cpu.Topology.Values.push_back(0.0f);
+                        pending.push_back(entry);
+                    }
+                    groups.push_back(group);
+                }
+            }
+            firstGroup.push_back(groups.size());
+        }
+
+        scratch.assign(inputs.size(), 0.0f);
+        for (size_t g = 0; g < groups.size(); ++g) {
+            for (int stat = 0; stat < TopologyStatCount; ++stat) {
+                Pending& entry = pending[g * TopologyStatCount + stat];
+                float* field = &model.cpu.Topology.Values[entry.index];
+                groups[g].fields[stat] = field;
+                groups[g].outputs[stat] = model.BindDerived(entry.description, field);
+            }
+        }
+        return Count();
+    }
+
+    // 計算 values 中有數值 (非 NaN) 的最小、最大與總和，回傳有數值的個數
+    static size_t Reduce(const float* values, size_t count, float& minimum, float& maximum, double& sum) {
+        float low = std::numeric_limits<float>::infinity();
+        float high = -std::numeric_limits<float>::infinity();
+        float total = 0.0f;
+        size_t valid = 0;
+        size_t i = 0;
+
+#ifdef HWI_TOPOLOGY_SSE2
+        // 一次 8 個：NaN 在 min/max 的第一個運算元時回傳第二個運算元 (累計值)，總和與個數以有序遮罩排除 NaN
+        if (count >= 8) {
+            __m128 minimums = _mm_set1_ps(low), maximums = _mm_set1_ps(high);
+            __m128 totals = _mm_setzero_ps();
+            __m128i counts = _mm_setzero_si128();
+            for (; i + 8 <= count; i += 8) {
+                __m128 first = _mm_loadu_ps(values + i);
+                __m128 second = _mm_loadu_ps(values + i + 4);
+                __m128 firstValid = _mm_cmpord_ps(first, first);
+                __m128 secondValid = _mm_cmpord_ps(second, second);
+                minimums = _mm_min_ps(second, _mm_min_ps(first, minimums));
+                maximums = _mm_max_ps(second, _mm_max_ps(first, maximums));
+                totals = _mm_add_ps(totals, _mm_add_ps(_mm_and_ps(first, firstValid), _mm_and_ps(second, secondValid)));
+                counts = _mm_sub_epi32(counts, _mm_add_epi32(_mm_castps_si128(firstValid), _mm_castps_si128(secondValid)));
+            }
+
+            float lanes[4];
+            int32_t laneCounts[4];
+            _mm_storeu_ps(lanes, minimums);
+            low = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+            _mm_storeu_ps(lanes, maximums);
+            high = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+            _mm_storeu_ps(lanes, totals);
+            total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(laneCounts), counts);
+            valid = static_cast<size_t>(laneCounts[0]) + laneCounts[1] + laneCounts[2] + laneCounts[3];
+        }
+#endif
+
+        for (; i < count; ++i) {
+            float value = values[i];
+            if (value != value) continue;
+            low = std::min(low, value);
+            high = std::max(high, value);
+            total += value;
+            valid++;
+        }
+
+        minimum = low;
+        maximum = high;
+        sum = total;
+        return valid;
+    }
+
+    // 最近排名法的 P95：少於 20 個時即為最大值；排名在前 8 名內時以插入排序保留最大的幾個，否則以選擇演算法 (平均 O(n))
+    static float Percentile95(float* values, size_t count, float maximum) {
+        size_t rank = (count * 95 + 99) / 100 - 1;
+        size_t top = count - rank;  // P95 是第 top 大的數值
+        if (top == 1) return maximum;
+
+        if (top <= 8) {
+            float largest[8];  // 由大到小
+            for (size_t i = 0; i < top; ++i) largest[i] = -std::numeric_limits<float>::infinity();
+            for (size_t i = 0; i < count; ++i) {
+                float value = values[i];
+                if (value <= largest[top - 1]) continue;
+                size_t position = top - 1;
+                for (; position > 0 && largest[position - 1] < value; --position) largest[position] = largest[position - 1];
+                largest[position] = value;
+            }
+            return largest[top - 1];
+        }
+
+        std::nth_element(values, values + rank, values + count);
+        return values[rank];
+    }
+
+    bool TopologyAggregates::Update(SensorModel& model, size_t bindingIndex) {
+        if (!Active(bindingIndex)) return false;
+
+        const float* sourceValues = model.sourceValues.data();
+        float* values = model.values.data();
+        bool changed = false;
+
+        size_t end = firstGroup[bindingIndex + 1];
+        for (size_t g = firstGroup[bindingIndex]; g < end; ++g) {
+            Group& group = groups[g];
+            float* work = scratch.data() + group.first;
+            if (group.contiguous) {
+                std::memcpy(work, sourceValues + group.base, group.count * sizeof(float));
+            }
+            else {
+                const size_t* input = inputs.data() + group.first;
+                for (size_t i = 0; i < group.count; ++i) work[i] = sourceValues[input[i]];
+            }
+
+            float result[TopologyStatCount];
+            double sum;
+            size_t valid = Reduce(work, group.count, result[TopologyMin], result[TopologyMax], sum);
+            if (valid == 0) continue;  // 本次沒有數值 (NaN)
+            if (valid < group.count) {  // 移除 NaN
+                size_t kept = 0;
+                for (size_t i = 0; i < group.count; ++i) {
+                    if (work[i] == work[i]) work[kept++] = work[i];
+                }
+            }
+
+            result[TopologyMean] = static_cast<float>(sum / valid);
+            result[TopologyP95] = Percentile95(work, valid, result[TopologyMax]);
+
+            for (int stat = 0; stat < TopologyStatCount; ++stat) {
+                size_t output = group.outputs[stat];
+                if (values[output] != result[stat]) changed = true;
+                values[output] = result[stat];
+                *group.fields[stat] = result[stat];
+            }
+        }
+        return changed;
+    }
+}
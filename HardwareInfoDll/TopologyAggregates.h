@@ -0,0 +1,69 @@
+﻿#pragma once
+
+// 拓撲彙總：依 CPU 拓撲把每核心的負載 (每個執行緒)、時脈與溫度分組 (每個封裝/插槽、每個 L3 網域、效能/效率核心)，
+// 每次 CPU 更新後以 SIMD 計算各組的最小、最大、平均與 P95。結果繫結為額外的槽位
+// (Identifier 為 CPU 的 Identifier 加上 "/topology/分組/指標/統計")，因此快照、目錄、共享記憶體、OpenMetrics、
+// 歷史、變化串流與集中收集都會包含，GetCPUInfo 則輸出在 "Topology" 中。
+// 純原生程式碼，由 HardwareInfo 與效能測試共用。
+
+#include "CpuTopology.h"
+#include "SensorModel.h"
+
+#include <stddef.h>
+#include <vector>
+
+namespace HardwareInfoDll {
+    enum TopologyMetric {
+        TopologyLoad,  // 每個執行緒的負載
+        TopologyClock,  // 每核心時脈
+        TopologyTemperature,  // 每核心溫度
+        TopologyMetricCount
+    };
+
+    enum TopologyStat {
+        TopologyMin,
+        TopologyMax,
+        TopologyMean,
+        TopologyP95,  // 最近排名法 (不內插)
+        TopologyStatCount
+    };
+
+    const char* TopologyStatName(int stat);  // "Min"、"Max"、"Mean"、"P95"
+
+    class TopologyAggregates {
+        struct Group {
+            size_t first;  // 來源在 inputs 中的起點 (也是在 scratch 中的起點)
+            size_t count;
+            size_t base;  // 來源在 sourceValues 中連續時的起點 (可直接複製)
+            bool contiguous;
+            size_t outputs[TopologyStatCount];  // 輸出槽位
+            float* fields[TopologyStatCount];  // 輸出的結構欄位
+        };
+
+        std::vector<Group> groups;  // 依繫結排列
+        std::vector<size_t> firstGroup;  // 每個繫結的第一個分組 (多一個結尾)
+        std::vector<size_t> inputs;  // 所有分組的來源在 sourceValues 的位置
+        std::vector<float> scratch;  // 與 inputs 對齊的工作區 (每個分組各自一段，不同繫結可同時更新)
+
+        public:
+        // 在 DerivedMetrics::Rebind 之後呼叫：依拓撲分組並繫結輸出槽位，回傳輸出數。
+        // 第 k 個 CPU 硬體對應 topology 的第 k 個封裝；沒有拓撲或核心數不符時只以封裝分組
+        size_t Rebind(SensorModel& model, const CpuTopology& topology);
+
+        // 繫結是否有分組 (只有 CPU)
+        bool Active(size_t bindingIndex) const {
+            return bindingIndex + 1 < firstGroup.size() && firstGroup[bindingIndex] != firstGroup[bindingIndex + 1];
+        }
+
+        // 在繫結 bindingIndex 的 Poll 之後呼叫，回傳是否有數值改變 (沒有數值的分組保留上一次的結果)
+        bool Update(SensorModel& model, size_t bindingIndex);
+
+        size_t Count() const {
+            return groups.size() * TopologyStatCount;
+        }
+
+        size_t GroupCount() const {
+            return groups.size();
+        }
+    };
+}
@@ -1,6 +1,7 @@
 ﻿using System;
 using System.Diagnostics;  // 引入 Stopwatch
 using HardwareInfoDll;  // 引用 C++/CLI DLL
+using LibreHardwareMonitor.Hardware;  // HardwareType
 
 namespace CPUInfoApp
 {
@@ -8,10 +9,45 @@ namespace CPUInfoApp
     {
         static void Main(string[] args)
         {
-            HardwareInfo hardwareInfo = new HardwareInfo();
+            // 讀取端：讀取其他處理程序發布的共享快照，不開啟 Computer
+            if (args.Length > 0 && args[0] == "--read-shared")
+            {
+                ReadShared(args.Length > 1 ? args[1] : "HardwareInfo");
+                return;
+            }
+
+            // 合成來源 (--synthetic [執行緒 GPU 磁碟 網路卡]) 或重播軌跡 (--replay 檔案)，不需要感測器硬體
+            HardwareInfo hardwareInfo;
+            if (args.Length > 0 && args[0] == "--synthetic")
+            {
+                int threads = args.Length > 1 ? int.Parse(args[1]) : 16;
+                int gpus = args.Length > 2 ? int.Parse(args[2]) : 1;
+                int disks = args.Length > 3 ? int.Parse(args[3]) : 2;
+                int nics = args.Length > 4 ? int.Parse(args[4]) : 2;
+                hardwareInfo = HardwareInfo.CreateSynthetic(threads, gpus, disks, nics);
+            }
+            else if (args.Length > 1 && args[0] == "--replay")
+            {
+                hardwareInfo = HardwareInfo.CreateReplay(args[1]);
+            }
+            else
+            {
+                // 背景平行開啟各類別，CPU 可讀取後就開始，不等待儲存裝置或 GPU
+                hardwareInfo = HardwareInfo.OpenInBackground();
+                hardwareInfo.WhenReady(HardwareType.Cpu).Wait();
+                Console.WriteLine(hardwareInfo.GetCPUInfo());
+                hardwareInfo.WhenReady().Wait();
+                Console.WriteLine(hardwareInfo.GetStartupStats());
+            }
+            hardwareInfo.StartSharedPublisher("HardwareInfo", 4096);
+            hardwareInfo.EnableDiagnostics(true);
+            if (hardwareInfo.StartMetricsServer(9182))
+                Console.WriteLine("OpenMetrics: http://127.0.0.1:" + hardwareInfo.GetMetricsPort() + "/metrics");
 
             // 計時器
             //hardwareInfo.StartSaveAllHardwareThread(1000);
+            //hardwareInfo.EnableAdaptiveSampling(0.5);  // 背景取樣依變化率調整週期，使用的 CPU 不超過單一核心的 0.5%
+            //hardwareInfo.StartSampling();
 
             //System.Threading.Thread.Sleep(600);  // 暫停 1 秒
 
@@ -19,13 +55,40 @@ namespace CPUInfoApp
             //var temp = hardwareInfo.GetMemoryInfo();
             //var temp = hardwareInfo.GetStorageInfo();
             //var temp = hardwareInfo.GetNetworkInfo();
+            //var temp = hardwareInfo.GetDeviceInfo();  // 需要先 Subscribe 主機板、控制器、PSU 或電池
+            //var temp = hardwareInfo.GetAllInfo();  // 所有類別一次取得 (同一次取樣)
+
+            // 同一處理程序中的多個外掛共用一個取樣核心 (每個 view 有自己的游標，最後一個 Dispose 時關閉)
+            //using (var view = HardwareInfo.Attach())
+            //{
+            //    view.WhenReady().Wait();
+            //    var temp = view.GetCPUInfo();
+            //}
 
             //Console.WriteLine(temp);
 
+            // 警示規則：CPU 最高核心溫度超過 95 度持續 10 秒 (回到 93 度以下解除)、GPU 熱點每秒上升超過 2 度
+            //hardwareInfo.AddAlertRule(HardwareType.Cpu, SensorType.Temperature, "Core Max", SensorAlertCondition.Above, 95, 2, 10);
+            //hardwareInfo.AddAlertRule(SensorType.Temperature, "GPU Hot Spot", SensorAlertCondition.Rising, 2, 1, 0);
+            //hardwareInfo.AlertChanged += alert => Console.WriteLine((alert.Firing ? "觸發 " : "解除 ") + alert.Identifier + " = " + alert.Value);
+
+            // 集中收集：每台主機每秒送出一次取樣，收集端彙總各機櫃的最高溫度與總功率
+            //hardwareInfo.StartFleetSender("udp://10.0.0.10:9183", null, "rack-1", 1000);
+            //var fleet = new HardwareFleetCollector("udp://0.0.0.0:9183");
+            //Console.WriteLine(fleet.GetAggregates());
+
             //hardwareInfo.PrintAllHardware();
 
+            // 變化串流：溫度超過 0.5 度、其他感測器超過 1% 才送出
+            hardwareInfo.SetDeadband("*", 0, 0.01f);
+            hardwareInfo.SetDeadband("*/temperature/*", 0.5f, 0);
+            hardwareInfo.StartDeltaStream(256);
+            long deltaSequence = 0;
+            int deltaChanges = 0;  // 送出的感測器數
+            int resyncCount = 0;
+
             //// 開始計時
-            long cnt = 0;
+            long cnt = 0;  // Stopwatch 刻度
             long testnum = 100;
             string previousCpuInfo = "";
             int changeCount = 0;  // 記錄 CPU Info 改變的次數
@@ -49,15 +112,123 @@ namespace CPUInfoApp
                     previousCpuInfo = cpuInfo;  // 更新上一個 CPU Info
                 }
 
-                cnt += stopwatch.ElapsedMilliseconds * 1000; // 轉換為微秒
+                cnt += stopwatch.ElapsedTicks;
+
+                // 只處理超過門檻的感測器；批次遺失時由基準數值重新同步
+                SensorDeltaBatch[] batches = hardwareInfo.ReadDeltas(deltaSequence, 0);
+                if (batches == null)
+                {
+                    hardwareInfo.GetDeltaBaseline(ref deltaSequence);
+                    resyncCount++;
+                    continue;
+                }
+                foreach (SensorDeltaBatch batch in batches)
+                {
+                    deltaChanges += batch.Changes.Length;
+                    deltaSequence = batch.Sequence;
+                }
             }
 
             //// 顯示變化次數
             Console.WriteLine("CPU Info changed " + changeCount + " times.");
+            Console.WriteLine("Delta stream: " + deltaChanges + " sensor changes in " + deltaSequence + " batches (" + resyncCount + " resyncs)");
 
             //// 顯示平均執行時間
-            double avgTime = (double)cnt / testnum;
+            double avgTime = cnt * 1e6 / Stopwatch.Frequency / testnum;  // 微秒
             Console.WriteLine("Average Execution Time: " + avgTime.ToString("F2") + " µs");
+
+            // 比較 JSON 序列化方式 (DOM / 串流 / 快取)
+            BenchmarkSerializers(hardwareInfo, 1000);
+
+            // 二進位快照：複製到預先配置的緩衝區，不產生 GC 配置
+            BenchmarkSnapshot(hardwareInfo, 1000);
+
+            // 感測器歷史：取得最近 10 秒的原始樣本 (解析度 0)
+            Console.WriteLine(hardwareInfo.GetHistoryInfo());
+            long now = DateTimeOffset.UtcNow.ToUnixTimeMilliseconds() * 1000;
+            SensorHistoryPoint[] history = hardwareInfo.GetHistory(0, now - 10000000, now, 0);
+            Console.WriteLine("History points for slot 0: " + history.Length);
+
+            // 自我量測：各硬體 Update() 與序列化的耗時分布、GPU 略過次數
+            Console.WriteLine(hardwareInfo.GetDiagnostics());
+        }
+
+        static void ReadShared(string name)
+        {
+            using (SharedHardwareReader reader = new SharedHardwareReader(name))
+            {
+                byte[] snapshot = new byte[32];
+                int size = reader.CopySnapshot(snapshot);
+                if (size < 0)
+                {
+                    snapshot = new byte[-size];
+                    size = reader.CopySnapshot(snapshot);
+                }
+
+                Console.WriteLine("Shared snapshot: " + size + " bytes, " + (reader.GetIdentifiers()?.Length ?? 0) + " sensors, age " +
+                    reader.GetAgeMicroseconds() + " µs" + (reader.IsStale(5000) ? " (stale)" : ""));
+            }
+        }
+
+        static void BenchmarkSnapshot(HardwareInfo hardwareInfo, int iterations)
+        {
+            byte[] snapshot = new byte[hardwareInfo.GetSnapshotSize()];
+            float[] values = new float[snapshot.Length / sizeof(float)];
+
+            long allocatedBefore = GC.GetAllocatedBytesForCurrentThread();
+            long start = Stopwatch.GetTimestamp();
+            for (int i = 0; i < iterations; i++)
+            {
+                hardwareInfo.CopySnapshot(snapshot);
+                hardwareInfo.CopyValues(values);
+            }
+            long elapsed = Stopwatch.GetTimestamp() - start;
+            long allocated = GC.GetAllocatedBytesForCurrentThread() - allocatedBefore;
+
+            Console.WriteLine("Snapshot copy: " + (elapsed * 1e6 / Stopwatch.Frequency / iterations).ToString("F2") + " µs, " +
+                (allocated / iterations) + " bytes allocated per read");
+
+            // 固定同一次取樣：CPU 與記憶體資訊保證來自同一個 frame
+            using (HardwareSnapshot pinned = hardwareInfo.AcquireSnapshot())
+            {
+                if (pinned != null)
+                {
+                    Console.WriteLine("Snapshot #" + pinned.GetSequence() + " (" + pinned.GetSize() + " bytes)");
+                    Console.WriteLine(pinned.GetCPUInfo());
+                    Console.WriteLine(pinned.GetMemoryInfo());
+                }
+            }
+        }
+
+        // 每次呼叫五個 Get*Info 的平均時間
+        static double MeasureGetInfo(HardwareInfo hardwareInfo, int iterations, bool useCache)
+        {
+            long start = Stopwatch.GetTimestamp();
+            for (int i = 0; i < iterations; i++)
+            {
+                if (!useCache) hardwareInfo.InvalidateJsonCache();
+                hardwareInfo.GetCPUInfo();
+                hardwareInfo.GetGPUInfo();
+                hardwareInfo.GetMemoryInfo();
+                hardwareInfo.GetStorageInfo();
+                hardwareInfo.GetNetworkInfo();
+            }
+            long elapsed = Stopwatch.GetTimestamp() - start;
+            return elapsed * 1e6 / Stopwatch.Frequency / iterations;  // 微秒
+        }
+
+        static void BenchmarkSerializers(HardwareInfo hardwareInfo, int iterations)
+        {
+            hardwareInfo.SetJsonSerializer(JsonSerializerKind.Dom);
+            double domTime = MeasureGetInfo(hardwareInfo, iterations, false);
+
+            hardwareInfo.SetJsonSerializer(JsonSerializerKind.Streaming);
+            double streamingTime = MeasureGetInfo(hardwareInfo, iterations, false);
+            double cachedTime = MeasureGetInfo(hardwareInfo, iterations, true);
+
+            Console.WriteLine("DOM serializer: " + domTime.ToString("F2") + " µs");
+            Console.WriteLine("Streaming serializer: " + streamingTime.ToString("F2") + " µs");
+            Console.WriteLine("Cached (no new sample): " + cachedTime.ToString("F2") + " µs");
         }
     }
 }